@@ -0,0 +1,593 @@
+/*--------------------------------------------------------------------*/
+/* benchsymtable.c                                                    */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() is a POSIX extension, so ask for it */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Benchmarks of the SymTable operations, timed one kind at a time
+   with a wall clock. The same program is linked against each
+   implementation, so their numbers compare like for like. Keys and
+   lookup orders are all made before any timing starts. */
+
+/* operations are timed in batches of BATCH_SIZE, and the percentiles
+   reported are of the batches' mean times per operation, since a
+   clock read costs about as much as a fast lookup. */
+enum { BATCH_SIZE = 64 };
+
+/* room for the longest key any distribution makes, with its NUL. */
+enum { MAX_KEY_LENGTH = 96 };
+
+/* the prefix of every long key: a path that all keys share, as the
+   names of files in one directory do. */
+static const char LONG_KEY_PREFIX[] =
+   "/var/lib/symtable/benchmark/keys/with/a/long/shared/prefix/";
+
+/*--------------------------------------------------------------------*/
+/* The kinds of keys benchmarked, and how lookups choose among them. */
+
+enum Distribution
+{
+   /* decimal numbers 0, 1, 2, and so on, looked up in random order. */
+   SEQUENTIAL,
+
+   /* scattered 32-bit numbers in hex, looked up in random order. */
+   RANDOM,
+
+   /* scattered numbers after LONG_KEY_PREFIX, so that keys differ
+      only past their first 60 bytes. */
+   LONG_KEYS,
+
+   /* RANDOM keys, looked up with Zipfian popularity, so that a few
+      keys take most of the lookups. */
+   ZIPFIAN,
+
+   DISTRIBUTION_COUNT
+};
+
+static const char *const apcDistributionNames[DISTRIBUTION_COUNT] =
+   {"sequential", "random", "long", "zipfian"};
+
+/*--------------------------------------------------------------------*/
+/* A KeySet is uCount keys stored in one buffer.                      */
+
+struct KeySet
+{
+   char *pcBuffer;
+   const char **ppcKeys;
+   size_t uCount;
+};
+
+/*--------------------------------------------------------------------*/
+/* A Timing gathers the times of one kind of operation.               */
+
+struct Timing
+{
+   /* the mean nanoseconds per operation of each batch timed. */
+   double *pdBatchTimes;
+   size_t uBatchCount;
+
+   /* the nanoseconds and number of operations of all batches. */
+   double dTotalTime;
+   size_t uOperationCount;
+};
+
+/*--------------------------------------------------------------------*/
+/* Return the wall-clock time in nanoseconds, from an arbitrary       */
+/* starting point.                                                    */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the next number from the xorshift generator whose state is */
+/* *pulState, which must not be 0. Only the low 32 bits are used.     */
+
+static unsigned long nextRandom(unsigned long *pulState)
+{
+   unsigned long ulState;
+
+   assert(pulState != NULL);
+
+   ulState = *pulState;
+   ulState ^= (ulState << 13) & 0xffffffffUL;
+   ulState ^= ulState >> 17;
+   ulState ^= (ulState << 5) & 0xffffffffUL;
+   *pulState = ulState;
+   return ulState;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return ul scrambled by a one-to-one function of 32-bit numbers, so */
+/* distinct numbers give distinct, scattered results.                 */
+
+static unsigned long scramble(unsigned long ul)
+{
+   ul &= 0xffffffffUL;
+   ul ^= ul >> 16;
+   ul = (ul * 0x7feb352dUL) & 0xffffffffUL;
+   ul ^= ul >> 15;
+   ul = (ul * 0x846ca68bUL) & 0xffffffffUL;
+   ul ^= ul >> 16;
+   return ul;
+}
+
+/*--------------------------------------------------------------------*/
+/* Fill *psKeys with uCount keys of distribution eDistribution: those */
+/* numbered uFirst through uFirst+uCount-1. Sets of keys whose        */
+/* numbers do not overlap have no key in common. Return 1 if          */
+/* successful, or 0 if out of memory.                                 */
+
+static int makeKeys(struct KeySet *psKeys,
+                    enum Distribution eDistribution,
+                    size_t uFirst, size_t uCount)
+{
+   char *pcKey;
+   unsigned long ulNumber;
+   size_t u;
+
+   assert(psKeys != NULL);
+
+   psKeys->uCount = uCount;
+   psKeys->pcBuffer = (char*)malloc(uCount * MAX_KEY_LENGTH + 1U);
+   psKeys->ppcKeys =
+      (const char**)malloc(uCount * sizeof(const char*) + 1U);
+   if (psKeys->pcBuffer == NULL || psKeys->ppcKeys == NULL)
+   {
+      free(psKeys->pcBuffer);
+      free(psKeys->ppcKeys);
+      return 0;
+   }
+
+   for (u = 0; u < uCount; u++)
+   {
+      pcKey = psKeys->pcBuffer + u * MAX_KEY_LENGTH;
+      ulNumber = (unsigned long)(uFirst + u);
+      switch (eDistribution)
+      {
+         case SEQUENTIAL:
+            sprintf(pcKey, "%lu", ulNumber);
+            break;
+         case LONG_KEYS:
+            sprintf(pcKey, "%s%08lx", LONG_KEY_PREFIX,
+                    scramble(ulNumber));
+            break;
+         default:
+            sprintf(pcKey, "%08lx", scramble(ulNumber));
+            break;
+      }
+      psKeys->ppcKeys[u] = pcKey;
+   }
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/* Free the memory of *psKeys.                                        */
+
+static void freeKeys(struct KeySet *psKeys)
+{
+   assert(psKeys != NULL);
+
+   free(psKeys->pcBuffer);
+   free(psKeys->ppcKeys);
+}
+
+/*--------------------------------------------------------------------*/
+/* Store in auOrder a random permutation of 0 through uCount-1.       */
+
+static void makeShuffle(size_t auOrder[], size_t uCount,
+                        unsigned long *pulState)
+{
+   size_t u;
+   size_t uOther;
+   size_t uSwap;
+
+   assert(auOrder != NULL);
+   assert(pulState != NULL);
+
+   for (u = 0; u < uCount; u++)
+      auOrder[u] = u;
+   for (u = uCount; u > 1U; u--)
+   {
+      uOther = (size_t)(nextRandom(pulState) % (unsigned long)u);
+      uSwap = auOrder[u - 1U];
+      auOrder[u - 1U] = auOrder[uOther];
+      auOrder[uOther] = uSwap;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/* Store in auOrder uCount ranks from 0 through uCount-1, each drawn */
+/* with Zipfian probability: rank r is r+1 times less likely than     */
+/* rank 0. Return 1 if successful, or 0 if out of memory.             */
+
+static int makeZipfian(size_t auOrder[], size_t uCount,
+                       unsigned long *pulState)
+{
+   double *pdCumulative;
+   double dTotal;
+   double dTarget;
+   size_t uLow;
+   size_t uHigh;
+   size_t uMiddle;
+   size_t u;
+
+   assert(auOrder != NULL);
+   assert(pulState != NULL);
+
+   pdCumulative = (double*)malloc(uCount * sizeof(double) + 1U);
+   if (pdCumulative == NULL)
+      return 0;
+
+   dTotal = 0.0;
+   for (u = 0; u < uCount; u++)
+   {
+      dTotal += 1.0 / (double)(u + 1U);
+      pdCumulative[u] = dTotal;
+   }
+
+   for (u = 0; u < uCount; u++)
+   {
+      dTarget = dTotal * (double)nextRandom(pulState) / 4294967296.0;
+      uLow = 0U;
+      uHigh = uCount - 1U;
+      while (uLow < uHigh)
+      {
+         uMiddle = uLow + (uHigh - uLow) / 2U;
+         if (pdCumulative[uMiddle] < dTarget)
+            uLow = uMiddle + 1U;
+         else
+            uHigh = uMiddle;
+      }
+      auOrder[u] = uLow;
+   }
+
+   free(pdCumulative);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/* The operations timed one batch at a time.                          */
+
+enum Operation { PUT, GET_HIT, GET_MISS, REMOVE };
+
+/*--------------------------------------------------------------------*/
+/* Make *psTiming ready to time uOperationCount operations. Return 1  */
+/* if successful, or 0 if out of memory.                              */
+
+static int initTiming(struct Timing *psTiming, size_t uOperationCount)
+{
+   assert(psTiming != NULL);
+
+   psTiming->pdBatchTimes = (double*)malloc(
+      (uOperationCount / BATCH_SIZE + 1U) * sizeof(double));
+   psTiming->uBatchCount = 0U;
+   psTiming->dTotalTime = 0.0;
+   psTiming->uOperationCount = 0U;
+   return psTiming->pdBatchTimes != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+/* Perform eOperation on oSymTable for the keys ppcKeys[auOrder[0]]   */
+/* through ppcKeys[auOrder[uCount-1]], in that order, recording the   */
+/* times in *psTiming. Return the number of operations whose result   */
+/* was not the one expected.                                          */
+
+static size_t timeOperations(SymTable_T oSymTable,
+                             enum Operation eOperation,
+                             const char *const ppcKeys[],
+                             const size_t auOrder[], size_t uCount,
+                             struct Timing *psTiming)
+{
+   const char *pcKey;
+   double dStart;
+   double dTime;
+   size_t uFirst;
+   size_t uLast;
+   size_t uWrong;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(ppcKeys != NULL);
+   assert(auOrder != NULL);
+   assert(psTiming != NULL);
+
+   uWrong = 0U;
+   for (uFirst = 0; uFirst < uCount; uFirst = uLast)
+   {
+      uLast = uFirst + BATCH_SIZE;
+      if (uLast > uCount)
+         uLast = uCount;
+
+      /* the switch is outside the loops, so each loop times only the
+         operation itself */
+      dStart = getNanoseconds();
+      switch (eOperation)
+      {
+         case PUT:
+            for (u = uFirst; u < uLast; u++)
+            {
+               pcKey = ppcKeys[auOrder[u]];
+               uWrong += !SymTable_put(oSymTable, pcKey, pcKey);
+            }
+            break;
+         case GET_HIT:
+            for (u = uFirst; u < uLast; u++)
+               uWrong += SymTable_get(oSymTable,
+                                      ppcKeys[auOrder[u]]) == NULL;
+            break;
+         case GET_MISS:
+            for (u = uFirst; u < uLast; u++)
+               uWrong += SymTable_get(oSymTable,
+                                      ppcKeys[auOrder[u]]) != NULL;
+            break;
+         case REMOVE:
+            for (u = uFirst; u < uLast; u++)
+               uWrong += SymTable_remove(oSymTable,
+                                         ppcKeys[auOrder[u]]) == NULL;
+            break;
+      }
+      dTime = getNanoseconds() - dStart;
+
+      psTiming->pdBatchTimes[psTiming->uBatchCount++] =
+         dTime / (double)(uLast - uFirst);
+      psTiming->dTotalTime += dTime;
+      psTiming->uOperationCount += uLast - uFirst;
+   }
+   return uWrong;
+}
+
+/*--------------------------------------------------------------------*/
+/* Count the binding through pvExtra, a size_t counter. Called        */
+/* through SymTable_map().                                            */
+
+static void countBinding(const char *pcKey, void *pvValue,
+                         void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+/* Compare the doubles at pvFirst and pvSecond, for qsort().          */
+
+static int compareDoubles(const void *pvFirst, const void *pvSecond)
+{
+   double dFirst;
+   double dSecond;
+
+   assert(pvFirst != NULL);
+   assert(pvSecond != NULL);
+
+   dFirst = *(const double*)pvFirst;
+   dSecond = *(const double*)pvSecond;
+   return (dFirst > dSecond) - (dFirst < dSecond);
+}
+
+/*--------------------------------------------------------------------*/
+/* Print a line reporting *psTiming, the times of operation pcName on */
+/* keys of distribution eDistribution, and free its memory.           */
+
+static void reportTiming(enum Distribution eDistribution,
+                         const char *pcName, struct Timing *psTiming)
+{
+   double *pdTimes;
+   size_t uCount;
+
+   assert(pcName != NULL);
+   assert(psTiming != NULL);
+
+   pdTimes = psTiming->pdBatchTimes;
+   uCount = psTiming->uBatchCount;
+   if (uCount == 0U)
+   {
+      free(pdTimes);
+      return;
+   }
+
+   qsort(pdTimes, uCount, sizeof(double), compareDoubles);
+   printf("%-10s %-9s %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+          apcDistributionNames[eDistribution], pcName,
+          psTiming->dTotalTime / (double)psTiming->uOperationCount,
+          pdTimes[(uCount - 1U) / 2U],
+          pdTimes[(size_t)((double)(uCount - 1U) * 0.9)],
+          pdTimes[(size_t)((double)(uCount - 1U) * 0.99)],
+          pdTimes[uCount - 1U]);
+   free(pdTimes);
+}
+
+/*--------------------------------------------------------------------*/
+/* Benchmark a new SymTable with uCount keys of distribution          */
+/* eDistribution, printing one line per operation. Return 1 if        */
+/* successful, or 0 if out of memory or an operation went wrong.      */
+
+static int benchDistribution(enum Distribution eDistribution,
+                             size_t uCount)
+{
+   SymTable_T oSymTable;
+   struct KeySet sPresent;
+   struct KeySet sAbsent;
+   struct Timing asTimings[4];
+   size_t *auInOrder;
+   size_t *auLookups;
+   size_t *auRemovals;
+   unsigned long ulState;
+   double dStart;
+   double dMapTime;
+   double dIterTime;
+   size_t uMapped;
+   size_t uBytes = 0U;
+   struct SymTable_Iter sIter;
+   const char *pcKey;
+   void *pvValue;
+   size_t uWrong;
+   size_t u;
+   int iSuccessful;
+
+   if (!makeKeys(&sPresent, eDistribution, 0U, uCount))
+      return 0;
+   if (!makeKeys(&sAbsent, eDistribution, uCount, uCount))
+   {
+      freeKeys(&sPresent);
+      return 0;
+   }
+
+   auInOrder = (size_t*)malloc(uCount * sizeof(size_t));
+   auLookups = (size_t*)malloc(uCount * sizeof(size_t));
+   auRemovals = (size_t*)malloc(uCount * sizeof(size_t));
+   oSymTable = SymTable_new();
+   iSuccessful = auInOrder != NULL && auLookups != NULL &&
+                 auRemovals != NULL && oSymTable != NULL;
+   for (u = 0; u < 4U; u++)
+      if (!initTiming(&asTimings[u], uCount))
+         iSuccessful = 0;
+
+   /* keys go in in the order they were made, and are looked up and
+      removed in random orders, or looked up by popularity */
+   ulState = 2463534242UL + (unsigned long)eDistribution;
+   if (iSuccessful)
+   {
+      for (u = 0; u < uCount; u++)
+         auInOrder[u] = u;
+      if (eDistribution == ZIPFIAN)
+         iSuccessful = makeZipfian(auLookups, uCount, &ulState);
+      else
+         makeShuffle(auLookups, uCount, &ulState);
+      makeShuffle(auRemovals, uCount, &ulState);
+   }
+
+   if (iSuccessful)
+   {
+      uWrong = timeOperations(oSymTable, PUT, sPresent.ppcKeys,
+                              auInOrder, uCount, &asTimings[0]);
+      uWrong += timeOperations(oSymTable, GET_HIT, sPresent.ppcKeys,
+                               auLookups, uCount, &asTimings[1]);
+      uWrong += timeOperations(oSymTable, GET_MISS, sAbsent.ppcKeys,
+                               auInOrder, uCount, &asTimings[2]);
+      uBytes = SymTable_memoryUsage(oSymTable, NULL);
+
+      uMapped = 0U;
+      dStart = getNanoseconds();
+      SymTable_map(oSymTable, countBinding, &uMapped);
+      dMapTime = getNanoseconds() - dStart;
+      uWrong += uMapped != uCount;
+
+      uMapped = 0U;
+      dStart = getNanoseconds();
+      SymTable_iterBegin(oSymTable, &sIter);
+      while (SymTable_iterNext(&sIter, &pcKey, &pvValue))
+         uMapped++;
+      dIterTime = getNanoseconds() - dStart;
+      uWrong += uMapped != uCount;
+
+      uWrong += timeOperations(oSymTable, REMOVE, sPresent.ppcKeys,
+                               auRemovals, uCount, &asTimings[3]);
+      uWrong += SymTable_getLength(oSymTable) != 0U;
+
+      reportTiming(eDistribution, "put", &asTimings[0]);
+      reportTiming(eDistribution, "get-hit", &asTimings[1]);
+      reportTiming(eDistribution, "get-miss", &asTimings[2]);
+      printf("%-10s %-9s %9.1f\n", apcDistributionNames[eDistribution],
+             "map", dMapTime / (double)uCount);
+      printf("%-10s %-9s %9.1f\n", apcDistributionNames[eDistribution],
+             "iter", dIterTime / (double)uCount);
+      reportTiming(eDistribution, "remove", &asTimings[3]);
+      printf("%-10s %-9s %9.1f\n", apcDistributionNames[eDistribution],
+             "bytes", (double)uBytes / (double)uCount);
+      fflush(stdout);
+
+      if (uWrong != 0U)
+      {
+         fprintf(stderr, "%lu operations on %s keys went wrong\n",
+                 (unsigned long)uWrong,
+                 apcDistributionNames[eDistribution]);
+         iSuccessful = 0;
+      }
+   }
+   else
+      for (u = 0; u < 4U; u++)
+         free(asTimings[u].pdBatchTimes);
+
+   if (oSymTable != NULL)
+      SymTable_free(oSymTable);
+   free(auInOrder);
+   free(auLookups);
+   free(auRemovals);
+   freeKeys(&sPresent);
+   freeKeys(&sAbsent);
+   return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+/* Benchmark the SymTable implementation this program was linked      */
+/* with, using as many keys as argv[1] says, for every distribution   */
+/* or for the one named by argv[2]. Return 0 if successful, or        */
+/* EXIT_FAILURE otherwise.                                            */
+
+int main(int argc, char *argv[])
+{
+   long lCount;
+   int iDistribution;
+   int iFound;
+
+   if (argc != 2 && argc != 3)
+   {
+      fprintf(stderr, "Usage: %s keycount [distribution]\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+   if (sscanf(argv[1], "%ld", &lCount) != 1 || lCount <= 0L)
+   {
+      fprintf(stderr, "keycount must be a positive number\n");
+      return EXIT_FAILURE;
+   }
+
+   iFound = argc == 2;
+   for (iDistribution = 0; iDistribution < DISTRIBUTION_COUNT;
+        iDistribution++)
+      if (argc == 3 &&
+          strcmp(argv[2], apcDistributionNames[iDistribution]) == 0)
+         iFound = 1;
+   if (!iFound)
+   {
+      fprintf(stderr, "distribution must be sequential, random, long, "
+                      "or zipfian\n");
+      return EXIT_FAILURE;
+   }
+
+   printf("%s, %ld keys; nanoseconds per operation, and bytes per "
+          "binding:\n", argv[0], lCount);
+   printf("%-10s %-9s %9s %9s %9s %9s %9s\n", "keys", "operation",
+          "mean", "p50", "p90", "p99", "max");
+
+   for (iDistribution = 0; iDistribution < DISTRIBUTION_COUNT;
+        iDistribution++)
+   {
+      if (argc == 3 &&
+          strcmp(argv[2], apcDistributionNames[iDistribution]) != 0)
+         continue;
+      if (!benchDistribution((enum Distribution)iDistribution,
+                             (size_t)lCount))
+      {
+         fprintf(stderr, "%s benchmark failed\n",
+                 apcDistributionNames[iDistribution]);
+         return EXIT_FAILURE;
+      }
+   }
+   return 0;
+}
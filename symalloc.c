@@ -0,0 +1,470 @@
+/*--------------------------------------------------------------------*/
+/* symalloc.c                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symalloc.h"
+#include <assert.h>
+#include <stdlib.h>
+
+/* A union of the types with the strictest alignment requirements. An
+   object whose size is a multiple of sizeof(union Align) can follow
+   another one without padding. */
+union Align
+{
+   void *pv;
+   size_t u;
+   long l;
+   double d;
+};
+
+/* Each slab and chunk begins with this header. */
+union ChunkHeader
+{
+   /* the address of the previously allocated slab or chunk. */
+   union ChunkHeader *psPrevious;
+
+   union Align uAlign;
+};
+
+/* Each large block of a SymArena begins with this header. */
+union LargeHeader
+{
+   struct
+   {
+      /* the neighbouring large blocks. */
+      union LargeHeader *psPrevious;
+      union LargeHeader *psNext;
+   } sLinks;
+
+   union Align uAlign;
+};
+
+/* the first and the largest number of objects in a SymPool slab. */
+enum { FIRST_SLAB_LENGTH = 8, MAX_SLAB_LENGTH = 1024 };
+
+/* SymArena size classes are multiples of CLASS_GRANULE bytes, so the
+   largest string they hold is CLASS_GRANULE * SYMARENA_CLASS_COUNT
+   bytes. */
+enum { CLASS_GRANULE = 16 };
+
+/* the first and the largest SymArena chunk size, in bytes. */
+enum { FIRST_CHUNK_SIZE = 256, MAX_CHUNK_SIZE = 65536 };
+
+/*--------------------------------------------------------------------*/
+
+void SymPool_init(struct SymPool *psPool, size_t uObjectSize)
+{
+   assert(psPool != NULL);
+   assert(uObjectSize > 0U);
+
+   /* round up so every object is aligned and can hold a free list
+      link */
+   psPool->uObjectSize =
+      (uObjectSize + sizeof(union Align) - 1U) /
+      sizeof(union Align) * sizeof(union Align);
+
+   psPool->pvFreeList = NULL;
+   psPool->pvSlabs = NULL;
+   psPool->pcNext = NULL;
+   psPool->uRemaining = 0U;
+   psPool->uNextSlabLength = FIRST_SLAB_LENGTH;
+   psPool->uFootprint = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymPool_alloc(struct SymPool *psPool)
+{
+   union ChunkHeader *psSlab;
+   void *pvObject;
+
+   assert(psPool != NULL);
+
+   /* reuse a released object if there is one */
+   if (psPool->pvFreeList != NULL)
+   {
+      pvObject = psPool->pvFreeList;
+      psPool->pvFreeList = *(void**)pvObject;
+      return pvObject;
+   }
+
+   /* otherwise carve one from the newest slab, starting a new slab
+      twice the size of the last one if it is used up */
+   if (psPool->uRemaining == 0U)
+   {
+      psSlab = (union ChunkHeader*)malloc(
+         sizeof(union ChunkHeader) +
+         psPool->uNextSlabLength * psPool->uObjectSize);
+      if (psSlab == NULL)
+         return NULL;
+
+      psSlab->psPrevious = (union ChunkHeader*)psPool->pvSlabs;
+      psPool->pvSlabs = psSlab;
+      psPool->pcNext = (char*)(psSlab + 1);
+      psPool->uRemaining = psPool->uNextSlabLength;
+      psPool->uFootprint +=
+         sizeof(union ChunkHeader) +
+         psPool->uNextSlabLength * psPool->uObjectSize;
+
+      if (psPool->uNextSlabLength < MAX_SLAB_LENGTH)
+         psPool->uNextSlabLength *= 2U;
+   }
+
+   pvObject = psPool->pcNext;
+   psPool->pcNext += psPool->uObjectSize;
+   psPool->uRemaining--;
+   return pvObject;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymPool_release(struct SymPool *psPool, void *pvObject)
+{
+   assert(psPool != NULL);
+   assert(pvObject != NULL);
+
+   *(void**)pvObject = psPool->pvFreeList;
+   psPool->pvFreeList = pvObject;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymPool_destroy(struct SymPool *psPool)
+{
+   union ChunkHeader *psSlab;
+   union ChunkHeader *psPrevious;
+
+   assert(psPool != NULL);
+
+   for (psSlab = (union ChunkHeader*)psPool->pvSlabs;
+        psSlab != NULL;
+        psSlab = psPrevious)
+   {
+      psPrevious = psSlab->psPrevious;
+      free(psSlab);
+   }
+
+   psPool->pvFreeList = NULL;
+   psPool->pvSlabs = NULL;
+   psPool->pcNext = NULL;
+   psPool->uRemaining = 0U;
+   psPool->uFootprint = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+/* Link the free list whose first object is pvFirst in ahead of the   */
+/* free list *ppvFreeList.                                            */
+
+static void SymAlloc_spliceFreeList(void **ppvFreeList, void *pvFirst)
+{
+   void **ppvLink;
+
+   assert(ppvFreeList != NULL);
+
+   if (pvFirst == NULL)
+      return;
+
+   for (ppvLink = (void**)pvFirst; *ppvLink != NULL;
+        ppvLink = (void**)*ppvLink)
+      ;
+   *ppvLink = *ppvFreeList;
+   *ppvFreeList = pvFirst;
+}
+
+/*--------------------------------------------------------------------*/
+/* Link the chain of slabs or chunks whose newest is pvNewest in      */
+/* ahead of the chain *ppvChain.                                      */
+
+static void SymAlloc_spliceChunks(void **ppvChain, void *pvNewest)
+{
+   union ChunkHeader *psOldest;
+
+   assert(ppvChain != NULL);
+
+   if (pvNewest == NULL)
+      return;
+
+   for (psOldest = (union ChunkHeader*)pvNewest;
+        psOldest->psPrevious != NULL;
+        psOldest = psOldest->psPrevious)
+      ;
+   psOldest->psPrevious = (union ChunkHeader*)*ppvChain;
+   *ppvChain = pvNewest;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymPool_merge(struct SymPool *psInto, struct SymPool *psFrom)
+{
+   char *pcNext;
+   size_t uRemaining;
+
+   assert(psInto != NULL);
+   assert(psFrom != NULL);
+   assert(psInto->uObjectSize == psFrom->uObjectSize);
+
+   SymAlloc_spliceChunks(&psInto->pvSlabs, psFrom->pvSlabs);
+   SymAlloc_spliceFreeList(&psInto->pvFreeList, psFrom->pvFreeList);
+
+   /* keep carving from whichever slab has more never-used objects
+      left, and put the other one's on the free list */
+   if (psFrom->uRemaining > psInto->uRemaining)
+   {
+      pcNext = psInto->pcNext;
+      uRemaining = psInto->uRemaining;
+      psInto->pcNext = psFrom->pcNext;
+      psInto->uRemaining = psFrom->uRemaining;
+   }
+   else
+   {
+      pcNext = psFrom->pcNext;
+      uRemaining = psFrom->uRemaining;
+   }
+   for (; uRemaining > 0U; uRemaining--)
+   {
+      SymPool_release(psInto, pcNext);
+      pcNext += psInto->uObjectSize;
+   }
+
+   if (psInto->uNextSlabLength < psFrom->uNextSlabLength)
+      psInto->uNextSlabLength = psFrom->uNextSlabLength;
+   psInto->uFootprint += psFrom->uFootprint;
+
+   psFrom->pvFreeList = NULL;
+   psFrom->pvSlabs = NULL;
+   psFrom->pcNext = NULL;
+   psFrom->uRemaining = 0U;
+   psFrom->uFootprint = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymPool_getFootprint(const struct SymPool *psPool)
+{
+   assert(psPool != NULL);
+   return psPool->uFootprint;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymArena_init(struct SymArena *psArena)
+{
+   size_t u;
+
+   assert(psArena != NULL);
+
+   for (u = 0; u < (size_t)SYMARENA_CLASS_COUNT; u++)
+      psArena->apvFreeLists[u] = NULL;
+
+   psArena->pvChunks = NULL;
+   psArena->pcNext = NULL;
+   psArena->uRemaining = 0U;
+   psArena->uNextChunkSize = FIRST_CHUNK_SIZE;
+   psArena->pvLargeBlocks = NULL;
+   psArena->uFootprint = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return a new block of its own for a string of uSize bytes that is  */
+/* too long for the size classes of *psArena, or NULL if out of       */
+/* memory.                                                            */
+
+static char *SymArena_allocLarge(struct SymArena *psArena, size_t uSize)
+{
+   union LargeHeader *psBlock;
+   union LargeHeader *psFirst;
+
+   assert(psArena != NULL);
+
+   psBlock = (union LargeHeader*)malloc(sizeof(union LargeHeader) +
+                                        uSize);
+   if (psBlock == NULL)
+      return NULL;
+
+   /* link the block in at the front of the list */
+   psFirst = (union LargeHeader*)psArena->pvLargeBlocks;
+   psBlock->sLinks.psPrevious = NULL;
+   psBlock->sLinks.psNext = psFirst;
+   if (psFirst != NULL)
+      psFirst->sLinks.psPrevious = psBlock;
+   psArena->pvLargeBlocks = psBlock;
+   psArena->uFootprint += sizeof(union LargeHeader) + uSize;
+
+   return (char*)(psBlock + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+char *SymArena_alloc(struct SymArena *psArena, size_t uSize)
+{
+   union ChunkHeader *psChunk;
+   size_t uClass;
+   size_t uClassSize;
+   char *pcBytes;
+
+   assert(psArena != NULL);
+
+   if (uSize == 0U)
+      uSize = 1U;
+   if (uSize > (size_t)CLASS_GRANULE * SYMARENA_CLASS_COUNT)
+      return SymArena_allocLarge(psArena, uSize);
+
+   uClass = (uSize - 1U) / CLASS_GRANULE;
+   uClassSize = (uClass + 1U) * CLASS_GRANULE;
+
+   /* reuse a released block of the same class if there is one */
+   if (psArena->apvFreeLists[uClass] != NULL)
+   {
+      pcBytes = (char*)psArena->apvFreeLists[uClass];
+      psArena->apvFreeLists[uClass] = *(void**)(void*)pcBytes;
+      return pcBytes;
+   }
+
+   /* otherwise bump-allocate from the newest chunk, starting a new
+      chunk if it cannot hold the block. The few bytes left at the end
+      of the old chunk are not used again. */
+   if (psArena->uRemaining < uClassSize)
+   {
+      psChunk = (union ChunkHeader*)malloc(sizeof(union ChunkHeader) +
+                                           psArena->uNextChunkSize);
+      if (psChunk == NULL)
+         return NULL;
+
+      psChunk->psPrevious = (union ChunkHeader*)psArena->pvChunks;
+      psArena->pvChunks = psChunk;
+      psArena->pcNext = (char*)(psChunk + 1);
+      psArena->uRemaining = psArena->uNextChunkSize;
+      psArena->uFootprint += sizeof(union ChunkHeader) +
+                             psArena->uNextChunkSize;
+
+      if (psArena->uNextChunkSize < MAX_CHUNK_SIZE)
+         psArena->uNextChunkSize *= 2U;
+   }
+
+   pcBytes = psArena->pcNext;
+   psArena->pcNext += uClassSize;
+   psArena->uRemaining -= uClassSize;
+   return pcBytes;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymArena_release(struct SymArena *psArena, char *pcBytes,
+                      size_t uSize)
+{
+   union LargeHeader *psBlock;
+   size_t uClass;
+
+   assert(psArena != NULL);
+   assert(pcBytes != NULL);
+
+   if (uSize == 0U)
+      uSize = 1U;
+
+   /* a large block is unlinked and given back to malloc */
+   if (uSize > (size_t)CLASS_GRANULE * SYMARENA_CLASS_COUNT)
+   {
+      psBlock = (union LargeHeader*)(void*)pcBytes - 1;
+      if (psBlock->sLinks.psPrevious != NULL)
+         psBlock->sLinks.psPrevious->sLinks.psNext =
+            psBlock->sLinks.psNext;
+      else
+         psArena->pvLargeBlocks = psBlock->sLinks.psNext;
+      if (psBlock->sLinks.psNext != NULL)
+         psBlock->sLinks.psNext->sLinks.psPrevious =
+            psBlock->sLinks.psPrevious;
+      free(psBlock);
+      psArena->uFootprint -= sizeof(union LargeHeader) + uSize;
+      return;
+   }
+
+   /* a small block goes on the free list of its class */
+   uClass = (uSize - 1U) / CLASS_GRANULE;
+   *(void**)(void*)pcBytes = psArena->apvFreeLists[uClass];
+   psArena->apvFreeLists[uClass] = pcBytes;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymArena_destroy(struct SymArena *psArena)
+{
+   union ChunkHeader *psChunk;
+   union ChunkHeader *psPrevious;
+   union LargeHeader *psBlock;
+   union LargeHeader *psNext;
+
+   assert(psArena != NULL);
+
+   for (psChunk = (union ChunkHeader*)psArena->pvChunks;
+        psChunk != NULL;
+        psChunk = psPrevious)
+   {
+      psPrevious = psChunk->psPrevious;
+      free(psChunk);
+   }
+
+   for (psBlock = (union LargeHeader*)psArena->pvLargeBlocks;
+        psBlock != NULL;
+        psBlock = psNext)
+   {
+      psNext = psBlock->sLinks.psNext;
+      free(psBlock);
+   }
+
+   SymArena_init(psArena);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymArena_merge(struct SymArena *psInto, struct SymArena *psFrom)
+{
+   union LargeHeader *psLast;
+   union LargeHeader *psFirst;
+   size_t u;
+
+   assert(psInto != NULL);
+   assert(psFrom != NULL);
+
+   SymAlloc_spliceChunks(&psInto->pvChunks, psFrom->pvChunks);
+   for (u = 0; u < (size_t)SYMARENA_CLASS_COUNT; u++)
+      SymAlloc_spliceFreeList(&psInto->apvFreeLists[u],
+                              psFrom->apvFreeLists[u]);
+
+   /* keep bump-allocating from whichever chunk has more room left.
+      As when a chunk fills, the other one's few bytes go unused */
+   if (psFrom->uRemaining > psInto->uRemaining)
+   {
+      psInto->pcNext = psFrom->pcNext;
+      psInto->uRemaining = psFrom->uRemaining;
+   }
+   if (psInto->uNextChunkSize < psFrom->uNextChunkSize)
+      psInto->uNextChunkSize = psFrom->uNextChunkSize;
+
+   /* link psFrom's large blocks in ahead of psInto's */
+   if (psFrom->pvLargeBlocks != NULL)
+   {
+      for (psLast = (union LargeHeader*)psFrom->pvLargeBlocks;
+           psLast->sLinks.psNext != NULL;
+           psLast = psLast->sLinks.psNext)
+         ;
+      psFirst = (union LargeHeader*)psInto->pvLargeBlocks;
+      psLast->sLinks.psNext = psFirst;
+      if (psFirst != NULL)
+         psFirst->sLinks.psPrevious = psLast;
+      psInto->pvLargeBlocks = psFrom->pvLargeBlocks;
+   }
+   psInto->uFootprint += psFrom->uFootprint;
+
+   SymArena_init(psFrom);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymArena_getFootprint(const struct SymArena *psArena)
+{
+   assert(psArena != NULL);
+   return psArena->uFootprint;
+}
+
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,128 @@
+/*--------------------------------------------------------------------*/
+/* symalloc.h                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMALLOC_INCLUDED
+#define SYMALLOC_INCLUDED
+#include <stddef.h>
+
+/* Per-table allocators used by the SymTable implementations. A
+   SymPool hands out fixed-size objects (Bindings) carved from large
+   slabs; a SymArena hands out key strings bump-pointer style from
+   large chunks. Both keep released memory on free lists for reuse,
+   and both give everything back to malloc in a few calls when they
+   are destroyed. Clients embed the structures below by value but
+   must not use their fields directly. */
+
+/*--------------------------------------------------------------------*/
+
+/* A SymPool allocates objects of one size. */
+struct SymPool
+{
+   /* size of each object, rounded up for alignment. */
+   size_t uObjectSize;
+
+   /* the most recently released object; each free object holds the
+      address of the next one. */
+   void *pvFreeList;
+
+   /* the most recently allocated slab; each slab begins with the
+      address of the previous one. */
+   void *pvSlabs;
+
+   /* the next never-used object in the newest slab. */
+   char *pcNext;
+
+   /* number of never-used objects left in the newest slab. */
+   size_t uRemaining;
+
+   /* number of objects in the next slab to allocate. */
+   size_t uNextSlabLength;
+
+   /* number of bytes of all the slabs. */
+   size_t uFootprint;
+};
+
+/* Initialize *psPool to allocate objects of uObjectSize bytes. */
+void SymPool_init(struct SymPool *psPool, size_t uObjectSize);
+
+/* Return a new uninitialized object from *psPool, or NULL if out of
+   memory. */
+void *SymPool_alloc(struct SymPool *psPool);
+
+/* Give pvObject, which *psPool allocated, back to *psPool. */
+void SymPool_release(struct SymPool *psPool, void *pvObject);
+
+/* Free every object *psPool has allocated, at once. *psPool may be
+   reused after another call of SymPool_init(). */
+void SymPool_destroy(struct SymPool *psPool);
+
+/* Move every object of *psFrom, in use or free, into *psInto, which
+   allocates objects of the same size; *psInto then owns them and
+   *psFrom is left empty. Lets several threads allocate from pools of
+   their own and hand the results to one table. */
+void SymPool_merge(struct SymPool *psInto, struct SymPool *psFrom);
+
+/* Return the number of bytes *psPool has taken from malloc, counting
+   objects in use and free alike. */
+size_t SymPool_getFootprint(const struct SymPool *psPool);
+
+/*--------------------------------------------------------------------*/
+
+/* number of size classes a SymArena keeps free lists for. */
+enum { SYMARENA_CLASS_COUNT = 8 };
+
+/* A SymArena allocates byte strings of any length. */
+struct SymArena
+{
+   /* apvFreeLists[i] is the most recently released block of size
+      class i; each free block holds the address of the next one. */
+   void *apvFreeLists[SYMARENA_CLASS_COUNT];
+
+   /* the most recently allocated chunk; each chunk begins with the
+      address of the previous one. */
+   void *pvChunks;
+
+   /* the next unused byte in the newest chunk. */
+   char *pcNext;
+
+   /* number of unused bytes left in the newest chunk. */
+   size_t uRemaining;
+
+   /* size of the next chunk to allocate. */
+   size_t uNextChunkSize;
+
+   /* strings too long for any size class get a block of their own;
+      this is the most recent one, doubly linked with the others. */
+   void *pvLargeBlocks;
+
+   /* number of bytes of all the chunks and large blocks. */
+   size_t uFootprint;
+};
+
+/* Initialize *psArena. */
+void SymArena_init(struct SymArena *psArena);
+
+/* Return uSize uninitialized bytes from *psArena, or NULL if out of
+   memory. */
+char *SymArena_alloc(struct SymArena *psArena, size_t uSize);
+
+/* Give the uSize bytes at pcBytes, which SymArena_alloc(psArena,
+   uSize) returned, back to *psArena. */
+void SymArena_release(struct SymArena *psArena, char *pcBytes,
+                      size_t uSize);
+
+/* Free every string *psArena has allocated, at once. *psArena may be
+   reused after another call of SymArena_init(). */
+void SymArena_destroy(struct SymArena *psArena);
+
+/* Move every string of *psFrom, in use or free, into *psInto, which
+   then owns them; *psFrom is left empty. */
+void SymArena_merge(struct SymArena *psInto, struct SymArena *psFrom);
+
+/* Return the number of bytes *psArena has taken from malloc, counting
+   strings in use, free blocks and unused chunk space alike. */
+size_t SymArena_getFootprint(const struct SymArena *psArena);
+
+#endif
@@ -0,0 +1,353 @@
+/*--------------------------------------------------------------------*/
+/* symconc.c                                                          */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+/* reader/writer locks are a POSIX extension, so ask for them */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symconc.h"
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* number of stripes in a SymConc made by SymConc_new() */
+enum { DEFAULT_STRIPE_COUNT = 64 };
+
+/* size of a cache line, to which Stripes are padded so that locking
+   one never invalidates the cached lock of another */
+enum { CACHE_LINE_SIZE = 64 };
+
+/* number of low bits of a mixed hash code that are left to the
+   stripe's own SymTable. The stripe index comes from the bits above
+   them. */
+static const unsigned int STRIPE_SHIFT =
+   (unsigned int)(sizeof(size_t) * CHAR_BIT / 2U);
+
+/* the multiplier and shift of the mix applied to a hash code before
+   its stripe bits are taken, so that a hash function such as
+   SymHash_classic, whose high bits are zero for short keys, still
+   spreads keys over every stripe. They are those of SymHash_word's
+   final avalanche step. */
+static const size_t MIX_MULTIPLIER =
+   sizeof(size_t) >= 8U ?
+      ((((size_t)0xc6a4a793UL << 16) << 16) | (size_t)0x5bd1e995UL) :
+      (size_t)0x5bd1e995UL;
+static const unsigned int MIX_SHIFT = sizeof(size_t) >= 8U ? 47U : 15U;
+
+/*--------------------------------------------------------------------*/
+/* A Stripe is one SymTable together with the lock that guards it.    */
+
+struct StripeFields
+{
+   /* held for reading by lookups, and for writing by changes. */
+   pthread_rwlock_t sLock;
+
+   /* the bindings whose keys hash to this stripe. */
+   SymTable_T oSymTable;
+};
+
+union Stripe
+{
+   struct StripeFields sFields;
+
+   char acPadding[(sizeof(struct StripeFields) + CACHE_LINE_SIZE - 1U) /
+                  CACHE_LINE_SIZE * CACHE_LINE_SIZE];
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymConc is an array of Stripes.                                  */
+
+struct SymConc
+{
+   /* array of uStripeCount Stripes. */
+   union Stripe *psStripes;
+
+   /* number of stripes. Always a power of two. */
+   size_t uStripeCount;
+};
+
+/*--------------------------------------------------------------------*/
+/* Return the fields of the Stripe of oSymConc that holds pcKey, and  */
+/* store the length of pcKey in *puKeyLength and its hash code in     */
+/* *puHash so the stripe's SymTable need not measure or hash it       */
+/* again.                                                             */
+
+static struct StripeFields *SymConc_stripe(SymConc_T oSymConc,
+                                           const char *pcKey,
+                                           size_t *puKeyLength,
+                                           size_t *puHash)
+{
+   size_t uHash;
+
+   assert(oSymConc != NULL);
+   assert(pcKey != NULL);
+   assert(puKeyLength != NULL);
+   assert(puHash != NULL);
+
+   /* every stripe's SymTable has the same options, so any of them
+      gives the code all of them use */
+   *puKeyLength = strlen(pcKey);
+   *puHash = SymTable_hashN(oSymConc->psStripes[0].sFields.oSymTable,
+                            pcKey, *puKeyLength);
+
+   uHash = *puHash;
+   uHash ^= uHash >> MIX_SHIFT;
+   uHash *= MIX_MULTIPLIER;
+   uHash ^= uHash >> MIX_SHIFT;
+   return &oSymConc->psStripes[(uHash >> STRIPE_SHIFT) &
+                               (oSymConc->uStripeCount - 1U)].sFields;
+}
+
+/*--------------------------------------------------------------------*/
+/* Destroy the first uCount Stripes of oSymConc, then free it.        */
+
+static void SymConc_destroy(SymConc_T oSymConc, size_t uCount)
+{
+   size_t u;
+
+   assert(oSymConc != NULL);
+
+   for (u = 0; u < uCount; u++)
+   {
+      SymTable_free(oSymConc->psStripes[u].sFields.oSymTable);
+      pthread_rwlock_destroy(&oSymConc->psStripes[u].sFields.sLock);
+   }
+   free(oSymConc->psStripes);
+   free(oSymConc);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymConc_T SymConc_new(void)
+{
+   struct SymTable_Options sOptions;
+
+   SymTable_initOptions(&sOptions);
+   return SymConc_newWithOptions(&sOptions, DEFAULT_STRIPE_COUNT);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymConc_T SymConc_newWithOptions(
+   const struct SymTable_Options *psOptions, size_t uStripeCount)
+{
+   struct SymTable_Options sOptions;
+   struct StripeFields *psFields;
+   SymConc_T oSymConc;
+   size_t uCount;
+   size_t u;
+
+   assert(psOptions != NULL);
+
+   oSymConc = (SymConc_T)malloc(sizeof(struct SymConc));
+   if (oSymConc == NULL)
+      return NULL;
+
+   /* round the stripe count up to a power of two that the bits
+      above STRIPE_SHIFT can index */
+   uCount = 1U;
+   while (uCount < uStripeCount && uCount < ((size_t)1 << STRIPE_SHIFT))
+      uCount *= 2U;
+   oSymConc->uStripeCount = uCount;
+
+   oSymConc->psStripes = (union Stripe*)malloc(uCount *
+                                               sizeof(union Stripe));
+   if (oSymConc->psStripes == NULL)
+   {
+      free(oSymConc);
+      return NULL;
+   }
+
+   sOptions = *psOptions;
+   sOptions.uRehashStep = 0U;
+   sOptions.iMoveToFront = 0;
+
+   for (u = 0; u < uCount; u++)
+   {
+      psFields = &oSymConc->psStripes[u].sFields;
+      if (pthread_rwlock_init(&psFields->sLock, NULL) != 0)
+      {
+         SymConc_destroy(oSymConc, u);
+         return NULL;
+      }
+      psFields->oSymTable = SymTable_newWithOptions(&sOptions);
+      if (psFields->oSymTable == NULL)
+      {
+         pthread_rwlock_destroy(&psFields->sLock);
+         SymConc_destroy(oSymConc, u);
+         return NULL;
+      }
+   }
+
+   return oSymConc;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymConc_free(SymConc_T oSymConc)
+{
+   assert(oSymConc != NULL);
+
+   SymConc_destroy(oSymConc, oSymConc->uStripeCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymConc_getLength(SymConc_T oSymConc)
+{
+   struct StripeFields *psFields;
+   size_t uLength;
+   size_t u;
+
+   assert(oSymConc != NULL);
+
+   uLength = 0U;
+   for (u = 0; u < oSymConc->uStripeCount; u++)
+   {
+      psFields = &oSymConc->psStripes[u].sFields;
+      pthread_rwlock_rdlock(&psFields->sLock);
+      uLength += SymTable_getLength(psFields->oSymTable);
+      pthread_rwlock_unlock(&psFields->sLock);
+   }
+
+   return uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymConc_put(SymConc_T oSymConc,
+                const char *pcKey, const void *pvValue)
+{
+   struct StripeFields *psFields;
+   size_t uKeyLength;
+   size_t uHash;
+   int iSuccessful;
+
+   psFields = SymConc_stripe(oSymConc, pcKey, &uKeyLength, &uHash);
+   pthread_rwlock_wrlock(&psFields->sLock);
+   iSuccessful = SymTable_putH(psFields->oSymTable, pcKey,
+                               uKeyLength, uHash, pvValue);
+   pthread_rwlock_unlock(&psFields->sLock);
+
+   return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymConc_upsert(SymConc_T oSymConc,
+                   const char *pcKey, const void *pvValue)
+{
+   struct StripeFields *psFields;
+   size_t uKeyLength;
+   size_t uHash;
+   int iSuccessful;
+
+   psFields = SymConc_stripe(oSymConc, pcKey, &uKeyLength, &uHash);
+   pthread_rwlock_wrlock(&psFields->sLock);
+   iSuccessful = SymTable_upsertH(psFields->oSymTable, pcKey,
+                                  uKeyLength, uHash, pvValue);
+   pthread_rwlock_unlock(&psFields->sLock);
+
+   return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymConc_replace(SymConc_T oSymConc,
+                      const char *pcKey, const void *pvValue)
+{
+   struct StripeFields *psFields;
+   size_t uKeyLength;
+   size_t uHash;
+   void *pvOldValue;
+
+   psFields = SymConc_stripe(oSymConc, pcKey, &uKeyLength, &uHash);
+   pthread_rwlock_wrlock(&psFields->sLock);
+   pvOldValue = SymTable_replaceH(psFields->oSymTable, pcKey,
+                                  uKeyLength, uHash, pvValue);
+   pthread_rwlock_unlock(&psFields->sLock);
+
+   return pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymConc_contains(SymConc_T oSymConc, const char *pcKey)
+{
+   struct StripeFields *psFields;
+   size_t uKeyLength;
+   size_t uHash;
+   int iFound;
+
+   psFields = SymConc_stripe(oSymConc, pcKey, &uKeyLength, &uHash);
+   pthread_rwlock_rdlock(&psFields->sLock);
+   iFound = SymTable_containsH(psFields->oSymTable, pcKey,
+                               uKeyLength, uHash);
+   pthread_rwlock_unlock(&psFields->sLock);
+
+   return iFound;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymConc_get(SymConc_T oSymConc, const char *pcKey)
+{
+   struct StripeFields *psFields;
+   size_t uKeyLength;
+   size_t uHash;
+   void *pvValue;
+
+   psFields = SymConc_stripe(oSymConc, pcKey, &uKeyLength, &uHash);
+   pthread_rwlock_rdlock(&psFields->sLock);
+   pvValue = SymTable_getH(psFields->oSymTable, pcKey,
+                           uKeyLength, uHash);
+   pthread_rwlock_unlock(&psFields->sLock);
+
+   return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymConc_remove(SymConc_T oSymConc, const char *pcKey)
+{
+   struct StripeFields *psFields;
+   size_t uKeyLength;
+   size_t uHash;
+   void *pvValue;
+
+   psFields = SymConc_stripe(oSymConc, pcKey, &uKeyLength, &uHash);
+   pthread_rwlock_wrlock(&psFields->sLock);
+   pvValue = SymTable_removeH(psFields->oSymTable, pcKey,
+                              uKeyLength, uHash);
+   pthread_rwlock_unlock(&psFields->sLock);
+
+   return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymConc_map(SymConc_T oSymConc,
+                 void (*pfApply)(const char *pcKey,
+                                 void *pvValue,
+                                 void *pvExtra),
+                 const void *pvExtra)
+{
+   struct StripeFields *psFields;
+   size_t u;
+
+   assert(oSymConc != NULL);
+   assert(pfApply != NULL);
+
+   for (u = 0; u < oSymConc->uStripeCount; u++)
+   {
+      psFields = &oSymConc->psStripes[u].sFields;
+      pthread_rwlock_rdlock(&psFields->sLock);
+      SymTable_map(psFields->oSymTable, pfApply, pvExtra);
+      pthread_rwlock_unlock(&psFields->sLock);
+   }
+}
+
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,67 @@
+/*--------------------------------------------------------------------*/
+/* symconc.h                                                          */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMCONC_INCLUDED
+#define SYMCONC_INCLUDED
+#include "symtable.h"
+#include <stddef.h>
+
+/* A SymConc_T is a pointer to a SymConc object, a SymTable that many
+   threads may use at once. Its keys are split by hash code among a
+   number of stripes, each an ordinary SymTable guarded by its own
+   reader/writer lock. Calls on keys of different stripes never wait
+   for each other, readers of the same stripe proceed in parallel, and
+   a stripe that expands blocks only the callers that need it. */
+typedef struct SymConc *SymConc_T;
+
+/* Return a new, empty SymConc with the default number of stripes,
+   or NULL if out of memory. */
+SymConc_T SymConc_new(void);
+
+/* Return a new, empty SymConc of uStripeCount stripes, rounded up to
+   a power of two, each a SymTable configured by *psOptions, or NULL
+   if out of memory. psOptions->uRehashStep and
+   psOptions->iMoveToFront are ignored: incremental rehashing and
+   move-to-front would make lookups modify a stripe under a read
+   lock. */
+SymConc_T SymConc_newWithOptions(
+   const struct SymTable_Options *psOptions, size_t uStripeCount);
+
+/* Free oSymConc. No other thread may be using it. */
+void SymConc_free(SymConc_T oSymConc);
+
+/* Return the number of bindings in oSymConc. While other threads are
+   changing it, the result is only an estimate, since the stripes are
+   counted one at a time. */
+size_t SymConc_getLength(SymConc_T oSymConc);
+
+/* The functions below behave like the SymTable functions of the same
+   names, and are safe to call from any number of threads at once. */
+
+int SymConc_put(SymConc_T oSymConc,
+                const char *pcKey, const void *pvValue);
+
+int SymConc_upsert(SymConc_T oSymConc,
+                   const char *pcKey, const void *pvValue);
+
+void *SymConc_replace(SymConc_T oSymConc,
+                      const char *pcKey, const void *pvValue);
+
+int SymConc_contains(SymConc_T oSymConc, const char *pcKey);
+
+void *SymConc_get(SymConc_T oSymConc, const char *pcKey);
+
+void *SymConc_remove(SymConc_T oSymConc, const char *pcKey);
+
+/* For each binding in oSymConc, call pfApply(pcKey, pvValue,
+   pvExtra). Each stripe is read-locked while its bindings are
+   visited, so pfApply must not change oSymConc. */
+void SymConc_map(SymConc_T oSymConc,
+                 void (*pfApply)(const char *pcKey,
+                                 void *pvValue,
+                                 void *pvExtra),
+                 const void *pvExtra);
+
+#endif
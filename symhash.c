@@ -0,0 +1,257 @@
+/*--------------------------------------------------------------------*/
+/* symhash.c                                                          */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symhash.h"
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+
+/* the multiplier of the multiply-xorshift mix step. The 64-bit value
+   is the one used by MurmurHash64A; the 32-bit one by MurmurHash2. */
+static const size_t MIX_MULTIPLIER =
+   sizeof(size_t) >= 8U ?
+      ((((size_t)0xc6a4a793UL << 16) << 16) | (size_t)0x5bd1e995UL) :
+      (size_t)0x5bd1e995UL;
+
+/* the right shift of the mix step */
+static const unsigned int MIX_SHIFT = sizeof(size_t) >= 8U ? 47U : 24U;
+
+/* the right shifts of the final avalanche step */
+static const unsigned int FINAL_SHIFT_1 =
+   sizeof(size_t) >= 8U ? 47U : 13U;
+static const unsigned int FINAL_SHIFT_2 =
+   sizeof(size_t) >= 8U ? 47U : 15U;
+
+/* the rotations of a SipRound: those of SipHash when a size_t has 64
+   bits, and those of HalfSipHash, its 32-bit variant, otherwise */
+static const unsigned int SIP_ROTATE_1 =
+   sizeof(size_t) >= 8U ? 13U : 5U;
+static const unsigned int SIP_ROTATE_2 =
+   sizeof(size_t) >= 8U ? 16U : 8U;
+static const unsigned int SIP_ROTATE_3 =
+   sizeof(size_t) >= 8U ? 21U : 7U;
+static const unsigned int SIP_ROTATE_4 =
+   sizeof(size_t) >= 8U ? 17U : 13U;
+static const unsigned int SIP_ROTATE_HALF =
+   sizeof(size_t) >= 8U ? 32U : 16U;
+
+/* the number of SipRounds per word and after the last word: SipHash-
+   1-3 trades the margin of SipHash-2-4 for speed, as hash tables may */
+enum { SIP_C_ROUNDS = 1, SIP_D_ROUNDS = 3 };
+
+/* the number of bits in a size_t */
+enum { WORD_BITS = sizeof(size_t) * CHAR_BIT };
+
+/*--------------------------------------------------------------------*/
+
+size_t SymHash_classic(const void *pvKey, size_t uLength, size_t uSeed)
+{
+   const size_t HASH_MULTIPLIER = 65599;
+   const unsigned char *pucKey;
+   size_t u;
+   size_t uHash = uSeed;
+
+   assert(pvKey != NULL);
+
+   pucKey = (const unsigned char*)pvKey;
+   for (u = 0; u < uLength; u++)
+      uHash = uHash * HASH_MULTIPLIER + (size_t)pucKey[u];
+
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymHash_word(const void *pvKey, size_t uLength, size_t uSeed)
+{
+   const unsigned char *pucKey;
+   size_t uHash;
+   size_t uWord;
+   size_t uTail;
+
+   assert(pvKey != NULL);
+
+   pucKey = (const unsigned char*)pvKey;
+   uHash = uSeed ^ (uLength * MIX_MULTIPLIER);
+
+   /* mix in each whole word. memcpy keeps unaligned keys legal and
+      compiles to a single load. */
+   for (; uLength >= sizeof(size_t); uLength -= sizeof(size_t))
+   {
+      memcpy(&uWord, pucKey, sizeof(size_t));
+      pucKey += sizeof(size_t);
+
+      uWord *= MIX_MULTIPLIER;
+      uWord ^= uWord >> MIX_SHIFT;
+      uWord *= MIX_MULTIPLIER;
+
+      uHash ^= uWord;
+      uHash *= MIX_MULTIPLIER;
+   }
+
+   /* mix in the remaining bytes, if any, as one partial word */
+   if (uLength > 0U)
+   {
+      uTail = 0;
+      while (uLength > 0U)
+      {
+         uLength--;
+         uTail = (uTail << 8) | (size_t)pucKey[uLength];
+      }
+      uHash ^= uTail;
+      uHash *= MIX_MULTIPLIER;
+   }
+
+   /* avalanche, so the low bits depend on the whole key */
+   uHash ^= uHash >> FINAL_SHIFT_1;
+   uHash *= MIX_MULTIPLIER;
+   uHash ^= uHash >> FINAL_SHIFT_2;
+
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return uWord rotated left by uBits, which is between 1 and         */
+/* WORD_BITS - 1.                                                     */
+
+static size_t SymHash_rotate(size_t uWord, unsigned int uBits)
+{
+   assert(uBits > 0U && uBits < (unsigned int)WORD_BITS);
+   return (uWord << uBits) |
+          (uWord >> ((unsigned int)WORD_BITS - uBits));
+}
+
+/*--------------------------------------------------------------------*/
+/* Apply one SipRound to the state puV[0] through puV[3].             */
+
+static void SymHash_sipRound(size_t puV[4])
+{
+   puV[0] += puV[1];
+   puV[1] = SymHash_rotate(puV[1], SIP_ROTATE_1);
+   puV[1] ^= puV[0];
+   puV[0] = SymHash_rotate(puV[0], SIP_ROTATE_HALF);
+   puV[2] += puV[3];
+   puV[3] = SymHash_rotate(puV[3], SIP_ROTATE_2);
+   puV[3] ^= puV[2];
+   puV[0] += puV[3];
+   puV[3] = SymHash_rotate(puV[3], SIP_ROTATE_3);
+   puV[3] ^= puV[0];
+   puV[2] += puV[1];
+   puV[1] = SymHash_rotate(puV[1], SIP_ROTATE_4);
+   puV[1] ^= puV[2];
+   puV[2] = SymHash_rotate(puV[2], SIP_ROTATE_HALF);
+}
+
+/*--------------------------------------------------------------------*/
+/* Mix uWord into the state puV[0] through puV[3] with iRounds        */
+/* SipRounds.                                                         */
+
+static void SymHash_sipCompress(size_t puV[4], size_t uWord,
+                                int iRounds)
+{
+   puV[3] ^= uWord;
+   for (; iRounds > 0; iRounds--)
+      SymHash_sipRound(puV);
+   puV[0] ^= uWord;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymHash_sip(const void *pvKey, size_t uLength, size_t uSeed)
+{
+   const unsigned char *pucKey;
+   size_t auV[4];
+   size_t uKey0;
+   size_t uKey1;
+   size_t uWord;
+   size_t uTail;
+   size_t uRemaining;
+   int i;
+
+   assert(pvKey != NULL);
+
+   /* the second half of the key is derived from the seed, which is
+      all the secret there is */
+   uKey0 = uSeed;
+   uKey1 = uSeed ^ (uSeed >> FINAL_SHIFT_1);
+   uKey1 *= MIX_MULTIPLIER;
+   uKey1 ^= uKey1 >> FINAL_SHIFT_2;
+
+   /* the initial state of SipHash, or of HalfSipHash */
+   if (sizeof(size_t) >= 8U)
+   {
+      auV[0] = uKey0 ^ ((((size_t)0x736f6d65UL << 16) << 16) |
+                        (size_t)0x70736575UL);
+      auV[1] = uKey1 ^ ((((size_t)0x646f7261UL << 16) << 16) |
+                        (size_t)0x6e646f6dUL);
+      auV[2] = uKey0 ^ ((((size_t)0x6c796765UL << 16) << 16) |
+                        (size_t)0x6e657261UL);
+      auV[3] = uKey1 ^ ((((size_t)0x74656462UL << 16) << 16) |
+                        (size_t)0x79746573UL);
+   }
+   else
+   {
+      auV[0] = uKey0;
+      auV[1] = uKey1;
+      auV[2] = uKey0 ^ (size_t)0x6c796765UL;
+      auV[3] = uKey1 ^ (size_t)0x74656462UL;
+   }
+
+   /* compress each whole word, read little-endian so that the code
+      does not depend on the machine's byte order */
+   pucKey = (const unsigned char*)pvKey;
+   for (uRemaining = uLength; uRemaining >= sizeof(size_t);
+        uRemaining -= sizeof(size_t))
+   {
+      uWord = 0;
+      for (i = (int)sizeof(size_t) - 1; i >= 0; i--)
+         uWord = (uWord << 8) | (size_t)pucKey[i];
+      pucKey += sizeof(size_t);
+      SymHash_sipCompress(auV, uWord, SIP_C_ROUNDS);
+   }
+
+   /* then the remaining bytes, with the low byte of the length in
+      the top byte */
+   uTail = ((size_t)uLength & 0xffU) << ((unsigned int)WORD_BITS - 8U);
+   for (i = (int)uRemaining - 1; i >= 0; i--)
+      uTail |= (size_t)pucKey[i] << (8 * i);
+   SymHash_sipCompress(auV, uTail, SIP_C_ROUNDS);
+
+   /* finalize */
+   auV[2] ^= 0xffU;
+   for (i = 0; i < SIP_D_ROUNDS; i++)
+      SymHash_sipRound(auV);
+
+   if (sizeof(size_t) >= 8U)
+      return auV[0] ^ auV[1] ^ auV[2] ^ auV[3];
+   return auV[1] ^ auV[3];
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymHash_makeSeed(void)
+{
+   /* counts calls, so two seeds made in the same clock tick differ */
+   static size_t uCalls = 0;
+
+   struct
+   {
+      time_t iTime;
+      clock_t iClock;
+      size_t uCalls;
+      const void *pvStack;
+   } sEntropy;
+
+   memset(&sEntropy, 0, sizeof(sEntropy));
+   sEntropy.iTime = time(NULL);
+   sEntropy.iClock = clock();
+   sEntropy.uCalls = ++uCalls;
+   sEntropy.pvStack = (const void*)&sEntropy;
+
+   return SymHash_word(&sEntropy, sizeof(sEntropy), MIX_MULTIPLIER);
+}
+
+/*--------------------------------------------------------------------*/
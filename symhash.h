@@ -0,0 +1,40 @@
+/*--------------------------------------------------------------------*/
+/* symhash.h                                                          */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMHASH_INCLUDED
+#define SYMHASH_INCLUDED
+#include <stddef.h>
+
+/* A SymHash_T is a pointer to a hash function. It returns a hash
+   code for the uLength bytes at pvKey. Every bit of the result
+   depends on every byte of the key and on uSeed, so the code can be
+   reduced to a bucket index by masking off its low bits. */
+typedef size_t (*SymHash_T)(const void *pvKey, size_t uLength,
+                            size_t uSeed);
+
+/* Return the hash code from the assignment specification: one byte
+   at a time, multiplying by 65599, starting from uSeed. Its low bits
+   are weak, so it suits prime bucket counts better than masking. */
+size_t SymHash_classic(const void *pvKey, size_t uLength, size_t uSeed);
+
+/* Return a hash code computed one machine word at a time, with a
+   multiply-xorshift mix after every word and a final avalanche step.
+   This is the default hash function of the hashing SymTables. It is
+   fast but not keyed: keys whose codes are equal under one seed can
+   be built to be equal under every seed. */
+size_t SymHash_word(const void *pvKey, size_t uLength, size_t uSeed);
+
+/* Return the SipHash-1-3 code of the uLength bytes at pvKey, keyed by
+   uSeed, or the HalfSipHash-1-3 code where a size_t has 32 bits. It
+   is slower than SymHash_word, but without the seed an adversary
+   cannot find keys whose codes are equal. */
+size_t SymHash_sip(const void *pvKey, size_t uLength, size_t uSeed);
+
+/* Return a seed that differs from run to run. With SymHash_sip, it
+   keeps an adversary from picking keys that all land in one bucket;
+   with the other functions, it only varies their layout. */
+size_t SymHash_makeSeed(void);
+
+#endif
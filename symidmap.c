@@ -0,0 +1,176 @@
+/*--------------------------------------------------------------------*/
+/* symidmap.c                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symidmap.h"
+#include <assert.h>
+#include <stdlib.h>
+
+/* number of entries a SymIdMap gets when its first ID is bound. */
+enum { INITIAL_ENTRY_COUNT = 64 };
+
+/*--------------------------------------------------------------------*/
+/* An Entry holds the binding, if any, of one ID.                     */
+
+struct Entry
+{
+   /* the value bound to the ID. */
+   const void *pvValue;
+
+   /* nonzero if the ID is bound, since a value may be NULL. */
+   int iBound;
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymIdMap is an array of Entries indexed by ID.                   */
+
+struct SymIdMap
+{
+   /* array of uEntryCount Entries, or NULL while the count is 0. */
+   struct Entry *psEntries;
+   size_t uEntryCount;
+
+   /* number of bound Entries. */
+   size_t uLength;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymIdMap_T SymIdMap_new(void)
+{
+   SymIdMap_T oSymIdMap;
+
+   oSymIdMap = (SymIdMap_T)malloc(sizeof(struct SymIdMap));
+   if (oSymIdMap == NULL)
+      return NULL;
+
+   oSymIdMap->psEntries = NULL;
+   oSymIdMap->uEntryCount = 0U;
+   oSymIdMap->uLength = 0U;
+   return oSymIdMap;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymIdMap_free(SymIdMap_T oSymIdMap)
+{
+   assert(oSymIdMap != NULL);
+
+   free(oSymIdMap->psEntries);
+   free(oSymIdMap);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymIdMap_getLength(SymIdMap_T oSymIdMap)
+{
+   assert(oSymIdMap != NULL);
+   return oSymIdMap->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+/* Grow oSymIdMap's array, doubling it as often as needed, to have an */
+/* Entry for uId. Return 1 if successful, or 0 if out of memory.      */
+
+static int SymIdMap_growTo(SymIdMap_T oSymIdMap, size_t uId)
+{
+   struct Entry *psNewEntries;
+   size_t uNewCount;
+   size_t u;
+
+   assert(oSymIdMap != NULL);
+   assert(uId >= oSymIdMap->uEntryCount);
+
+   uNewCount = oSymIdMap->uEntryCount;
+   if (uNewCount == 0U)
+      uNewCount = INITIAL_ENTRY_COUNT;
+   while (uNewCount <= uId)
+   {
+      if (uNewCount > (size_t)-1 / sizeof(struct Entry) / 2U)
+         return 0;
+      uNewCount *= 2U;
+   }
+
+   psNewEntries = (struct Entry*)realloc(
+      oSymIdMap->psEntries, uNewCount * sizeof(struct Entry));
+   if (psNewEntries == NULL)
+      return 0;
+
+   for (u = oSymIdMap->uEntryCount; u < uNewCount; u++)
+      psNewEntries[u].iBound = 0;
+   oSymIdMap->psEntries = psNewEntries;
+   oSymIdMap->uEntryCount = uNewCount;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymIdMap_put(SymIdMap_T oSymIdMap, size_t uId, const void *pvValue)
+{
+   assert(oSymIdMap != NULL);
+
+   if (uId >= oSymIdMap->uEntryCount)
+      if (!SymIdMap_growTo(oSymIdMap, uId))
+         return 0;
+   if (oSymIdMap->psEntries[uId].iBound)
+      return 0;
+
+   oSymIdMap->psEntries[uId].pvValue = pvValue;
+   oSymIdMap->psEntries[uId].iBound = 1;
+   oSymIdMap->uLength++;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymIdMap_replace(SymIdMap_T oSymIdMap, size_t uId,
+                       const void *pvValue)
+{
+   const void *pvOldValue;
+
+   assert(oSymIdMap != NULL);
+
+   if (!SymIdMap_contains(oSymIdMap, uId))
+      return NULL;
+
+   pvOldValue = oSymIdMap->psEntries[uId].pvValue;
+   oSymIdMap->psEntries[uId].pvValue = pvValue;
+   return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymIdMap_contains(SymIdMap_T oSymIdMap, size_t uId)
+{
+   assert(oSymIdMap != NULL);
+
+   return uId < oSymIdMap->uEntryCount &&
+          oSymIdMap->psEntries[uId].iBound;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymIdMap_get(SymIdMap_T oSymIdMap, size_t uId)
+{
+   assert(oSymIdMap != NULL);
+
+   if (!SymIdMap_contains(oSymIdMap, uId))
+      return NULL;
+   return (void*)oSymIdMap->psEntries[uId].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymIdMap_remove(SymIdMap_T oSymIdMap, size_t uId)
+{
+   assert(oSymIdMap != NULL);
+
+   if (!SymIdMap_contains(oSymIdMap, uId))
+      return NULL;
+
+   oSymIdMap->psEntries[uId].iBound = 0;
+   assert(oSymIdMap->uLength > 0U);
+   oSymIdMap->uLength--;
+   return (void*)oSymIdMap->psEntries[uId].pvValue;
+}
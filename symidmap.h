@@ -0,0 +1,46 @@
+/*--------------------------------------------------------------------*/
+/* symidmap.h                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMIDMAP_INCLUDED
+#define SYMIDMAP_INCLUDED
+#include <stddef.h>
+
+/* A SymIdMap_T is a pointer to a SymIdMap object, a table of
+   bindings whose keys are small integer IDs, such as those a
+   SymIntern gives, instead of strings. It is an array indexed by ID,
+   so a lookup neither hashes nor compares, and it takes memory in
+   proportion to the largest ID bound, not to the number of
+   bindings. */
+typedef struct SymIdMap *SymIdMap_T;
+
+/* Return a new, empty SymIdMap, or NULL if out of memory. */
+SymIdMap_T SymIdMap_new(void);
+
+/* Free oSymIdMap. */
+void SymIdMap_free(SymIdMap_T oSymIdMap);
+
+/* Return the number of bindings in oSymIdMap. */
+size_t SymIdMap_getLength(SymIdMap_T oSymIdMap);
+
+/* If uId is not bound in oSymIdMap, bind it to pvValue and return 1.
+   Otherwise return 0, as also if out of memory. */
+int SymIdMap_put(SymIdMap_T oSymIdMap, size_t uId, const void *pvValue);
+
+/* If uId is bound in oSymIdMap, set its value to pvValue and return
+   the old value. Otherwise return NULL. */
+void *SymIdMap_replace(SymIdMap_T oSymIdMap, size_t uId,
+                       const void *pvValue);
+
+/* Return 1 if uId is bound in oSymIdMap, or 0 otherwise. */
+int SymIdMap_contains(SymIdMap_T oSymIdMap, size_t uId);
+
+/* Return the value of uId in oSymIdMap, or NULL if it is not bound. */
+void *SymIdMap_get(SymIdMap_T oSymIdMap, size_t uId);
+
+/* If uId is bound in oSymIdMap, remove the binding and return its
+   value. Otherwise return NULL. */
+void *SymIdMap_remove(SymIdMap_T oSymIdMap, size_t uId);
+
+#endif
@@ -0,0 +1,591 @@
+/*--------------------------------------------------------------------*/
+/* symimage.c                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+/* mmap and friends are POSIX, so ask for them */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symimage.h"
+#include "symhash.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* the first bytes of every image. */
+static const char acImageMagic[8] = "SYMIMG1";
+
+/* the header holds this as a size_t, so a machine of the other byte
+   order can tell the image is not for it */
+static const size_t BYTE_ORDER_MARK = (size_t)0x01020304UL;
+
+/* each section of an image, and each encoded value, starts at a
+   multiple of this many bytes from the start of the image, which
+   mmap places on a page boundary. */
+enum { IMAGE_ALIGNMENT = 16 };
+
+/*--------------------------------------------------------------------*/
+/* An image begins with an ImageHeader. Every offset in an image      */
+/* counts bytes from its start.                                       */
+
+struct ImageHeader
+{
+   /* acImageMagic. */
+   char acMagic[8];
+
+   /* sizeof(size_t) and BYTE_ORDER_MARK on the machine that wrote
+      the image. */
+   size_t uWordSize;
+   size_t uByteOrder;
+
+   /* the size of the whole image, in bytes. */
+   size_t uImageSize;
+
+   /* the number of bindings, and of buckets. The bucket count is a
+      power of two. */
+   size_t uLength;
+   size_t uBucketCount;
+
+   /* the offset of an array of uBucketCount+1 entry indices. The
+      ImageEntries of bucket i are those from the one at index i of
+      that array up to but not including the one at index i+1. */
+   size_t uBucketsOffset;
+
+   /* the offset of the array of uLength ImageEntries. */
+   size_t uEntriesOffset;
+};
+
+/*--------------------------------------------------------------------*/
+/* Each binding is described by an ImageEntry. Entries are sorted by  */
+/* bucket. The keys and values they describe follow them.             */
+
+struct ImageEntry
+{
+   /* the hash code of the key under SymHash_word() with seed 0. */
+   size_t uHash;
+
+   /* the offset and length of the key, which is followed by a
+      NUL. */
+   size_t uKeyOffset;
+   size_t uKeyLength;
+
+   /* the offset and length of the encoded value. */
+   size_t uValueOffset;
+   size_t uValueLength;
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymImage is a mapped image and the addresses of its sections.    */
+
+struct SymImage
+{
+   /* the mapped image, and its size. */
+   const char *pcBase;
+   size_t uSize;
+
+   const struct ImageHeader *psHeader;
+   const size_t *puBucketStarts;
+   const struct ImageEntry *psEntries;
+};
+
+/*--------------------------------------------------------------------*/
+/* The state of SymImage_write() while it gathers bindings.           */
+
+struct Collector
+{
+   /* the entries gathered so far, and room for uEntryCapacity. Their
+      offsets count from the start of pcData until the layout is
+      known. */
+   struct ImageEntry *psEntries;
+   size_t uEntryCount;
+   size_t uEntryCapacity;
+
+   /* the keys and encoded values gathered so far, in uDataSize bytes
+      of a buffer of uDataCapacity. */
+   char *pcData;
+   size_t uDataSize;
+   size_t uDataCapacity;
+
+   /* the arguments of SymImage_write(). */
+   SymImage_Encode_T pfEncode;
+   const void *pvExtra;
+
+   /* nonzero once memory has run out. */
+   int iFailed;
+};
+
+/*--------------------------------------------------------------------*/
+/* Return uSize rounded up to a multiple of IMAGE_ALIGNMENT.          */
+
+static size_t SymImage_align(size_t uSize)
+{
+   return (uSize + IMAGE_ALIGNMENT - 1U) / IMAGE_ALIGNMENT *
+          IMAGE_ALIGNMENT;
+}
+
+/*--------------------------------------------------------------------*/
+/* Append the uLength bytes at pvBytes to psCollector's data, first   */
+/* padding it to a multiple of IMAGE_ALIGNMENT bytes if iAlign is     */
+/* nonzero, then append uNulCount NUL bytes. Return the offset where  */
+/* the bytes went, or set psCollector->iFailed if out of memory.      */
+
+static size_t SymImage_append(struct Collector *psCollector,
+                              const void *pvBytes, size_t uLength,
+                              int iAlign, size_t uNulCount)
+{
+   char *pcNewData;
+   size_t uOffset;
+   size_t uNeeded;
+   size_t uNewCapacity;
+
+   assert(psCollector != NULL);
+   assert(pvBytes != NULL || uLength == 0U);
+
+   uOffset = psCollector->uDataSize;
+   if (iAlign)
+      uOffset = SymImage_align(uOffset);
+   uNeeded = uOffset + uLength + uNulCount;
+   if (uNeeded < uOffset)
+   {
+      psCollector->iFailed = 1;
+      return 0U;
+   }
+
+   if (uNeeded > psCollector->uDataCapacity)
+   {
+      uNewCapacity = psCollector->uDataCapacity * 2U;
+      if (uNewCapacity < uNeeded)
+         uNewCapacity = uNeeded;
+      pcNewData = (char*)realloc(psCollector->pcData, uNewCapacity);
+      if (pcNewData == NULL)
+      {
+         psCollector->iFailed = 1;
+         return 0U;
+      }
+      psCollector->pcData = pcNewData;
+      psCollector->uDataCapacity = uNewCapacity;
+   }
+
+   memset(psCollector->pcData + psCollector->uDataSize, 0,
+          uOffset - psCollector->uDataSize);
+   if (uLength > 0U)
+      memcpy(psCollector->pcData + uOffset, pvBytes, uLength);
+   memset(psCollector->pcData + uOffset + uLength, 0, uNulCount);
+   psCollector->uDataSize = uNeeded;
+
+   return uOffset;
+}
+
+/*--------------------------------------------------------------------*/
+/* Add the binding of pcKey to pvValue to the Collector at pvExtra.   */
+/* Called through SymTable_map().                                     */
+
+static void SymImage_collect(const char *pcKey, void *pvValue,
+                             void *pvExtra)
+{
+   struct Collector *psCollector;
+   struct ImageEntry *psEntry;
+   const void *pvBytes;
+   size_t uValueLength;
+
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   psCollector = (struct Collector*)pvExtra;
+   if (psCollector->iFailed)
+      return;
+   assert(psCollector->uEntryCount < psCollector->uEntryCapacity);
+
+   psEntry = &psCollector->psEntries[psCollector->uEntryCount];
+   psEntry->uKeyLength = strlen(pcKey);
+   psEntry->uHash = SymHash_word(pcKey, psEntry->uKeyLength, 0U);
+   psEntry->uKeyOffset = SymImage_append(psCollector, pcKey,
+                                         psEntry->uKeyLength, 0, 1U);
+
+   uValueLength = 0U;
+   pvBytes = (*psCollector->pfEncode)(pcKey, pvValue, &uValueLength,
+                                      (void*)psCollector->pvExtra);
+   psEntry->uValueLength = uValueLength;
+   psEntry->uValueOffset = SymImage_append(psCollector, pvBytes,
+                                           uValueLength, 1, 0U);
+
+   psCollector->uEntryCount++;
+}
+
+/*--------------------------------------------------------------------*/
+/* Write the uSize bytes at pvBytes to psFile, followed by enough NUL */
+/* bytes to reach a multiple of IMAGE_ALIGNMENT. Return 1 if          */
+/* successful, or 0 otherwise.                                        */
+
+static int SymImage_writeSection(FILE *psFile, const void *pvBytes,
+                                 size_t uSize)
+{
+   static const char acPadding[IMAGE_ALIGNMENT] = {0};
+   size_t uPadding;
+
+   assert(psFile != NULL);
+   assert(pvBytes != NULL || uSize == 0U);
+
+   uPadding = SymImage_align(uSize) - uSize;
+   return (uSize == 0U ||
+           fwrite(pvBytes, 1U, uSize, psFile) == uSize) &&
+          (uPadding == 0U ||
+           fwrite(acPadding, 1U, uPadding, psFile) == uPadding);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymImage_write(SymTable_T oSymTable, const char *pcPath,
+                   SymImage_Encode_T pfEncode, const void *pvExtra)
+{
+   struct Collector sCollector;
+   struct ImageHeader sHeader;
+   struct ImageEntry *psSorted;
+   size_t *puBucketStarts;
+   size_t uDataOffset;
+   size_t uBucket;
+   size_t u;
+   FILE *psFile;
+   int iSuccessful;
+
+   assert(oSymTable != NULL);
+   assert(pcPath != NULL);
+   assert(pfEncode != NULL);
+
+   /* gather every key and encoded value */
+   sCollector.uEntryCapacity = SymTable_getLength(oSymTable);
+   sCollector.uEntryCount = 0U;
+   if (sCollector.uEntryCapacity >
+       (size_t)-1 / (2U * sizeof(struct ImageEntry)))
+      return 0;
+   sCollector.psEntries = (struct ImageEntry*)malloc(
+      (sCollector.uEntryCapacity + 1U) * sizeof(struct ImageEntry));
+   sCollector.pcData = NULL;
+   sCollector.uDataSize = 0U;
+   sCollector.uDataCapacity = 0U;
+   sCollector.pfEncode = pfEncode;
+   sCollector.pvExtra = pvExtra;
+   sCollector.iFailed = sCollector.psEntries == NULL;
+   if (!sCollector.iFailed)
+      SymTable_map(oSymTable, SymImage_collect, &sCollector);
+
+   /* one bucket per binding, at least, keeps chains short */
+   sHeader.uBucketCount = 1U;
+   while (sHeader.uBucketCount < sCollector.uEntryCount &&
+          sHeader.uBucketCount <= (size_t)-1 / 4U / sizeof(size_t))
+      sHeader.uBucketCount *= 2U;
+
+   psSorted = NULL;
+   puBucketStarts = NULL;
+   if (!sCollector.iFailed)
+   {
+      psSorted = (struct ImageEntry*)malloc(
+         (sCollector.uEntryCount + 1U) * sizeof(struct ImageEntry));
+      puBucketStarts = (size_t*)calloc(sHeader.uBucketCount + 1U,
+                                       sizeof(size_t));
+   }
+   if (sCollector.iFailed || psSorted == NULL || puBucketStarts == NULL)
+   {
+      free(sCollector.psEntries);
+      free(sCollector.pcData);
+      free(psSorted);
+      free(puBucketStarts);
+      return 0;
+   }
+
+   /* lay the image out: header, bucket starts, entries, data */
+   memcpy(sHeader.acMagic, acImageMagic, sizeof(sHeader.acMagic));
+   sHeader.uWordSize = sizeof(size_t);
+   sHeader.uByteOrder = BYTE_ORDER_MARK;
+   sHeader.uLength = sCollector.uEntryCount;
+   sHeader.uBucketsOffset = SymImage_align(sizeof(struct ImageHeader));
+   sHeader.uEntriesOffset = sHeader.uBucketsOffset + SymImage_align(
+      (sHeader.uBucketCount + 1U) * sizeof(size_t));
+   uDataOffset = sHeader.uEntriesOffset + SymImage_align(
+      sHeader.uLength * sizeof(struct ImageEntry));
+   sHeader.uImageSize = uDataOffset +
+                        SymImage_align(sCollector.uDataSize);
+
+   /* sort the entries by bucket with a counting sort, rebasing their
+      offsets on the start of the image */
+   for (u = 0; u < sHeader.uLength; u++)
+   {
+      uBucket = sCollector.psEntries[u].uHash &
+                (sHeader.uBucketCount - 1U);
+      puBucketStarts[uBucket + 1U]++;
+   }
+   for (uBucket = 0; uBucket < sHeader.uBucketCount; uBucket++)
+      puBucketStarts[uBucket + 1U] += puBucketStarts[uBucket];
+   for (u = 0; u < sHeader.uLength; u++)
+   {
+      uBucket = sCollector.psEntries[u].uHash &
+                (sHeader.uBucketCount - 1U);
+      psSorted[puBucketStarts[uBucket]] = sCollector.psEntries[u];
+      psSorted[puBucketStarts[uBucket]].uKeyOffset += uDataOffset;
+      psSorted[puBucketStarts[uBucket]].uValueOffset += uDataOffset;
+      puBucketStarts[uBucket]++;
+   }
+   /* each start has moved to the next bucket's start */
+   for (uBucket = sHeader.uBucketCount; uBucket > 0U; uBucket--)
+      puBucketStarts[uBucket] = puBucketStarts[uBucket - 1U];
+   puBucketStarts[0] = 0U;
+
+   psFile = fopen(pcPath, "wb");
+   iSuccessful = psFile != NULL;
+   if (iSuccessful)
+   {
+      iSuccessful =
+         SymImage_writeSection(psFile, &sHeader,
+                               sizeof(struct ImageHeader)) &&
+         SymImage_writeSection(psFile, puBucketStarts,
+                               (sHeader.uBucketCount + 1U) *
+                               sizeof(size_t)) &&
+         SymImage_writeSection(psFile, psSorted,
+                               sHeader.uLength *
+                               sizeof(struct ImageEntry)) &&
+         SymImage_writeSection(psFile, sCollector.pcData,
+                               sCollector.uDataSize);
+      if (fclose(psFile) != 0)
+         iSuccessful = 0;
+   }
+
+   free(sCollector.psEntries);
+   free(sCollector.pcData);
+   free(psSorted);
+   free(puBucketStarts);
+   return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return 1 if an array of uCount objects of uSize bytes at offset    */
+/* uOffset, aligned for a size_t, lies within an image of uImageSize  */
+/* bytes, or 0 otherwise.                                             */
+
+static int SymImage_fits(size_t uOffset, size_t uCount, size_t uSize,
+                         size_t uImageSize)
+{
+   return uOffset % sizeof(size_t) == 0U &&
+          uOffset <= uImageSize &&
+          uCount <= (uImageSize - uOffset) / uSize;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return 1 if the uSize bytes at pcBase hold an image this machine   */
+/* can read, and whose every bucket, key and value lies within it,    */
+/* or 0 otherwise. uSize is at least the size of an ImageHeader.      */
+
+static int SymImage_isValid(const char *pcBase, size_t uSize)
+{
+   const struct ImageHeader *psHeader;
+   const size_t *puBucketStarts;
+   const struct ImageEntry *psEntry;
+   size_t u;
+
+   assert(pcBase != NULL);
+
+   psHeader = (const struct ImageHeader*)(const void*)pcBase;
+   if (memcmp(psHeader->acMagic, acImageMagic,
+              sizeof(psHeader->acMagic)) != 0 ||
+       psHeader->uWordSize != sizeof(size_t) ||
+       psHeader->uByteOrder != BYTE_ORDER_MARK ||
+       psHeader->uImageSize != uSize ||
+       psHeader->uBucketCount == 0U ||
+       (psHeader->uBucketCount & (psHeader->uBucketCount - 1U)) != 0U ||
+       psHeader->uBucketCount == (size_t)-1 ||
+       ! SymImage_fits(psHeader->uBucketsOffset,
+                       psHeader->uBucketCount + 1U, sizeof(size_t),
+                       uSize) ||
+       ! SymImage_fits(psHeader->uEntriesOffset, psHeader->uLength,
+                       sizeof(struct ImageEntry), uSize))
+      return 0;
+
+   /* each bucket's entries lie within the entry array */
+   puBucketStarts = (const size_t*)(const void*)
+      (pcBase + psHeader->uBucketsOffset);
+   if (puBucketStarts[0] != 0U ||
+       puBucketStarts[psHeader->uBucketCount] != psHeader->uLength)
+      return 0;
+   for (u = 0; u < psHeader->uBucketCount; u++)
+      if (puBucketStarts[u] > puBucketStarts[u + 1U])
+         return 0;
+
+   /* each key, with its NUL, and each value lie within the image */
+   psEntry = (const struct ImageEntry*)(const void*)
+      (pcBase + psHeader->uEntriesOffset);
+   for (u = 0; u < psHeader->uLength; u++, psEntry++)
+   {
+      if (psEntry->uKeyOffset >= uSize ||
+          psEntry->uKeyLength >= uSize - psEntry->uKeyOffset ||
+          pcBase[psEntry->uKeyOffset + psEntry->uKeyLength] != '\0' ||
+          psEntry->uValueOffset % IMAGE_ALIGNMENT != 0U ||
+          psEntry->uValueOffset > uSize ||
+          psEntry->uValueLength > uSize - psEntry->uValueOffset)
+         return 0;
+   }
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymImage_T SymImage_open(const char *pcPath)
+{
+   SymImage_T oSymImage;
+   struct stat sStat;
+   void *pvBase;
+   size_t uSize;
+   int iFd;
+   int iValid;
+
+   assert(pcPath != NULL);
+
+   iFd = open(pcPath, O_RDONLY);
+   if (iFd < 0)
+      return NULL;
+   if (fstat(iFd, &sStat) != 0 ||
+       sStat.st_size < (off_t)sizeof(struct ImageHeader) ||
+       (off_t)(size_t)sStat.st_size != sStat.st_size)
+   {
+      close(iFd);
+      return NULL;
+   }
+   uSize = (size_t)sStat.st_size;
+
+   /* the mapping outlives the descriptor */
+   pvBase = mmap(NULL, uSize, PROT_READ, MAP_SHARED, iFd, 0);
+   close(iFd);
+   if (pvBase == MAP_FAILED)
+      return NULL;
+
+   /* check the whole image, so every lookup can trust it */
+   iValid = SymImage_isValid((const char*)pvBase, uSize);
+
+   oSymImage = NULL;
+   if (iValid)
+      oSymImage = (SymImage_T)malloc(sizeof(struct SymImage));
+   if (oSymImage == NULL)
+   {
+      munmap(pvBase, uSize);
+      return NULL;
+   }
+
+   oSymImage->pcBase = (const char*)pvBase;
+   oSymImage->uSize = uSize;
+   oSymImage->psHeader =
+      (const struct ImageHeader*)(const void*)oSymImage->pcBase;
+   oSymImage->puBucketStarts = (const size_t*)(const void*)
+      (oSymImage->pcBase + oSymImage->psHeader->uBucketsOffset);
+   oSymImage->psEntries = (const struct ImageEntry*)(const void*)
+      (oSymImage->pcBase + oSymImage->psHeader->uEntriesOffset);
+
+   return oSymImage;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymImage_close(SymImage_T oSymImage)
+{
+   assert(oSymImage != NULL);
+
+   munmap((void*)oSymImage->pcBase, oSymImage->uSize);
+   free(oSymImage);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymImage_getLength(SymImage_T oSymImage)
+{
+   assert(oSymImage != NULL);
+
+   return oSymImage->psHeader->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the ImageEntry of pcKey in oSymImage, or NULL if pcKey is   */
+/* not present.                                                       */
+
+static const struct ImageEntry *SymImage_find(SymImage_T oSymImage,
+                                              const char *pcKey)
+{
+   const struct ImageEntry *psEntry;
+   const struct ImageEntry *psEnd;
+   size_t uKeyLength;
+   size_t uHash;
+   size_t uBucket;
+
+   assert(oSymImage != NULL);
+   assert(pcKey != NULL);
+
+   uKeyLength = strlen(pcKey);
+   uHash = SymHash_word(pcKey, uKeyLength, 0U);
+   uBucket = uHash & (oSymImage->psHeader->uBucketCount - 1U);
+
+   psEntry = &oSymImage->psEntries[oSymImage->puBucketStarts[uBucket]];
+   psEnd =
+      &oSymImage->psEntries[oSymImage->puBucketStarts[uBucket + 1U]];
+   for (; psEntry < psEnd; psEntry++)
+   {
+      if (psEntry->uHash == uHash &&
+          psEntry->uKeyLength == uKeyLength &&
+          memcmp(oSymImage->pcBase + psEntry->uKeyOffset, pcKey,
+                 uKeyLength) == 0)
+         return psEntry;
+   }
+
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymImage_contains(SymImage_T oSymImage, const char *pcKey)
+{
+   return SymImage_find(oSymImage, pcKey) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+const void *SymImage_get(SymImage_T oSymImage, const char *pcKey,
+                         size_t *puLength)
+{
+   const struct ImageEntry *psEntry;
+
+   assert(puLength != NULL);
+
+   psEntry = SymImage_find(oSymImage, pcKey);
+   if (psEntry == NULL)
+      return NULL;
+
+   *puLength = psEntry->uValueLength;
+   return oSymImage->pcBase + psEntry->uValueOffset;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymImage_map(SymImage_T oSymImage,
+                  void (*pfApply)(const char *pcKey,
+                                  const void *pvValue,
+                                  size_t uLength,
+                                  void *pvExtra),
+                  const void *pvExtra)
+{
+   const struct ImageEntry *psEntry;
+   size_t u;
+
+   assert(oSymImage != NULL);
+   assert(pfApply != NULL);
+
+   for (u = 0; u < oSymImage->psHeader->uLength; u++)
+   {
+      psEntry = &oSymImage->psEntries[u];
+      (*pfApply)(oSymImage->pcBase + psEntry->uKeyOffset,
+                 oSymImage->pcBase + psEntry->uValueOffset,
+                 psEntry->uValueLength, (void*)pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
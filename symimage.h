@@ -0,0 +1,69 @@
+/*--------------------------------------------------------------------*/
+/* symimage.h                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMIMAGE_INCLUDED
+#define SYMIMAGE_INCLUDED
+#include "symtable.h"
+#include <stddef.h>
+
+/* A SymImage_T is a pointer to a SymImage object, an immutable
+   table read straight from a file that SymImage_write() made. The
+   file is mapped into memory, and lookups work on the mapped pages
+   as they are: the file holds offsets instead of pointers, so
+   opening it needs no allocation or decoding per binding, only one
+   pass that checks every offset. An image is specific to the machine
+   type that wrote it. */
+typedef struct SymImage *SymImage_T;
+
+/* A SymImage_Encode_T is a pointer to a function that returns the
+   address of the bytes to store in an image for the binding of pcKey
+   to pvValue, and stores their number in *puLength. The bytes are
+   copied before the function is called again. */
+typedef const void *(*SymImage_Encode_T)(const char *pcKey,
+                                         const void *pvValue,
+                                         size_t *puLength,
+                                         void *pvExtra);
+
+/* Write an image of oSymTable to the file named pcPath, replacing
+   it, with each value encoded by pfEncode(pcKey, pvValue, puLength,
+   pvExtra). Return 1 if successful, or 0 if out of memory or the
+   file cannot be written. */
+int SymImage_write(SymTable_T oSymTable, const char *pcPath,
+                   SymImage_Encode_T pfEncode, const void *pvExtra);
+
+/* Return a new SymImage for the image in the file named pcPath, or
+   NULL if it cannot be mapped or is not an image this machine can
+   read, including one whose offsets or lengths point outside it.
+   The file must not change while the SymImage is open. */
+SymImage_T SymImage_open(const char *pcPath);
+
+/* Unmap oSymImage and free it. Pointers it returned become
+   invalid. */
+void SymImage_close(SymImage_T oSymImage);
+
+/* Return the number of bindings in oSymImage. */
+size_t SymImage_getLength(SymImage_T oSymImage);
+
+/* Return 1 (TRUE) if oSymImage contains a binding whose key is
+   pcKey, and 0 (FALSE) otherwise. */
+int SymImage_contains(SymImage_T oSymImage, const char *pcKey);
+
+/* Return the address of the encoded value of pcKey in oSymImage, and
+   store its length in *puLength, or return NULL if pcKey is not
+   present. The bytes are aligned for any type, and read-only. */
+const void *SymImage_get(SymImage_T oSymImage, const char *pcKey,
+                         size_t *puLength);
+
+/* For each binding in oSymImage, call pfApply(pcKey, pvValue,
+   uLength, pvExtra), where pvValue and uLength describe the encoded
+   value. */
+void SymImage_map(SymImage_T oSymImage,
+                  void (*pfApply)(const char *pcKey,
+                                  const void *pvValue,
+                                  size_t uLength,
+                                  void *pvExtra),
+                  const void *pvExtra);
+
+#endif
@@ -0,0 +1,208 @@
+/*--------------------------------------------------------------------*/
+/* symintern.c                                                        */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symintern.h"
+#include "symalloc.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* number of IDs a new SymIntern has room to give. */
+enum { INITIAL_STRING_CAPACITY = 64 };
+
+/*--------------------------------------------------------------------*/
+/* A Symbol is the value the table binds an interned string to.       */
+
+struct Symbol
+{
+   /* the ID of the string. */
+   size_t uId;
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymIntern is a SymTable from strings to their Symbols, and an    */
+/* array from IDs to the strings.                                     */
+
+struct SymIntern
+{
+   /* maps each interned string to its Symbol. The table borrows its
+      keys, which are the canonical copies. */
+   SymTable_T oSymTable;
+
+   /* ppcStrings[i] is the canonical copy of the string of ID i, for
+      i from 1 through uCount; ppcStrings has room for uCapacity. */
+   const char **ppcStrings;
+   size_t uCount;
+   size_t uCapacity;
+
+   /* where the Symbols and the canonical copies are allocated. */
+   struct SymPool sSymbolPool;
+   struct SymArena sStringArena;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymIntern_T SymIntern_new(void)
+{
+   struct SymTable_Options sOptions;
+   SymIntern_T oSymIntern;
+
+   oSymIntern = (SymIntern_T)malloc(sizeof(struct SymIntern));
+   if (oSymIntern == NULL)
+      return NULL;
+
+   /* the canonical copies outlive the table, so it need not copy
+      them again */
+   SymTable_initOptions(&sOptions);
+   sOptions.iBorrowKeys = 1;
+   oSymIntern->oSymTable = SymTable_newWithOptions(&sOptions);
+   oSymIntern->ppcStrings = (const char**)malloc(
+      (size_t)INITIAL_STRING_CAPACITY * sizeof(const char*));
+   if (oSymIntern->oSymTable == NULL || oSymIntern->ppcStrings == NULL)
+   {
+      if (oSymIntern->oSymTable != NULL)
+         SymTable_free(oSymIntern->oSymTable);
+      free(oSymIntern->ppcStrings);
+      free(oSymIntern);
+      return NULL;
+   }
+
+   /* ID 0 is never given */
+   oSymIntern->ppcStrings[0] = NULL;
+   oSymIntern->uCount = 0U;
+   oSymIntern->uCapacity = INITIAL_STRING_CAPACITY;
+   SymPool_init(&oSymIntern->sSymbolPool, sizeof(struct Symbol));
+   SymArena_init(&oSymIntern->sStringArena);
+   return oSymIntern;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymIntern_free(SymIntern_T oSymIntern)
+{
+   assert(oSymIntern != NULL);
+
+   SymTable_free(oSymIntern->oSymTable);
+   SymPool_destroy(&oSymIntern->sSymbolPool);
+   SymArena_destroy(&oSymIntern->sStringArena);
+   free(oSymIntern->ppcStrings);
+   free(oSymIntern);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymIntern_getCount(SymIntern_T oSymIntern)
+{
+   assert(oSymIntern != NULL);
+   return oSymIntern->uCount;
+}
+
+/*--------------------------------------------------------------------*/
+/* Make room in oSymIntern->ppcStrings for one more ID, which must    */
+/* fit with 0 unused. Return 1 if successful, or 0 if out of memory.  */
+
+static int SymIntern_makeRoom(SymIntern_T oSymIntern)
+{
+   const char **ppcNewStrings;
+   size_t uNewCapacity;
+
+   assert(oSymIntern != NULL);
+
+   if (oSymIntern->uCount + 1U < oSymIntern->uCapacity)
+      return 1;
+
+   if (oSymIntern->uCapacity > (size_t)-1 / sizeof(const char*) / 2U)
+      return 0;
+   uNewCapacity = oSymIntern->uCapacity * 2U;
+   ppcNewStrings = (const char**)realloc(
+      (void*)oSymIntern->ppcStrings,
+      uNewCapacity * sizeof(const char*));
+   if (ppcNewStrings == NULL)
+      return 0;
+   oSymIntern->ppcStrings = ppcNewStrings;
+   oSymIntern->uCapacity = uNewCapacity;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymIntern_intern(SymIntern_T oSymIntern, const char *pcKey)
+{
+   struct Symbol *psSymbol;
+   char *pcCopy;
+   void **ppvSlot;
+   size_t uKeyLength;
+
+   assert(oSymIntern != NULL);
+   assert(pcKey != NULL);
+
+   /* the table borrows the key it is given, so the probe is made
+      with a new canonical copy, given back at once if the string is
+      already interned */
+   uKeyLength = strlen(pcKey);
+   pcCopy = SymArena_alloc(&oSymIntern->sStringArena, uKeyLength + 1U);
+   if (pcCopy == NULL)
+      return 0U;
+   memcpy(pcCopy, pcKey, uKeyLength + 1U);
+
+   /* one probe finds the Symbol, or inserts a binding to NULL */
+   ppvSlot = SymTable_getOrInsertN(oSymIntern->oSymTable, pcCopy,
+                                   uKeyLength, NULL);
+   if (ppvSlot == NULL || *ppvSlot != NULL)
+   {
+      SymArena_release(&oSymIntern->sStringArena, pcCopy,
+                       uKeyLength + 1U);
+      if (ppvSlot == NULL)
+         return 0U;
+      return ((const struct Symbol*)*ppvSlot)->uId;
+   }
+
+   /* make room for the new ID and its Symbol */
+   psSymbol = NULL;
+   if (SymIntern_makeRoom(oSymIntern))
+      psSymbol = (struct Symbol*)
+         SymPool_alloc(&oSymIntern->sSymbolPool);
+
+   /* out of memory: undo the insertion, since no Symbol is bound */
+   if (psSymbol == NULL)
+   {
+      (void)SymTable_removeN(oSymIntern->oSymTable, pcCopy, uKeyLength);
+      SymArena_release(&oSymIntern->sStringArena, pcCopy,
+                       uKeyLength + 1U);
+      return 0U;
+   }
+
+   psSymbol->uId = oSymIntern->uCount + 1U;
+   *ppvSlot = psSymbol;
+   oSymIntern->uCount++;
+   oSymIntern->ppcStrings[oSymIntern->uCount] = pcCopy;
+   return oSymIntern->uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymIntern_lookup(SymIntern_T oSymIntern, const char *pcKey)
+{
+   const struct Symbol *psFound;
+
+   assert(oSymIntern != NULL);
+   assert(pcKey != NULL);
+
+   psFound = (const struct Symbol*)
+      SymTable_get(oSymIntern->oSymTable, pcKey);
+   if (psFound == NULL)
+      return 0U;
+   return psFound->uId;
+}
+
+/*--------------------------------------------------------------------*/
+
+const char *SymIntern_getString(SymIntern_T oSymIntern, size_t uId)
+{
+   assert(oSymIntern != NULL);
+   assert(uId > 0U && uId <= oSymIntern->uCount);
+
+   return oSymIntern->ppcStrings[uId];
+}
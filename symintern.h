@@ -0,0 +1,43 @@
+/*--------------------------------------------------------------------*/
+/* symintern.h                                                        */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMINTERN_INCLUDED
+#define SYMINTERN_INCLUDED
+#include "symtable.h"
+#include <stddef.h>
+
+/* A SymIntern_T is a pointer to a SymIntern object, which interns
+   strings: it gives each distinct string it is shown a dense integer
+   ID, 1 for the first, 2 for the next, and so on, and keeps one
+   canonical copy of it. Code that interns its identifiers once can
+   then compare them as integers, and look them up in a SymIdMap
+   instead of hashing and comparing strings on every access. IDs and
+   canonical copies stay valid until the SymIntern is freed. */
+typedef struct SymIntern *SymIntern_T;
+
+/* Return a new SymIntern with no strings interned, or NULL if out of
+   memory. */
+SymIntern_T SymIntern_new(void);
+
+/* Free oSymIntern and its canonical copies. */
+void SymIntern_free(SymIntern_T oSymIntern);
+
+/* Return the number of distinct strings interned in oSymIntern, which
+   is also the largest ID it has given. */
+size_t SymIntern_getCount(SymIntern_T oSymIntern);
+
+/* Return the ID of pcKey in oSymIntern, first interning it if it has
+   none, or return 0 if out of memory. */
+size_t SymIntern_intern(SymIntern_T oSymIntern, const char *pcKey);
+
+/* Return the ID of pcKey in oSymIntern, or 0 if it has not been
+   interned. */
+size_t SymIntern_lookup(SymIntern_T oSymIntern, const char *pcKey);
+
+/* Return oSymIntern's canonical copy of the string whose ID is uId,
+   which must be one it has given. */
+const char *SymIntern_getString(SymIntern_T oSymIntern, size_t uId);
+
+#endif
@@ -0,0 +1,196 @@
+/*--------------------------------------------------------------------*/
+/* symorder.c                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symorder.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* number of bindings a Collection first has room for. */
+enum { INITIAL_CAPACITY = 64 };
+
+/*--------------------------------------------------------------------*/
+/* A Visit is one binding to be passed to the function being applied. */
+
+struct Visit
+{
+   const char *pcKey;
+   void *pvValue;
+};
+
+/*--------------------------------------------------------------------*/
+/* A Collection gathers, through SymTable_map(), the bindings whose   */
+/* keys are in a range or begin with a prefix.                        */
+
+struct Collection
+{
+   /* keys at least pcLow and less than pcHigh are wanted. Either may
+      be NULL to leave that end of the range open. */
+   const char *pcLow;
+   const char *pcHigh;
+
+   /* if not NULL, only keys that begin with the uPrefixLength bytes
+      at pcPrefix are wanted. */
+   const char *pcPrefix;
+   size_t uPrefixLength;
+
+   /* the wanted bindings found so far, with room for uCapacity. */
+   struct Visit *psVisits;
+   size_t uCount;
+   size_t uCapacity;
+
+   /* nonzero if memory ran out while collecting. */
+   int iOutOfMemory;
+};
+
+/*--------------------------------------------------------------------*/
+/* Add the binding of pcKey to pvValue to the Collection at pvExtra   */
+/* if it is wanted. Called through SymTable_map().                    */
+
+static void SymOrder_collect(const char *pcKey, void *pvValue,
+                             void *pvExtra)
+{
+   struct Collection *psCollection;
+   struct Visit *psVisits;
+   size_t uNewCapacity;
+
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   psCollection = (struct Collection*)pvExtra;
+   if (psCollection->iOutOfMemory)
+      return;
+   if (psCollection->pcLow != NULL &&
+       strcmp(pcKey, psCollection->pcLow) < 0)
+      return;
+   if (psCollection->pcHigh != NULL &&
+       strcmp(pcKey, psCollection->pcHigh) >= 0)
+      return;
+   if (psCollection->pcPrefix != NULL &&
+       strncmp(pcKey, psCollection->pcPrefix,
+               psCollection->uPrefixLength) != 0)
+      return;
+
+   if (psCollection->uCount == psCollection->uCapacity)
+   {
+      uNewCapacity = psCollection->uCapacity == 0U
+                        ? (size_t)INITIAL_CAPACITY
+                        : 2U * psCollection->uCapacity;
+      psVisits = NULL;
+      if (uNewCapacity <= (size_t)-1 / sizeof(struct Visit))
+         psVisits = (struct Visit*)realloc(
+            psCollection->psVisits,
+            uNewCapacity * sizeof(struct Visit));
+      if (psVisits == NULL)
+      {
+         psCollection->iOutOfMemory = 1;
+         return;
+      }
+      psCollection->psVisits = psVisits;
+      psCollection->uCapacity = uNewCapacity;
+   }
+
+   psCollection->psVisits[psCollection->uCount].pcKey = pcKey;
+   psCollection->psVisits[psCollection->uCount].pvValue = pvValue;
+   psCollection->uCount++;
+}
+
+/*--------------------------------------------------------------------*/
+/* Compare the keys of the Visits at pvVisit1 and pvVisit2, for       */
+/* qsort().                                                           */
+
+static int SymOrder_compareVisits(const void *pvVisit1,
+                                  const void *pvVisit2)
+{
+   assert(pvVisit1 != NULL);
+   assert(pvVisit2 != NULL);
+
+   return strcmp(((const struct Visit*)pvVisit1)->pcKey,
+                 ((const struct Visit*)pvVisit2)->pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+/* Collect the bindings of oSymTable that *psCollection wants, sort   */
+/* them, and call pfApply(pcKey, pvValue, pvExtra) for each. Return 1 */
+/* if it works, or 0, without calling pfApply, if out of memory.      */
+
+static int SymOrder_apply(SymTable_T oSymTable,
+                          struct Collection *psCollection,
+                          void (*pfApply)(const char *pcKey,
+                                          void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra)
+{
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(psCollection != NULL);
+   assert(pfApply != NULL);
+
+   psCollection->psVisits = NULL;
+   psCollection->uCount = 0U;
+   psCollection->uCapacity = 0U;
+   psCollection->iOutOfMemory = 0;
+   SymTable_map(oSymTable, SymOrder_collect, psCollection);
+   if (psCollection->iOutOfMemory)
+   {
+      free(psCollection->psVisits);
+      return 0;
+   }
+
+   if (psCollection->uCount > 1U)
+      qsort(psCollection->psVisits, psCollection->uCount,
+            sizeof(struct Visit), SymOrder_compareVisits);
+   for (u = 0; u < psCollection->uCount; u++)
+      (*pfApply)(psCollection->psVisits[u].pcKey,
+                 psCollection->psVisits[u].pvValue, (void*)pvExtra);
+
+   free(psCollection->psVisits);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymOrder_mapRange(SymTable_T oSymTable,
+                      const char *pcLow, const char *pcHigh,
+                      void (*pfApply)(const char *pcKey,
+                                      void *pvValue,
+                                      void *pvExtra),
+                      const void *pvExtra)
+{
+   struct Collection sCollection;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   sCollection.pcLow = pcLow;
+   sCollection.pcHigh = pcHigh;
+   sCollection.pcPrefix = NULL;
+   sCollection.uPrefixLength = 0U;
+   return SymOrder_apply(oSymTable, &sCollection, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymOrder_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+                       void (*pfApply)(const char *pcKey,
+                                       void *pvValue,
+                                       void *pvExtra),
+                       const void *pvExtra)
+{
+   struct Collection sCollection;
+
+   assert(oSymTable != NULL);
+   assert(pcPrefix != NULL);
+   assert(pfApply != NULL);
+
+   sCollection.pcLow = NULL;
+   sCollection.pcHigh = NULL;
+   sCollection.pcPrefix = pcPrefix;
+   sCollection.uPrefixLength = strlen(pcPrefix);
+   return SymOrder_apply(oSymTable, &sCollection, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
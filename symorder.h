@@ -0,0 +1,31 @@
+/*--------------------------------------------------------------------*/
+/* symorder.h                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMORDER_INCLUDED
+#define SYMORDER_INCLUDED
+#include "symtable.h"
+
+/* Ordered traversals for the SymTable implementations that keep no
+   order of their own. Each one collects the bindings it needs with
+   SymTable_map(), sorts them, and then applies the function to them,
+   so it costs O(n + k log k) time and O(k) memory for a table of n
+   bindings of which k are visited. */
+
+/* Do what SymTable_mapRange() does. */
+int SymOrder_mapRange(SymTable_T oSymTable,
+                      const char *pcLow, const char *pcHigh,
+                      void (*pfApply)(const char *pcKey,
+                                      void *pvValue,
+                                      void *pvExtra),
+                      const void *pvExtra);
+
+/* Do what SymTable_mapPrefix() does. */
+int SymOrder_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+                       void (*pfApply)(const char *pcKey,
+                                       void *pvValue,
+                                       void *pvExtra),
+                       const void *pvExtra);
+
+#endif
@@ -0,0 +1,576 @@
+/*--------------------------------------------------------------------*/
+/* symperfect.c                                                       */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symperfect.h"
+#include "symhash.h"
+#include <assert.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the average number of keys per bucket. Each bucket costs one seed,
+   and larger buckets are harder to place. */
+enum { KEYS_PER_BUCKET = 4 };
+
+/* the number of seeds tried for a bucket before giving up on the
+   hash seed, and the number of hash seeds tried before giving up. */
+enum { MAX_SEED_TRIES = 65536, MAX_HASH_SEEDS = 16 };
+
+/*--------------------------------------------------------------------*/
+/* Each binding is stored in a Slot.                                  */
+
+struct Slot
+{
+   /* The key string, in the SymPerfect's key block, and its length
+      not counting its NUL. */
+   const char *pcKey;
+   size_t uKeyLength;
+
+   /* The value associated with the key. */
+   const void *pvValue;
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymPerfect is a dense array of Slots together with the per-      */
+/* bucket seeds that send each key to its own slot.                   */
+
+struct SymPerfect
+{
+   /* number of bindings, which is also the number of slots. */
+   size_t uLength;
+
+   /* array of uLength Slots. */
+   struct Slot *psSlots;
+
+   /* number of buckets, and their seeds. A key belongs in bucket
+      uHash % uBucketCount, and in slot
+      SymPerfect_slot(uHash, puSeeds[that bucket], uLength). */
+   size_t uBucketCount;
+   size_t *puSeeds;
+
+   /* the seed with which SymHash_word() hashes keys. */
+   size_t uHashSeed;
+
+   /* all the key strings, one after another. */
+   char *pcKeys;
+};
+
+/*--------------------------------------------------------------------*/
+/* The state of SymPerfect_compile() while it gathers and places the  */
+/* bindings of a SymTable.                                            */
+
+struct Pending
+{
+   /* the key, still owned by the SymTable, and its length. */
+   const char *pcKey;
+   size_t uKeyLength;
+
+   /* its hash code under the hash seed being tried. */
+   size_t uHash;
+
+   /* its value. */
+   const void *pvValue;
+};
+
+struct Compiler
+{
+   /* the bindings gathered so far, with room for uCapacity. */
+   struct Pending *psPending;
+   size_t uCount;
+   size_t uCapacity;
+
+   /* the total size of the gathered keys, NULs included. */
+   size_t uKeyBytes;
+};
+
+/*--------------------------------------------------------------------*/
+
+size_t SymPerfect_slot(size_t uHash, size_t uSeed, size_t uSlotCount)
+{
+   size_t uMix;
+
+   assert(uSlotCount > 0U);
+
+   if ((uSeed & SYMPERFECT_DIRECT) != 0U)
+      return uSeed & ~SYMPERFECT_DIRECT;
+
+   /* a cheap integer finalizer suffices, since uHash is already a
+      good hash code */
+   uMix = uHash ^ (uSeed * (size_t)0x9E3779B9UL);
+   uMix ^= uMix >> 15;
+   uMix *= (size_t)0x2C1B3C6DUL;
+   uMix ^= uMix >> 12;
+   uMix *= (size_t)0x297A2D39UL;
+   uMix ^= uMix >> 15;
+   return uMix % uSlotCount;
+}
+
+/*--------------------------------------------------------------------*/
+/* Add the binding of pcKey to pvValue to the Compiler at pvExtra.    */
+/* Called through SymTable_map().                                     */
+
+static void SymPerfect_gather(const char *pcKey, void *pvValue,
+                              void *pvExtra)
+{
+   struct Compiler *psCompiler;
+   struct Pending *psPending;
+
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   psCompiler = (struct Compiler*)pvExtra;
+   assert(psCompiler->uCount < psCompiler->uCapacity);
+
+   psPending = &psCompiler->psPending[psCompiler->uCount];
+   psPending->pcKey = pcKey;
+   psPending->uKeyLength = strlen(pcKey);
+   psPending->pvValue = pvValue;
+   psCompiler->uKeyBytes += psPending->uKeyLength + 1U;
+   psCompiler->uCount++;
+}
+
+/*--------------------------------------------------------------------*/
+/* Try to place the uCount bindings of psPending, whose hash codes    */
+/* are set, in as many slots using uBucketCount buckets. On success,  */
+/* store each binding's slot in auSlotOf and each bucket's seed in    */
+/* puSeeds and return 1. Otherwise return 0. The other arrays are     */
+/* scratch space: auOrder and aiTaken have uCount elements,           */
+/* auBucketStarts and auBucketOrder uBucketCount + 1.                 */
+
+static int SymPerfect_place(const struct Pending *psPending,
+                            size_t uCount, size_t uBucketCount,
+                            size_t *puSeeds, size_t auSlotOf[],
+                            size_t auOrder[], char aiTaken[],
+                            size_t auBucketStarts[],
+                            size_t auBucketOrder[])
+{
+   size_t uBucket;
+   size_t uSize;
+   size_t uMaxSize;
+   size_t uFirst;
+   size_t uSeed;
+   size_t uSlot;
+   size_t uFree;
+   size_t u;
+   size_t v;
+   size_t i;
+   int iPlaced;
+
+   assert(psPending != NULL || uCount == 0U);
+   assert(uBucketCount > 0U);
+
+   /* group the bindings by bucket with a counting sort */
+   for (uBucket = 0; uBucket <= uBucketCount; uBucket++)
+      auBucketStarts[uBucket] = 0U;
+   for (u = 0; u < uCount; u++)
+      auBucketStarts[psPending[u].uHash % uBucketCount + 1U]++;
+   uMaxSize = 0U;
+   for (uBucket = 0; uBucket < uBucketCount; uBucket++)
+   {
+      if (auBucketStarts[uBucket + 1U] > uMaxSize)
+         uMaxSize = auBucketStarts[uBucket + 1U];
+      auBucketStarts[uBucket + 1U] += auBucketStarts[uBucket];
+   }
+   for (u = 0; u < uCount; u++)
+   {
+      uBucket = psPending[u].uHash % uBucketCount;
+      auOrder[auBucketStarts[uBucket]++] = u;
+   }
+   for (uBucket = uBucketCount; uBucket > 0U; uBucket--)
+      auBucketStarts[uBucket] = auBucketStarts[uBucket - 1U];
+   auBucketStarts[0] = 0U;
+
+   /* list the buckets from largest to smallest, since the large ones
+      are the hardest to place and should go while slots are plenty */
+   i = 0U;
+   for (uSize = uMaxSize; uSize > 0U; uSize--)
+      for (uBucket = 0; uBucket < uBucketCount; uBucket++)
+         if (auBucketStarts[uBucket + 1U] - auBucketStarts[uBucket] ==
+             uSize)
+            auBucketOrder[i++] = uBucket;
+
+   for (u = 0; u < uBucketCount; u++)
+      puSeeds[u] = 0U;
+   for (u = 0; u < uCount; u++)
+      aiTaken[u] = 0;
+
+   /* find a seed for each bucket that sends its keys to free,
+      distinct slots. A bucket of one key instead takes the next free
+      slot outright */
+   uFree = 0U;
+   for (v = 0; v < i; v++)
+   {
+      uBucket = auBucketOrder[v];
+      uFirst = auBucketStarts[uBucket];
+      uSize = auBucketStarts[uBucket + 1U] - uFirst;
+
+      if (uSize == 1U)
+      {
+         while (aiTaken[uFree])
+            uFree++;
+         puSeeds[uBucket] = SYMPERFECT_DIRECT | uFree;
+         auSlotOf[auOrder[uFirst]] = uFree;
+         aiTaken[uFree] = 1;
+         continue;
+      }
+
+      iPlaced = 0;
+      for (uSeed = 0; uSeed < (size_t)MAX_SEED_TRIES && !iPlaced;
+           uSeed++)
+      {
+         iPlaced = 1;
+         for (u = 0; u < uSize && iPlaced; u++)
+         {
+            uSlot = SymPerfect_slot(
+               psPending[auOrder[uFirst + u]].uHash, uSeed, uCount);
+            if (aiTaken[uSlot])
+               iPlaced = 0;
+            else
+            {
+               /* take it for now, so the bucket's other keys see it */
+               aiTaken[uSlot] = 1;
+               auSlotOf[auOrder[uFirst + u]] = uSlot;
+            }
+         }
+         if (!iPlaced)
+         {
+            /* free the slots taken by the keys placed so far */
+            for (u--; u > 0U; u--)
+               aiTaken[auSlotOf[auOrder[uFirst + u - 1U]]] = 0;
+         }
+         else
+            puSeeds[uBucket] = uSeed;
+      }
+      if (!iPlaced)
+         return 0;
+   }
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymPerfect_T SymPerfect_compile(SymTable_T oSymTable)
+{
+   SymPerfect_T oSymPerfect;
+   struct Compiler sCompiler;
+   size_t *puScratch;
+   size_t *auSlotOf;
+   size_t *auOrder;
+   size_t *auBucketStarts;
+   size_t *auBucketOrder;
+   char *aiTaken;
+   char *pcNextKey;
+   struct Slot *psSlot;
+   size_t uBucketCount;
+   size_t uAttempt;
+   size_t u;
+   int iPlaced;
+
+   assert(oSymTable != NULL);
+
+   /* gather the bindings */
+   sCompiler.uCapacity = SymTable_getLength(oSymTable);
+   sCompiler.uCount = 0U;
+   sCompiler.uKeyBytes = 0U;
+   uBucketCount = sCompiler.uCapacity / KEYS_PER_BUCKET + 1U;
+   if (sCompiler.uCapacity > (size_t)-1 / 8U / sizeof(size_t))
+      return NULL;
+
+   oSymPerfect = (SymPerfect_T)malloc(sizeof(struct SymPerfect));
+   if (oSymPerfect == NULL)
+      return NULL;
+   sCompiler.psPending = (struct Pending*)malloc(
+      (sCompiler.uCapacity + 1U) * sizeof(struct Pending));
+   oSymPerfect->psSlots = (struct Slot*)malloc(
+      (sCompiler.uCapacity + 1U) * sizeof(struct Slot));
+   oSymPerfect->puSeeds = (size_t*)malloc(uBucketCount *
+                                          sizeof(size_t));
+   puScratch = (size_t*)malloc(
+      (2U * sCompiler.uCapacity + 2U * uBucketCount + 2U) *
+      sizeof(size_t));
+   aiTaken = (char*)malloc(sCompiler.uCapacity + 1U);
+   oSymPerfect->pcKeys = NULL;
+   if (sCompiler.psPending == NULL || oSymPerfect->psSlots == NULL ||
+       oSymPerfect->puSeeds == NULL || puScratch == NULL ||
+       aiTaken == NULL)
+   {
+      free(sCompiler.psPending);
+      free(puScratch);
+      free(aiTaken);
+      SymPerfect_free(oSymPerfect);
+      return NULL;
+   }
+   auSlotOf = puScratch;
+   auOrder = auSlotOf + sCompiler.uCapacity;
+   auBucketStarts = auOrder + sCompiler.uCapacity;
+   auBucketOrder = auBucketStarts + uBucketCount + 1U;
+
+   SymTable_map(oSymTable, SymPerfect_gather, &sCompiler);
+   oSymPerfect->uLength = sCompiler.uCount;
+   oSymPerfect->uBucketCount = uBucketCount;
+
+   /* a hash seed on which some bucket cannot be placed is replaced
+      by the next one */
+   iPlaced = 0;
+   for (uAttempt = 0; uAttempt < (size_t)MAX_HASH_SEEDS && !iPlaced;
+        uAttempt++)
+   {
+      oSymPerfect->uHashSeed = uAttempt;
+      for (u = 0; u < sCompiler.uCount; u++)
+         sCompiler.psPending[u].uHash =
+            SymHash_word(sCompiler.psPending[u].pcKey,
+                         sCompiler.psPending[u].uKeyLength,
+                         oSymPerfect->uHashSeed);
+      iPlaced = SymPerfect_place(sCompiler.psPending, sCompiler.uCount,
+                                 uBucketCount, oSymPerfect->puSeeds,
+                                 auSlotOf, auOrder, aiTaken,
+                                 auBucketStarts, auBucketOrder);
+   }
+
+   if (iPlaced)
+      oSymPerfect->pcKeys = (char*)malloc(sCompiler.uKeyBytes + 1U);
+   if (oSymPerfect->pcKeys == NULL)
+   {
+      free(sCompiler.psPending);
+      free(puScratch);
+      free(aiTaken);
+      SymPerfect_free(oSymPerfect);
+      return NULL;
+   }
+
+   /* fill each binding's slot, copying the keys into one block */
+   pcNextKey = oSymPerfect->pcKeys;
+   for (u = 0; u < sCompiler.uCount; u++)
+   {
+      psSlot = &oSymPerfect->psSlots[auSlotOf[u]];
+      memcpy(pcNextKey, sCompiler.psPending[u].pcKey,
+             sCompiler.psPending[u].uKeyLength + 1U);
+      psSlot->pcKey = pcNextKey;
+      psSlot->uKeyLength = sCompiler.psPending[u].uKeyLength;
+      psSlot->pvValue = sCompiler.psPending[u].pvValue;
+      pcNextKey += psSlot->uKeyLength + 1U;
+   }
+
+   free(sCompiler.psPending);
+   free(puScratch);
+   free(aiTaken);
+   return oSymPerfect;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymPerfect_free(SymPerfect_T oSymPerfect)
+{
+   assert(oSymPerfect != NULL);
+
+   free(oSymPerfect->psSlots);
+   free(oSymPerfect->puSeeds);
+   free(oSymPerfect->pcKeys);
+   free(oSymPerfect);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymPerfect_getLength(SymPerfect_T oSymPerfect)
+{
+   assert(oSymPerfect != NULL);
+
+   return oSymPerfect->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the Slot of pcKey in oSymPerfect, or NULL if pcKey is not   */
+/* present.                                                           */
+
+static const struct Slot *SymPerfect_find(SymPerfect_T oSymPerfect,
+                                          const char *pcKey)
+{
+   const struct Slot *psSlot;
+   size_t uKeyLength;
+   size_t uHash;
+
+   assert(oSymPerfect != NULL);
+   assert(pcKey != NULL);
+
+   if (oSymPerfect->uLength == 0U)
+      return NULL;
+
+   uKeyLength = strlen(pcKey);
+   uHash = SymHash_word(pcKey, uKeyLength, oSymPerfect->uHashSeed);
+   psSlot = &oSymPerfect->psSlots[SymPerfect_slot(
+      uHash, oSymPerfect->puSeeds[uHash % oSymPerfect->uBucketCount],
+      oSymPerfect->uLength)];
+
+   if (psSlot->uKeyLength != uKeyLength ||
+       memcmp(psSlot->pcKey, pcKey, uKeyLength) != 0)
+      return NULL;
+   return psSlot;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymPerfect_contains(SymPerfect_T oSymPerfect, const char *pcKey)
+{
+   return SymPerfect_find(oSymPerfect, pcKey) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymPerfect_get(SymPerfect_T oSymPerfect, const char *pcKey)
+{
+   const struct Slot *psSlot;
+
+   psSlot = SymPerfect_find(oSymPerfect, pcKey);
+   if (psSlot == NULL)
+      return NULL;
+   return (void*)psSlot->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymPerfect_map(SymPerfect_T oSymPerfect,
+                    void (*pfApply)(const char *pcKey,
+                                    void *pvValue,
+                                    void *pvExtra),
+                    const void *pvExtra)
+{
+   size_t u;
+
+   assert(oSymPerfect != NULL);
+   assert(pfApply != NULL);
+
+   for (u = 0; u < oSymPerfect->uLength; u++)
+      (*pfApply)(oSymPerfect->psSlots[u].pcKey,
+                 (void*)oSymPerfect->psSlots[u].pvValue,
+                 (void*)pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+/* Write the uKeyLength bytes at pcKey to psFile as a C string        */
+/* literal.                                                           */
+
+static void SymPerfect_writeString(FILE *psFile, const char *pcKey,
+                                   size_t uKeyLength)
+{
+   size_t u;
+   int iChar;
+
+   assert(psFile != NULL);
+   assert(pcKey != NULL);
+
+   putc('"', psFile);
+   for (u = 0; u < uKeyLength; u++)
+   {
+      iChar = (unsigned char)pcKey[u];
+      /* '?' is escaped so no trigraph can form */
+      if (iChar == '"' || iChar == '\\' || iChar == '?')
+         fprintf(psFile, "\\%c", iChar);
+      else if (isprint(iChar))
+         putc(iChar, psFile);
+      else
+         fprintf(psFile, "\\%03o", (unsigned int)iChar);
+   }
+   putc('"', psFile);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymPerfect_writeSource(SymPerfect_T oSymPerfect, FILE *psFile,
+                           const char *pcName,
+                           void (*pfWriteValue)(FILE *psFile,
+                                                const char *pcKey,
+                                                void *pvValue,
+                                                void *pvExtra),
+                           const void *pvExtra)
+{
+   const struct Slot *psSlot;
+   size_t uSeed;
+   size_t u;
+
+   assert(oSymPerfect != NULL);
+   assert(psFile != NULL);
+   assert(pcName != NULL);
+   assert(pfWriteValue != NULL);
+
+   fprintf(psFile,
+           "/* %s: a perfect hash table of %lu keys, written by\n"
+           "   SymPerfect_writeSource(). */\n\n"
+           "#include \"symperfect.h\"\n"
+           "#include \"symhash.h\"\n"
+           "#include <string.h>\n\n",
+           pcName, (unsigned long)oSymPerfect->uLength);
+
+   /* C has no empty arrays, so an empty table is just a function */
+   if (oSymPerfect->uLength == 0U)
+   {
+      fprintf(psFile,
+              "void *%s_get(const char *pcKey)\n"
+              "{\n"
+              "   (void)pcKey;\n"
+              "   return NULL;\n"
+              "}\n",
+              pcName);
+      return !ferror(psFile);
+   }
+
+   fprintf(psFile, "static const size_t au%sSeeds[%lu] =\n{\n",
+           pcName, (unsigned long)oSymPerfect->uBucketCount);
+   for (u = 0; u < oSymPerfect->uBucketCount; u++)
+   {
+      uSeed = oSymPerfect->puSeeds[u];
+      if ((uSeed & SYMPERFECT_DIRECT) != 0U)
+         fprintf(psFile, "   SYMPERFECT_DIRECT | %luU,\n",
+                 (unsigned long)(uSeed & ~SYMPERFECT_DIRECT));
+      else
+         fprintf(psFile, "   %luU,\n", (unsigned long)uSeed);
+   }
+   fprintf(psFile, "};\n\n");
+
+   fprintf(psFile,
+           "static const struct\n"
+           "{\n"
+           "   const char *pcKey;\n"
+           "   size_t uKeyLength;\n"
+           "   const void *pvValue;\n"
+           "} as%sSlots[%lu] =\n{\n",
+           pcName, (unsigned long)oSymPerfect->uLength);
+   for (u = 0; u < oSymPerfect->uLength; u++)
+   {
+      psSlot = &oSymPerfect->psSlots[u];
+      fprintf(psFile, "   {");
+      SymPerfect_writeString(psFile, psSlot->pcKey, psSlot->uKeyLength);
+      fprintf(psFile, ", %luU, ", (unsigned long)psSlot->uKeyLength);
+      (*pfWriteValue)(psFile, psSlot->pcKey, (void*)psSlot->pvValue,
+                      (void*)pvExtra);
+      fprintf(psFile, "},\n");
+   }
+   fprintf(psFile, "};\n\n");
+
+   fprintf(psFile,
+           "void *%s_get(const char *pcKey)\n"
+           "{\n"
+           "   size_t uKeyLength;\n"
+           "   size_t uHash;\n"
+           "   size_t uSlot;\n\n"
+           "   uKeyLength = strlen(pcKey);\n"
+           "   uHash = SymHash_word(pcKey, uKeyLength, %luU);\n"
+           "   uSlot = SymPerfect_slot(uHash,\n"
+           "      au%sSeeds[uHash %% %luU], %luU);\n"
+           "   if (as%sSlots[uSlot].uKeyLength != uKeyLength ||\n"
+           "       memcmp(as%sSlots[uSlot].pcKey, pcKey, uKeyLength) "
+           "!= 0)\n"
+           "      return NULL;\n"
+           "   return (void*)as%sSlots[uSlot].pvValue;\n"
+           "}\n",
+           pcName, (unsigned long)oSymPerfect->uHashSeed, pcName,
+           (unsigned long)oSymPerfect->uBucketCount,
+           (unsigned long)oSymPerfect->uLength, pcName, pcName,
+           pcName);
+
+   return !ferror(psFile);
+}
+
+/*--------------------------------------------------------------------*/
@@ -0,0 +1,72 @@
+/*--------------------------------------------------------------------*/
+/* symperfect.h                                                       */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMPERFECT_INCLUDED
+#define SYMPERFECT_INCLUDED
+#include "symtable.h"
+#include <stddef.h>
+#include <stdio.h>
+
+/* A SymPerfect_T is a pointer to a SymPerfect object, an immutable
+   table built from the keys of a SymTable with a minimal perfect
+   hash: the n keys fill n slots of one array with no collisions, so
+   a lookup hashes the key once, indexes a per-bucket seed, and
+   compares the key of the one slot that seed selects. */
+typedef struct SymPerfect *SymPerfect_T;
+
+/* A seed with this bit set names a slot outright instead of being
+   mixed into the hash code. */
+#define SYMPERFECT_DIRECT (~((size_t)-1 >> 1))
+
+/* Return a new SymPerfect holding the bindings of oSymTable, or NULL
+   if out of memory or no perfect hash was found. The keys are
+   copied; the values are not. oSymTable is not changed. */
+SymPerfect_T SymPerfect_compile(SymTable_T oSymTable);
+
+/* Free oSymPerfect. */
+void SymPerfect_free(SymPerfect_T oSymPerfect);
+
+/* Return the number of bindings in oSymPerfect. */
+size_t SymPerfect_getLength(SymPerfect_T oSymPerfect);
+
+/* Return 1 (TRUE) if oSymPerfect contains a binding whose key is
+   pcKey, and 0 (FALSE) otherwise. */
+int SymPerfect_contains(SymPerfect_T oSymPerfect, const char *pcKey);
+
+/* Return the value of the binding within oSymPerfect whose key is
+   pcKey, or NULL if no such binding exists. */
+void *SymPerfect_get(SymPerfect_T oSymPerfect, const char *pcKey);
+
+/* For each binding in oSymPerfect, in slot order, call
+   pfApply(pcKey, pvValue, pvExtra). */
+void SymPerfect_map(SymPerfect_T oSymPerfect,
+                    void (*pfApply)(const char *pcKey,
+                                    void *pvValue,
+                                    void *pvExtra),
+                    const void *pvExtra);
+
+/* Write to psFile C source that defines oSymPerfect as constant data
+   and a function void *<pcName>_get(const char *pcKey) that looks
+   keys up in it like SymPerfect_get(). pcName must be a C identifier.
+   Each value is written as whatever C expression
+   pfWriteValue(psFile, pcKey, pvValue, pvExtra) writes; it must be an
+   address constant, such as NULL or the address of a static object
+   declared before the source is compiled. The source needs
+   symperfect.h and symhash.h and the code that implements them.
+   Return 1 if successful, or 0 if writing fails. */
+int SymPerfect_writeSource(SymPerfect_T oSymPerfect, FILE *psFile,
+                           const char *pcName,
+                           void (*pfWriteValue)(FILE *psFile,
+                                                const char *pcKey,
+                                                void *pvValue,
+                                                void *pvExtra),
+                           const void *pvExtra);
+
+/* Return the slot of a key whose hash code is uHash, given the seed
+   uSeed of its bucket, in a SymPerfect of uSlotCount slots. Used by
+   the source that SymPerfect_writeSource() writes. */
+size_t SymPerfect_slot(size_t uHash, size_t uSeed, size_t uSlotCount);
+
+#endif
@@ -0,0 +1,759 @@
+/*--------------------------------------------------------------------*/
+/* symrcu.c                                                           */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+/* mutexes are a POSIX extension, so ask for them */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symrcu.h"
+#include "symhash.h"
+#include "symalloc.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Words that lock-free readers share with the writer are accessed
+   with the atomic built-ins of GCC and Clang, since C90 has none. */
+#ifndef __GNUC__
+#error "symrcu.c needs the __atomic built-ins of GCC or Clang"
+#endif
+
+#define LOAD_ACQUIRE(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define LOAD_SEQ_CST(p) __atomic_load_n(p, __ATOMIC_SEQ_CST)
+#define STORE_SEQ_CST(p, v) __atomic_store_n(p, v, __ATOMIC_SEQ_CST)
+#define FULL_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* number of buckets in a new SymRcu. Each expansion doubles it. */
+enum { INITIAL_BUCKET_COUNT = 512 };
+
+/* the maximum load factor used by SymRcu_new() */
+static const double DEFAULT_MAX_LOAD_FACTOR = 1.0;
+
+/* size of a cache line. Each reader's epoch is followed by this much
+   padding, so readers announcing themselves do not contend. */
+enum { CACHE_LINE_SIZE = 64 };
+
+/*--------------------------------------------------------------------*/
+/* Each binding is stored in a Binding. Bindings in the same bucket   */
+/* are linked to form a chain. Readers may be following psNextBinding */
+/* at any time, so a Binding that is unlinked keeps its fields until  */
+/* it is reclaimed.                                                   */
+
+struct Binding
+{
+   /* The full hash code of the key. */
+   size_t uHash;
+
+   /* The length of the key string, not counting its NUL. */
+   size_t uKeyLength;
+
+   /* The key string, in the table's key arena. */
+   const char *pcKey;
+
+   /* Nonzero if reclaiming this Binding also reclaims its key. An
+      expansion copies every Binding, and the copy takes the key
+      over. */
+   int iOwnsKey;
+
+   /* The value associated with the key. Accessed atomically. */
+   const void *pvValue;
+
+   /* The address of the next Binding in this bucket's chain.
+      Accessed atomically. */
+   struct Binding *psNextBinding;
+
+   /* Once unlinked, the next Binding waiting to be reclaimed, and the
+      epoch in which this one was unlinked. */
+   struct Binding *psNextRetired;
+   size_t uRetireEpoch;
+};
+
+/*--------------------------------------------------------------------*/
+/* A BucketArray is one generation of the table's buckets. Expansion  */
+/* builds a new one beside the old one instead of rehashing in place. */
+
+struct BucketArray
+{
+   /* number of buckets. Always a power of two. */
+   size_t uBucketCount;
+
+   /* array of bucket heads, each accessed atomically. */
+   struct Binding **ppsBuckets;
+
+   /* once replaced, the next BucketArray waiting to be reclaimed,
+      and the epoch in which this one was replaced. */
+   struct BucketArray *psNextRetired;
+   size_t uRetireEpoch;
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymRcuReader tells the writer whether, and since when, a reading */
+/* thread may be holding pointers into its SymRcu.                    */
+
+struct SymRcuReader
+{
+   /* the global epoch when the current lookup began, or 0 if no
+      lookup is running. Accessed atomically. */
+   size_t uActiveEpoch;
+
+   /* the table read, and the next of its readers. */
+   SymRcu_T oSymRcu;
+   struct SymRcuReader *psNextReader;
+
+   char acPadding[CACHE_LINE_SIZE];
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymRcu is a hash table with separate chaining whose current      */
+/* BucketArray is published through one atomic pointer.               */
+
+struct SymRcu
+{
+   /* the current bucket array. Accessed atomically. */
+   struct BucketArray *psBuckets;
+
+   /* total number of bindings stored. Accessed atomically. */
+   size_t uLength;
+
+   /* the largest average chain length tolerated before expanding,
+      and the number of bindings that triggers expansion. */
+   double dMaxLoadFactor;
+   size_t uExpandLength;
+
+   /* the function that hashes keys, and the seed passed to it. */
+   SymHash_T pfHash;
+   size_t uHashSeed;
+
+   /* the global epoch, which starts at 1 and advances whenever the
+      writer tries to reclaim memory. Accessed atomically. */
+   size_t uEpoch;
+
+   /* held by the one thread changing the table. Guards every field
+      below. */
+   pthread_mutex_t sWriteLock;
+
+   /* every reader of this table. */
+   struct SymRcuReader *psReaders;
+
+   /* unlinked Bindings waiting to be reclaimed, oldest first. */
+   struct Binding *psRetiredFirst;
+   struct Binding *psRetiredLast;
+
+   /* replaced BucketArrays waiting to be reclaimed. */
+   struct BucketArray *psRetiredArrays;
+
+   /* where this table's Bindings and key strings are allocated. */
+   struct SymPool sBindingPool;
+   struct SymArena sKeyArena;
+};
+
+/*--------------------------------------------------------------------*/
+/* Return a new BucketArray of uBucketCount empty buckets, or NULL if */
+/* out of memory.                                                     */
+
+static struct BucketArray *SymRcu_allocateBuckets(size_t uBucketCount)
+{
+   struct BucketArray *psArray;
+   size_t u;
+
+   psArray = (struct BucketArray*)malloc(sizeof(struct BucketArray));
+   if (psArray == NULL)
+      return NULL;
+
+   psArray->ppsBuckets = (struct Binding**)malloc(
+      uBucketCount * sizeof(struct Binding*));
+   if (psArray->ppsBuckets == NULL)
+   {
+      free(psArray);
+      return NULL;
+   }
+
+   for (u = 0; u < uBucketCount; u++)
+      psArray->ppsBuckets[u] = NULL;
+   psArray->uBucketCount = uBucketCount;
+   psArray->psNextRetired = NULL;
+   psArray->uRetireEpoch = 0U;
+
+   return psArray;
+}
+
+/*--------------------------------------------------------------------*/
+/* Free *psArray, but not the Bindings in it.                         */
+
+static void SymRcu_freeBuckets(struct BucketArray *psArray)
+{
+   assert(psArray != NULL);
+
+   free(psArray->ppsBuckets);
+   free(psArray);
+}
+
+/*--------------------------------------------------------------------*/
+/* Set oSymRcu's expansion threshold for a bucket count of            */
+/* uBucketCount.                                                      */
+
+static void SymRcu_setExpandLength(SymRcu_T oSymRcu,
+                                   size_t uBucketCount)
+{
+   double dLimit;
+
+   assert(oSymRcu != NULL);
+
+   dLimit = (double)uBucketCount * oSymRcu->dMaxLoadFactor;
+   if (dLimit >= (double)(size_t)-1)
+      oSymRcu->uExpandLength = (size_t)-1;
+   else
+      oSymRcu->uExpandLength = (size_t)dLimit;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymRcu_T SymRcu_new(void)
+{
+   struct SymTable_Options sOptions;
+
+   SymTable_initOptions(&sOptions);
+   sOptions.dMaxLoadFactor = DEFAULT_MAX_LOAD_FACTOR;
+   return SymRcu_newWithOptions(&sOptions);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymRcu_T SymRcu_newWithOptions(const struct SymTable_Options *psOptions)
+{
+   SymRcu_T oSymRcu;
+
+   assert(psOptions != NULL);
+   assert(psOptions->dMaxLoadFactor > 0.0);
+
+   oSymRcu = (SymRcu_T)malloc(sizeof(struct SymRcu));
+   if (oSymRcu == NULL)
+      return NULL;
+
+   oSymRcu->psBuckets = SymRcu_allocateBuckets(INITIAL_BUCKET_COUNT);
+   if (oSymRcu->psBuckets == NULL)
+   {
+      free(oSymRcu);
+      return NULL;
+   }
+
+   if (pthread_mutex_init(&oSymRcu->sWriteLock, NULL) != 0)
+   {
+      SymRcu_freeBuckets(oSymRcu->psBuckets);
+      free(oSymRcu);
+      return NULL;
+   }
+
+   oSymRcu->uLength = 0U;
+   oSymRcu->dMaxLoadFactor = psOptions->dMaxLoadFactor;
+   SymRcu_setExpandLength(oSymRcu, INITIAL_BUCKET_COUNT);
+
+   oSymRcu->pfHash = psOptions->pfHash;
+   if (oSymRcu->pfHash == NULL)
+      oSymRcu->pfHash = SymHash_word;
+   oSymRcu->uHashSeed = psOptions->uHashSeed;
+
+   oSymRcu->uEpoch = 1U;
+   oSymRcu->psReaders = NULL;
+   oSymRcu->psRetiredFirst = NULL;
+   oSymRcu->psRetiredLast = NULL;
+   oSymRcu->psRetiredArrays = NULL;
+
+   SymPool_init(&oSymRcu->sBindingPool, sizeof(struct Binding));
+   SymArena_init(&oSymRcu->sKeyArena);
+
+   return oSymRcu;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymRcu_free(SymRcu_T oSymRcu)
+{
+   struct BucketArray *psArray;
+   struct BucketArray *psNext;
+
+   assert(oSymRcu != NULL);
+   assert(oSymRcu->psReaders == NULL);
+
+   /* every Binding and key, retired or not, lives in the pool and
+      the arena */
+   SymPool_destroy(&oSymRcu->sBindingPool);
+   SymArena_destroy(&oSymRcu->sKeyArena);
+
+   for (psArray = oSymRcu->psRetiredArrays; psArray != NULL;
+        psArray = psNext)
+   {
+      psNext = psArray->psNextRetired;
+      SymRcu_freeBuckets(psArray);
+   }
+   SymRcu_freeBuckets(oSymRcu->psBuckets);
+
+   pthread_mutex_destroy(&oSymRcu->sWriteLock);
+   free(oSymRcu);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymRcuReader_T SymRcu_newReader(SymRcu_T oSymRcu)
+{
+   SymRcuReader_T oReader;
+
+   assert(oSymRcu != NULL);
+
+   oReader = (SymRcuReader_T)malloc(sizeof(struct SymRcuReader));
+   if (oReader == NULL)
+      return NULL;
+
+   oReader->uActiveEpoch = 0U;
+   oReader->oSymRcu = oSymRcu;
+
+   pthread_mutex_lock(&oSymRcu->sWriteLock);
+   oReader->psNextReader = oSymRcu->psReaders;
+   oSymRcu->psReaders = oReader;
+   pthread_mutex_unlock(&oSymRcu->sWriteLock);
+
+   return oReader;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymRcu_freeReader(SymRcuReader_T oReader)
+{
+   SymRcu_T oSymRcu;
+   struct SymRcuReader **ppsLink;
+
+   assert(oReader != NULL);
+   assert(oReader->uActiveEpoch == 0U);
+
+   oSymRcu = oReader->oSymRcu;
+   pthread_mutex_lock(&oSymRcu->sWriteLock);
+   for (ppsLink = &oSymRcu->psReaders; *ppsLink != oReader;
+        ppsLink = &(*ppsLink)->psNextReader)
+      assert(*ppsLink != NULL);
+   *ppsLink = oReader->psNextReader;
+   pthread_mutex_unlock(&oSymRcu->sWriteLock);
+
+   free(oReader);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymRcu_getLength(SymRcu_T oSymRcu)
+{
+   assert(oSymRcu != NULL);
+
+   return LOAD_ACQUIRE(&oSymRcu->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the full hash code of pcKey, whose length is uKeyLength,    */
+/* under oSymRcu's hash function and seed.                            */
+
+static size_t SymRcu_hash(SymRcu_T oSymRcu, const char *pcKey,
+                          size_t uKeyLength)
+{
+   assert(oSymRcu != NULL);
+   assert(pcKey != NULL);
+
+   return (*oSymRcu->pfHash)(pcKey, uKeyLength, oSymRcu->uHashSeed);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return 1 if psBinding holds the key of uKeyLength bytes at pcKey,  */
+/* whose full hash code is uHash, or 0 otherwise. The fields compared */
+/* never change once a Binding is published.                          */
+
+static int SymRcu_matches(const struct Binding *psBinding,
+                          const char *pcKey, size_t uKeyLength,
+                          size_t uHash)
+{
+   assert(psBinding != NULL);
+   assert(pcKey != NULL);
+
+   return psBinding->uHash == uHash &&
+          psBinding->uKeyLength == uKeyLength &&
+          memcmp(psBinding->pcKey, pcKey, uKeyLength) == 0;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the address of the link in oSymRcu's current bucket array   */
+/* that points to the Binding of pcKey, whose length is uKeyLength    */
+/* and whose full hash code is uHash, or NULL if pcKey is not         */
+/* present. Only the writer calls it, so it needs no atomic loads.    */
+
+static struct Binding **SymRcu_findLink(SymRcu_T oSymRcu,
+                                        const char *pcKey,
+                                        size_t uKeyLength, size_t uHash)
+{
+   struct BucketArray *psArray;
+   struct Binding **ppsLink;
+
+   assert(oSymRcu != NULL);
+   assert(pcKey != NULL);
+
+   psArray = oSymRcu->psBuckets;
+   for (ppsLink =
+           &psArray->ppsBuckets[uHash & (psArray->uBucketCount - 1U)];
+        *ppsLink != NULL;
+        ppsLink = &(*ppsLink)->psNextBinding)
+   {
+      if (SymRcu_matches(*ppsLink, pcKey, uKeyLength, uHash))
+         return ppsLink;
+   }
+
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+/* Queue psBinding, which the writer of oSymRcu has just unlinked, to */
+/* be reclaimed once no reader can still hold it.                     */
+
+static void SymRcu_retireBinding(SymRcu_T oSymRcu,
+                                 struct Binding *psBinding)
+{
+   assert(oSymRcu != NULL);
+   assert(psBinding != NULL);
+
+   psBinding->uRetireEpoch = oSymRcu->uEpoch;
+   psBinding->psNextRetired = NULL;
+   if (oSymRcu->psRetiredLast == NULL)
+      oSymRcu->psRetiredFirst = psBinding;
+   else
+      oSymRcu->psRetiredLast->psNextRetired = psBinding;
+   oSymRcu->psRetiredLast = psBinding;
+}
+
+/*--------------------------------------------------------------------*/
+/* Start a new epoch of oSymRcu, then free whatever was retired in an */
+/* epoch before that of every running lookup. A lookup that begins in */
+/* the new epoch cannot reach anything retired so far.                */
+
+static void SymRcu_reclaim(SymRcu_T oSymRcu)
+{
+   struct SymRcuReader *psReader;
+   struct Binding *psBinding;
+   struct BucketArray **ppsLink;
+   struct BucketArray *psArray;
+   size_t uOldestEpoch;
+   size_t uEpoch;
+
+   assert(oSymRcu != NULL);
+
+   uOldestEpoch = oSymRcu->uEpoch + 1U;
+   STORE_SEQ_CST(&oSymRcu->uEpoch, uOldestEpoch);
+   FULL_FENCE();
+
+   for (psReader = oSymRcu->psReaders; psReader != NULL;
+        psReader = psReader->psNextReader)
+   {
+      uEpoch = LOAD_SEQ_CST(&psReader->uActiveEpoch);
+      if (uEpoch != 0U && uEpoch < uOldestEpoch)
+         uOldestEpoch = uEpoch;
+   }
+
+   while (oSymRcu->psRetiredFirst != NULL &&
+          oSymRcu->psRetiredFirst->uRetireEpoch < uOldestEpoch)
+   {
+      psBinding = oSymRcu->psRetiredFirst;
+      oSymRcu->psRetiredFirst = psBinding->psNextRetired;
+      if (psBinding->iOwnsKey)
+         SymArena_release(&oSymRcu->sKeyArena, (char*)psBinding->pcKey,
+                          psBinding->uKeyLength + 1U);
+      SymPool_release(&oSymRcu->sBindingPool, psBinding);
+   }
+   if (oSymRcu->psRetiredFirst == NULL)
+      oSymRcu->psRetiredLast = NULL;
+
+   ppsLink = &oSymRcu->psRetiredArrays;
+   while (*ppsLink != NULL)
+   {
+      psArray = *ppsLink;
+      if (psArray->uRetireEpoch < uOldestEpoch)
+      {
+         *ppsLink = psArray->psNextRetired;
+         SymRcu_freeBuckets(psArray);
+      }
+      else
+         ppsLink = &psArray->psNextRetired;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/* Expand oSymRcu to a new bucket array of twice the size, filled     */
+/* with copies of its Bindings, then publish the new array and retire */
+/* the old one and its Bindings. Readers still in the old array are   */
+/* undisturbed. If out of memory, skip expansion.                     */
+
+static void SymRcu_expand(SymRcu_T oSymRcu)
+{
+   struct BucketArray *psOld;
+   struct BucketArray *psNew;
+   struct Binding *psBinding;
+   struct Binding *psCopy;
+   struct Binding *psNext;
+   size_t uIndex;
+   size_t u;
+
+   assert(oSymRcu != NULL);
+
+   psOld = oSymRcu->psBuckets;
+   if (psOld->uBucketCount >
+       ((size_t)-1 / sizeof(struct Binding*)) / 2U)
+      return;
+
+   psNew = SymRcu_allocateBuckets(psOld->uBucketCount * 2U);
+   if (psNew == NULL)
+      return;
+
+   for (u = 0; u < psOld->uBucketCount; u++)
+   {
+      for (psBinding = psOld->ppsBuckets[u]; psBinding != NULL;
+           psBinding = psBinding->psNextBinding)
+      {
+         psCopy =
+            (struct Binding*)SymPool_alloc(&oSymRcu->sBindingPool);
+         if (psCopy == NULL)
+         {
+            /* give back the copies made so far */
+            for (uIndex = 0; uIndex < psNew->uBucketCount; uIndex++)
+               for (psCopy = psNew->ppsBuckets[uIndex]; psCopy != NULL;
+                    psCopy = psNext)
+               {
+                  psNext = psCopy->psNextBinding;
+                  SymPool_release(&oSymRcu->sBindingPool, psCopy);
+               }
+            SymRcu_freeBuckets(psNew);
+            return;
+         }
+
+         *psCopy = *psBinding;
+         uIndex = psCopy->uHash & (psNew->uBucketCount - 1U);
+         psCopy->psNextBinding = psNew->ppsBuckets[uIndex];
+         psNew->ppsBuckets[uIndex] = psCopy;
+      }
+   }
+
+   /* the copies now own the keys; the originals wait for the readers
+      that may still be walking them */
+   for (u = 0; u < psOld->uBucketCount; u++)
+      for (psBinding = psOld->ppsBuckets[u]; psBinding != NULL;
+           psBinding = psBinding->psNextBinding)
+      {
+         psBinding->iOwnsKey = 0;
+         SymRcu_retireBinding(oSymRcu, psBinding);
+      }
+
+   STORE_RELEASE(&oSymRcu->psBuckets, psNew);
+   SymRcu_setExpandLength(oSymRcu, psNew->uBucketCount);
+
+   psOld->uRetireEpoch = oSymRcu->uEpoch;
+   psOld->psNextRetired = oSymRcu->psRetiredArrays;
+   oSymRcu->psRetiredArrays = psOld;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymRcu_put(SymRcu_T oSymRcu,
+               const char *pcKey, const void *pvValue)
+{
+   struct Binding *psNewBinding;
+   struct Binding **ppsBucket;
+   char *pcKeyCopy;
+   size_t uKeyLength;
+   size_t uHash;
+
+   assert(oSymRcu != NULL);
+   assert(pcKey != NULL);
+
+   uKeyLength = strlen(pcKey);
+   uHash = SymRcu_hash(oSymRcu, pcKey, uKeyLength);
+
+   pthread_mutex_lock(&oSymRcu->sWriteLock);
+
+   if (SymRcu_findLink(oSymRcu, pcKey, uKeyLength, uHash) != NULL)
+   {
+      pthread_mutex_unlock(&oSymRcu->sWriteLock);
+      return 0;
+   }
+
+   psNewBinding =
+      (struct Binding*)SymPool_alloc(&oSymRcu->sBindingPool);
+   pcKeyCopy = SymArena_alloc(&oSymRcu->sKeyArena, uKeyLength + 1U);
+   if (psNewBinding == NULL || pcKeyCopy == NULL)
+   {
+      if (psNewBinding != NULL)
+         SymPool_release(&oSymRcu->sBindingPool, psNewBinding);
+      if (pcKeyCopy != NULL)
+         SymArena_release(&oSymRcu->sKeyArena, pcKeyCopy,
+                          uKeyLength + 1U);
+      pthread_mutex_unlock(&oSymRcu->sWriteLock);
+      return 0;
+   }
+   memcpy(pcKeyCopy, pcKey, uKeyLength + 1U);
+
+   /* fill the Binding in completely before publishing it */
+   psNewBinding->uHash = uHash;
+   psNewBinding->uKeyLength = uKeyLength;
+   psNewBinding->pcKey = pcKeyCopy;
+   psNewBinding->iOwnsKey = 1;
+   psNewBinding->pvValue = pvValue;
+   ppsBucket = &oSymRcu->psBuckets->ppsBuckets[
+      uHash & (oSymRcu->psBuckets->uBucketCount - 1U)];
+   psNewBinding->psNextBinding = *ppsBucket;
+   STORE_RELEASE(ppsBucket, psNewBinding);
+
+   STORE_RELEASE(&oSymRcu->uLength, oSymRcu->uLength + 1U);
+   if (oSymRcu->uLength > oSymRcu->uExpandLength)
+   {
+      SymRcu_expand(oSymRcu);
+      SymRcu_reclaim(oSymRcu);
+   }
+
+   pthread_mutex_unlock(&oSymRcu->sWriteLock);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymRcu_replace(SymRcu_T oSymRcu,
+                     const char *pcKey, const void *pvValue)
+{
+   struct Binding **ppsLink;
+   const void *pvOldValue;
+   size_t uKeyLength;
+   size_t uHash;
+
+   assert(oSymRcu != NULL);
+   assert(pcKey != NULL);
+
+   uKeyLength = strlen(pcKey);
+   uHash = SymRcu_hash(oSymRcu, pcKey, uKeyLength);
+
+   pthread_mutex_lock(&oSymRcu->sWriteLock);
+
+   ppsLink = SymRcu_findLink(oSymRcu, pcKey, uKeyLength, uHash);
+   if (ppsLink == NULL)
+   {
+      pthread_mutex_unlock(&oSymRcu->sWriteLock);
+      return NULL;
+   }
+
+   pvOldValue = (*ppsLink)->pvValue;
+   STORE_RELEASE(&(*ppsLink)->pvValue, pvValue);
+
+   pthread_mutex_unlock(&oSymRcu->sWriteLock);
+   return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymRcu_remove(SymRcu_T oSymRcu, const char *pcKey)
+{
+   struct Binding **ppsLink;
+   struct Binding *psBinding;
+   const void *pvValue;
+   size_t uKeyLength;
+   size_t uHash;
+
+   assert(oSymRcu != NULL);
+   assert(pcKey != NULL);
+
+   uKeyLength = strlen(pcKey);
+   uHash = SymRcu_hash(oSymRcu, pcKey, uKeyLength);
+
+   pthread_mutex_lock(&oSymRcu->sWriteLock);
+
+   ppsLink = SymRcu_findLink(oSymRcu, pcKey, uKeyLength, uHash);
+   if (ppsLink == NULL)
+   {
+      pthread_mutex_unlock(&oSymRcu->sWriteLock);
+      return NULL;
+   }
+
+   /* unlink the Binding but leave its own link alone, so a reader
+      standing on it can still walk on down the chain */
+   psBinding = *ppsLink;
+   pvValue = psBinding->pvValue;
+   STORE_RELEASE(ppsLink, psBinding->psNextBinding);
+   SymRcu_retireBinding(oSymRcu, psBinding);
+
+   assert(oSymRcu->uLength > 0U);
+   STORE_RELEASE(&oSymRcu->uLength, oSymRcu->uLength - 1U);
+   SymRcu_reclaim(oSymRcu);
+
+   pthread_mutex_unlock(&oSymRcu->sWriteLock);
+   return (void*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+/* Look pcKey up through oReader. If it is present, store its value   */
+/* in *ppvValue and return 1; otherwise return 0. Runs in a bounded   */
+/* number of steps whatever the writer is doing.                      */
+
+static int SymRcu_lookup(SymRcuReader_T oReader, const char *pcKey,
+                         void **ppvValue)
+{
+   SymRcu_T oSymRcu;
+   struct BucketArray *psArray;
+   struct Binding *psBinding;
+   size_t uKeyLength;
+   size_t uHash;
+   int iFound;
+
+   assert(oReader != NULL);
+   assert(pcKey != NULL);
+   assert(ppvValue != NULL);
+
+   oSymRcu = oReader->oSymRcu;
+   uKeyLength = strlen(pcKey);
+   uHash = SymRcu_hash(oSymRcu, pcKey, uKeyLength);
+
+   /* announce the epoch this lookup starts in before touching any
+      shared pointer, so the writer keeps everything reachable now */
+   STORE_SEQ_CST(&oReader->uActiveEpoch,
+                 LOAD_ACQUIRE(&oSymRcu->uEpoch));
+   FULL_FENCE();
+
+   iFound = 0;
+   psArray = LOAD_ACQUIRE(&oSymRcu->psBuckets);
+   for (psBinding = LOAD_ACQUIRE(
+           &psArray->ppsBuckets[uHash & (psArray->uBucketCount - 1U)]);
+        psBinding != NULL;
+        psBinding = LOAD_ACQUIRE(&psBinding->psNextBinding))
+   {
+      if (SymRcu_matches(psBinding, pcKey, uKeyLength, uHash))
+      {
+         *ppvValue = (void*)LOAD_ACQUIRE(&psBinding->pvValue);
+         iFound = 1;
+         break;
+      }
+   }
+
+   STORE_RELEASE(&oReader->uActiveEpoch, (size_t)0U);
+   return iFound;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymRcu_contains(SymRcuReader_T oReader, const char *pcKey)
+{
+   void *pvValue;
+
+   return SymRcu_lookup(oReader, pcKey, &pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymRcu_get(SymRcuReader_T oReader, const char *pcKey)
+{
+   void *pvValue;
+
+   if (!SymRcu_lookup(oReader, pcKey, &pvValue))
+      return NULL;
+   return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
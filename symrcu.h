@@ -0,0 +1,66 @@
+/*--------------------------------------------------------------------*/
+/* symrcu.h                                                           */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMRCU_INCLUDED
+#define SYMRCU_INCLUDED
+#include "symtable.h"
+#include <stddef.h>
+
+/* A SymRcu_T is a pointer to a SymRcu object, a hash table for
+   tables that are read by many threads and changed by few. Lookups
+   take no locks and never wait: they follow atomically published
+   pointers, and memory that a change unlinks is freed only once no
+   lookup that started before the change is still running (epoch-based
+   reclamation). Changes are serialized by a mutex. A lookup that runs
+   at the same time as a change sees the table either as it was before
+   the change or as it is after it. */
+typedef struct SymRcu *SymRcu_T;
+
+/* A SymRcuReader_T is a pointer to a SymRcuReader object, through
+   which one thread looks keys up in a SymRcu. Each reading thread
+   needs a reader of its own. */
+typedef struct SymRcuReader *SymRcuReader_T;
+
+/* Return a new, empty SymRcu, or NULL if out of memory. */
+SymRcu_T SymRcu_new(void);
+
+/* Return a new, empty SymRcu configured by *psOptions, or NULL if out
+   of memory. Only the load factor and the hash function and seed are
+   used. */
+SymRcu_T SymRcu_newWithOptions(
+   const struct SymTable_Options *psOptions);
+
+/* Free oSymRcu. Every reader of it must have been freed already. */
+void SymRcu_free(SymRcu_T oSymRcu);
+
+/* Return a new reader of oSymRcu for the calling thread, or NULL if
+   out of memory. */
+SymRcuReader_T SymRcu_newReader(SymRcu_T oSymRcu);
+
+/* Free oReader. */
+void SymRcu_freeReader(SymRcuReader_T oReader);
+
+/* Return the number of bindings in oSymRcu. */
+size_t SymRcu_getLength(SymRcu_T oSymRcu);
+
+/* The changes below behave like the SymTable functions of the same
+   names. Any thread may call them; they run one at a time. */
+
+int SymRcu_put(SymRcu_T oSymRcu,
+               const char *pcKey, const void *pvValue);
+
+void *SymRcu_replace(SymRcu_T oSymRcu,
+                     const char *pcKey, const void *pvValue);
+
+void *SymRcu_remove(SymRcu_T oSymRcu, const char *pcKey);
+
+/* The lookups below behave like the SymTable functions of the same
+   names, looking in the SymRcu of oReader. They are wait-free. */
+
+int SymRcu_contains(SymRcuReader_T oReader, const char *pcKey);
+
+void *SymRcu_get(SymRcuReader_T oReader, const char *pcKey);
+
+#endif
@@ -0,0 +1,323 @@
+/*--------------------------------------------------------------------*/
+/* symscope.c                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symscope.h"
+#include "symalloc.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* number of nested scopes a new SymScope has room to record. */
+enum { INITIAL_SCOPE_CAPACITY = 8 };
+
+/*--------------------------------------------------------------------*/
+/* A Declaration is one binding of a key in one scope. The table      */
+/* maps the key to its innermost Declaration, and each Declaration    */
+/* points to the one it shadows.                                      */
+
+struct Declaration
+{
+   /* the value bound to the key. */
+   const void *pvValue;
+
+   /* the depth of the scope the binding was made in. */
+   size_t uDepth;
+
+   /* the binding of the same key in an outer scope that this one
+      shadows, or NULL. */
+   struct Declaration *psShadowed;
+
+   /* the Declaration made before this one in any scope: the next
+      older entry of the undo log. */
+   struct Declaration *psOlder;
+
+   /* a copy of the key, in the SymScope's key arena, and its length
+      not counting the NUL. */
+   char *pcKey;
+   size_t uKeyLength;
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymScope is a SymTable of innermost Declarations together with   */
+/* the undo log of all of them.                                       */
+
+struct SymScope
+{
+   /* maps each bound key to its innermost Declaration. The table
+      borrows its keys: each binding's key is the copy made for the
+      outermost Declaration of that key, which is undone, removing
+      the binding, before its copy is released. */
+   SymTable_T oSymTable;
+
+   /* the newest Declaration, the top of the undo log. */
+   struct Declaration *psNewest;
+
+   /* ppsScopeStarts[d-1] is what psNewest was when the scope of
+      depth d was pushed, for each open scope but the outermost. */
+   struct Declaration **ppsScopeStarts;
+   size_t uScopeCapacity;
+
+   /* the depth of the innermost open scope. */
+   size_t uDepth;
+
+   /* where the Declarations and their key copies are allocated. */
+   struct SymPool sDeclarationPool;
+   struct SymArena sKeyArena;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymScope_T SymScope_new(void)
+{
+   struct SymTable_Options sOptions;
+
+   SymTable_initOptions(&sOptions);
+   return SymScope_newWithOptions(&sOptions);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymScope_T SymScope_newWithOptions(
+   const struct SymTable_Options *psOptions)
+{
+   SymScope_T oSymScope;
+   struct SymTable_Options sOptions;
+
+   assert(psOptions != NULL);
+
+   oSymScope = (SymScope_T)malloc(sizeof(struct SymScope));
+   if (oSymScope == NULL)
+      return NULL;
+
+   /* the Declarations hold copies of the keys, so the table need not
+      make its own */
+   sOptions = *psOptions;
+   sOptions.iBorrowKeys = 1;
+   oSymScope->oSymTable = SymTable_newWithOptions(&sOptions);
+   oSymScope->ppsScopeStarts = (struct Declaration**)malloc(
+      (size_t)INITIAL_SCOPE_CAPACITY * sizeof(struct Declaration*));
+   if (oSymScope->oSymTable == NULL ||
+       oSymScope->ppsScopeStarts == NULL)
+   {
+      if (oSymScope->oSymTable != NULL)
+         SymTable_free(oSymScope->oSymTable);
+      free(oSymScope->ppsScopeStarts);
+      free(oSymScope);
+      return NULL;
+   }
+
+   oSymScope->psNewest = NULL;
+   oSymScope->uScopeCapacity = INITIAL_SCOPE_CAPACITY;
+   oSymScope->uDepth = 0U;
+   SymPool_init(&oSymScope->sDeclarationPool,
+                sizeof(struct Declaration));
+   SymArena_init(&oSymScope->sKeyArena);
+   return oSymScope;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymScope_free(SymScope_T oSymScope)
+{
+   assert(oSymScope != NULL);
+
+   /* every Declaration and key copy goes at once, without undoing
+      the log */
+   SymPool_destroy(&oSymScope->sDeclarationPool);
+   SymArena_destroy(&oSymScope->sKeyArena);
+   SymTable_free(oSymScope->oSymTable);
+   free(oSymScope->ppsScopeStarts);
+   free(oSymScope);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymScope_getDepth(SymScope_T oSymScope)
+{
+   assert(oSymScope != NULL);
+   return oSymScope->uDepth;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymScope_push(SymScope_T oSymScope)
+{
+   struct Declaration **ppsNewStarts;
+   size_t uNewCapacity;
+
+   assert(oSymScope != NULL);
+
+   if (oSymScope->uDepth == oSymScope->uScopeCapacity)
+   {
+      if (oSymScope->uScopeCapacity >
+          (size_t)-1 / sizeof(struct Declaration*) / 2U)
+         return 0;
+      uNewCapacity = oSymScope->uScopeCapacity * 2U;
+      ppsNewStarts = (struct Declaration**)realloc(
+         oSymScope->ppsScopeStarts,
+         uNewCapacity * sizeof(struct Declaration*));
+      if (ppsNewStarts == NULL)
+         return 0;
+      oSymScope->ppsScopeStarts = ppsNewStarts;
+      oSymScope->uScopeCapacity = uNewCapacity;
+   }
+
+   oSymScope->ppsScopeStarts[oSymScope->uDepth] = oSymScope->psNewest;
+   oSymScope->uDepth++;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymScope_pop(SymScope_T oSymScope)
+{
+   struct Declaration *psStart;
+   struct Declaration *psDeclaration;
+
+   assert(oSymScope != NULL);
+   assert(oSymScope->uDepth > 0U);
+
+   /* undo the scope's Declarations, newest first, so that each key
+      is bound again to what it was bound to before the scope */
+   oSymScope->uDepth--;
+   psStart = oSymScope->ppsScopeStarts[oSymScope->uDepth];
+   while (oSymScope->psNewest != psStart)
+   {
+      psDeclaration = oSymScope->psNewest;
+      assert(psDeclaration != NULL);
+      assert(psDeclaration->uDepth == oSymScope->uDepth + 1U);
+
+      if (psDeclaration->psShadowed != NULL)
+         (void)SymTable_replaceN(oSymScope->oSymTable,
+                                 psDeclaration->pcKey,
+                                 psDeclaration->uKeyLength,
+                                 psDeclaration->psShadowed);
+      else
+         (void)SymTable_removeN(oSymScope->oSymTable,
+                                psDeclaration->pcKey,
+                                psDeclaration->uKeyLength);
+
+      oSymScope->psNewest = psDeclaration->psOlder;
+      SymArena_release(&oSymScope->sKeyArena, psDeclaration->pcKey,
+                       psDeclaration->uKeyLength + 1U);
+      SymPool_release(&oSymScope->sDeclarationPool, psDeclaration);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymScope_put(SymScope_T oSymScope,
+                 const char *pcKey, const void *pvValue)
+{
+   struct Declaration *psDeclaration;
+   struct Declaration *psShadowed;
+   void **ppvSlot;
+   size_t uKeyLength;
+
+   assert(oSymScope != NULL);
+   assert(pcKey != NULL);
+
+   /* allocate first, so that a key is never left bound to nothing */
+   uKeyLength = strlen(pcKey);
+   psDeclaration = (struct Declaration*)
+      SymPool_alloc(&oSymScope->sDeclarationPool);
+   if (psDeclaration == NULL)
+      return 0;
+   psDeclaration->pcKey = SymArena_alloc(&oSymScope->sKeyArena,
+                                         uKeyLength + 1U);
+   if (psDeclaration->pcKey == NULL)
+   {
+      SymPool_release(&oSymScope->sDeclarationPool, psDeclaration);
+      return 0;
+   }
+   memcpy(psDeclaration->pcKey, pcKey, uKeyLength + 1U);
+
+   /* one probe finds the binding to shadow, or makes room for a new
+      one, bound to NULL, that borrows the copy */
+   ppvSlot = SymTable_getOrInsertN(oSymScope->oSymTable,
+                                   psDeclaration->pcKey, uKeyLength,
+                                   NULL);
+   psShadowed = ppvSlot == NULL ? NULL : (struct Declaration*)*ppvSlot;
+   if (ppvSlot == NULL ||
+       (psShadowed != NULL && psShadowed->uDepth == oSymScope->uDepth))
+   {
+      SymArena_release(&oSymScope->sKeyArena, psDeclaration->pcKey,
+                       uKeyLength + 1U);
+      SymPool_release(&oSymScope->sDeclarationPool, psDeclaration);
+      return 0;
+   }
+
+   psDeclaration->uKeyLength = uKeyLength;
+   psDeclaration->pvValue = pvValue;
+   psDeclaration->uDepth = oSymScope->uDepth;
+   psDeclaration->psShadowed = psShadowed;
+   psDeclaration->psOlder = oSymScope->psNewest;
+   oSymScope->psNewest = psDeclaration;
+   *ppvSlot = psDeclaration;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymScope_replace(SymScope_T oSymScope,
+                       const char *pcKey, const void *pvValue)
+{
+   struct Declaration *psDeclaration;
+   const void *pvOldValue;
+
+   assert(oSymScope != NULL);
+   assert(pcKey != NULL);
+
+   psDeclaration = (struct Declaration*)
+      SymTable_get(oSymScope->oSymTable, pcKey);
+   if (psDeclaration == NULL)
+      return NULL;
+
+   pvOldValue = psDeclaration->pvValue;
+   psDeclaration->pvValue = pvValue;
+   return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymScope_contains(SymScope_T oSymScope, const char *pcKey)
+{
+   assert(oSymScope != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_contains(oSymScope->oSymTable, pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymScope_get(SymScope_T oSymScope, const char *pcKey)
+{
+   struct Declaration *psDeclaration;
+
+   assert(oSymScope != NULL);
+   assert(pcKey != NULL);
+
+   psDeclaration = (struct Declaration*)
+      SymTable_get(oSymScope->oSymTable, pcKey);
+   if (psDeclaration == NULL)
+      return NULL;
+   return (void*)psDeclaration->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymScope_getScope(SymScope_T oSymScope, const char *pcKey)
+{
+   struct Declaration *psDeclaration;
+
+   assert(oSymScope != NULL);
+   assert(pcKey != NULL);
+
+   psDeclaration = (struct Declaration*)
+      SymTable_get(oSymScope->oSymTable, pcKey);
+   if (psDeclaration == NULL)
+      return oSymScope->uDepth + 1U;
+   return psDeclaration->uDepth;
+}
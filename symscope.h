@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------*/
+/* symscope.h                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMSCOPE_INCLUDED
+#define SYMSCOPE_INCLUDED
+#include "symtable.h"
+#include <stddef.h>
+
+/* A SymScope_T is a pointer to a SymScope object, a symbol table of
+   nested scopes. One SymTable maps each key to its innermost
+   binding, which shadows those of the same key in outer scopes, so a
+   lookup is one probe however deep the nesting. Each binding is also
+   pushed on an undo log, and leaving a scope pops the log back to
+   where the scope began, restoring each shadowed binding with one
+   table operation. */
+typedef struct SymScope *SymScope_T;
+
+/* Return a new SymScope with only its outermost scope, at depth 0,
+   open and empty, or NULL if out of memory. */
+SymScope_T SymScope_new(void);
+
+/* Do what SymScope_new() does, but map keys with a SymTable
+   configured by *psOptions. psOptions->iBorrowKeys is ignored: the
+   SymScope always copies keys once, and its SymTable borrows the
+   copies. */
+SymScope_T SymScope_newWithOptions(
+   const struct SymTable_Options *psOptions);
+
+/* Free oSymScope, whatever scopes are open. */
+void SymScope_free(SymScope_T oSymScope);
+
+/* Return the depth of oSymScope's innermost scope: 0 for the
+   outermost, and one more for each scope pushed and not popped. */
+size_t SymScope_getDepth(SymScope_T oSymScope);
+
+/* Open a new innermost scope in oSymScope. Return 1 if it works, or
+   0 if out of memory. */
+int SymScope_push(SymScope_T oSymScope);
+
+/* Close oSymScope's innermost scope, which must not be the outermost,
+   removing its bindings and uncovering those they shadowed. */
+void SymScope_pop(SymScope_T oSymScope);
+
+/* Bind pcKey to pvValue in oSymScope's innermost scope, shadowing any
+   binding of it in an outer scope. Return 1 if it works, or 0 if out
+   of memory or pcKey is already bound in the innermost scope. */
+int SymScope_put(SymScope_T oSymScope,
+                 const char *pcKey, const void *pvValue);
+
+/* Set the value of pcKey's innermost binding in oSymScope, in
+   whatever scope, to pvValue, and return the old value, or return
+   NULL, changing nothing, if pcKey is not bound. */
+void *SymScope_replace(SymScope_T oSymScope,
+                       const char *pcKey, const void *pvValue);
+
+/* Return 1 if pcKey is bound in any open scope of oSymScope, or 0
+   otherwise. */
+int SymScope_contains(SymScope_T oSymScope, const char *pcKey);
+
+/* Return the value of pcKey's innermost binding in oSymScope, or
+   NULL if it is not bound. */
+void *SymScope_get(SymScope_T oSymScope, const char *pcKey);
+
+/* Return the depth of the scope that holds pcKey's innermost binding
+   in oSymScope, or oSymScope's depth plus 1 if it is not bound. */
+size_t SymScope_getScope(SymScope_T oSymScope, const char *pcKey);
+
+#endif
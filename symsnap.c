@@ -0,0 +1,896 @@
+/*--------------------------------------------------------------------*/
+/* symsnap.c                                                          */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symsnap.h"
+#include "symhash.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Reference counts may be changed by the threads of several SymSnaps
+   that share a node, so they are accessed with the atomic built-ins
+   of GCC and Clang, since C90 has none. */
+#ifndef __GNUC__
+#error "symsnap.c needs the __atomic built-ins of GCC or Clang"
+#endif
+
+/* number of hash code bits that pick a child at each branch level,
+   and the mask that extracts them. */
+enum { BITS_PER_LEVEL = 5 };
+enum { LEVEL_MASK = (1 << BITS_PER_LEVEL) - 1 };
+
+/* number of bits in a hash code. Branches exist only at shifts below
+   this; bindings whose hash codes are equal share a collision node. */
+enum { HASH_BITS = sizeof(size_t) * CHAR_BIT };
+
+/*--------------------------------------------------------------------*/
+/* Each node of the trie begins with a Node. A node is shared by      */
+/* every SymSnap holding a reference to it, whether directly or       */
+/* through a parent, and may be changed in place only when its count  */
+/* is 1 and its parent (or, for a root, the SymSnap) is so too.       */
+
+enum NodeKind { NODE_LEAF, NODE_BRANCH, NODE_COLLISION };
+
+struct Node
+{
+   /* the number of references to the node. Accessed atomically. */
+   size_t uRefCount;
+
+   enum NodeKind eKind;
+
+   /* the full hash code of a leaf's key, or of every key below a
+      collision node. Unused in a branch. */
+   size_t uHash;
+};
+
+/*--------------------------------------------------------------------*/
+/* A Leaf holds one binding. Its key is stored right after it.        */
+
+struct Leaf
+{
+   struct Node sNode;
+
+   /* the key string, and its length not counting its NUL. */
+   char *pcKey;
+   size_t uKeyLength;
+
+   /* the value associated with the key. */
+   const void *pvValue;
+};
+
+/*--------------------------------------------------------------------*/
+/* A Branch is a branch node or a collision node. A branch's children */
+/* are those of its 32 slots that are in use, in slot order, and bit  */
+/* i of ulBitmap is set if slot i is. A collision node's children are */
+/* leaves whose keys have the same hash code. The child array is      */
+/* stored right after the Branch.                                     */
+
+struct Branch
+{
+   struct Node sNode;
+
+   /* the slots in use. Unused in a collision node. */
+   unsigned long ulBitmap;
+
+   /* the number of children, and their addresses. */
+   size_t uCount;
+   struct Node **ppsChildren;
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymSnap is a reference to the root of a trie.                    */
+
+struct SymSnap
+{
+   /* the root node, or NULL if the SymSnap is empty. */
+   struct Node *psRoot;
+
+   /* total number of bindings stored. */
+   size_t uLength;
+
+   /* the function that hashes keys, and the seed passed to it. */
+   SymHash_T pfHash;
+   size_t uHashSeed;
+};
+
+/*--------------------------------------------------------------------*/
+/* Return the full hash code of the uKeyLength bytes at pcKey under
+   oSymSnap's hash function and seed. */
+
+static size_t SymSnap_hash(SymSnap_T oSymSnap, const char *pcKey,
+                           size_t uKeyLength)
+{
+   assert(oSymSnap != NULL);
+   assert(pcKey != NULL);
+
+   return (*oSymSnap->pfHash)(pcKey, uKeyLength, oSymSnap->uHashSeed);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the bit of a branch's bitmap for the slot that hash code
+   uHash picks at the level whose shift is uShift. */
+
+static unsigned long SymSnap_bit(size_t uHash, unsigned int uShift)
+{
+   assert(uShift < (unsigned int)HASH_BITS);
+   return 1UL << ((uHash >> uShift) & LEVEL_MASK);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the index in psBranch's child array of the slot whose bit is
+   ulBit. */
+
+static size_t SymSnap_childIndex(const struct Branch *psBranch,
+                                 unsigned long ulBit)
+{
+   assert(psBranch != NULL);
+   return (size_t)__builtin_popcountl(psBranch->ulBitmap &
+                                      (ulBit - 1UL));
+}
+
+/*--------------------------------------------------------------------*/
+/* Return 1 if psLeaf holds the key of length uKeyLength at pcKey,
+   whose hash code is uHash, or 0 otherwise. */
+
+static int SymSnap_matches(const struct Leaf *psLeaf, size_t uHash,
+                           const char *pcKey, size_t uKeyLength)
+{
+   assert(psLeaf != NULL);
+   assert(pcKey != NULL);
+
+   return psLeaf->sNode.uHash == uHash &&
+          psLeaf->uKeyLength == uKeyLength &&
+          memcmp(psLeaf->pcKey, pcKey, uKeyLength) == 0;
+}
+
+/*--------------------------------------------------------------------*/
+/* Add one reference to psNode. */
+
+static void SymSnap_retain(struct Node *psNode)
+{
+   assert(psNode != NULL);
+   __atomic_add_fetch(&psNode->uRefCount, 1U, __ATOMIC_RELAXED);
+}
+
+/*--------------------------------------------------------------------*/
+/* Drop one reference to psNode, freeing it, and dropping its
+   references to its children, if it was the last. */
+
+static void SymSnap_release(struct Node *psNode)
+{
+   const struct Branch *psBranch;
+   size_t u;
+
+   assert(psNode != NULL);
+
+   if (__atomic_sub_fetch(&psNode->uRefCount, 1U, __ATOMIC_ACQ_REL)
+       != 0U)
+      return;
+
+   if (psNode->eKind != NODE_LEAF)
+   {
+      psBranch = (const struct Branch*)psNode;
+      for (u = 0; u < psBranch->uCount; u++)
+         SymSnap_release(psBranch->ppsChildren[u]);
+   }
+   free(psNode);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return a new Leaf, with one reference, binding the key of length
+   uKeyLength at pcKey, whose hash code is uHash, to pvValue, or NULL
+   if out of memory. */
+
+static struct Leaf *SymSnap_newLeaf(size_t uHash, const char *pcKey,
+                                    size_t uKeyLength,
+                                    const void *pvValue)
+{
+   struct Leaf *psLeaf;
+
+   assert(pcKey != NULL);
+
+   if (uKeyLength > (size_t)-1 - sizeof(struct Leaf) - 1U)
+      return NULL;
+   psLeaf = (struct Leaf*)malloc(sizeof(struct Leaf) + uKeyLength + 1U);
+   if (psLeaf == NULL)
+      return NULL;
+
+   psLeaf->sNode.uRefCount = 1U;
+   psLeaf->sNode.eKind = NODE_LEAF;
+   psLeaf->sNode.uHash = uHash;
+   psLeaf->pcKey = (char*)(psLeaf + 1);
+   memcpy(psLeaf->pcKey, pcKey, uKeyLength);
+   psLeaf->pcKey[uKeyLength] = '\0';
+   psLeaf->uKeyLength = uKeyLength;
+   psLeaf->pvValue = pvValue;
+   return psLeaf;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return a new Branch of kind eKind, with one reference and room for
+   uCount children, whose fields other than the children are set from
+   the arguments, or NULL if out of memory. */
+
+static struct Branch *SymSnap_newBranch(enum NodeKind eKind,
+                                        size_t uHash,
+                                        unsigned long ulBitmap,
+                                        size_t uCount)
+{
+   struct Branch *psBranch;
+
+   if (uCount > ((size_t)-1 - sizeof(struct Branch)) /
+                sizeof(struct Node*))
+      return NULL;
+   psBranch = (struct Branch*)malloc(
+      sizeof(struct Branch) + uCount * sizeof(struct Node*));
+   if (psBranch == NULL)
+      return NULL;
+
+   psBranch->sNode.uRefCount = 1U;
+   psBranch->sNode.eKind = eKind;
+   psBranch->sNode.uHash = uHash;
+   psBranch->ulBitmap = ulBitmap;
+   psBranch->uCount = uCount;
+   psBranch->ppsChildren = (struct Node**)(psBranch + 1);
+   return psBranch;
+}
+
+/*--------------------------------------------------------------------*/
+/* Make the node at *ppsSlot one that only its parent refers to,
+   replacing it by a copy if it is shared. The copy refers to the
+   same children. Return 1 if successful, or 0, leaving *ppsSlot
+   alone, if out of memory. The bindings below *ppsSlot stay the
+   same either way. */
+
+static int SymSnap_own(struct Node **ppsSlot)
+{
+   struct Node *psNode;
+   const struct Leaf *psLeaf;
+   const struct Branch *psBranch;
+   struct Branch *psCopy;
+   struct Node *psNewNode;
+   size_t u;
+
+   assert(ppsSlot != NULL);
+   assert(*ppsSlot != NULL);
+
+   psNode = *ppsSlot;
+   if (__atomic_load_n(&psNode->uRefCount, __ATOMIC_ACQUIRE) == 1U)
+      return 1;
+
+   if (psNode->eKind == NODE_LEAF)
+   {
+      psLeaf = (const struct Leaf*)psNode;
+      psNewNode = (struct Node*)SymSnap_newLeaf(
+         psNode->uHash, psLeaf->pcKey, psLeaf->uKeyLength,
+         psLeaf->pvValue);
+      if (psNewNode == NULL)
+         return 0;
+   }
+   else
+   {
+      psBranch = (const struct Branch*)psNode;
+      psCopy = SymSnap_newBranch(psNode->eKind, psNode->uHash,
+                                 psBranch->ulBitmap, psBranch->uCount);
+      if (psCopy == NULL)
+         return 0;
+      for (u = 0; u < psBranch->uCount; u++)
+      {
+         psCopy->ppsChildren[u] = psBranch->ppsChildren[u];
+         SymSnap_retain(psCopy->ppsChildren[u]);
+      }
+      psNewNode = (struct Node*)psCopy;
+   }
+
+   SymSnap_release(psNode);
+   *ppsSlot = psNewNode;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return a copy of psBranch, which only its parent refers to, with
+   psChild inserted at index uIndex of its child array, and free
+   psBranch; or return NULL, leaving psBranch alone, if out of
+   memory. ulBit is set in the copy's bitmap. */
+
+static struct Branch *SymSnap_insertChild(struct Branch *psBranch,
+                                          size_t uIndex,
+                                          unsigned long ulBit,
+                                          struct Node *psChild)
+{
+   struct Branch *psNewBranch;
+
+   assert(psBranch != NULL);
+   assert(uIndex <= psBranch->uCount);
+   assert(psChild != NULL);
+
+   psNewBranch = SymSnap_newBranch(psBranch->sNode.eKind,
+                                   psBranch->sNode.uHash,
+                                   psBranch->ulBitmap | ulBit,
+                                   psBranch->uCount + 1U);
+   if (psNewBranch == NULL)
+      return NULL;
+
+   memcpy(psNewBranch->ppsChildren, psBranch->ppsChildren,
+          uIndex * sizeof(struct Node*));
+   psNewBranch->ppsChildren[uIndex] = psChild;
+   memcpy(psNewBranch->ppsChildren + uIndex + 1,
+          psBranch->ppsChildren + uIndex,
+          (psBranch->uCount - uIndex) * sizeof(struct Node*));
+   free(psBranch);
+   return psNewBranch;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return a new subtrie, for the level whose shift is uShift, holding
+   psOld and psNew, whose hash codes differ; or NULL if out of memory.
+   The subtrie takes the callers' references to both. */
+
+static struct Node *SymSnap_merge(struct Node *psOld,
+                                  struct Node *psNew,
+                                  unsigned int uShift)
+{
+   struct Branch *psBottom;
+   struct Branch *psParent;
+   struct Node *psTop;
+   struct Node *psNext;
+   unsigned long ulOldBit;
+   unsigned long ulNewBit;
+   unsigned int uSplit;
+
+   assert(psOld != NULL);
+   assert(psNew != NULL);
+   assert(psOld->uHash != psNew->uHash);
+
+   /* find the first level at which the hash codes pick different
+      slots. Every level above it needs a branch with one child. */
+   uSplit = uShift;
+   while (SymSnap_bit(psOld->uHash, uSplit) ==
+          SymSnap_bit(psNew->uHash, uSplit))
+      uSplit += BITS_PER_LEVEL;
+
+   ulOldBit = SymSnap_bit(psOld->uHash, uSplit);
+   ulNewBit = SymSnap_bit(psNew->uHash, uSplit);
+   psBottom = SymSnap_newBranch(NODE_BRANCH, 0U, ulOldBit | ulNewBit,
+                                2U);
+   if (psBottom == NULL)
+      return NULL;
+   psBottom->ppsChildren[ulOldBit < ulNewBit ? 0 : 1] = psOld;
+   psBottom->ppsChildren[ulOldBit < ulNewBit ? 1 : 0] = psNew;
+
+   psTop = (struct Node*)psBottom;
+   while (uSplit > uShift)
+   {
+      uSplit -= BITS_PER_LEVEL;
+      psParent = SymSnap_newBranch(
+         NODE_BRANCH, 0U, SymSnap_bit(psOld->uHash, uSplit), 1U);
+      if (psParent == NULL)
+      {
+         /* free the branches made so far, but not psOld or psNew */
+         while (psTop != (struct Node*)psBottom)
+         {
+            psNext = ((struct Branch*)psTop)->ppsChildren[0];
+            free(psTop);
+            psTop = psNext;
+         }
+         free(psBottom);
+         return NULL;
+      }
+      psParent->ppsChildren[0] = psTop;
+      psTop = (struct Node*)psParent;
+   }
+   return psTop;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the Leaf of oSymSnap that holds the key of length uKeyLength
+   at pcKey, whose hash code is uHash, or NULL if there is none. */
+
+static struct Leaf *SymSnap_find(SymSnap_T oSymSnap, size_t uHash,
+                                 const char *pcKey, size_t uKeyLength)
+{
+   const struct Node *psNode;
+   const struct Branch *psBranch;
+   unsigned long ulBit;
+   unsigned int uShift;
+   size_t u;
+
+   assert(oSymSnap != NULL);
+   assert(pcKey != NULL);
+
+   psNode = oSymSnap->psRoot;
+   uShift = 0U;
+   while (psNode != NULL && psNode->eKind == NODE_BRANCH)
+   {
+      psBranch = (const struct Branch*)psNode;
+      ulBit = SymSnap_bit(uHash, uShift);
+      if ((psBranch->ulBitmap & ulBit) == 0UL)
+         return NULL;
+      psNode = psBranch->ppsChildren[SymSnap_childIndex(psBranch,
+                                                        ulBit)];
+      uShift += BITS_PER_LEVEL;
+   }
+
+   if (psNode == NULL)
+      return NULL;
+   if (psNode->eKind == NODE_LEAF)
+   {
+      if (SymSnap_matches((const struct Leaf*)psNode, uHash, pcKey,
+                          uKeyLength))
+         return (struct Leaf*)psNode;
+      return NULL;
+   }
+
+   psBranch = (const struct Branch*)psNode;
+   if (psNode->uHash != uHash)
+      return NULL;
+   for (u = 0; u < psBranch->uCount; u++)
+      if (SymSnap_matches((const struct Leaf*)psBranch->ppsChildren[u],
+                          uHash, pcKey, uKeyLength))
+         return (struct Leaf*)psBranch->ppsChildren[u];
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+/* Insert psLeaf, whose key oSymSnap does not contain, into oSymSnap.
+   Return 1 if successful, or 0, leaving oSymSnap's bindings alone, if
+   out of memory. */
+
+static int SymSnap_insert(SymSnap_T oSymSnap, struct Leaf *psLeaf)
+{
+   struct Node **ppsSlot;
+   struct Node *psNode;
+   struct Node *psNew;
+   struct Branch *psBranch;
+   unsigned long ulBit;
+   unsigned int uShift;
+   size_t uHash;
+
+   assert(oSymSnap != NULL);
+   assert(psLeaf != NULL);
+
+   uHash = psLeaf->sNode.uHash;
+   ppsSlot = &oSymSnap->psRoot;
+   uShift = 0U;
+   for (;;)
+   {
+      psNode = *ppsSlot;
+      if (psNode == NULL)
+      {
+         *ppsSlot = (struct Node*)psLeaf;
+         return 1;
+      }
+
+      /* a leaf or collision node of another hash code moves down,
+         and one of the same hash code gains a child */
+      if (psNode->eKind != NODE_BRANCH)
+      {
+         if (psNode->uHash != uHash)
+         {
+            psNew = SymSnap_merge(psNode, (struct Node*)psLeaf, uShift);
+            if (psNew == NULL)
+               return 0;
+            *ppsSlot = psNew;
+            return 1;
+         }
+         if (psNode->eKind == NODE_LEAF)
+         {
+            psBranch = SymSnap_newBranch(NODE_COLLISION, uHash, 0UL,
+                                         2U);
+            if (psBranch == NULL)
+               return 0;
+            psBranch->ppsChildren[0] = psNode;
+            psBranch->ppsChildren[1] = (struct Node*)psLeaf;
+            *ppsSlot = (struct Node*)psBranch;
+            return 1;
+         }
+         if (!SymSnap_own(ppsSlot))
+            return 0;
+         psBranch = (struct Branch*)*ppsSlot;
+         psBranch = SymSnap_insertChild(psBranch, psBranch->uCount, 0UL,
+                                        (struct Node*)psLeaf);
+         if (psBranch == NULL)
+            return 0;
+         *ppsSlot = (struct Node*)psBranch;
+         return 1;
+      }
+
+      if (!SymSnap_own(ppsSlot))
+         return 0;
+      psBranch = (struct Branch*)*ppsSlot;
+      ulBit = SymSnap_bit(uHash, uShift);
+      if ((psBranch->ulBitmap & ulBit) == 0UL)
+      {
+         psBranch = SymSnap_insertChild(
+            psBranch, SymSnap_childIndex(psBranch, ulBit), ulBit,
+            (struct Node*)psLeaf);
+         if (psBranch == NULL)
+            return 0;
+         *ppsSlot = (struct Node*)psBranch;
+         return 1;
+      }
+      ppsSlot = &psBranch->ppsChildren[SymSnap_childIndex(psBranch,
+                                                          ulBit)];
+      uShift += BITS_PER_LEVEL;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the Leaf of oSymSnap that holds the key of length uKeyLength
+   at pcKey, whose hash code is uHash, first making it and every node
+   above it ones that only oSymSnap refers to; or return NULL if out
+   of memory. oSymSnap must contain the key. */
+
+static struct Leaf *SymSnap_ownLeaf(SymSnap_T oSymSnap, size_t uHash,
+                                    const char *pcKey,
+                                    size_t uKeyLength)
+{
+   struct Node **ppsSlot;
+   struct Branch *psBranch;
+   unsigned int uShift;
+   size_t u;
+
+   assert(oSymSnap != NULL);
+   assert(pcKey != NULL);
+
+   ppsSlot = &oSymSnap->psRoot;
+   uShift = 0U;
+   for (;;)
+   {
+      assert(*ppsSlot != NULL);
+      if (!SymSnap_own(ppsSlot))
+         return NULL;
+      if ((*ppsSlot)->eKind == NODE_LEAF)
+         return (struct Leaf*)*ppsSlot;
+
+      psBranch = (struct Branch*)*ppsSlot;
+      if (psBranch->sNode.eKind == NODE_BRANCH)
+      {
+         ppsSlot = &psBranch->ppsChildren[
+            SymSnap_childIndex(psBranch, SymSnap_bit(uHash, uShift))];
+         uShift += BITS_PER_LEVEL;
+      }
+      else
+      {
+         for (u = 0; !SymSnap_matches(
+                 (const struct Leaf*)psBranch->ppsChildren[u],
+                 uHash, pcKey, uKeyLength); u++)
+            assert(u + 1U < psBranch->uCount);
+         ppsSlot = &psBranch->ppsChildren[u];
+      }
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/* Remove the child at index uIndex of psBranch, which only its parent
+   refers to, without dropping the reference to it. If psBranch is
+   then left with one child that is not a branch, or with none, free
+   psBranch and return that child, or NULL; otherwise return
+   psBranch. ulBit is cleared in psBranch's bitmap. */
+
+static struct Node *SymSnap_removeChild(struct Branch *psBranch,
+                                        size_t uIndex,
+                                        unsigned long ulBit)
+{
+   struct Node *psChild;
+
+   assert(psBranch != NULL);
+   assert(uIndex < psBranch->uCount);
+
+   memmove(psBranch->ppsChildren + uIndex,
+           psBranch->ppsChildren + uIndex + 1,
+           (psBranch->uCount - uIndex - 1U) * sizeof(struct Node*));
+   psBranch->uCount--;
+   psBranch->ulBitmap &= ~ulBit;
+
+   /* a lone leaf or collision node is found as well one level up,
+      so this branch is not needed */
+   if (psBranch->uCount == 0U)
+   {
+      free(psBranch);
+      return NULL;
+   }
+   psChild = psBranch->ppsChildren[0];
+   if (psBranch->uCount == 1U && psChild->eKind != NODE_BRANCH)
+   {
+      free(psBranch);
+      return psChild;
+   }
+   return (struct Node*)psBranch;
+}
+
+/*--------------------------------------------------------------------*/
+/* Remove from the subtrie at *ppsSlot, at the level whose shift is
+   uShift, the binding of the key of length uKeyLength at pcKey, whose
+   hash code is uHash, storing its value in *ppvValue. The subtrie
+   must contain the key. Return 1 if successful, or 0, leaving the
+   subtrie's bindings alone, if out of memory. */
+
+static int SymSnap_delete(struct Node **ppsSlot, unsigned int uShift,
+                          size_t uHash, const char *pcKey,
+                          size_t uKeyLength, const void **ppvValue)
+{
+   struct Node *psNode;
+   struct Branch *psBranch;
+   unsigned long ulBit;
+   size_t uIndex;
+
+   assert(ppsSlot != NULL);
+   assert(*ppsSlot != NULL);
+   assert(pcKey != NULL);
+   assert(ppvValue != NULL);
+
+   /* a leaf, even a shared one, need only be let go */
+   psNode = *ppsSlot;
+   if (psNode->eKind == NODE_LEAF)
+   {
+      *ppvValue = ((const struct Leaf*)psNode)->pvValue;
+      SymSnap_release(psNode);
+      *ppsSlot = NULL;
+      return 1;
+   }
+
+   if (!SymSnap_own(ppsSlot))
+      return 0;
+   psBranch = (struct Branch*)*ppsSlot;
+
+   if (psBranch->sNode.eKind == NODE_COLLISION)
+   {
+      for (uIndex = 0; !SymSnap_matches(
+              (const struct Leaf*)psBranch->ppsChildren[uIndex],
+              uHash, pcKey, uKeyLength); uIndex++)
+         assert(uIndex + 1U < psBranch->uCount);
+      *ppvValue =
+         ((const struct Leaf*)psBranch->ppsChildren[uIndex])->pvValue;
+      SymSnap_release(psBranch->ppsChildren[uIndex]);
+      *ppsSlot = SymSnap_removeChild(psBranch, uIndex, 0UL);
+      return 1;
+   }
+
+   ulBit = SymSnap_bit(uHash, uShift);
+   uIndex = SymSnap_childIndex(psBranch, ulBit);
+   if (!SymSnap_delete(&psBranch->ppsChildren[uIndex],
+                       uShift + BITS_PER_LEVEL, uHash, pcKey,
+                       uKeyLength, ppvValue))
+      return 0;
+
+   if (psBranch->ppsChildren[uIndex] == NULL)
+      *ppsSlot = SymSnap_removeChild(psBranch, uIndex, ulBit);
+   else if (psBranch->uCount == 1U &&
+            psBranch->ppsChildren[0]->eKind != NODE_BRANCH)
+   {
+      /* the child became a lone leaf, so it moves up a level */
+      *ppsSlot = psBranch->ppsChildren[0];
+      free(psBranch);
+   }
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/* Call (*pfApply)(pcKey, pvValue, pvExtra) for each binding in the
+   subtrie psNode. */
+
+static void SymSnap_mapNode(const struct Node *psNode,
+                            void (*pfApply)(const char *pcKey,
+                                            void *pvValue,
+                                            void *pvExtra),
+                            const void *pvExtra)
+{
+   const struct Leaf *psLeaf;
+   const struct Branch *psBranch;
+   size_t u;
+
+   assert(psNode != NULL);
+   assert(pfApply != NULL);
+
+   if (psNode->eKind == NODE_LEAF)
+   {
+      psLeaf = (const struct Leaf*)psNode;
+      (*pfApply)(psLeaf->pcKey, (void*)psLeaf->pvValue,
+                 (void*)pvExtra);
+      return;
+   }
+
+   psBranch = (const struct Branch*)psNode;
+   for (u = 0; u < psBranch->uCount; u++)
+      SymSnap_mapNode(psBranch->ppsChildren[u], pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymSnap_T SymSnap_new(void)
+{
+   struct SymTable_Options sOptions;
+
+   SymTable_initOptions(&sOptions);
+   return SymSnap_newWithOptions(&sOptions);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymSnap_T SymSnap_newWithOptions(
+   const struct SymTable_Options *psOptions)
+{
+   SymSnap_T oSymSnap;
+
+   assert(psOptions != NULL);
+
+   oSymSnap = (SymSnap_T)malloc(sizeof(struct SymSnap));
+   if (oSymSnap == NULL)
+      return NULL;
+
+   oSymSnap->psRoot = NULL;
+   oSymSnap->uLength = 0U;
+   oSymSnap->pfHash = psOptions->pfHash;
+   if (oSymSnap->pfHash == NULL)
+      oSymSnap->pfHash = SymHash_word;
+   oSymSnap->uHashSeed = psOptions->uHashSeed;
+   return oSymSnap;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymSnap_free(SymSnap_T oSymSnap)
+{
+   assert(oSymSnap != NULL);
+
+   if (oSymSnap->psRoot != NULL)
+      SymSnap_release(oSymSnap->psRoot);
+   free(oSymSnap);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymSnap_T SymSnap_snapshot(SymSnap_T oSymSnap)
+{
+   SymSnap_T oSnapshot;
+
+   assert(oSymSnap != NULL);
+
+   oSnapshot = (SymSnap_T)malloc(sizeof(struct SymSnap));
+   if (oSnapshot == NULL)
+      return NULL;
+
+   *oSnapshot = *oSymSnap;
+   if (oSnapshot->psRoot != NULL)
+      SymSnap_retain(oSnapshot->psRoot);
+   return oSnapshot;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymSnap_getLength(SymSnap_T oSymSnap)
+{
+   assert(oSymSnap != NULL);
+   return oSymSnap->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymSnap_put(SymSnap_T oSymSnap,
+                const char *pcKey, const void *pvValue)
+{
+   struct Leaf *psLeaf;
+   size_t uKeyLength;
+   size_t uHash;
+
+   assert(oSymSnap != NULL);
+   assert(pcKey != NULL);
+
+   uKeyLength = strlen(pcKey);
+   uHash = SymSnap_hash(oSymSnap, pcKey, uKeyLength);
+   if (SymSnap_find(oSymSnap, uHash, pcKey, uKeyLength) != NULL)
+      return 0;
+
+   psLeaf = SymSnap_newLeaf(uHash, pcKey, uKeyLength, pvValue);
+   if (psLeaf == NULL)
+      return 0;
+   if (!SymSnap_insert(oSymSnap, psLeaf))
+   {
+      free(psLeaf);
+      return 0;
+   }
+
+   oSymSnap->uLength++;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymSnap_replace(SymSnap_T oSymSnap,
+                      const char *pcKey, const void *pvValue)
+{
+   struct Leaf *psLeaf;
+   const void *pvOldValue;
+   size_t uKeyLength;
+   size_t uHash;
+
+   assert(oSymSnap != NULL);
+   assert(pcKey != NULL);
+
+   uKeyLength = strlen(pcKey);
+   uHash = SymSnap_hash(oSymSnap, pcKey, uKeyLength);
+   if (SymSnap_find(oSymSnap, uHash, pcKey, uKeyLength) == NULL)
+      return NULL;
+
+   psLeaf = SymSnap_ownLeaf(oSymSnap, uHash, pcKey, uKeyLength);
+   if (psLeaf == NULL)
+      return NULL;
+   pvOldValue = psLeaf->pvValue;
+   psLeaf->pvValue = pvValue;
+   return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymSnap_contains(SymSnap_T oSymSnap, const char *pcKey)
+{
+   size_t uKeyLength;
+
+   assert(oSymSnap != NULL);
+   assert(pcKey != NULL);
+
+   uKeyLength = strlen(pcKey);
+   return SymSnap_find(oSymSnap,
+                       SymSnap_hash(oSymSnap, pcKey, uKeyLength),
+                       pcKey, uKeyLength) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymSnap_get(SymSnap_T oSymSnap, const char *pcKey)
+{
+   const struct Leaf *psLeaf;
+   size_t uKeyLength;
+
+   assert(oSymSnap != NULL);
+   assert(pcKey != NULL);
+
+   uKeyLength = strlen(pcKey);
+   psLeaf = SymSnap_find(oSymSnap,
+                         SymSnap_hash(oSymSnap, pcKey, uKeyLength),
+                         pcKey, uKeyLength);
+   if (psLeaf == NULL)
+      return NULL;
+   return (void*)psLeaf->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymSnap_remove(SymSnap_T oSymSnap, const char *pcKey)
+{
+   const void *pvValue;
+   size_t uKeyLength;
+   size_t uHash;
+
+   assert(oSymSnap != NULL);
+   assert(pcKey != NULL);
+
+   uKeyLength = strlen(pcKey);
+   uHash = SymSnap_hash(oSymSnap, pcKey, uKeyLength);
+   if (SymSnap_find(oSymSnap, uHash, pcKey, uKeyLength) == NULL)
+      return NULL;
+
+   if (!SymSnap_delete(&oSymSnap->psRoot, 0U, uHash, pcKey,
+                       uKeyLength, &pvValue))
+      return NULL;
+   oSymSnap->uLength--;
+   return (void*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymSnap_map(SymSnap_T oSymSnap,
+                 void (*pfApply)(const char *pcKey, void *pvValue,
+                                 void *pvExtra),
+                 const void *pvExtra)
+{
+   assert(oSymSnap != NULL);
+   assert(pfApply != NULL);
+
+   if (oSymSnap->psRoot != NULL)
+      SymSnap_mapNode(oSymSnap->psRoot, pfApply, pvExtra);
+}
@@ -0,0 +1,63 @@
+/*--------------------------------------------------------------------*/
+/* symsnap.h                                                          */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMSNAP_INCLUDED
+#define SYMSNAP_INCLUDED
+#include "symtable.h"
+#include <stddef.h>
+
+/* A SymSnap_T is a pointer to a SymSnap object, a symbol table that
+   can be snapshotted in constant time. It is a hash array mapped trie
+   whose nodes are shared, with reference counts, between a SymSnap and
+   the snapshots taken of it. A change copies only the nodes on the
+   path to the binding it changes that are still shared, so each
+   snapshot costs memory only for the parts of the table changed after
+   it was taken. A SymSnap and its snapshots are independent tables:
+   changing one never changes the others. Each may be used by a
+   different thread, but no one of them by two threads at once. */
+typedef struct SymSnap *SymSnap_T;
+
+/* Return a new, empty SymSnap, or NULL if out of memory. */
+SymSnap_T SymSnap_new(void);
+
+/* Return a new, empty SymSnap configured by *psOptions, or NULL if
+   out of memory. Only the hash function and seed are used. */
+SymSnap_T SymSnap_newWithOptions(
+   const struct SymTable_Options *psOptions);
+
+/* Free oSymSnap. Its snapshots, and the SymSnap it is a snapshot of,
+   are unaffected. */
+void SymSnap_free(SymSnap_T oSymSnap);
+
+/* Return a new SymSnap with the bindings oSymSnap has now, or NULL if
+   out of memory. It takes constant time. */
+SymSnap_T SymSnap_snapshot(SymSnap_T oSymSnap);
+
+/* Return the number of bindings in oSymSnap. */
+size_t SymSnap_getLength(SymSnap_T oSymSnap);
+
+/* The functions below behave like the SymTable functions of the same
+   names. A change may need to copy shared nodes, so put, replace and
+   remove may fail if out of memory: put then returns 0, and replace
+   and remove NULL, leaving oSymSnap unchanged. */
+
+int SymSnap_put(SymSnap_T oSymSnap,
+                const char *pcKey, const void *pvValue);
+
+void *SymSnap_replace(SymSnap_T oSymSnap,
+                      const char *pcKey, const void *pvValue);
+
+int SymSnap_contains(SymSnap_T oSymSnap, const char *pcKey);
+
+void *SymSnap_get(SymSnap_T oSymSnap, const char *pcKey);
+
+void *SymSnap_remove(SymSnap_T oSymSnap, const char *pcKey);
+
+void SymSnap_map(SymSnap_T oSymSnap,
+                 void (*pfApply)(const char *pcKey, void *pvValue,
+                                 void *pvExtra),
+                 const void *pvExtra);
+
+#endif
@@ -0,0 +1,81 @@
+/*--------------------------------------------------------------------*/
+/* symstats.c                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symstats.h"
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+void SymStats_init(struct SymTable_Stats *psStats)
+{
+   size_t u;
+
+   assert(psStats != NULL);
+
+   psStats->uLookups = 0U;
+   psStats->uHits = 0U;
+   psStats->uProbes = 0U;
+   psStats->uKeyCompares = 0U;
+   psStats->uResizes = 0U;
+   psStats->dResizeSeconds = 0.0;
+
+   psStats->uChainCount = 0U;
+   psStats->uMaxChainLength = 0U;
+   psStats->dAverageChainLength = 0.0;
+   for (u = 0; u < (size_t)SYMTABLE_STATS_HISTOGRAM_SIZE; u++)
+      psStats->auChainLengths[u] = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymStats_addChain(struct SymTable_Stats *psStats, size_t uLength)
+{
+   assert(psStats != NULL);
+
+   psStats->uChainCount++;
+   if (uLength > psStats->uMaxChainLength)
+      psStats->uMaxChainLength = uLength;
+   if (uLength >= (size_t)SYMTABLE_STATS_HISTOGRAM_SIZE)
+      uLength = SYMTABLE_STATS_HISTOGRAM_SIZE - 1;
+   psStats->auChainLengths[uLength]++;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymStats_finish(struct SymTable_Stats *psStats,
+                     size_t uBindingCount)
+{
+   size_t uNonEmpty;
+
+   assert(psStats != NULL);
+
+   uNonEmpty = psStats->uChainCount - psStats->auChainLengths[0];
+   psStats->dAverageChainLength = 0.0;
+   if (uNonEmpty > 0U)
+      psStats->dAverageChainLength =
+         (double)uBindingCount / (double)uNonEmpty;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymStats_finishMemory(struct SymTable_Memory *psMemory,
+                             size_t uTotalBytes,
+                             struct SymTable_Memory *psResult)
+{
+   size_t uUsedBytes;
+
+   assert(psMemory != NULL);
+
+   uUsedBytes = psMemory->uTableBytes + psMemory->uIndexBytes +
+                psMemory->uBindingBytes + psMemory->uKeyBytes;
+   assert(uUsedBytes <= uTotalBytes);
+   psMemory->uSlackBytes = uTotalBytes - uUsedBytes;
+
+   if (psResult != NULL)
+      *psResult = *psMemory;
+   return uTotalBytes;
+}
+
+/*--------------------------------------------------------------------*/
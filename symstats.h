@@ -0,0 +1,76 @@
+/*--------------------------------------------------------------------*/
+/* symstats.h                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMSTATS_INCLUDED
+#define SYMSTATS_INCLUDED
+#include "symtable.h"
+#include <stddef.h>
+
+/* Helpers for SymTable_getStats(), shared by the SymTable
+   implementations. */
+
+/* Set every field of *psStats to 0. */
+void SymStats_init(struct SymTable_Stats *psStats);
+
+/* Count in *psStats a chain of uLength bindings. */
+void SymStats_addChain(struct SymTable_Stats *psStats, size_t uLength);
+
+/* Complete *psStats, whose chains hold uBindingCount bindings in
+   all, once every chain has been counted. */
+void SymStats_finish(struct SymTable_Stats *psStats,
+                     size_t uBindingCount);
+
+/* Helper for SymTable_memoryUsage(), likewise shared. Set the slack
+   of *psMemory, whose other fields are set, to the rest of the
+   uTotalBytes its table uses, copy *psMemory to *psResult unless
+   psResult is NULL, and return uTotalBytes. */
+size_t SymStats_finishMemory(struct SymTable_Memory *psMemory,
+                             size_t uTotalBytes,
+                             struct SymTable_Memory *psResult);
+
+/*--------------------------------------------------------------------*/
+
+/* Unless SYMTABLE_STATS is defined, every macro below expands to
+   nothing the compiler keeps, so a table built without it pays no
+   cost for its counters. They are added to atomically where the
+   compiler allows, since several threads may look keys up in one
+   table at once. */
+
+#ifdef SYMTABLE_STATS
+
+#include <time.h>
+
+/* the type of a starting time for SYMSTATS_STOP(). */
+typedef clock_t SymStats_Clock;
+
+/* Add uAmount to the size_t counter uCounter. */
+#ifdef __GNUC__
+#define SYMSTATS_ADD(uCounter, uAmount) \
+   ((void)__atomic_fetch_add(&(uCounter), (size_t)(uAmount), \
+                             __ATOMIC_RELAXED))
+#else
+#define SYMSTATS_ADD(uCounter, uAmount) \
+   ((void)((uCounter) += (size_t)(uAmount)))
+#endif
+
+/* Store the CPU time so far in the SymStats_Clock tStart. */
+#define SYMSTATS_START(tStart) ((void)((tStart) = clock()))
+
+/* Add to the double dSeconds the CPU seconds since
+   SYMSTATS_START(tStart). */
+#define SYMSTATS_STOP(dSeconds, tStart) \
+   ((void)((dSeconds) += (double)(clock() - (tStart)) / \
+                         (double)CLOCKS_PER_SEC))
+
+#else
+
+typedef int SymStats_Clock;
+#define SYMSTATS_ADD(uCounter, uAmount) ((void)0)
+#define SYMSTATS_START(tStart) ((void)((tStart) = 0))
+#define SYMSTATS_STOP(dSeconds, tStart) ((void)(tStart))
+
+#endif
+
+#endif
@@ -12,20 +12,233 @@
    that map to void pointer values. */
 typedef struct SymTable *SymTable_T;
 
+/* The kinds of event a SymTable reports to its trace function. */
+enum SymTable_TraceKind
+{
+   /* A sampled lookup that was slow or that examined many bindings. */
+   SYMTABLE_TRACE_LOOKUP,
+
+   /* The table began moving its bindings to a new array. */
+   SYMTABLE_TRACE_RESIZE_BEGIN,
+
+   /* The table finished moving them. */
+   SYMTABLE_TRACE_RESIZE_END
+};
+
+/* An event reported to a SymTable's trace function. Its fields are
+   plain values, to be copied out to whatever collects them. */
+struct SymTable_TraceEvent
+{
+   enum SymTable_TraceKind eKind;
+
+   /* The table the event happened to. */
+   SymTable_T oSymTable;
+
+   /* For a lookup, the uKeyLength bytes of the key at pcKey, which
+      need not be NUL-terminated; 1 if it was found, or 0 otherwise;
+      and the number of bindings, slots, or nodes examined. */
+   const char *pcKey;
+   size_t uKeyLength;
+   int iFound;
+   size_t uProbes;
+
+   /* The wall-clock seconds the lookup took, or for the end of a
+      resize, the seconds since it began. A resize that moves
+      bindings incrementally ends only once all of them have moved. */
+   double dSeconds;
+
+   /* For a resize, the sizes of the old and new arrays, in buckets or
+      slots, and the number of bindings in the table. */
+   size_t uOldSize;
+   size_t uNewSize;
+   size_t uLength;
+};
+
+/* A SymTable_Options object holds the tuning parameters accepted by
+   SymTable_newWithOptions(). Fill one in with SymTable_initOptions()
+   and then change only the fields of interest. */
+struct SymTable_Options
+{
+   /* The largest average number of bindings per bucket that the
+      table tolerates before it expands. Larger values trade longer
+      chains for less memory. Open-addressing implementations cap it
+      below 1. Implementations that do not hash ignore it. */
+   double dMaxLoadFactor;
+
+   /* If nonzero, a chained hash table spreads each expansion over
+      the operations that follow it: every put, get, replace,
+      contains, and remove moves this many buckets from the old
+      bucket array to the new one, bounding the latency of any single
+      call. If 0, expansion rehashes every binding at once.
+      Implementations without incremental rehashing ignore it. */
+   size_t uRehashStep;
+
+   /* The function that hashes keys: it returns a hash code for the
+      uLength bytes at pvKey, perturbed by uSeed. NULL selects the
+      implementation's default. symhash.h declares several to choose
+      from. Implementations that do not hash ignore it. */
+   size_t (*pfHash)(const void *pvKey, size_t uLength, size_t uSeed);
+
+   /* The seed passed to pfHash. When keys may be chosen by an
+      adversary trying to force collisions, use SymHash_sip() with a
+      seed from SymHash_makeSeed(): the other hash functions collide
+      on the same keys whatever the seed. */
+   size_t uHashSeed;
+
+   /* If nonzero, SymTable_put() stores the caller's pcKey pointer
+      instead of a copy of the key, so the key string must stay
+      allocated and unchanged for as long as its binding exists.
+      Suits keys that already outlive the table, such as interned or
+      memory-mapped strings. If 0, the default, every key is copied. */
+   int iBorrowKeys;
+
+   /* If nonzero, the list implementation moves each binding that a
+      lookup finds to the front of the list, so the keys looked up
+      most often are found soonest. Lookups then change the table:
+      none may be made from within SymTable_map() or at the same
+      time as any other. Other implementations ignore it. */
+   int iMoveToFront;
+
+   /* If not NULL, pfTrace(psEvent, pvTraceExtra) reports events as
+      they happen: every resize, and every lookup of those sampled,
+      1 in uTraceSampleInterval, that took at least dTraceMinSeconds
+      or examined at least uTraceMinProbes bindings. A threshold of 0
+      is not tested; if both are 0, every sampled lookup is reported.
+      pfTrace must not change the table, and is called from several
+      threads at once if they use the table at once. If NULL, the
+      default, tracing costs one test per lookup. */
+   void (*pfTrace)(const struct SymTable_TraceEvent *psEvent,
+                   void *pvExtra);
+   void *pvTraceExtra;
+   size_t uTraceSampleInterval;
+   double dTraceMinSeconds;
+   size_t uTraceMinProbes;
+};
+
+/* Set every field of *psOptions to this implementation's default. */
+void SymTable_initOptions(struct SymTable_Options *psOptions);
+
 /* Return a new, empty SymTable, or NULL if out of memory. */
 SymTable_T SymTable_new(void);
 
+/* Return a new, empty SymTable configured by *psOptions, or NULL if
+   out of memory. psOptions->dMaxLoadFactor must be positive. */
+SymTable_T SymTable_newWithOptions(
+   const struct SymTable_Options *psOptions);
+
+/* Return a new, empty SymTable with room made for uCount bindings as
+   by SymTable_reserve(), or NULL if out of memory. */
+SymTable_T SymTable_newWithCapacity(size_t uCount);
+
 /* Free oSymTable. */
 void SymTable_free(SymTable_T oSymTable);
 
 /* Return number of bindings in oSymTable. */
 size_t SymTable_getLength(SymTable_T oSymTable);
 
+/* Shrink oSymTable's internal arrays to the smallest that hold its
+   bindings, giving the memory back to malloc. Tables also shrink on
+   their own as removals empty them; this reclaims the rest at once.
+   Return 1 if it works, or 0, leaving oSymTable unchanged, if out of
+   memory. */
+int SymTable_compact(SymTable_T oSymTable);
+
+/* Make room in oSymTable for uCount bindings in all, so that putting
+   up to that many resizes it no more. Removals may still shrink it.
+   Return 1 if it works, or 0, leaving oSymTable unchanged, if out of
+   memory. */
+int SymTable_reserve(SymTable_T oSymTable, size_t uCount);
+
+/* number of chain lengths SymTable_Stats counts separately. */
+enum { SYMTABLE_STATS_HISTOGRAM_SIZE = 16 };
+
+/* How a SymTable has performed, and its shape. A chain is the group
+   of bindings one lookup chooses among: a bucket of the hash
+   implementation, the bindings sharing a home slot in the flat one,
+   a leaf of the tree, and the whole of the list. */
+struct SymTable_Stats
+{
+   /* Counters, kept since the table was created only if its
+      implementation was compiled with SYMTABLE_STATS defined, and 0
+      otherwise. uProbes counts the bindings, slots, or nodes
+      lookups examined; uKeyCompares the key strings they compared;
+      uResizes the times the table moved its bindings to a new array;
+      and dResizeSeconds the CPU time that took. */
+   size_t uLookups;
+   size_t uHits;
+   size_t uProbes;
+   size_t uKeyCompares;
+   size_t uResizes;
+   double dResizeSeconds;
+
+   /* The shape of the table as it stands: its number of chains, the
+      longest, the mean length of those not empty, and in
+      auChainLengths[i] the number of chains of length i, where the
+      last element also counts every longer chain. */
+   size_t uChainCount;
+   size_t uMaxChainLength;
+   double dAverageChainLength;
+   size_t auChainLengths[SYMTABLE_STATS_HISTOGRAM_SIZE];
+};
+
+/* Store in *psStats the counters and the shape of oSymTable. Takes
+   time proportional to the size of oSymTable, to measure its shape. */
+void SymTable_getStats(SymTable_T oSymTable,
+                       struct SymTable_Stats *psStats);
+
+/* Where the memory of a SymTable goes, in bytes. Memory the table has
+   taken from malloc is counted once, in one field; malloc's own
+   bookkeeping is not counted. */
+struct SymTable_Memory
+{
+   /* the SymTable object itself. */
+   size_t uTableBytes;
+
+   /* what leads lookups to the bindings: the bucket arrays of the
+      hash implementation and the branches, with their separator keys,
+      of the tree. */
+   size_t uIndexBytes;
+
+   /* the records of the bindings in use: their Bindings, or slots of
+      the flat implementation. */
+   size_t uBindingBytes;
+
+   /* the key strings copied outside those records, NULs included. */
+   size_t uKeyBytes;
+
+   /* everything else: unused slots and node entries, released or
+      never-used Bindings, and key space freed, rounded off or not yet
+      used. */
+   size_t uSlackBytes;
+};
+
+/* Return the number of bytes oSymTable uses, and if psMemory is not
+   NULL store in *psMemory where they go; the fields sum to the
+   result. Takes time proportional to the size of oSymTable, to
+   measure its keys. */
+size_t SymTable_memoryUsage(SymTable_T oSymTable,
+                            struct SymTable_Memory *psMemory);
+
 /* Insert pcKey -> pvValue in oSymTable if pcKey isn't already present.
    Return 1 if it works, 0 if it already exists). */
 int SymTable_put(SymTable_T oSymTable,
                  const char *pcKey, const void *pvValue);
 
+/* Bind pcKey to pvValue in oSymTable: insert the binding if pcKey
+   isn't present, otherwise replace its value. The key is hashed and
+   looked up only once. Return 1 if it works, 0 if out of memory. */
+int SymTable_upsert(SymTable_T oSymTable,
+                    const char *pcKey, const void *pvValue);
+
+/* Return the address of the value of pcKey in oSymTable, first
+   inserting pcKey -> pvValue if pcKey isn't present, or return NULL
+   if out of memory. The key is hashed and looked up only once. The
+   address stays valid only until the next call that changes
+   oSymTable, including reserve, removeIf, putBatch and putParallel,
+   since some implementations then move their bindings. */
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+                            const char *pcKey, const void *pvValue);
+
 /* If pcKey exists in oSymTable, replace its value with pvValue.
    Returns the old value. Otherwise returns NULL. */
 void *SymTable_replace(SymTable_T oSymTable,
@@ -41,6 +254,106 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey);
    Otherwise return NULL and don't do anything. */
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey);
 
+/* Remove from oSymTable every binding for which
+   pfPredicate(pcKey, pvValue, pvExtra) returns nonzero, in one pass
+   over the table, and return how many were removed. If pfRelease is
+   not NULL, first call pfRelease(pcKey, pvValue, pvExtra) for each of
+   them, say to free the value. Neither function may change
+   oSymTable. */
+size_t SymTable_removeIf(SymTable_T oSymTable,
+                         int (*pfPredicate)(const char *pcKey,
+                                            void *pvValue,
+                                            void *pvExtra),
+                         void (*pfRelease)(const char *pcKey,
+                                           void *pvValue,
+                                           void *pvExtra),
+                         const void *pvExtra);
+
+/* The functions below behave like the ones above without the N, but
+   take the key as the uKeyLength bytes at pcKey instead of as a
+   string. The key need not be NUL-terminated, so it may be a slice of
+   a larger buffer, and it is never scanned for its length. A key
+   stored by putN, upsertN, or getOrInsertN is copied with a NUL
+   appended; in a table that borrows its keys, pcKey[uKeyLength] must
+   already be '\0'. */
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+                  size_t uKeyLength, const void *pvValue);
+
+int SymTable_upsertN(SymTable_T oSymTable, const char *pcKey,
+                     size_t uKeyLength, const void *pvValue);
+
+void **SymTable_getOrInsertN(SymTable_T oSymTable, const char *pcKey,
+                             size_t uKeyLength, const void *pvValue);
+
+void *SymTable_replaceN(SymTable_T oSymTable, const char *pcKey,
+                        size_t uKeyLength, const void *pvValue);
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength);
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+                    size_t uKeyLength);
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength);
+
+/* Return the hash code of the key of uKeyLength bytes at pcKey under
+   oSymTable's hash function and seed, or, in implementations that do
+   not hash, its SymHash_word() code with seed 0. It depends only on
+   the options oSymTable was created with, so it needs no lock against
+   changes to oSymTable, and tables created with the same options give
+   the same code. */
+size_t SymTable_hashN(SymTable_T oSymTable, const char *pcKey,
+                      size_t uKeyLength);
+
+/* The functions below behave like the ones above with only the N,
+   but take as uHash the code SymTable_hashN() returns for the key,
+   for a caller that needed it already, so the key is not hashed
+   again. */
+
+int SymTable_putH(SymTable_T oSymTable, const char *pcKey,
+                  size_t uKeyLength, size_t uHash,
+                  const void *pvValue);
+
+int SymTable_upsertH(SymTable_T oSymTable, const char *pcKey,
+                     size_t uKeyLength, size_t uHash,
+                     const void *pvValue);
+
+void **SymTable_getOrInsertH(SymTable_T oSymTable, const char *pcKey,
+                             size_t uKeyLength, size_t uHash,
+                             const void *pvValue);
+
+void *SymTable_replaceH(SymTable_T oSymTable, const char *pcKey,
+                        size_t uKeyLength, size_t uHash,
+                        const void *pvValue);
+
+int SymTable_containsH(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength, size_t uHash);
+
+void *SymTable_getH(SymTable_T oSymTable, const char *pcKey,
+                    size_t uKeyLength, size_t uHash);
+
+void *SymTable_removeH(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength, size_t uHash);
+
+/* For each i from 0 through uCount-1, set apvValues[i] to the value
+   for apcKeys[i] in oSymTable, or to NULL if it is not present. The
+   hashing implementations hash a group of keys and prefetch the
+   memory each one leads to before probing for any of them, so the
+   cache misses of different keys overlap. */
+void SymTable_getBatch(SymTable_T oSymTable,
+                       const char *const apcKeys[], size_t uCount,
+                       void *apvValues[]);
+
+/* For each i from 0 through uCount-1 in order, insert apcKeys[i] ->
+   apvValues[i] in oSymTable if apcKeys[i] isn't already present,
+   prefetching as SymTable_getBatch() does. Return the number of
+   bindings inserted. */
+size_t SymTable_putBatch(SymTable_T oSymTable,
+                         const char *const apcKeys[],
+                         const void *const apvValues[], size_t uCount);
+
 /* For each binding in oSymTable, call
    pfApply(pcKey, pvValue, pvExtra). */
 void SymTable_map(SymTable_T oSymTable,
@@ -49,4 +362,77 @@ void SymTable_map(SymTable_T oSymTable,
                                   void *pvExtra),
                   const void *pvExtra);
 
+/* A SymTable_Iter is a cursor over the bindings of a SymTable. It
+   lives wherever its caller puts it and needs no freeing. Its fields
+   belong to the implementation. */
+struct SymTable_Iter
+{
+   SymTable_T oSymTable;
+   const void *pvNext;
+   size_t uIndex;
+};
+
+/* Set *psIter before the first binding of oSymTable, finishing any
+   incremental rehash in progress so that lookups move no binding
+   while the iteration lasts. The bindings come in no particular
+   order, except in the tree implementation, which gives them in
+   increasing order of key. Putting or removing bindings, and looking
+   keys up in a list created with iMoveToFront, invalidates *psIter;
+   looking keys up and replacing values otherwise does not. */
+void SymTable_iterBegin(SymTable_T oSymTable,
+                        struct SymTable_Iter *psIter);
+
+/* If *psIter has a binding left, set *ppcKey and *ppvValue to its key
+   and value, move *psIter past it, and return 1. Otherwise return 0.
+   An iteration may stop at any binding, and resume from there later
+   while *psIter is still valid. */
+int SymTable_iterNext(struct SymTable_Iter *psIter,
+                      const char **ppcKey, void **ppvValue);
+
+/* For each binding in oSymTable whose key is at least pcLow and less
+   than pcHigh, in increasing order of key, call
+   pfApply(pcKey, pvValue, pvExtra). Keys are ordered as strcmp()
+   orders them. A NULL pcLow or pcHigh leaves that end of the range
+   open. The tree implementation finds the first key in O(log n) time
+   and visits the others in O(1) time each; the others collect and
+   sort the keys in range, and if out of memory while doing so they
+   call pfApply for none of them. Return 1 if it works, or 0 if out of
+   memory. */
+int SymTable_mapRange(SymTable_T oSymTable,
+                      const char *pcLow, const char *pcHigh,
+                      void (*pfApply)(const char *pcKey,
+                                      void *pvValue,
+                                      void *pvExtra),
+                      const void *pvExtra);
+
+/* Do what SymTable_mapRange() does, but for the bindings whose keys
+   begin with pcPrefix. */
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+                       void (*pfApply)(const char *pcKey,
+                                       void *pvValue,
+                                       void *pvExtra),
+                       const void *pvExtra);
+
+/* Do what SymTable_putBatch() does, but in up to uThreadCount
+   threads, the calling one included. The keys are split so that no
+   two threads touch the same part of the table, and no locks are
+   taken. Small batches use fewer threads, and an implementation that
+   cannot split the work does it all in the calling thread. No other
+   thread may use oSymTable meanwhile. */
+size_t SymTable_putParallel(SymTable_T oSymTable,
+                            const char *const apcKeys[],
+                            const void *const apvValues[],
+                            size_t uCount, size_t uThreadCount);
+
+/* Do what SymTable_map() does, but split the bindings among up to
+   uThreadCount threads, the calling one included. pfApply may run in
+   several threads at once, in no particular order, and must not
+   change oSymTable. Small tables, like those that cannot be split,
+   use fewer threads. */
+void SymTable_mapParallel(SymTable_T oSymTable, size_t uThreadCount,
+                          void (*pfApply)(const char *pcKey,
+                                          void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra);
+
 #endif
@@ -0,0 +1,1560 @@
+/*--------------------------------------------------------------------*/
+/* symtableflat.c                                                     */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include "symhash.h"
+#include "symalloc.h"
+#include "symorder.h"
+#include "symstats.h"
+#include "symthread.h"
+#include "symtrace.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* number of slots in a new SymTable. Must be a power of two. */
+enum { INITIAL_SLOT_COUNT = 16 };
+
+/* a SymTable shrinks to half as many slots once removals leave it
+   with fewer than 1/SHRINK_FACTOR of the bindings that would make it
+   expand, so a length that hovers near a threshold cannot make it
+   resize again and again. */
+enum { SHRINK_FACTOR = 4 };
+
+/* the maximum load factor used by SymTable_new() */
+static const double DEFAULT_MAX_LOAD_FACTOR = 0.875;
+
+/* larger requested load factors are clamped to this, since probe
+   sequences grow without bound as the table fills */
+static const double MAX_MAX_LOAD_FACTOR = 0.95;
+
+/* number of keys the batch functions hash and prefetch for before
+   probing for any of them. */
+enum { BATCH_SIZE = 16 };
+
+/* each thread of the parallel functions is given at least this many
+   slots or keys, so small jobs are not split among more threads than
+   they can keep busy. */
+enum { MIN_WORK_PER_THREAD = 1024 };
+
+/* Hint that the memory at pv will be read soon. A prefetch never
+   faults, so pv may be NULL. */
+#ifdef __GNUC__
+#define PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define PREFETCH(pv) ((void)(pv))
+#endif
+
+/*--------------------------------------------------------------------*/
+/* Each binding is stored inline in a Slot of one contiguous array.   */
+/* A slot whose pcKey is NULL is empty.                               */
+
+struct Slot
+{
+   /* The full (unreduced) hash code of pcKey, and the length of the
+      key string, not counting its NUL. A compact build keeps both in
+      unsigned ints, which share one word. */
+#ifdef SYMTABLE_COMPACT
+   unsigned int uHash;
+   unsigned int uKeyLength;
+#else
+   size_t uHash;
+   size_t uKeyLength;
+#endif
+
+   /* The key string, or NULL if the slot is empty. It lives in the
+      table's key arena, or belongs to the caller if the table
+      borrows its keys. */
+   char *pcKey;
+
+   /* The value associated with the key. */
+   const void *pvValue;
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymTable is an open-addressing hash table that uses Robin Hood   */
+/* linear probing: a binding never sits further from its home slot    */
+/* than the binding it displaced, which keeps probe sequences short   */
+/* and lets unsuccessful lookups stop early.                          */
+
+struct SymTable
+{
+   /* array of uSlotCount slots. */
+   struct Slot *psSlots;
+
+   /* number of slots. Always a power of two. */
+   size_t uSlotCount;
+
+   /* total number of bindings stored. */
+   size_t uLength;
+
+   /* the largest fraction of occupied slots tolerated. */
+   double dMaxLoadFactor;
+
+   /* expand before uLength would exceed this many bindings, and
+      shrink once it falls below uShrinkLength. */
+   size_t uExpandLength;
+   size_t uShrinkLength;
+
+   /* the function that hashes keys, and the seed passed to it. */
+   SymHash_T pfHash;
+   size_t uHashSeed;
+
+   /* where this table's key strings are allocated. */
+   struct SymArena sKeyArena;
+
+   /* nonzero if slots point to the callers' key strings instead of
+      to copies. */
+   int iBorrowKeys;
+
+   /* the trace function and the sampling of lookups for it. */
+   struct SymTrace sTrace;
+
+#ifdef SYMTABLE_STATS
+   /* the counters reported by SymTable_getStats(). */
+   struct SymTable_Stats sStats;
+#endif
+};
+
+/*--------------------------------------------------------------------*/
+/* Return the full hash code of the uKeyLength bytes at pcKey under
+   oSymTable's hash function and seed. The caller reduces it to a
+   slot index by masking. */
+
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey,
+                            size_t uKeyLength)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+#ifdef SYMTABLE_COMPACT
+   /* drop the bits a Slot has no room for, so that every hash code
+      compared with a Slot's is the same width */
+   return (unsigned int)(*oSymTable->pfHash)(pcKey, uKeyLength,
+                                             oSymTable->uHashSeed);
+#else
+   return (*oSymTable->pfHash)(pcKey, uKeyLength,
+                               oSymTable->uHashSeed);
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the distance of the binding in slot uIndex from its home
+   slot in a table whose slot-index mask is uMask. */
+
+static size_t SymTable_probeDistance(const struct Slot *psSlot,
+                                     size_t uIndex, size_t uMask)
+{
+   assert(psSlot != NULL);
+   assert(psSlot->pcKey != NULL);
+
+   return (uIndex - (psSlot->uHash & uMask)) & uMask;
+}
+
+/*--------------------------------------------------------------------*/
+/* allocate an array of uSlotCount empty slots and return it, or      */
+/* return NULL if it doesn't work.                                    */
+
+static struct Slot *SymTable_allocateSlots(size_t uSlotCount)
+{
+   struct Slot *psSlots;
+   size_t u;
+
+   psSlots = (struct Slot*)malloc(uSlotCount * sizeof(struct Slot));
+   if (psSlots == NULL)
+      return NULL;
+
+   for (u = 0; u < uSlotCount; u++)
+      psSlots[u].pcKey = NULL;
+
+   return psSlots;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the index of the slot in oSymTable that holds the key of
+   uKeyLength bytes at pcKey, whose hash code is uHash, or return
+   oSymTable->uSlotCount if that key is not present. */
+
+static size_t SymTable_search(SymTable_T oSymTable, const char *pcKey,
+                              size_t uKeyLength, size_t uHash)
+{
+   size_t uMask;
+   size_t uIndex;
+   size_t uDistance;
+   struct Slot *psSlot;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uMask = oSymTable->uSlotCount - 1U;
+   uIndex = uHash & uMask;
+
+   SYMSTATS_ADD(oSymTable->sStats.uLookups, 1U);
+   for (uDistance = 0; ; uDistance++)
+   {
+      psSlot = &oSymTable->psSlots[uIndex];
+      SYMSTATS_ADD(oSymTable->sStats.uProbes, 1U);
+
+      /* an empty slot, or a binding closer to its home slot than we
+         are to ours, means pcKey would have been placed before it */
+      if (psSlot->pcKey == NULL)
+         return oSymTable->uSlotCount;
+      if (SymTable_probeDistance(psSlot, uIndex, uMask) < uDistance)
+         return oSymTable->uSlotCount;
+
+      /* compare the hash codes and the lengths first, so the bytes
+         are compared only on a likely match */
+      if (psSlot->uHash == uHash && psSlot->uKeyLength == uKeyLength)
+      {
+         SYMSTATS_ADD(oSymTable->sStats.uKeyCompares, 1U);
+         if (memcmp(psSlot->pcKey, pcKey, uKeyLength) == 0)
+         {
+            SYMSTATS_ADD(oSymTable->sStats.uHits, 1U);
+            return uIndex;
+         }
+      }
+
+      uIndex = (uIndex + 1U) & uMask;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the number of slots that SymTable_search() examined in
+   oSymTable to find the key whose hash code is uHash in slot uFound,
+   or to find that it is absent if uFound is oSymTable->uSlotCount. */
+
+static size_t SymTable_countProbes(SymTable_T oSymTable, size_t uHash,
+                                   size_t uFound)
+{
+   size_t uMask;
+   size_t uIndex;
+   size_t uDistance;
+
+   assert(oSymTable != NULL);
+
+   uMask = oSymTable->uSlotCount - 1U;
+   if (uFound != oSymTable->uSlotCount)
+      return SymTable_probeDistance(&oSymTable->psSlots[uFound],
+                                    uFound, uMask) + 1U;
+
+   uIndex = uHash & uMask;
+   for (uDistance = 0; ; uDistance++)
+   {
+      if (oSymTable->psSlots[uIndex].pcKey == NULL ||
+          SymTable_probeDistance(&oSymTable->psSlots[uIndex], uIndex,
+                                 uMask) < uDistance)
+         return uDistance + 1U;
+      uIndex = (uIndex + 1U) & uMask;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/* Return what SymTable_search() returns for the key of uKeyLength
+   bytes at pcKey, whose hash code is uHash, reporting the lookup to
+   oSymTable's trace function if it is sampled. */
+
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey,
+                            size_t uKeyLength, size_t uHash)
+{
+   size_t uIndex;
+   double dStart;
+   double dSeconds;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   if (!SYMTRACE_SAMPLED(&oSymTable->sTrace))
+      return SymTable_search(oSymTable, pcKey, uKeyLength, uHash);
+
+   dStart = SymTrace_now();
+   uIndex = SymTable_search(oSymTable, pcKey, uKeyLength, uHash);
+   dSeconds = SymTrace_now() - dStart;
+
+   SymTrace_lookup(&oSymTable->sTrace, oSymTable, pcKey, uKeyLength,
+                   uIndex != oSymTable->uSlotCount,
+                   SymTable_countProbes(oSymTable, uHash, uIndex),
+                   dSeconds);
+   return uIndex;
+}
+
+/*--------------------------------------------------------------------*/
+/* Place the binding described by sSlot into the slot array psSlots
+   of uSlotCount slots, and return the index of the slot it lands in.
+   The key must not already be present, and the array must have at
+   least one empty slot. */
+
+static size_t SymTable_insertSlot(struct Slot *psSlots,
+                                  size_t uSlotCount, struct Slot sSlot)
+{
+   size_t uMask;
+   size_t uIndex;
+   size_t uDistance;
+   size_t uOtherDistance;
+   size_t uLanded;
+   struct Slot sTemp;
+
+   assert(psSlots != NULL);
+   assert(sSlot.pcKey != NULL);
+
+   uMask = uSlotCount - 1U;
+   uIndex = sSlot.uHash & uMask;
+   uDistance = 0;
+   uLanded = uSlotCount;
+
+   while (psSlots[uIndex].pcKey != NULL)
+   {
+      /* take the slot from a binding that is closer to home, and
+         carry that binding forward instead */
+      uOtherDistance =
+         SymTable_probeDistance(&psSlots[uIndex], uIndex, uMask);
+      if (uOtherDistance < uDistance)
+      {
+         /* the first swap is where the new binding stays */
+         if (uLanded == uSlotCount)
+            uLanded = uIndex;
+         sTemp = psSlots[uIndex];
+         psSlots[uIndex] = sSlot;
+         sSlot = sTemp;
+         uDistance = uOtherDistance;
+      }
+
+      uIndex = (uIndex + 1U) & uMask;
+      uDistance++;
+   }
+
+   psSlots[uIndex] = sSlot;
+   if (uLanded == uSlotCount)
+      uLanded = uIndex;
+   return uLanded;
+}
+
+/*--------------------------------------------------------------------*/
+/* Set oSymTable's expansion and shrinking thresholds for its current */
+/* slot count. At least one slot always stays empty.                  */
+
+static void SymTable_setExpandLength(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   oSymTable->uExpandLength = (size_t)((double)oSymTable->uSlotCount *
+                                       oSymTable->dMaxLoadFactor);
+   if (oSymTable->uExpandLength >= oSymTable->uSlotCount)
+      oSymTable->uExpandLength = oSymTable->uSlotCount - 1U;
+
+   oSymTable->uShrinkLength = 0U;
+   if (oSymTable->uSlotCount > (size_t)INITIAL_SLOT_COUNT)
+      oSymTable->uShrinkLength =
+         oSymTable->uExpandLength / SHRINK_FACTOR;
+}
+
+/*--------------------------------------------------------------------*/
+/* Move oSymTable to a new array of uNewSlotCount slots, reinserting  */
+/* every binding using its stored hash code. Return 1 if successful,  */
+/* or 0 if allocation fails.                                          */
+
+static int SymTable_resize(SymTable_T oSymTable, size_t uNewSlotCount)
+{
+   struct Slot *psNewSlots;
+   size_t u;
+   SymStats_Clock tStart;
+
+   assert(oSymTable != NULL);
+   assert(uNewSlotCount > oSymTable->uLength);
+
+   SYMSTATS_START(tStart);
+   psNewSlots = SymTable_allocateSlots(uNewSlotCount);
+   if (psNewSlots == NULL)
+      return 0;
+   SymTrace_beginResize(&oSymTable->sTrace, oSymTable,
+                        oSymTable->uLength, oSymTable->uSlotCount,
+                        uNewSlotCount);
+
+   for (u = 0; u < oSymTable->uSlotCount; u++)
+      if (oSymTable->psSlots[u].pcKey != NULL)
+         (void)SymTable_insertSlot(psNewSlots, uNewSlotCount,
+                                   oSymTable->psSlots[u]);
+
+   free(oSymTable->psSlots);
+   oSymTable->psSlots = psNewSlots;
+   oSymTable->uSlotCount = uNewSlotCount;
+   SymTable_setExpandLength(oSymTable);
+   SymTrace_endResize(&oSymTable->sTrace, oSymTable, oSymTable->uLength,
+                      uNewSlotCount);
+
+   SYMSTATS_STOP(oSymTable->sStats.dResizeSeconds, tStart);
+   SYMSTATS_ADD(oSymTable->sStats.uResizes, 1U);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/* expand oSymTable to twice as many slots. if allocation fails, skip */
+/* expansion.                                                         */
+
+static void SymTable_expand(SymTable_T oSymTable)
+{
+   size_t uNewSlotCount;
+
+   assert(oSymTable != NULL);
+
+   uNewSlotCount = oSymTable->uSlotCount * 2U;
+   if (uNewSlotCount > (size_t)-1 / sizeof(struct Slot))
+      return;
+
+   (void)SymTable_resize(oSymTable, uNewSlotCount);
+}
+
+/*--------------------------------------------------------------------*/
+/* shrink oSymTable to half as many slots if removals have left       */
+/* uLength below the limit that allows. if allocation fails, skip     */
+/* shrinking.                                                         */
+
+static void SymTable_shrink(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   if (oSymTable->uLength >= oSymTable->uShrinkLength)
+      return;
+
+   (void)SymTable_resize(oSymTable, oSymTable->uSlotCount / 2U);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the smallest slot count, a power of two no less than        */
+/* uSlotCount, whose load factor limit admits uLength bindings in     */
+/* oSymTable, or 0 if no such array fits.                             */
+
+static size_t SymTable_fitSlotCount(SymTable_T oSymTable,
+                                    size_t uSlotCount, size_t uLength)
+{
+   assert(oSymTable != NULL);
+
+   while ((double)uSlotCount * oSymTable->dMaxLoadFactor <
+             (double)uLength ||
+          uSlotCount <= uLength)
+   {
+      if (uSlotCount > (size_t)-1 / sizeof(struct Slot) / 2U)
+         return 0U;
+      uSlotCount *= 2U;
+   }
+   return uSlotCount;
+}
+
+/*--------------------------------------------------------------------*/
+/* Grow oSymTable at once to the smallest slot count, a power of two, */
+/* whose load factor limit admits uLength bindings. Return 1 if       */
+/* successful, or 0 if no such array fits or allocation fails.        */
+
+static int SymTable_growTo(SymTable_T oSymTable, size_t uLength)
+{
+   size_t uNewSlotCount;
+
+   assert(oSymTable != NULL);
+
+   uNewSlotCount =
+      SymTable_fitSlotCount(oSymTable, oSymTable->uSlotCount, uLength);
+   if (uNewSlotCount == 0U)
+      return 0;
+   if (uNewSlotCount == oSymTable->uSlotCount)
+      return 1;
+   return SymTable_resize(oSymTable, uNewSlotCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_initOptions(struct SymTable_Options *psOptions)
+{
+   assert(psOptions != NULL);
+
+   psOptions->dMaxLoadFactor = DEFAULT_MAX_LOAD_FACTOR;
+   psOptions->uRehashStep = 0U;
+   psOptions->pfHash = NULL;
+   psOptions->uHashSeed = 0U;
+   psOptions->iBorrowKeys = 0;
+   psOptions->iMoveToFront = 0;
+   psOptions->pfTrace = NULL;
+   psOptions->pvTraceExtra = NULL;
+   psOptions->uTraceSampleInterval = 1024U;
+   psOptions->dTraceMinSeconds = 0.0;
+   psOptions->uTraceMinProbes = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void)
+{
+   struct SymTable_Options sOptions;
+
+   SymTable_initOptions(&sOptions);
+   return SymTable_newWithOptions(&sOptions);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithOptions(
+   const struct SymTable_Options *psOptions)
+{
+   SymTable_T oSymTable;
+
+   assert(psOptions != NULL);
+   assert(psOptions->dMaxLoadFactor > 0.0);
+
+   oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+   if (oSymTable == NULL)
+      return NULL;
+
+   oSymTable->uSlotCount = INITIAL_SLOT_COUNT;
+   oSymTable->psSlots = SymTable_allocateSlots(oSymTable->uSlotCount);
+   if (oSymTable->psSlots == NULL)
+   {
+      free(oSymTable);
+      return NULL;
+   }
+
+   oSymTable->dMaxLoadFactor = psOptions->dMaxLoadFactor;
+   if (oSymTable->dMaxLoadFactor > MAX_MAX_LOAD_FACTOR)
+      oSymTable->dMaxLoadFactor = MAX_MAX_LOAD_FACTOR;
+   SymTable_setExpandLength(oSymTable);
+
+   oSymTable->pfHash = psOptions->pfHash;
+   if (oSymTable->pfHash == NULL)
+      oSymTable->pfHash = SymHash_word;
+   oSymTable->uHashSeed = psOptions->uHashSeed;
+   oSymTable->iBorrowKeys = psOptions->iBorrowKeys;
+
+   SymArena_init(&oSymTable->sKeyArena);
+   SymTrace_init(&oSymTable->sTrace, psOptions);
+#ifdef SYMTABLE_STATS
+   SymStats_init(&oSymTable->sStats);
+#endif
+
+   oSymTable->uLength = 0U;
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCount)
+{
+   SymTable_T oSymTable;
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+      return NULL;
+
+   if (!SymTable_reserve(oSymTable, uCount))
+   {
+      SymTable_free(oSymTable);
+      return NULL;
+   }
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   /* free all the key strings at once, then the slot array and the
+      table */
+   SymArena_destroy(&oSymTable->sKeyArena);
+   free(oSymTable->psSlots);
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+   return oSymTable->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_compact(SymTable_T oSymTable)
+{
+   size_t uNewSlotCount;
+
+   assert(oSymTable != NULL);
+
+   uNewSlotCount = SymTable_fitSlotCount(oSymTable, INITIAL_SLOT_COUNT,
+                                         oSymTable->uLength);
+   if (uNewSlotCount == 0U ||
+       uNewSlotCount >= oSymTable->uSlotCount)
+      return 1;
+   return SymTable_resize(oSymTable, uNewSlotCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCount)
+{
+   assert(oSymTable != NULL);
+
+   if (uCount <= oSymTable->uLength)
+      return 1;
+   return SymTable_growTo(oSymTable, uCount);
+}
+
+/*--------------------------------------------------------------------*/
+/* Insert a new binding of the uKeyLength bytes at pcKey, whose full  */
+/* hash code is uHash, to pvValue in oSymTable, and return the index  */
+/* of its slot, or return oSymTable->uSlotCount if out of memory, or, */
+/* in a compact build, if uKeyLength is too large for a Slot. The key */
+/* must not already be present.                                       */
+
+static size_t SymTable_insert(SymTable_T oSymTable, const char *pcKey,
+                              size_t uKeyLength, size_t uHash,
+                              const void *pvValue)
+{
+   struct Slot sSlot;
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+#ifdef SYMTABLE_COMPACT
+   if (uKeyLength > UINT_MAX)
+      return oSymTable->uSlotCount;
+#endif
+
+   /* make room first, so the new binding never fills the last slot */
+   if (oSymTable->uLength + 1U > oSymTable->uExpandLength)
+   {
+      SymTable_expand(oSymTable);
+      if (oSymTable->uLength + 1U >= oSymTable->uSlotCount)
+         return oSymTable->uSlotCount;
+   }
+
+   /* a copy of the key is always NUL-terminated */
+   if (oSymTable->iBorrowKeys)
+   {
+      assert(pcKey[uKeyLength] == '\0');
+      sSlot.pcKey = (char*)pcKey;
+   }
+   else
+   {
+      sSlot.pcKey =
+         SymArena_alloc(&oSymTable->sKeyArena, uKeyLength + 1U);
+      if (sSlot.pcKey == NULL)
+         return oSymTable->uSlotCount;
+      memcpy(sSlot.pcKey, pcKey, uKeyLength);
+      sSlot.pcKey[uKeyLength] = '\0';
+   }
+   sSlot.uHash = uHash;
+   sSlot.uKeyLength = uKeyLength;
+   sSlot.pvValue = pvValue;
+
+   uIndex = SymTable_insertSlot(oSymTable->psSlots,
+                                oSymTable->uSlotCount, sSlot);
+   oSymTable->uLength++;
+
+   return uIndex;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_hashN(SymTable_T oSymTable, const char *pcKey,
+                      size_t uKeyLength)
+{
+   return SymTable_hash(oSymTable, pcKey, uKeyLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putH(SymTable_T oSymTable, const char *pcKey,
+                  size_t uKeyLength, size_t uHash,
+                  const void *pvValue)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   /* return 0 if key already exists */
+   if (SymTable_find(oSymTable, pcKey, uKeyLength, uHash) !=
+       oSymTable->uSlotCount)
+      return 0;
+
+   return SymTable_insert(oSymTable, pcKey, uKeyLength, uHash,
+                          pvValue) != oSymTable->uSlotCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+                  size_t uKeyLength, const void *pvValue)
+{
+   return SymTable_putH(oSymTable, pcKey, uKeyLength,
+                        SymTable_hash(oSymTable, pcKey, uKeyLength),
+                        pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+                 const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertH(SymTable_T oSymTable, const char *pcKey,
+                     size_t uKeyLength, size_t uHash,
+                     const void *pvValue)
+{
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uIndex = SymTable_find(oSymTable, pcKey, uKeyLength, uHash);
+   if (uIndex != oSymTable->uSlotCount)
+   {
+      oSymTable->psSlots[uIndex].pvValue = pvValue;
+      return 1;
+   }
+
+   return SymTable_insert(oSymTable, pcKey, uKeyLength, uHash,
+                          pvValue) != oSymTable->uSlotCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertN(SymTable_T oSymTable, const char *pcKey,
+                     size_t uKeyLength, const void *pvValue)
+{
+   return SymTable_upsertH(oSymTable, pcKey, uKeyLength,
+                           SymTable_hash(oSymTable, pcKey, uKeyLength),
+                           pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsert(SymTable_T oSymTable,
+                    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_upsertN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsertH(SymTable_T oSymTable, const char *pcKey,
+                             size_t uKeyLength, size_t uHash,
+                             const void *pvValue)
+{
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uIndex = SymTable_find(oSymTable, pcKey, uKeyLength, uHash);
+   if (uIndex == oSymTable->uSlotCount)
+   {
+      uIndex = SymTable_insert(oSymTable, pcKey, uKeyLength, uHash,
+                               pvValue);
+      if (uIndex == oSymTable->uSlotCount)
+         return NULL;
+   }
+
+   return (void**)&oSymTable->psSlots[uIndex].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsertN(SymTable_T oSymTable, const char *pcKey,
+                             size_t uKeyLength, const void *pvValue)
+{
+   return SymTable_getOrInsertH(oSymTable, pcKey, uKeyLength,
+                                SymTable_hash(oSymTable, pcKey,
+                                              uKeyLength),
+                                pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+                            const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_getOrInsertN(oSymTable, pcKey, strlen(pcKey),
+                                pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceH(SymTable_T oSymTable, const char *pcKey,
+                        size_t uKeyLength, size_t uHash,
+                        const void *pvValue)
+{
+   size_t uIndex;
+   const void *pvOldValue;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uIndex = SymTable_find(oSymTable, pcKey, uKeyLength, uHash);
+   if (uIndex == oSymTable->uSlotCount)
+      return NULL;
+
+   pvOldValue = oSymTable->psSlots[uIndex].pvValue;
+   oSymTable->psSlots[uIndex].pvValue = pvValue;
+   return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable, const char *pcKey,
+                        size_t uKeyLength, const void *pvValue)
+{
+   return SymTable_replaceH(oSymTable, pcKey, uKeyLength,
+                            SymTable_hash(oSymTable, pcKey, uKeyLength),
+                            pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+                       const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsH(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength, size_t uHash)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_find(oSymTable, pcKey, uKeyLength, uHash) !=
+          oSymTable->uSlotCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength)
+{
+   return SymTable_containsH(oSymTable, pcKey, uKeyLength,
+                             SymTable_hash(oSymTable, pcKey,
+                                           uKeyLength));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getH(SymTable_T oSymTable, const char *pcKey,
+                    size_t uKeyLength, size_t uHash)
+{
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uIndex = SymTable_find(oSymTable, pcKey, uKeyLength, uHash);
+   if (uIndex == oSymTable->uSlotCount)
+      return NULL;
+
+   return (void*)oSymTable->psSlots[uIndex].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+                    size_t uKeyLength)
+{
+   return SymTable_getH(oSymTable, pcKey, uKeyLength,
+                        SymTable_hash(oSymTable, pcKey, uKeyLength));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeH(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength, size_t uHash)
+{
+   size_t uMask;
+   size_t uIndex;
+   size_t uNext;
+   const void *pvValue;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uIndex = SymTable_find(oSymTable, pcKey, uKeyLength, uHash);
+   if (uIndex == oSymTable->uSlotCount)
+      return NULL;
+
+   pvValue = oSymTable->psSlots[uIndex].pvValue;
+   if (!oSymTable->iBorrowKeys)
+      SymArena_release(&oSymTable->sKeyArena,
+                       oSymTable->psSlots[uIndex].pcKey,
+                       oSymTable->psSlots[uIndex].uKeyLength + 1U);
+
+   /* shift the following bindings back one slot until one is empty
+      or already in its home slot, so no tombstones are needed */
+   uMask = oSymTable->uSlotCount - 1U;
+   for (;;)
+   {
+      uNext = (uIndex + 1U) & uMask;
+      if (oSymTable->psSlots[uNext].pcKey == NULL ||
+          SymTable_probeDistance(&oSymTable->psSlots[uNext],
+                                 uNext, uMask) == 0U)
+         break;
+
+      oSymTable->psSlots[uIndex] = oSymTable->psSlots[uNext];
+      uIndex = uNext;
+   }
+   oSymTable->psSlots[uIndex].pcKey = NULL;
+
+   assert(oSymTable->uLength > 0U);
+   oSymTable->uLength--;
+   SymTable_shrink(oSymTable);
+
+   return (void*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength)
+{
+   return SymTable_removeH(oSymTable, pcKey, uKeyLength,
+                           SymTable_hash(oSymTable, pcKey, uKeyLength));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_removeIf(SymTable_T oSymTable,
+                         int (*pfPredicate)(const char *pcKey,
+                                            void *pvValue,
+                                            void *pvExtra),
+                         void (*pfRelease)(const char *pcKey,
+                                           void *pvValue,
+                                           void *pvExtra),
+                         const void *pvExtra)
+{
+   struct Slot *psSlot;
+   size_t uMask;
+   size_t uStart;
+   size_t uIndex;
+   size_t uFree;
+   size_t uDistance;
+   size_t uRemoved = 0U;
+   size_t u;
+   int iHaveFree;
+
+   assert(oSymTable != NULL);
+   assert(pfPredicate != NULL);
+
+   /* start just past an empty slot, of which there is always one, so
+      that no run of bindings wraps around past the start */
+   uMask = oSymTable->uSlotCount - 1U;
+   for (uStart = 0; oSymTable->psSlots[uStart].pcKey != NULL; uStart++)
+      ;
+
+   /* empty the chosen slots as the scan reaches them, and move each
+      binding that stays back to the first empty slot from its home
+      slot on. bindings keep their order, so every probe sequence
+      stays unbroken, and no binding is looked at twice */
+   iHaveFree = 0;
+   uFree = 0U;
+   for (u = 1U; u < oSymTable->uSlotCount; u++)
+   {
+      uIndex = (uStart + u) & uMask;
+      psSlot = &oSymTable->psSlots[uIndex];
+      if (psSlot->pcKey == NULL)
+      {
+         if (!iHaveFree)
+            uFree = uIndex;
+         iHaveFree = 1;
+         continue;
+      }
+
+      if ((*pfPredicate)(psSlot->pcKey, (void*)psSlot->pvValue,
+                         (void*)pvExtra))
+      {
+         if (pfRelease != NULL)
+            (*pfRelease)(psSlot->pcKey, (void*)psSlot->pvValue,
+                         (void*)pvExtra);
+         if (!oSymTable->iBorrowKeys)
+            SymArena_release(&oSymTable->sKeyArena, psSlot->pcKey,
+                             psSlot->uKeyLength + 1U);
+         psSlot->pcKey = NULL;
+         uRemoved++;
+         if (!iHaveFree)
+            uFree = uIndex;
+         iHaveFree = 1;
+         continue;
+      }
+
+      /* a binding in its home slot stays, and so must the bindings
+         after it in its run until the next empty slot */
+      uDistance = SymTable_probeDistance(psSlot, uIndex, uMask);
+      if (!iHaveFree || uDistance == 0U)
+      {
+         iHaveFree = 0;
+         continue;
+      }
+
+      /* every slot from uFree up to uIndex is empty, so the binding
+         moves to the first of them not before its home slot */
+      if (((uIndex - uFree) & uMask) > uDistance)
+         uFree = (uIndex - uDistance) & uMask;
+      oSymTable->psSlots[uFree] = *psSlot;
+      psSlot->pcKey = NULL;
+      uFree = (uFree + 1U) & uMask;
+   }
+
+   assert(oSymTable->uLength >= uRemoved);
+   oSymTable->uLength -= uRemoved;
+
+   /* a sweep may leave the table far below the length that would
+      shrink it one step, so fit it to what is left at once */
+   if (oSymTable->uLength < oSymTable->uShrinkLength)
+      (void)SymTable_compact(oSymTable);
+
+   return uRemoved;
+}
+
+/*--------------------------------------------------------------------*/
+/* Hash the uCount keys apcKeys[0..uCount-1], storing their lengths   */
+/* in auLengths and their hash codes in auHashes, and prefetch their  */
+/* home slots and then the keys stored there, so the cache misses of  */
+/* all the keys overlap. uCount must not exceed BATCH_SIZE.           */
+
+static void SymTable_prepareBatch(SymTable_T oSymTable,
+                                  const char *const apcKeys[],
+                                  size_t uCount, size_t auLengths[],
+                                  size_t auHashes[])
+{
+   size_t uMask;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL);
+   assert(uCount <= (size_t)BATCH_SIZE);
+
+   uMask = oSymTable->uSlotCount - 1U;
+   for (u = 0; u < uCount; u++)
+   {
+      assert(apcKeys[u] != NULL);
+      auLengths[u] = strlen(apcKeys[u]);
+      auHashes[u] = SymTable_hash(oSymTable, apcKeys[u], auLengths[u]);
+      PREFETCH(&oSymTable->psSlots[auHashes[u] & uMask]);
+   }
+
+   for (u = 0; u < uCount; u++)
+      PREFETCH(oSymTable->psSlots[auHashes[u] & uMask].pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable,
+                       const char *const apcKeys[], size_t uCount,
+                       void *apvValues[])
+{
+   size_t auLengths[BATCH_SIZE];
+   size_t auHashes[BATCH_SIZE];
+   size_t uIndex;
+   size_t uFirst;
+   size_t uGroup;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0U);
+   assert(apvValues != NULL || uCount == 0U);
+
+   for (uFirst = 0; uFirst < uCount; uFirst += uGroup)
+   {
+      uGroup = uCount - uFirst;
+      if (uGroup > (size_t)BATCH_SIZE)
+         uGroup = BATCH_SIZE;
+
+      SymTable_prepareBatch(oSymTable, &apcKeys[uFirst], uGroup,
+                            auLengths, auHashes);
+
+      for (u = 0; u < uGroup; u++)
+      {
+         uIndex = SymTable_find(oSymTable, apcKeys[uFirst + u],
+                                auLengths[u], auHashes[u]);
+         apvValues[uFirst + u] =
+            uIndex == oSymTable->uSlotCount ?
+               NULL : (void*)oSymTable->psSlots[uIndex].pvValue;
+      }
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable,
+                         const char *const apcKeys[],
+                         const void *const apvValues[], size_t uCount)
+{
+   size_t auLengths[BATCH_SIZE];
+   size_t auHashes[BATCH_SIZE];
+   size_t uPutCount;
+   size_t uFirst;
+   size_t uGroup;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0U);
+   assert(apvValues != NULL || uCount == 0U);
+
+   uPutCount = 0U;
+   for (uFirst = 0; uFirst < uCount; uFirst += uGroup)
+   {
+      uGroup = uCount - uFirst;
+      if (uGroup > (size_t)BATCH_SIZE)
+         uGroup = BATCH_SIZE;
+
+      SymTable_prepareBatch(oSymTable, &apcKeys[uFirst], uGroup,
+                            auLengths, auHashes);
+
+      /* an expansion partway through leaves the prefetches stale,
+         which costs only their benefit */
+      for (u = 0; u < uGroup; u++)
+      {
+         if (SymTable_find(oSymTable, apcKeys[uFirst + u],
+                           auLengths[u], auHashes[u]) ==
+                oSymTable->uSlotCount &&
+             SymTable_insert(oSymTable, apcKeys[uFirst + u],
+                             auLengths[u], auHashes[u],
+                             apvValues[uFirst + u]) !=
+                oSymTable->uSlotCount)
+            uPutCount++;
+      }
+   }
+
+   return uPutCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey,
+                                  void *pvValue,
+                                  void *pvExtra),
+                  const void *pvExtra)
+{
+   size_t u;
+   struct Slot *psSlot;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   for (u = 0; u < oSymTable->uSlotCount; u++)
+   {
+      psSlot = &oSymTable->psSlots[u];
+
+      /* call pfApply for each occupied slot */
+      if (psSlot->pcKey != NULL)
+         (*pfApply)(psSlot->pcKey,
+                    (void*)psSlot->pvValue,
+                    (void*)pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable,
+                        struct SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->pvNext = NULL;
+   psIter->uIndex = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(struct SymTable_Iter *psIter,
+                      const char **ppcKey, void **ppvValue)
+{
+   SymTable_T oSymTable;
+   const struct Slot *psSlot;
+
+   assert(psIter != NULL);
+   assert(psIter->oSymTable != NULL);
+   assert(ppcKey != NULL);
+   assert(ppvValue != NULL);
+
+   /* uIndex is the next slot to look at */
+   oSymTable = psIter->oSymTable;
+   while (psIter->uIndex < oSymTable->uSlotCount)
+   {
+      psSlot = &oSymTable->psSlots[psIter->uIndex];
+      psIter->uIndex++;
+      if (psSlot->pcKey != NULL)
+      {
+         *ppcKey = psSlot->pcKey;
+         *ppvValue = (void*)psSlot->pvValue;
+         return 1;
+      }
+   }
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getStats(SymTable_T oSymTable,
+                       struct SymTable_Stats *psStats)
+{
+   size_t uMask;
+   size_t uStart;
+   size_t uIndex;
+   size_t uHome;
+   size_t uLength;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(psStats != NULL);
+
+#ifdef SYMTABLE_STATS
+   *psStats = oSymTable->sStats;
+#else
+   SymStats_init(psStats);
+#endif
+
+   /* Robin Hood probing keeps the bindings of each home slot next to
+      each other, in order of home slot, so a walk around the array
+      that starts at an empty slot meets each chain in one piece */
+   uMask = oSymTable->uSlotCount - 1U;
+   for (uStart = 0; oSymTable->psSlots[uStart].pcKey != NULL; uStart++)
+      ;
+
+   uHome = uStart;
+   uLength = 0U;
+   for (u = 1; u <= oSymTable->uSlotCount; u++)
+   {
+      uIndex = (uStart + u) & uMask;
+      if (oSymTable->psSlots[uIndex].pcKey == NULL)
+         continue;
+      while (uHome != (oSymTable->psSlots[uIndex].uHash & uMask))
+      {
+         SymStats_addChain(psStats, uLength);
+         uHome = (uHome + 1U) & uMask;
+         uLength = 0U;
+      }
+      uLength++;
+   }
+
+   /* the home slots after the last binding's have empty chains */
+   for (;;)
+   {
+      SymStats_addChain(psStats, uLength);
+      uHome = (uHome + 1U) & uMask;
+      if (uHome == uStart)
+         break;
+      uLength = 0U;
+   }
+   SymStats_finish(psStats, oSymTable->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_memoryUsage(SymTable_T oSymTable,
+                            struct SymTable_Memory *psMemory)
+{
+   struct SymTable_Memory sMemory;
+   size_t u;
+
+   assert(oSymTable != NULL);
+
+   /* the slots are the index as well as the bindings' records, and
+      the empty ones are slack */
+   sMemory.uTableBytes = sizeof(struct SymTable);
+   sMemory.uIndexBytes = 0U;
+   sMemory.uBindingBytes = oSymTable->uLength * sizeof(struct Slot);
+
+   sMemory.uKeyBytes = 0U;
+   if (!oSymTable->iBorrowKeys)
+      for (u = 0; u < oSymTable->uSlotCount; u++)
+         if (oSymTable->psSlots[u].pcKey != NULL)
+            sMemory.uKeyBytes += oSymTable->psSlots[u].uKeyLength + 1U;
+
+   return SymStats_finishMemory(
+      &sMemory,
+      sMemory.uTableBytes +
+         oSymTable->uSlotCount * sizeof(struct Slot) +
+         SymArena_getFootprint(&oSymTable->sKeyArena),
+      psMemory);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapRange(SymTable_T oSymTable,
+                      const char *pcLow, const char *pcHigh,
+                      void (*pfApply)(const char *pcKey,
+                                      void *pvValue,
+                                      void *pvExtra),
+                      const void *pvExtra)
+{
+   /* hashing scatters neighboring keys, so they are sorted here */
+   return SymOrder_mapRange(oSymTable, pcLow, pcHigh, pfApply,
+                            pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+                       void (*pfApply)(const char *pcKey,
+                                       void *pvValue,
+                                       void *pvExtra),
+                       const void *pvExtra)
+{
+   return SymOrder_mapPrefix(oSymTable, pcPrefix, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the number of threads to split uWorkCount slots or keys     */
+/* among, given a limit of uThreadCount.                              */
+
+static size_t SymTable_threadCount(size_t uThreadCount,
+                                   size_t uWorkCount)
+{
+   if (uThreadCount > uWorkCount / MIN_WORK_PER_THREAD)
+      uThreadCount = uWorkCount / MIN_WORK_PER_THREAD;
+   if (uThreadCount == 0U)
+      uThreadCount = 1U;
+   return uThreadCount;
+}
+
+/*--------------------------------------------------------------------*/
+/* One thread's share of a SymTable_mapParallel() call.               */
+
+struct MapWork
+{
+   /* the table being mapped. */
+   SymTable_T oSymTable;
+
+   /* this thread visits psSlots[uFirst] through psSlots[uLast-1]. */
+   size_t uFirst;
+   size_t uLast;
+
+   /* the arguments of SymTable_mapParallel(). */
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+   const void *pvExtra;
+};
+
+/*--------------------------------------------------------------------*/
+/* Do the work *(struct MapWork*)pvWork, and return NULL.             */
+
+static void *SymTable_mapWork(void *pvWork)
+{
+   struct MapWork *psWork;
+   struct Slot *psSlot;
+   size_t u;
+
+   assert(pvWork != NULL);
+
+   psWork = (struct MapWork*)pvWork;
+   for (u = psWork->uFirst; u < psWork->uLast; u++)
+   {
+      psSlot = &psWork->oSymTable->psSlots[u];
+      if (psSlot->pcKey != NULL)
+         (*psWork->pfApply)(psSlot->pcKey,
+                            (void*)psSlot->pvValue,
+                            (void*)psWork->pvExtra);
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable, size_t uThreadCount,
+                          void (*pfApply)(const char *pcKey,
+                                          void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra)
+{
+   struct MapWork *psWorks;
+   size_t uShare;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   uThreadCount =
+      SymTable_threadCount(uThreadCount, oSymTable->uSlotCount);
+   psWorks = NULL;
+   if (uThreadCount > 1U)
+      psWorks = (struct MapWork*)malloc(uThreadCount *
+                                        sizeof(struct MapWork));
+   if (psWorks == NULL)
+   {
+      SymTable_map(oSymTable, pfApply, pvExtra);
+      return;
+   }
+
+   uShare = (oSymTable->uSlotCount + uThreadCount - 1U) / uThreadCount;
+   for (u = 0; u < uThreadCount; u++)
+   {
+      psWorks[u].oSymTable = oSymTable;
+      psWorks[u].uFirst = u * uShare;
+      psWorks[u].uLast = psWorks[u].uFirst + uShare;
+      if (psWorks[u].uLast > oSymTable->uSlotCount)
+         psWorks[u].uLast = oSymTable->uSlotCount;
+      psWorks[u].pfApply = pfApply;
+      psWorks[u].pvExtra = pvExtra;
+   }
+
+   SymThread_runAll(SymTable_mapWork, psWorks, sizeof(struct MapWork),
+                    uThreadCount);
+   free(psWorks);
+}
+
+/*--------------------------------------------------------------------*/
+/* One thread's share of the hashing for a SymTable_putParallel()     */
+/* call.                                                              */
+
+struct HashWork
+{
+   /* the table being loaded. */
+   SymTable_T oSymTable;
+
+   /* all the keys being put, and their lengths and hash codes. */
+   const char *const *apcKeys;
+   size_t *auLengths;
+   size_t *auHashes;
+
+   /* this thread measures and hashes apcKeys[uFirst] through
+      apcKeys[uLast-1]. */
+   size_t uFirst;
+   size_t uLast;
+};
+
+/*--------------------------------------------------------------------*/
+/* Do the work *(struct HashWork*)pvWork, and return NULL.            */
+
+static void *SymTable_hashWork(void *pvWork)
+{
+   struct HashWork *psWork;
+   size_t u;
+
+   assert(pvWork != NULL);
+
+   psWork = (struct HashWork*)pvWork;
+   for (u = psWork->uFirst; u < psWork->uLast; u++)
+   {
+      assert(psWork->apcKeys[u] != NULL);
+      psWork->auLengths[u] = strlen(psWork->apcKeys[u]);
+      psWork->auHashes[u] = SymTable_hash(psWork->oSymTable,
+                                          psWork->apcKeys[u],
+                                          psWork->auLengths[u]);
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putParallel(SymTable_T oSymTable,
+                            const char *const apcKeys[],
+                            const void *const apvValues[],
+                            size_t uCount, size_t uThreadCount)
+{
+   struct HashWork *psWorks;
+   size_t *auLengths;
+   size_t *auHashes;
+   size_t uMask;
+   size_t uShare;
+   size_t uPutCount;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0U);
+   assert(apvValues != NULL || uCount == 0U);
+
+   /* a Robin Hood insertion may displace bindings any distance along
+      the array, so only the hashing is split among threads. Make room
+      for every key first, so the placement never expands */
+   uThreadCount = SymTable_threadCount(uThreadCount, uCount);
+   if (uThreadCount == 1U ||
+       uCount > ((size_t)-1 - oSymTable->uLength) ||
+       uCount > (size_t)-1 / (2U * sizeof(size_t)) ||
+       !SymTable_growTo(oSymTable, oSymTable->uLength + uCount))
+      return SymTable_putBatch(oSymTable, apcKeys, apvValues, uCount);
+
+   auLengths = (size_t*)malloc(2U * uCount * sizeof(size_t));
+   psWorks = (struct HashWork*)malloc(uThreadCount *
+                                      sizeof(struct HashWork));
+   if (auLengths == NULL || psWorks == NULL)
+   {
+      free(auLengths);
+      free(psWorks);
+      return SymTable_putBatch(oSymTable, apcKeys, apvValues, uCount);
+   }
+   auHashes = auLengths + uCount;
+
+   uShare = (uCount + uThreadCount - 1U) / uThreadCount;
+   for (u = 0; u < uThreadCount; u++)
+   {
+      psWorks[u].oSymTable = oSymTable;
+      psWorks[u].apcKeys = apcKeys;
+      psWorks[u].auLengths = auLengths;
+      psWorks[u].auHashes = auHashes;
+      psWorks[u].uFirst = u * uShare;
+      if (psWorks[u].uFirst > uCount)
+         psWorks[u].uFirst = uCount;
+      psWorks[u].uLast = psWorks[u].uFirst + uShare;
+      if (psWorks[u].uLast > uCount)
+         psWorks[u].uLast = uCount;
+   }
+   SymThread_runAll(SymTable_hashWork, psWorks, sizeof(struct HashWork),
+                    uThreadCount);
+
+   /* place the keys in order, prefetching the home slot of the key
+      BATCH_SIZE places ahead */
+   uMask = oSymTable->uSlotCount - 1U;
+   uPutCount = 0U;
+   for (u = 0; u < uCount; u++)
+   {
+      if (u + BATCH_SIZE < uCount)
+         PREFETCH(
+            &oSymTable->psSlots[auHashes[u + BATCH_SIZE] & uMask]);
+      if (SymTable_find(oSymTable, apcKeys[u], auLengths[u],
+                        auHashes[u]) == oSymTable->uSlotCount &&
+          SymTable_insert(oSymTable, apcKeys[u], auLengths[u],
+                          auHashes[u], apvValues[u]) !=
+             oSymTable->uSlotCount)
+         uPutCount++;
+   }
+
+   free(auLengths);
+   free(psWorks);
+   return uPutCount;
+}
+
+/*--------------------------------------------------------------------*/
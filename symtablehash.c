@@ -3,17 +3,63 @@
 /*--------------------------------------------------------------------*/
 
 #include "symtable.h"
+#include "symhash.h"
+#include "symalloc.h"
+#include "symorder.h"
+#include "symstats.h"
+#include "symthread.h"
+#include "symtrace.h"
 #include <assert.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
-/* list of bucket sizes used when expanding the hash table */
-static const size_t auBucketCounts[] = {
-   509, 1021, 2039, 4093, 8191, 16381, 32749, 65521
-};
-
-/* number of bucket sizes in auBucketCounts */
-enum { BUCKET_COUNTS_LEN = 8 };
+/* a SymTable of at most SMALL_TABLE_SIZE bindings keeps them all in
+   one bucket, embedded in the SymTable itself, so the many small
+   tables of a program cost no bucket array at all. */
+enum { SMALL_TABLE_SIZE = 8 };
+
+/* number of buckets in the first bucket array, which a SymTable gets
+   when it outgrows SMALL_TABLE_SIZE bindings. Each expansion after
+   that doubles it, so it is always a power of two and a hash code is
+   reduced to a bucket index by masking instead of by division. */
+enum { INITIAL_BUCKET_COUNT = 512 };
+
+/* a SymTable shrinks to half as many buckets once removals leave it
+   with fewer than 1/SHRINK_FACTOR of the bindings that would make it
+   expand, so a length that hovers near a threshold cannot make it
+   resize again and again. */
+enum { SHRINK_FACTOR = 4 };
+
+/* keys shorter than SHORT_KEY_SIZE bytes, not counting the NUL, are
+   stored right in their Binding, sparing an allocation and a cache
+   miss. A compact build stores only keys that fit in the space of
+   the pointer to a longer one. */
+#ifdef SYMTABLE_COMPACT
+enum { SHORT_KEY_SIZE = sizeof(char*) };
+#else
+enum { SHORT_KEY_SIZE = 16 };
+#endif
+
+/* the maximum load factor used by SymTable_new() */
+static const double DEFAULT_MAX_LOAD_FACTOR = 1.0;
+
+/* number of keys the batch functions hash and prefetch for before
+   probing for any of them. */
+enum { BATCH_SIZE = 16 };
+
+/* each thread of the parallel functions is given at least this many
+   buckets or keys, so small jobs are not split among more threads
+   than they can keep busy. */
+enum { MIN_WORK_PER_THREAD = 1024 };
+
+/* Hint that the memory at pv will be read soon. A prefetch never
+   faults, so pv may be NULL. */
+#ifdef __GNUC__
+#define PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define PREFETCH(pv) ((void)(pv))
+#endif
 
 /*--------------------------------------------------------------------*/
 /* Each binding is stored in a Binding. Bindings in the same bucket   */
@@ -21,8 +67,28 @@ enum { BUCKET_COUNTS_LEN = 8 };
 
 struct Binding
 {
-   /* The key string. */
-   char *pcKey;
+   /* The full hash code of pcKey, before reduction to a bucket
+      index. Lets lookups skip most strcmp calls and lets expansion
+      rebucket the binding without reading the key again. Then the
+      length of the key string, not counting its NUL. A compact build
+      keeps both in unsigned ints, which share one word. */
+#ifdef SYMTABLE_COMPACT
+   unsigned int uHash;
+   unsigned int uKeyLength;
+#else
+   size_t uHash;
+   size_t uKeyLength;
+#endif
+
+   /* The key string. A key shorter than SHORT_KEY_SIZE is stored in
+      acShortKey; a longer one lives in the table's key arena and
+      pcLongKey points to it. In a table that borrows its keys,
+      pcLongKey is the caller's own string, whatever its length. */
+   union
+   {
+      char acShortKey[SHORT_KEY_SIZE];
+      char *pcLongKey;
+   } uKey;
 
    /* The value associated with the key. */
    const void *pvValue;
@@ -37,35 +103,109 @@ struct Binding
 struct SymTable
 {
    /* array of bucket heads. ppsBuckets[i] is a linked list of
-      Bindings, or it is NULL if bucket i is empty. */
+      Bindings, or it is NULL if bucket i is empty. A small table's
+      array is psSmallBucket alone. */
    struct Binding **ppsBuckets;
 
-   /* number of buckets in use. */
+   /* number of buckets in use. Always a power of two. */
    size_t uBucketCount;
 
+   /* the one bucket of a small table. */
+   struct Binding *psSmallBucket;
+
    /* total number of bindings stored. */
    size_t uLength;
 
-   /* index into auBucketCounts[] that corresponds to uBucketCount. */
-   size_t uBucketIndex;
+   /* the largest average chain length tolerated before expanding. */
+   double dMaxLoadFactor;
+
+   /* expand once uLength exceeds this many bindings, and shrink once
+      it falls below uShrinkLength. */
+   size_t uExpandLength;
+   size_t uShrinkLength;
+
+   /* while an incremental resize is in progress, the previous
+      bucket array, whose bindings are moving into ppsBuckets.
+      NULL otherwise. */
+   struct Binding **ppsOldBuckets;
+
+   /* number of buckets in ppsOldBuckets. */
+   size_t uOldBucketCount;
+
+   /* ppsOldBuckets[0] through ppsOldBuckets[uMigrateIndex-1] have
+      already been moved and are empty. */
+   size_t uMigrateIndex;
+
+   /* number of old buckets to move per operation, or 0 to rehash
+      every binding at once. */
+   size_t uRehashStep;
+
+   /* the function that hashes keys, and the seed passed to it. */
+   SymHash_T pfHash;
+   size_t uHashSeed;
+
+   /* nonzero if Bindings point to the callers' key strings instead
+      of holding copies. */
+   int iBorrowKeys;
+
+   /* where this table's Bindings and key strings are allocated. */
+   struct SymPool sBindingPool;
+   struct SymArena sKeyArena;
+
+   /* the trace function and the sampling of lookups for it. */
+   struct SymTrace sTrace;
+
+#ifdef SYMTABLE_STATS
+   /* the counters reported by SymTable_getStats(). */
+   struct SymTable_Stats sStats;
+#endif
 };
 
 /*--------------------------------------------------------------------*/
-/* Return a hash code for pcKey that is between 0 and uBucketCount-1,
-   inclusive. */
+/* Return the full hash code of pcKey, whose length is uKeyLength,
+   under oSymTable's hash function and seed. Mask it with a bucket
+   count minus 1 to get a bucket index. */
 
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey,
+                            size_t uKeyLength)
 {
-   const size_t HASH_MULTIPLIER = 65599;
-   size_t u;
-   size_t uHash = 0;
-
+   assert(oSymTable != NULL);
    assert(pcKey != NULL);
 
-   for (u = 0; pcKey[u] != '\0'; u++)
-      uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+#ifdef SYMTABLE_COMPACT
+   /* drop the bits a Binding has no room for, so that every hash
+      code compared with a Binding's is the same width */
+   return (unsigned int)(*oSymTable->pfHash)(pcKey, uKeyLength,
+                                             oSymTable->uHashSeed);
+#else
+   return (*oSymTable->pfHash)(pcKey, uKeyLength, oSymTable->uHashSeed);
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the key string of psBinding, a Binding of oSymTable.        */
+
+static const char *SymTable_bindingKey(SymTable_T oSymTable,
+                                       const struct Binding *psBinding)
+{
+   assert(oSymTable != NULL);
+   assert(psBinding != NULL);
+
+   if (!oSymTable->iBorrowKeys &&
+       psBinding->uKeyLength < (size_t)SHORT_KEY_SIZE)
+      return psBinding->uKey.acShortKey;
+   return psBinding->uKey.pcLongKey;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return 1 if oSymTable is small, keeping its bindings in            */
+/* psSmallBucket, or 0 otherwise.                                     */
+
+static int SymTable_isSmall(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
 
-   return uHash % uBucketCount;
+   return oSymTable->ppsBuckets == &oSymTable->psSmallBucket;
 }
 
 /*--------------------------------------------------------------------*/
@@ -88,28 +228,107 @@ static struct Binding **SymTable_allocateBuckets(size_t uBucketCount)
    return ppsBuckets;
 }
 
+/*--------------------------------------------------------------------*/
+/* Set oSymTable's expansion and shrinking thresholds for its current */
+/* bucket count.                                                      */
+
+static void SymTable_setExpandLength(SymTable_T oSymTable)
+{
+   double dLimit;
+
+   assert(oSymTable != NULL);
+
+   /* a small table grows by size, whatever its load factor, and
+      cannot shrink */
+   if (SymTable_isSmall(oSymTable))
+   {
+      oSymTable->uExpandLength = SMALL_TABLE_SIZE;
+      oSymTable->uShrinkLength = 0U;
+      return;
+   }
+
+   dLimit = (double)oSymTable->uBucketCount * oSymTable->dMaxLoadFactor;
+   if (dLimit >= (double)(size_t)-1)
+      oSymTable->uExpandLength = (size_t)-1;
+   else
+      oSymTable->uExpandLength = (size_t)dLimit;
+
+   /* the first bucket array gives way to the small bucket instead */
+   if (oSymTable->uBucketCount <= (size_t)INITIAL_BUCKET_COUNT)
+      oSymTable->uShrinkLength = SMALL_TABLE_SIZE / SHRINK_FACTOR;
+   else
+      oSymTable->uShrinkLength =
+         oSymTable->uExpandLength / SHRINK_FACTOR;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_initOptions(struct SymTable_Options *psOptions)
+{
+   assert(psOptions != NULL);
+
+   psOptions->dMaxLoadFactor = DEFAULT_MAX_LOAD_FACTOR;
+   psOptions->uRehashStep = 0U;
+   psOptions->pfHash = NULL;
+   psOptions->uHashSeed = 0U;
+   psOptions->iBorrowKeys = 0;
+   psOptions->iMoveToFront = 0;
+   psOptions->pfTrace = NULL;
+   psOptions->pvTraceExtra = NULL;
+   psOptions->uTraceSampleInterval = 1024U;
+   psOptions->dTraceMinSeconds = 0.0;
+   psOptions->uTraceMinProbes = 0U;
+}
+
 /*--------------------------------------------------------------------*/
 
 SymTable_T SymTable_new(void)
+{
+   struct SymTable_Options sOptions;
+
+   SymTable_initOptions(&sOptions);
+   return SymTable_newWithOptions(&sOptions);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithOptions(
+   const struct SymTable_Options *psOptions)
 {
    SymTable_T oSymTable;
 
+   assert(psOptions != NULL);
+   assert(psOptions->dMaxLoadFactor > 0.0);
+
    oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
    if (oSymTable == NULL)
       return NULL;
 
-    /* initialize bucket index and count */
-   oSymTable->uBucketIndex = 0U;
-   oSymTable->uBucketCount = auBucketCounts[oSymTable->uBucketIndex];
+   /* every table starts small, with no bucket array to allocate */
+   oSymTable->psSmallBucket = NULL;
+   oSymTable->ppsBuckets = &oSymTable->psSmallBucket;
+   oSymTable->uBucketCount = 1U;
 
-   /* allocate and initialize the bucket array */
-   oSymTable->ppsBuckets =
-      SymTable_allocateBuckets(oSymTable->uBucketCount);
-   if (oSymTable->ppsBuckets == NULL)
-   {
-      free(oSymTable);
-      return NULL;
-   }
+   oSymTable->dMaxLoadFactor = psOptions->dMaxLoadFactor;
+   SymTable_setExpandLength(oSymTable);
+
+   oSymTable->ppsOldBuckets = NULL;
+   oSymTable->uOldBucketCount = 0U;
+   oSymTable->uMigrateIndex = 0U;
+   oSymTable->uRehashStep = psOptions->uRehashStep;
+
+   oSymTable->pfHash = psOptions->pfHash;
+   if (oSymTable->pfHash == NULL)
+      oSymTable->pfHash = SymHash_word;
+   oSymTable->uHashSeed = psOptions->uHashSeed;
+   oSymTable->iBorrowKeys = psOptions->iBorrowKeys;
+
+   SymPool_init(&oSymTable->sBindingPool, sizeof(struct Binding));
+   SymArena_init(&oSymTable->sKeyArena);
+   SymTrace_init(&oSymTable->sTrace, psOptions);
+#ifdef SYMTABLE_STATS
+   SymStats_init(&oSymTable->sStats);
+#endif
 
    oSymTable->uLength = 0U;
    return oSymTable;
@@ -117,29 +336,39 @@ SymTable_T SymTable_new(void)
 
 /*--------------------------------------------------------------------*/
 
-void SymTable_free(SymTable_T oSymTable)
+SymTable_T SymTable_newWithCapacity(size_t uCount)
 {
-   size_t u;
-   struct Binding *psCurrent;
-   struct Binding *psNext;
+   SymTable_T oSymTable;
 
-   assert(oSymTable != NULL);
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+      return NULL;
 
-   for (u = 0; u < oSymTable->uBucketCount; u++)
+   if (!SymTable_reserve(oSymTable, uCount))
    {
-      for (psCurrent = oSymTable->ppsBuckets[u];
-           psCurrent != NULL;
-           psCurrent = psNext)
-      {
-        /* store next binding before freeing current */
-         psNext = psCurrent->psNextBinding;
-        /* free the key string and the binding */
-         free(psCurrent->pcKey);
-         free(psCurrent);
-      }
+      SymTable_free(oSymTable);
+      return NULL;
    }
-/* free the bucket array and the symbol table itself */
-   free(oSymTable->ppsBuckets);
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   /* every Binding and key lives in the pool and the arena, so the
+      chains need not be walked */
+   SymPool_destroy(&oSymTable->sBindingPool);
+   SymArena_destroy(&oSymTable->sKeyArena);
+
+   /* free the bucket arrays and the symbol table itself. an old
+      array is never the small bucket, since a small table's bindings
+      move out of it at once */
+   if (!SymTable_isSmall(oSymTable))
+      free(oSymTable->ppsBuckets);
+   free(oSymTable->ppsOldBuckets);
    free(oSymTable);
 }
 
@@ -152,271 +381,1542 @@ size_t SymTable_getLength(SymTable_T oSymTable)
 }
 
 /*--------------------------------------------------------------------*/
-/* challenge helper: expand oSymTable if uLength > uBucketCount & not */
-/* already at the max bucket size. rehash all bindings into a new     */
-/* bucket array with the next size.                                   */
-/* if allocation fails, skip expansion                                */
+/* move the bindings of at most uBucketLimit old buckets of an        */
+/* incremental resize into oSymTable's current bucket array, and      */
+/* release the old array once it is empty.                            */
 
-static void SymTable_expand(SymTable_T oSymTable)
+static void SymTable_migrate(SymTable_T oSymTable, size_t uBucketLimit)
 {
-   size_t uNewBucketIndex;
-   size_t uNewBucketCount;
-   struct Binding **ppsNewBuckets;
-   size_t u;
    struct Binding *psCurrent;
    struct Binding *psNext;
    size_t uIndex;
+   SymStats_Clock tStart;
 
    assert(oSymTable != NULL);
 
-   /* if already at max bucket size, return */
-   if (oSymTable->uBucketIndex >= (size_t)(BUCKET_COUNTS_LEN - 1))
-    return;
-
-    /* if length is not greater than bucket count, return */
-   if (oSymTable->uLength <= oSymTable->uBucketCount)
+   if (oSymTable->ppsOldBuckets == NULL)
       return;
 
-     /* allocate new bucket array with next size */
-   uNewBucketIndex = oSymTable->uBucketIndex + 1U;
-   uNewBucketCount = auBucketCounts[uNewBucketIndex];
-
-   /* allocate new bucket array */
-   ppsNewBuckets = SymTable_allocateBuckets(uNewBucketCount);
-   if (ppsNewBuckets == NULL)
-      return;
-
-     /* rehash all existing bindings into new bucket array */
-   for (u = 0; u < oSymTable->uBucketCount; u++)
+   SYMSTATS_START(tStart);
+   while (oSymTable->ppsOldBuckets != NULL && uBucketLimit > 0U)
    {
-      for (psCurrent = oSymTable->ppsBuckets[u];
+      for (psCurrent =
+              oSymTable->ppsOldBuckets[oSymTable->uMigrateIndex];
            psCurrent != NULL;
            psCurrent = psNext)
       {
         /* store next binding before rehashing current */
          psNext = psCurrent->psNextBinding;
 
-         /* rehash the current binding into the new bucket array */
-         uIndex = SymTable_hash(psCurrent->pcKey, uNewBucketCount);
+         uIndex = psCurrent->uHash & (oSymTable->uBucketCount - 1U);
+         psCurrent->psNextBinding = oSymTable->ppsBuckets[uIndex];
+         oSymTable->ppsBuckets[uIndex] = psCurrent;
+      }
+      oSymTable->ppsOldBuckets[oSymTable->uMigrateIndex] = NULL;
+      oSymTable->uMigrateIndex++;
+      uBucketLimit--;
 
-         psCurrent->psNextBinding = ppsNewBuckets[uIndex];
-         ppsNewBuckets[uIndex] = psCurrent;
+      /* the old array is empty once every bucket has been moved */
+      if (oSymTable->uMigrateIndex == oSymTable->uOldBucketCount)
+      {
+         if (oSymTable->ppsOldBuckets != &oSymTable->psSmallBucket)
+            free(oSymTable->ppsOldBuckets);
+         oSymTable->ppsOldBuckets = NULL;
+         oSymTable->uOldBucketCount = 0U;
+         oSymTable->uMigrateIndex = 0U;
+         SymTrace_endResize(&oSymTable->sTrace, oSymTable,
+                            oSymTable->uLength,
+                            oSymTable->uBucketCount);
       }
    }
+   SYMSTATS_STOP(oSymTable->sStats.dResizeSeconds, tStart);
+}
+
+/*--------------------------------------------------------------------*/
+/* Begin moving oSymTable to a new bucket array of uNewBucketCount    */
+/* buckets, first completing any earlier resize. An array of one     */
+/* bucket is the small bucket. The bindings are left in the old array */
+/* for SymTable_migrate(). Return 1 if successful, or 0 if out of     */
+/* memory.                                                            */
+
+static int SymTable_startResize(SymTable_T oSymTable,
+                                size_t uNewBucketCount)
+{
+   struct Binding **ppsNewBuckets;
+   SymStats_Clock tStart;
+
+   assert(oSymTable != NULL);
+   assert(uNewBucketCount != oSymTable->uBucketCount);
 
-   free(oSymTable->ppsBuckets);
+   SYMSTATS_START(tStart);
+
+   /* allocate new bucket array, unless the table is becoming small */
+   if (uNewBucketCount == 1U)
+      ppsNewBuckets = &oSymTable->psSmallBucket;
+   else
+   {
+      ppsNewBuckets = SymTable_allocateBuckets(uNewBucketCount);
+      if (ppsNewBuckets == NULL)
+         return 0;
+   }
+   SYMSTATS_STOP(oSymTable->sStats.dResizeSeconds, tStart);
+   SYMSTATS_ADD(oSymTable->sStats.uResizes, 1U);
+
+   /* an earlier resize that has not finished yet must be
+      completed first, so there are never more than two arrays */
+   SymTable_migrate(oSymTable, oSymTable->uOldBucketCount);
+   SymTrace_beginResize(&oSymTable->sTrace, oSymTable,
+                        oSymTable->uLength, oSymTable->uBucketCount,
+                        uNewBucketCount);
+
+   /* the current array becomes the old one, to be drained into the
+      new array */
+   oSymTable->ppsOldBuckets = oSymTable->ppsBuckets;
+   oSymTable->uOldBucketCount = oSymTable->uBucketCount;
+   oSymTable->uMigrateIndex = 0U;
 
    /* update oSymTable to use the new bucket array and size */
    oSymTable->ppsBuckets = ppsNewBuckets;
    oSymTable->uBucketCount = uNewBucketCount;
-   oSymTable->uBucketIndex = uNewBucketIndex;
+   SymTable_setExpandLength(oSymTable);
+
+   return 1;
 }
 
 /*--------------------------------------------------------------------*/
+/* challenge helper: expand oSymTable if uLength exceeds the limit    */
+/* set by its load factor, moving to a new bucket array of twice the  */
+/* size. all bindings are rehashed now unless uRehashStep is nonzero, */
+/* in which case later operations move them a few buckets at a time.  */
+/* if no larger size fits or allocation fails, skip expansion         */
 
-int SymTable_put(SymTable_T oSymTable,
-                 const char *pcKey, const void *pvValue)
+static void SymTable_expand(SymTable_T oSymTable)
 {
-   struct Binding *psNewBinding;
-    struct Binding *psCurrent;
-    char *pcKeyCopy;
-    size_t uIndex;
+   assert(oSymTable != NULL);
 
-    assert(oSymTable != NULL);
-    assert(pcKey != NULL);
+    /* if length is not past the load factor limit, return */
+   if (oSymTable->uLength <= oSymTable->uExpandLength)
+      return;
 
-    /* check if key already exists */
-    uIndex = SymTable_hash(pcKey, oSymTable->uBucketCount);
-
-    for (psCurrent = oSymTable->ppsBuckets[uIndex];
-         psCurrent != NULL;
-         psCurrent = psCurrent->psNextBinding)
-    {
-        /* if we find the key */
-        if (strcmp(psCurrent->pcKey, pcKey) == 0)
-            return 0;
-    }
-
-    /* create new binding */
-    psNewBinding = (struct Binding*)malloc(sizeof(struct Binding));
-    if (psNewBinding == NULL)
-        return 0;
+   /* a small table gets its first bucket array, and its few bindings
+      move into it right away */
+   if (SymTable_isSmall(oSymTable))
+   {
+      if (SymTable_startResize(oSymTable, INITIAL_BUCKET_COUNT))
+         SymTable_migrate(oSymTable, oSymTable->uOldBucketCount);
+      return;
+   }
 
+   /* double the bucket count, unless the array would not fit */
+   if (oSymTable->uBucketCount >
+       ((size_t)-1 / sizeof(struct Binding*)) / 2U)
+      return;
 
-    pcKeyCopy = (char*)malloc(strlen(pcKey) + 1U);
-    if (pcKeyCopy == NULL)
-    {
-        free(psNewBinding);
-        return 0;
-    }
-    strcpy(pcKeyCopy, pcKey);
+   if (!SymTable_startResize(oSymTable, oSymTable->uBucketCount * 2U))
+      return;
 
-    /* initialize new binding */
-    psNewBinding->pcKey = pcKeyCopy;
-    psNewBinding->pvValue = pvValue;
+   /* without incremental rehashing, move everything right away */
+   if (oSymTable->uRehashStep == 0U)
+      SymTable_migrate(oSymTable, oSymTable->uOldBucketCount);
+}
+
+/*--------------------------------------------------------------------*/
+/* shrink oSymTable to half as many buckets, or from its first bucket */
+/* array back to the small bucket, if removals have left uLength      */
+/* below the limit that allows. bindings move as SymTable_expand()    */
+/* moves them. if allocation fails, skip shrinking.                   */
+
+static void SymTable_shrink(SymTable_T oSymTable)
+{
+   size_t uNewBucketCount;
 
-    /* insert new binding at the front of the correct bucket's chain */
-    psNewBinding->psNextBinding = oSymTable->ppsBuckets[uIndex];
-    oSymTable->ppsBuckets[uIndex] = psNewBinding;
+   assert(oSymTable != NULL);
 
-    oSymTable->uLength++;
+   if (oSymTable->uLength >= oSymTable->uShrinkLength)
+      return;
 
-    /* expand the hash table if necessary - challenge part*/
-    if (oSymTable->uLength > oSymTable->uBucketCount)
-    SymTable_expand(oSymTable);
+   uNewBucketCount = oSymTable->uBucketCount / 2U;
+   if (uNewBucketCount < (size_t)INITIAL_BUCKET_COUNT)
+      uNewBucketCount = 1U;
 
-    return 1;
+   if (!SymTable_startResize(oSymTable, uNewBucketCount))
+      return;
+   if (oSymTable->uRehashStep == 0U)
+      SymTable_migrate(oSymTable, oSymTable->uOldBucketCount);
 }
 
 /*--------------------------------------------------------------------*/
+/* Grow oSymTable at once to the smallest bucket count, a power of    */
+/* two, whose load factor limit admits uLength bindings, and finish   */
+/* any incremental expansion. Return 1 if successful, or 0 if no such */
+/* array fits or allocation fails.                                    */
 
-void *SymTable_replace(SymTable_T oSymTable,
-                       const char *pcKey, const void *pvValue)
+static int SymTable_growTo(SymTable_T oSymTable, size_t uLength)
 {
-    struct Binding *psCurrent;
-    const void *pvOldValue;
-    size_t uIndex;
+   size_t uNewBucketCount;
 
-    assert(oSymTable != NULL);
-    assert(pcKey != NULL);
+   assert(oSymTable != NULL);
 
-    uIndex = SymTable_hash(pcKey, oSymTable->uBucketCount);
+   /* a small table that will outgrow its one bucket starts from the
+      first bucket array */
+   uNewBucketCount = oSymTable->uBucketCount;
+   if (SymTable_isSmall(oSymTable))
+   {
+      if (uLength <= (size_t)SMALL_TABLE_SIZE)
+         return 1;
+      uNewBucketCount = INITIAL_BUCKET_COUNT;
+   }
+   while ((double)uNewBucketCount * oSymTable->dMaxLoadFactor <
+          (double)uLength)
+   {
+      if (uNewBucketCount > ((size_t)-1 / sizeof(struct Binding*)) / 2U)
+         return 0;
+      uNewBucketCount *= 2U;
+   }
 
-    for (psCurrent = oSymTable->ppsBuckets[uIndex];
-         psCurrent != NULL;
-         psCurrent = psCurrent->psNextBinding)
-    {
-        if (strcmp(psCurrent->pcKey, pcKey) == 0)
-        {
-            /* if we find the key that we want to replace */
-            pvOldValue = psCurrent->pvValue;
-            psCurrent->pvValue = pvValue;
-            return (void*)pvOldValue;
-        }
-    }
+   if (uNewBucketCount > oSymTable->uBucketCount &&
+       !SymTable_startResize(oSymTable, uNewBucketCount))
+      return 0;
 
-    return NULL;
+   SymTable_migrate(oSymTable, oSymTable->uOldBucketCount);
+   return 1;
 }
 
 /*--------------------------------------------------------------------*/
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+int SymTable_compact(SymTable_T oSymTable)
 {
-   struct Binding *psCurrent;
-    size_t uIndex;
+   size_t uNewBucketCount;
 
-    assert(oSymTable != NULL);
-    assert(pcKey != NULL);
+   assert(oSymTable != NULL);
 
-    uIndex = SymTable_hash(pcKey, oSymTable->uBucketCount);
+   /* the smallest table that holds every binding without expanding */
+   uNewBucketCount = 1U;
+   if (oSymTable->uLength > (size_t)SMALL_TABLE_SIZE)
+   {
+      uNewBucketCount = INITIAL_BUCKET_COUNT;
+      while (uNewBucketCount < oSymTable->uBucketCount &&
+             (double)uNewBucketCount * oSymTable->dMaxLoadFactor <
+                (double)oSymTable->uLength)
+         uNewBucketCount *= 2U;
+   }
 
-    for (psCurrent = oSymTable->ppsBuckets[uIndex];
-         psCurrent != NULL;
-         psCurrent = psCurrent->psNextBinding)
-    {
-        if (strcmp(psCurrent->pcKey, pcKey) == 0)
-            return 1;
-    }
+   if (uNewBucketCount < oSymTable->uBucketCount &&
+       !SymTable_startResize(oSymTable, uNewBucketCount))
+      return 0;
 
-    return 0;
+   SymTable_migrate(oSymTable, oSymTable->uOldBucketCount);
+   return 1;
 }
 
 /*--------------------------------------------------------------------*/
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+int SymTable_reserve(SymTable_T oSymTable, size_t uCount)
 {
-   struct Binding *psCurrent;
-    size_t uIndex;
+   assert(oSymTable != NULL);
 
-    assert(oSymTable != NULL);
-    assert(pcKey != NULL);
+   if (uCount <= oSymTable->uLength)
+      return 1;
+   return SymTable_growTo(oSymTable, uCount);
+}
 
-    uIndex = SymTable_hash(pcKey, oSymTable->uBucketCount);
+/*--------------------------------------------------------------------*/
+/* Return 1 if psBinding, a Binding of oSymTable, holds the key of    */
+/* uKeyLength bytes at pcKey, whose full hash code is uHash, or 0     */
+/* otherwise. The cached hash code and the length are compared first, */
+/* so the bytes are compared only on a likely match.                  */
+
+static int SymTable_matches(SymTable_T oSymTable,
+                            const struct Binding *psBinding,
+                            const char *pcKey, size_t uKeyLength,
+                            size_t uHash)
+{
+   assert(oSymTable != NULL);
+   assert(psBinding != NULL);
+   assert(pcKey != NULL);
 
-    for (psCurrent = oSymTable->ppsBuckets[uIndex];
-         psCurrent != NULL;
-         psCurrent = psCurrent->psNextBinding)
-    {
-        if (strcmp(psCurrent->pcKey, pcKey) == 0)
-            return (void*)psCurrent->pvValue;
-    }
+   SYMSTATS_ADD(oSymTable->sStats.uProbes, 1U);
+   if (psBinding->uHash != uHash || psBinding->uKeyLength != uKeyLength)
+      return 0;
 
-    return NULL;
+   SYMSTATS_ADD(oSymTable->sStats.uKeyCompares, 1U);
+   return memcmp(SymTable_bindingKey(oSymTable, psBinding), pcKey,
+                 uKeyLength) == 0;
 }
 
 /*--------------------------------------------------------------------*/
-
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+/* Return the address of the link -- a bucket head or the             */
+/* psNextBinding field of a Binding -- that points to the Binding     */
+/* whose key is the uKeyLength bytes at pcKey, or NULL if that key is */
+/* not in oSymTable. uHash is the full hash code of the key. If an    */
+/* incremental expansion is in progress, first move a step's worth of */
+/* old buckets, then search both bucket arrays.                       */
+
+static struct Binding **SymTable_search(SymTable_T oSymTable,
+                                        const char *pcKey,
+                                        size_t uKeyLength, size_t uHash)
 {
+   struct Binding **ppsLink;
    size_t uIndex;
-   struct Binding *psCurrent;
-   struct Binding *psPrev;
-   const void *pvValue;
 
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
 
-   uIndex = SymTable_hash(pcKey, oSymTable->uBucketCount);
+   if (oSymTable->ppsOldBuckets != NULL)
+      SymTable_migrate(oSymTable, oSymTable->uRehashStep);
 
-   psPrev = NULL;
-   psCurrent = oSymTable->ppsBuckets[uIndex];
-
-   while (psCurrent != NULL)
+   SYMSTATS_ADD(oSymTable->sStats.uLookups, 1U);
+   uIndex = uHash & (oSymTable->uBucketCount - 1U);
+   for (ppsLink = &oSymTable->ppsBuckets[uIndex];
+        *ppsLink != NULL;
+        ppsLink = &(*ppsLink)->psNextBinding)
    {
-      if (strcmp(psCurrent->pcKey, pcKey) == 0)
+      if (SymTable_matches(oSymTable, *ppsLink, pcKey, uKeyLength,
+                           uHash))
       {
-         pvValue = psCurrent->pvValue;
- 
-         /* remove psCurrent from the chain */
-         if (psPrev == NULL)
-            oSymTable->ppsBuckets[uIndex] =
-               psCurrent->psNextBinding;
-         else
-            psPrev->psNextBinding =
-               psCurrent->psNextBinding;
-
-         free(psCurrent->pcKey);
-         free(psCurrent);
-
-         assert(oSymTable->uLength > 0U);
-         oSymTable->uLength--;
-
-         return (void*)pvValue;
+         SYMSTATS_ADD(oSymTable->sStats.uHits, 1U);
+         return ppsLink;
       }
+   }
+
+   if (oSymTable->ppsOldBuckets == NULL)
+      return NULL;
+
+   /* buckets that were already moved are empty, so skip them */
+   uIndex = uHash & (oSymTable->uOldBucketCount - 1U);
+   if (uIndex < oSymTable->uMigrateIndex)
+      return NULL;
 
-      psPrev = psCurrent;
-      psCurrent = psCurrent->psNextBinding;
+   for (ppsLink = &oSymTable->ppsOldBuckets[uIndex];
+        *ppsLink != NULL;
+        ppsLink = &(*ppsLink)->psNextBinding)
+   {
+      if (SymTable_matches(oSymTable, *ppsLink, pcKey, uKeyLength,
+                           uHash))
+      {
+         SYMSTATS_ADD(oSymTable->sStats.uHits, 1U);
+         return ppsLink;
+      }
    }
 
    return NULL;
 }
 
 /*--------------------------------------------------------------------*/
+/* Return the number of Bindings that SymTable_search() examined in   */
+/* oSymTable to find psFound, or to find that the key whose full hash */
+/* code is uHash is absent if psFound is NULL.                        */
 
-void SymTable_map(SymTable_T oSymTable,
-                  void (*pfApply)(const char *pcKey,
-                                  void *pvValue,
-                                  void *pvExtra),
-                  const void *pvExtra)
+static size_t SymTable_countProbes(SymTable_T oSymTable, size_t uHash,
+                                   const struct Binding *psFound)
 {
-   size_t u;
-   struct Binding *psCurrent;
+   const struct Binding *psBinding;
+   size_t uIndex;
+   size_t uProbes = 0U;
 
    assert(oSymTable != NULL);
-   assert(pfApply != NULL);
 
-   for (u = 0; u < oSymTable->uBucketCount; u++)
+   uIndex = uHash & (oSymTable->uBucketCount - 1U);
+   for (psBinding = oSymTable->ppsBuckets[uIndex];
+        psBinding != NULL;
+        psBinding = psBinding->psNextBinding)
    {
-      for (psCurrent = oSymTable->ppsBuckets[u];
-           psCurrent != NULL;
-           psCurrent = psCurrent->psNextBinding)
+      uProbes++;
+      if (psBinding == psFound)
+         return uProbes;
+   }
+
+   if (oSymTable->ppsOldBuckets == NULL)
+      return uProbes;
+   uIndex = uHash & (oSymTable->uOldBucketCount - 1U);
+   if (uIndex < oSymTable->uMigrateIndex)
+      return uProbes;
+
+   for (psBinding = oSymTable->ppsOldBuckets[uIndex];
+        psBinding != NULL;
+        psBinding = psBinding->psNextBinding)
+   {
+      uProbes++;
+      if (psBinding == psFound)
+         return uProbes;
+   }
+   return uProbes;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return what SymTable_search() returns for the key of uKeyLength    */
+/* bytes at pcKey, whose full hash code is uHash, reporting the       */
+/* lookup to oSymTable's trace function if it is sampled.             */
+
+static struct Binding **SymTable_findLink(SymTable_T oSymTable,
+                                          const char *pcKey,
+                                          size_t uKeyLength,
+                                          size_t uHash)
+{
+   struct Binding **ppsLink;
+   const struct Binding *psFound;
+   double dStart;
+   double dSeconds;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   if (!SYMTRACE_SAMPLED(&oSymTable->sTrace))
+      return SymTable_search(oSymTable, pcKey, uKeyLength, uHash);
+
+   dStart = SymTrace_now();
+   ppsLink = SymTable_search(oSymTable, pcKey, uKeyLength, uHash);
+   dSeconds = SymTrace_now() - dStart;
+
+   psFound = ppsLink == NULL ? NULL : *ppsLink;
+   SymTrace_lookup(&oSymTable->sTrace, oSymTable, pcKey, uKeyLength,
+                   psFound != NULL,
+                   SymTable_countProbes(oSymTable, uHash, psFound),
+                   dSeconds);
+   return ppsLink;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return a new Binding of oSymTable from *psPool that binds the      */
+/* uKeyLength bytes at pcKey, whose full hash code is uHash, to       */
+/* pvValue, with any key copy in *psArena, or return NULL if out of   */
+/* memory or, in a compact build, if uKeyLength is too large for a    */
+/* Binding. The Binding is not linked into any bucket.                */
+
+static struct Binding *SymTable_newBinding(SymTable_T oSymTable,
+                                           struct SymPool *psPool,
+                                           struct SymArena *psArena,
+                                           const char *pcKey,
+                                           size_t uKeyLength,
+                                           size_t uHash,
+                                           const void *pvValue)
+{
+   struct Binding *psNewBinding;
+   char *pcKeyCopy;
+
+   assert(oSymTable != NULL);
+   assert(psPool != NULL);
+   assert(psArena != NULL);
+   assert(pcKey != NULL);
+
+#ifdef SYMTABLE_COMPACT
+   if (uKeyLength > UINT_MAX)
+      return NULL;
+#endif
+
+   /* create new binding */
+   psNewBinding = (struct Binding*)SymPool_alloc(psPool);
+   if (psNewBinding == NULL)
+      return NULL;
+
+   /* borrow the caller's key if the table was created to, or else
+      copy the key into the binding if it is short enough, or into
+      the key arena otherwise. a copy is always NUL-terminated */
+   if (oSymTable->iBorrowKeys)
+   {
+      assert(pcKey[uKeyLength] == '\0');
+      psNewBinding->uKey.pcLongKey = (char*)pcKey;
+   }
+   else
+   {
+      if (uKeyLength < (size_t)SHORT_KEY_SIZE)
+         pcKeyCopy = psNewBinding->uKey.acShortKey;
+      else
       {
-        /* call pfApply for each binding */
-         (*pfApply)(psCurrent->pcKey,
-                    (void*)psCurrent->pvValue,
-                    (void*)pvExtra);
+         pcKeyCopy = SymArena_alloc(psArena, uKeyLength + 1U);
+         if (pcKeyCopy == NULL)
+         {
+            SymPool_release(psPool, psNewBinding);
+            return NULL;
+         }
+         psNewBinding->uKey.pcLongKey = pcKeyCopy;
       }
+      memcpy(pcKeyCopy, pcKey, uKeyLength);
+      pcKeyCopy[uKeyLength] = '\0';
    }
+
+   /* initialize new binding */
+   psNewBinding->uHash = uHash;
+   psNewBinding->uKeyLength = uKeyLength;
+   psNewBinding->pvValue = pvValue;
+
+   return psNewBinding;
+}
+
+/*--------------------------------------------------------------------*/
+/* Insert a new binding of the uKeyLength bytes at pcKey, whose full  */
+/* hash code is uHash, to pvValue in oSymTable, and return it, or     */
+/* return NULL if out of memory. The key must not already be present. */
+
+static struct Binding *SymTable_insert(SymTable_T oSymTable,
+                                       const char *pcKey,
+                                       size_t uKeyLength, size_t uHash,
+                                       const void *pvValue)
+{
+   struct Binding *psNewBinding;
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psNewBinding = SymTable_newBinding(oSymTable,
+                                      &oSymTable->sBindingPool,
+                                      &oSymTable->sKeyArena, pcKey,
+                                      uKeyLength, uHash, pvValue);
+   if (psNewBinding == NULL)
+      return NULL;
+
+   /* insert new binding at the front of the correct bucket's chain.
+      new bindings always go into the current bucket array */
+   uIndex = uHash & (oSymTable->uBucketCount - 1U);
+   psNewBinding->psNextBinding = oSymTable->ppsBuckets[uIndex];
+   oSymTable->ppsBuckets[uIndex] = psNewBinding;
+
+   oSymTable->uLength++;
+
+   /* expand the hash table if necessary - challenge part. expansion
+      relinks Bindings but never moves them */
+   if (oSymTable->uLength > oSymTable->uExpandLength)
+      SymTable_expand(oSymTable);
+
+   return psNewBinding;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_hashN(SymTable_T oSymTable, const char *pcKey,
+                      size_t uKeyLength)
+{
+   return SymTable_hash(oSymTable, pcKey, uKeyLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putH(SymTable_T oSymTable, const char *pcKey,
+                  size_t uKeyLength, size_t uHash,
+                  const void *pvValue)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* check if key already exists */
+    if (SymTable_findLink(oSymTable, pcKey, uKeyLength, uHash) != NULL)
+        return 0;
+
+    return SymTable_insert(oSymTable, pcKey, uKeyLength, uHash,
+                           pvValue) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+                  size_t uKeyLength, const void *pvValue)
+{
+   return SymTable_putH(oSymTable, pcKey, uKeyLength,
+                        SymTable_hash(oSymTable, pcKey, uKeyLength),
+                        pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+                 const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertH(SymTable_T oSymTable, const char *pcKey,
+                     size_t uKeyLength, size_t uHash,
+                     const void *pvValue)
+{
+   struct Binding **ppsLink;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppsLink = SymTable_findLink(oSymTable, pcKey, uKeyLength, uHash);
+   if (ppsLink != NULL)
+   {
+      (*ppsLink)->pvValue = pvValue;
+      return 1;
+   }
+
+   return SymTable_insert(oSymTable, pcKey, uKeyLength, uHash,
+                          pvValue) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertN(SymTable_T oSymTable, const char *pcKey,
+                     size_t uKeyLength, const void *pvValue)
+{
+   return SymTable_upsertH(oSymTable, pcKey, uKeyLength,
+                           SymTable_hash(oSymTable, pcKey, uKeyLength),
+                           pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsert(SymTable_T oSymTable,
+                    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_upsertN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsertH(SymTable_T oSymTable, const char *pcKey,
+                             size_t uKeyLength, size_t uHash,
+                             const void *pvValue)
+{
+   struct Binding **ppsLink;
+   struct Binding *psBinding;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppsLink = SymTable_findLink(oSymTable, pcKey, uKeyLength, uHash);
+   if (ppsLink != NULL)
+      psBinding = *ppsLink;
+   else
+   {
+      psBinding = SymTable_insert(oSymTable, pcKey, uKeyLength, uHash,
+                                  pvValue);
+      if (psBinding == NULL)
+         return NULL;
+   }
+
+   return (void**)&psBinding->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsertN(SymTable_T oSymTable, const char *pcKey,
+                             size_t uKeyLength, const void *pvValue)
+{
+   return SymTable_getOrInsertH(oSymTable, pcKey, uKeyLength,
+                                SymTable_hash(oSymTable, pcKey,
+                                              uKeyLength),
+                                pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+                            const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_getOrInsertN(oSymTable, pcKey, strlen(pcKey),
+                                pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceH(SymTable_T oSymTable, const char *pcKey,
+                        size_t uKeyLength, size_t uHash,
+                        const void *pvValue)
+{
+    struct Binding **ppsLink;
+    const void *pvOldValue;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    ppsLink = SymTable_findLink(oSymTable, pcKey, uKeyLength, uHash);
+    if (ppsLink == NULL)
+        return NULL;
+
+    /* if we find the key that we want to replace */
+    pvOldValue = (*ppsLink)->pvValue;
+    (*ppsLink)->pvValue = pvValue;
+    return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable, const char *pcKey,
+                        size_t uKeyLength, const void *pvValue)
+{
+   return SymTable_replaceH(oSymTable, pcKey, uKeyLength,
+                            SymTable_hash(oSymTable, pcKey, uKeyLength),
+                            pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+                       const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsH(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength, size_t uHash)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    return SymTable_findLink(oSymTable, pcKey, uKeyLength,
+                             uHash) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength)
+{
+   return SymTable_containsH(oSymTable, pcKey, uKeyLength,
+                             SymTable_hash(oSymTable, pcKey,
+                                           uKeyLength));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getH(SymTable_T oSymTable, const char *pcKey,
+                    size_t uKeyLength, size_t uHash)
+{
+    struct Binding **ppsLink;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    ppsLink = SymTable_findLink(oSymTable, pcKey, uKeyLength, uHash);
+    if (ppsLink == NULL)
+        return NULL;
+
+    return (void*)(*ppsLink)->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+                    size_t uKeyLength)
+{
+   return SymTable_getH(oSymTable, pcKey, uKeyLength,
+                        SymTable_hash(oSymTable, pcKey, uKeyLength));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeH(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength, size_t uHash)
+{
+   struct Binding **ppsLink;
+   struct Binding *psCurrent;
+   const void *pvValue;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppsLink = SymTable_findLink(oSymTable, pcKey, uKeyLength, uHash);
+   if (ppsLink == NULL)
+      return NULL;
+
+   psCurrent = *ppsLink;
+   pvValue = psCurrent->pvValue;
+
+   /* remove psCurrent from the chain */
+   *ppsLink = psCurrent->psNextBinding;
+
+   if (!oSymTable->iBorrowKeys &&
+       psCurrent->uKeyLength >= (size_t)SHORT_KEY_SIZE)
+      SymArena_release(&oSymTable->sKeyArena, psCurrent->uKey.pcLongKey,
+                       psCurrent->uKeyLength + 1U);
+   SymPool_release(&oSymTable->sBindingPool, psCurrent);
+
+   assert(oSymTable->uLength > 0U);
+   oSymTable->uLength--;
+   SymTable_shrink(oSymTable);
+
+   return (void*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength)
+{
+   return SymTable_removeH(oSymTable, pcKey, uKeyLength,
+                           SymTable_hash(oSymTable, pcKey, uKeyLength));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+/* Remove from ppsBuckets[uFirst] through ppsBuckets[uBucketCount-1], */
+/* a bucket array of oSymTable, the bindings pfPredicate chooses, as  */
+/* SymTable_removeIf() does, and return how many were removed.        */
+
+static size_t SymTable_removeFromBuckets(
+   SymTable_T oSymTable, struct Binding **ppsBuckets, size_t uFirst,
+   size_t uBucketCount,
+   int (*pfPredicate)(const char *pcKey, void *pvValue, void *pvExtra),
+   void (*pfRelease)(const char *pcKey, void *pvValue, void *pvExtra),
+   const void *pvExtra)
+{
+   struct Binding **ppsLink;
+   struct Binding *psCurrent;
+   const char *pcKey;
+   size_t uRemoved = 0U;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(ppsBuckets != NULL);
+   assert(pfPredicate != NULL);
+
+   for (u = uFirst; u < uBucketCount; u++)
+   {
+      ppsLink = &ppsBuckets[u];
+      while (*ppsLink != NULL)
+      {
+         psCurrent = *ppsLink;
+         pcKey = SymTable_bindingKey(oSymTable, psCurrent);
+         if (!(*pfPredicate)(pcKey, (void*)psCurrent->pvValue,
+                             (void*)pvExtra))
+         {
+            ppsLink = &psCurrent->psNextBinding;
+            continue;
+         }
+
+         if (pfRelease != NULL)
+            (*pfRelease)(pcKey, (void*)psCurrent->pvValue,
+                         (void*)pvExtra);
+
+         /* remove psCurrent from the chain, and ppsLink is then the
+            link to the binding after it */
+         *ppsLink = psCurrent->psNextBinding;
+         if (!oSymTable->iBorrowKeys &&
+             psCurrent->uKeyLength >= (size_t)SHORT_KEY_SIZE)
+            SymArena_release(&oSymTable->sKeyArena,
+                             psCurrent->uKey.pcLongKey,
+                             psCurrent->uKeyLength + 1U);
+         SymPool_release(&oSymTable->sBindingPool, psCurrent);
+         uRemoved++;
+      }
+   }
+   return uRemoved;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_removeIf(SymTable_T oSymTable,
+                         int (*pfPredicate)(const char *pcKey,
+                                            void *pvValue,
+                                            void *pvExtra),
+                         void (*pfRelease)(const char *pcKey,
+                                           void *pvValue,
+                                           void *pvExtra),
+                         const void *pvExtra)
+{
+   size_t uRemoved;
+
+   assert(oSymTable != NULL);
+   assert(pfPredicate != NULL);
+
+   uRemoved = SymTable_removeFromBuckets(oSymTable,
+                                         oSymTable->ppsBuckets, 0U,
+                                         oSymTable->uBucketCount,
+                                         pfPredicate, pfRelease,
+                                         pvExtra);
+   if (oSymTable->ppsOldBuckets != NULL)
+      uRemoved += SymTable_removeFromBuckets(oSymTable,
+                                             oSymTable->ppsOldBuckets,
+                                             oSymTable->uMigrateIndex,
+                                             oSymTable->uOldBucketCount,
+                                             pfPredicate, pfRelease,
+                                             pvExtra);
+
+   assert(oSymTable->uLength >= uRemoved);
+   oSymTable->uLength -= uRemoved;
+
+   /* a sweep may leave the table far below the length that would
+      shrink it one step, so fit it to what is left at once */
+   if (oSymTable->uLength < oSymTable->uShrinkLength)
+      (void)SymTable_compact(oSymTable);
+
+   return uRemoved;
+}
+
+/*--------------------------------------------------------------------*/
+/* Hash the uCount keys apcKeys[0..uCount-1], storing their lengths   */
+/* in auLengths and their hash codes in auHashes, and prefetch the    */
+/* bucket heads and then the first Bindings of their chains, so the   */
+/* cache misses of all the keys overlap. uCount must not exceed       */
+/* BATCH_SIZE.                                                        */
+
+static void SymTable_prepareBatch(SymTable_T oSymTable,
+                                  const char *const apcKeys[],
+                                  size_t uCount, size_t auLengths[],
+                                  size_t auHashes[])
+{
+   size_t uMask;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL);
+   assert(uCount <= (size_t)BATCH_SIZE);
+
+   uMask = oSymTable->uBucketCount - 1U;
+   for (u = 0; u < uCount; u++)
+   {
+      assert(apcKeys[u] != NULL);
+      auLengths[u] = strlen(apcKeys[u]);
+      auHashes[u] = SymTable_hash(oSymTable, apcKeys[u], auLengths[u]);
+      PREFETCH(&oSymTable->ppsBuckets[auHashes[u] & uMask]);
+   }
+
+   for (u = 0; u < uCount; u++)
+      PREFETCH(oSymTable->ppsBuckets[auHashes[u] & uMask]);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable,
+                       const char *const apcKeys[], size_t uCount,
+                       void *apvValues[])
+{
+   size_t auLengths[BATCH_SIZE];
+   size_t auHashes[BATCH_SIZE];
+   struct Binding **ppsLink;
+   size_t uFirst;
+   size_t uGroup;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0U);
+   assert(apvValues != NULL || uCount == 0U);
+
+   for (uFirst = 0; uFirst < uCount; uFirst += uGroup)
+   {
+      uGroup = uCount - uFirst;
+      if (uGroup > (size_t)BATCH_SIZE)
+         uGroup = BATCH_SIZE;
+
+      SymTable_prepareBatch(oSymTable, &apcKeys[uFirst], uGroup,
+                            auLengths, auHashes);
+
+      for (u = 0; u < uGroup; u++)
+      {
+         ppsLink = SymTable_findLink(oSymTable, apcKeys[uFirst + u],
+                                     auLengths[u], auHashes[u]);
+         apvValues[uFirst + u] =
+            ppsLink == NULL ? NULL : (void*)(*ppsLink)->pvValue;
+      }
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable,
+                         const char *const apcKeys[],
+                         const void *const apvValues[], size_t uCount)
+{
+   size_t auLengths[BATCH_SIZE];
+   size_t auHashes[BATCH_SIZE];
+   size_t uPutCount;
+   size_t uFirst;
+   size_t uGroup;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0U);
+   assert(apvValues != NULL || uCount == 0U);
+
+   uPutCount = 0U;
+   for (uFirst = 0; uFirst < uCount; uFirst += uGroup)
+   {
+      uGroup = uCount - uFirst;
+      if (uGroup > (size_t)BATCH_SIZE)
+         uGroup = BATCH_SIZE;
+
+      SymTable_prepareBatch(oSymTable, &apcKeys[uFirst], uGroup,
+                            auLengths, auHashes);
+
+      /* an expansion partway through leaves the prefetches stale,
+         which costs only their benefit */
+      for (u = 0; u < uGroup; u++)
+      {
+         if (SymTable_findLink(oSymTable, apcKeys[uFirst + u],
+                               auLengths[u], auHashes[u]) == NULL &&
+             SymTable_insert(oSymTable, apcKeys[uFirst + u],
+                             auLengths[u], auHashes[u],
+                             apvValues[uFirst + u]) != NULL)
+            uPutCount++;
+      }
+   }
+
+   return uPutCount;
+}
+
+/*--------------------------------------------------------------------*/
+/* call pfApply for each binding in ppsBuckets[uFirst] through        */
+/* ppsBuckets[uBucketCount-1], a bucket array of oSymTable.           */
+
+static void SymTable_mapBuckets(SymTable_T oSymTable,
+                                struct Binding **ppsBuckets,
+                                size_t uFirst, size_t uBucketCount,
+                                void (*pfApply)(const char *pcKey,
+                                                void *pvValue,
+                                                void *pvExtra),
+                                const void *pvExtra)
+{
+   size_t u;
+   struct Binding *psCurrent;
+
+   assert(oSymTable != NULL);
+   assert(ppsBuckets != NULL);
+   assert(pfApply != NULL);
+
+   for (u = uFirst; u < uBucketCount; u++)
+   {
+      for (psCurrent = ppsBuckets[u];
+           psCurrent != NULL;
+           psCurrent = psCurrent->psNextBinding)
+      {
+        /* call pfApply for each binding */
+         (*pfApply)(SymTable_bindingKey(oSymTable, psCurrent),
+                    (void*)psCurrent->pvValue,
+                    (void*)pvExtra);
+      }
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey,
+                                  void *pvValue,
+                                  void *pvExtra),
+                  const void *pvExtra)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   SymTable_mapBuckets(oSymTable, oSymTable->ppsBuckets, 0U,
+                       oSymTable->uBucketCount, pfApply, pvExtra);
+   if (oSymTable->ppsOldBuckets != NULL)
+      SymTable_mapBuckets(oSymTable, oSymTable->ppsOldBuckets,
+                          oSymTable->uMigrateIndex,
+                          oSymTable->uOldBucketCount,
+                          pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable,
+                        struct SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   /* with one bucket array, lookups have nothing to migrate */
+   SymTable_migrate(oSymTable, oSymTable->uOldBucketCount);
+
+   psIter->oSymTable = oSymTable;
+   psIter->pvNext = NULL;
+   psIter->uIndex = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(struct SymTable_Iter *psIter,
+                      const char **ppcKey, void **ppvValue)
+{
+   SymTable_T oSymTable;
+   const struct Binding *psBinding;
+
+   assert(psIter != NULL);
+   assert(psIter->oSymTable != NULL);
+   assert(ppcKey != NULL);
+   assert(ppvValue != NULL);
+
+   /* pvNext is the rest of the chain of bucket uIndex-1 */
+   oSymTable = psIter->oSymTable;
+   psBinding = (const struct Binding*)psIter->pvNext;
+   while (psBinding == NULL)
+   {
+      if (psIter->uIndex == oSymTable->uBucketCount)
+         return 0;
+      psBinding = oSymTable->ppsBuckets[psIter->uIndex];
+      psIter->uIndex++;
+   }
+
+   psIter->pvNext = psBinding->psNextBinding;
+   *ppcKey = SymTable_bindingKey(oSymTable, psBinding);
+   *ppvValue = (void*)psBinding->pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/* Count in *psStats the chains of ppsBuckets[uFirst] through         */
+/* ppsBuckets[uBucketCount-1], a bucket array of a SymTable.          */
+
+static void SymTable_countChains(struct SymTable_Stats *psStats,
+                                 struct Binding **ppsBuckets,
+                                 size_t uFirst, size_t uBucketCount)
+{
+   struct Binding *psCurrent;
+   size_t uLength;
+   size_t u;
+
+   assert(psStats != NULL);
+   assert(ppsBuckets != NULL);
+
+   for (u = uFirst; u < uBucketCount; u++)
+   {
+      uLength = 0U;
+      for (psCurrent = ppsBuckets[u];
+           psCurrent != NULL;
+           psCurrent = psCurrent->psNextBinding)
+         uLength++;
+      SymStats_addChain(psStats, uLength);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getStats(SymTable_T oSymTable,
+                       struct SymTable_Stats *psStats)
+{
+   assert(oSymTable != NULL);
+   assert(psStats != NULL);
+
+#ifdef SYMTABLE_STATS
+   *psStats = oSymTable->sStats;
+#else
+   SymStats_init(psStats);
+#endif
+
+   /* buckets an incremental resize has yet to move count too */
+   SymTable_countChains(psStats, oSymTable->ppsBuckets, 0U,
+                        oSymTable->uBucketCount);
+   if (oSymTable->ppsOldBuckets != NULL)
+      SymTable_countChains(psStats, oSymTable->ppsOldBuckets,
+                           oSymTable->uMigrateIndex,
+                           oSymTable->uOldBucketCount);
+   SymStats_finish(psStats, oSymTable->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the number of bytes of the key strings that oSymTable keeps */
+/* in its key arena for the bindings of ppsBuckets[uFirst] through    */
+/* ppsBuckets[uBucketCount-1], a bucket array of oSymTable.           */
+
+static size_t SymTable_countKeyBytes(SymTable_T oSymTable,
+                                     struct Binding **ppsBuckets,
+                                     size_t uFirst,
+                                     size_t uBucketCount)
+{
+   struct Binding *psCurrent;
+   size_t uKeyBytes = 0U;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(ppsBuckets != NULL);
+
+   if (oSymTable->iBorrowKeys)
+      return 0U;
+
+   for (u = uFirst; u < uBucketCount; u++)
+      for (psCurrent = ppsBuckets[u];
+           psCurrent != NULL;
+           psCurrent = psCurrent->psNextBinding)
+         if (psCurrent->uKeyLength >= (size_t)SHORT_KEY_SIZE)
+            uKeyBytes += psCurrent->uKeyLength + 1U;
+   return uKeyBytes;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_memoryUsage(SymTable_T oSymTable,
+                            struct SymTable_Memory *psMemory)
+{
+   struct SymTable_Memory sMemory;
+
+   assert(oSymTable != NULL);
+
+   sMemory.uTableBytes = sizeof(struct SymTable);
+   sMemory.uIndexBytes = 0U;
+   if (!SymTable_isSmall(oSymTable))
+      sMemory.uIndexBytes +=
+         oSymTable->uBucketCount * sizeof(struct Binding*);
+   if (oSymTable->ppsOldBuckets != NULL &&
+       oSymTable->ppsOldBuckets != &oSymTable->psSmallBucket)
+      sMemory.uIndexBytes +=
+         oSymTable->uOldBucketCount * sizeof(struct Binding*);
+   sMemory.uBindingBytes = oSymTable->uLength * sizeof(struct Binding);
+
+   sMemory.uKeyBytes =
+      SymTable_countKeyBytes(oSymTable, oSymTable->ppsBuckets, 0U,
+                             oSymTable->uBucketCount);
+   if (oSymTable->ppsOldBuckets != NULL)
+      sMemory.uKeyBytes +=
+         SymTable_countKeyBytes(oSymTable, oSymTable->ppsOldBuckets,
+                                oSymTable->uMigrateIndex,
+                                oSymTable->uOldBucketCount);
+
+   return SymStats_finishMemory(
+      &sMemory,
+      sMemory.uTableBytes + sMemory.uIndexBytes +
+         SymPool_getFootprint(&oSymTable->sBindingPool) +
+         SymArena_getFootprint(&oSymTable->sKeyArena),
+      psMemory);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapRange(SymTable_T oSymTable,
+                      const char *pcLow, const char *pcHigh,
+                      void (*pfApply)(const char *pcKey,
+                                      void *pvValue,
+                                      void *pvExtra),
+                      const void *pvExtra)
+{
+   /* hashing scatters neighboring keys, so they are sorted here */
+   return SymOrder_mapRange(oSymTable, pcLow, pcHigh, pfApply,
+                            pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+                       void (*pfApply)(const char *pcKey,
+                                       void *pvValue,
+                                       void *pvExtra),
+                       const void *pvExtra)
+{
+   return SymOrder_mapPrefix(oSymTable, pcPrefix, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the number of threads to split uWorkCount buckets or keys   */
+/* among, given a limit of uThreadCount.                              */
+
+static size_t SymTable_threadCount(size_t uThreadCount,
+                                   size_t uWorkCount)
+{
+   if (uThreadCount > uWorkCount / MIN_WORK_PER_THREAD)
+      uThreadCount = uWorkCount / MIN_WORK_PER_THREAD;
+   if (uThreadCount == 0U)
+      uThreadCount = 1U;
+   return uThreadCount;
+}
+
+/*--------------------------------------------------------------------*/
+/* One thread's share of a SymTable_mapParallel() call.               */
+
+struct MapWork
+{
+   /* the table being mapped. */
+   SymTable_T oSymTable;
+
+   /* this thread visits ppsBuckets[uFirst] through
+      ppsBuckets[uLast-1]. */
+   size_t uFirst;
+   size_t uLast;
+
+   /* the arguments of SymTable_mapParallel(). */
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+   const void *pvExtra;
+};
+
+/*--------------------------------------------------------------------*/
+/* Do the work *(struct MapWork*)pvWork, and return NULL.             */
+
+static void *SymTable_mapWork(void *pvWork)
+{
+   struct MapWork *psWork;
+
+   assert(pvWork != NULL);
+
+   psWork = (struct MapWork*)pvWork;
+   SymTable_mapBuckets(psWork->oSymTable,
+                       psWork->oSymTable->ppsBuckets,
+                       psWork->uFirst, psWork->uLast,
+                       psWork->pfApply, psWork->pvExtra);
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable, size_t uThreadCount,
+                          void (*pfApply)(const char *pcKey,
+                                          void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra)
+{
+   struct MapWork *psWorks;
+   size_t uShare;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   /* with every binding in one array, the buckets can be dealt out
+      evenly */
+   SymTable_migrate(oSymTable, oSymTable->uOldBucketCount);
+
+   uThreadCount =
+      SymTable_threadCount(uThreadCount, oSymTable->uBucketCount);
+   psWorks = NULL;
+   if (uThreadCount > 1U)
+      psWorks = (struct MapWork*)malloc(uThreadCount *
+                                        sizeof(struct MapWork));
+   if (psWorks == NULL)
+   {
+      SymTable_map(oSymTable, pfApply, pvExtra);
+      return;
+   }
+
+   uShare = (oSymTable->uBucketCount + uThreadCount - 1U) /
+            uThreadCount;
+   for (u = 0; u < uThreadCount; u++)
+   {
+      psWorks[u].oSymTable = oSymTable;
+      psWorks[u].uFirst = u * uShare;
+      psWorks[u].uLast = psWorks[u].uFirst + uShare;
+      if (psWorks[u].uLast > oSymTable->uBucketCount)
+         psWorks[u].uLast = oSymTable->uBucketCount;
+      psWorks[u].pfApply = pfApply;
+      psWorks[u].pvExtra = pvExtra;
+   }
+
+   SymThread_runAll(SymTable_mapWork, psWorks, sizeof(struct MapWork),
+                    uThreadCount);
+   free(psWorks);
+}
+
+/*--------------------------------------------------------------------*/
+/* One thread's share of a SymTable_putParallel() call.               */
+
+struct LoadWork
+{
+   /* the table being loaded. */
+   SymTable_T oSymTable;
+
+   /* all the keys and values being put, and the lengths and hash
+      codes of the keys. */
+   const char *const *apcKeys;
+   const void *const *apvValues;
+   size_t *auLengths;
+   size_t *auHashes;
+
+   /* first this thread measures and hashes apcKeys[uFirst] through
+      apcKeys[uLast-1]; then it puts the keys whose indices are
+      auOrder[uFirst] through auOrder[uLast-1], all of which belong
+      in its own range of buckets. */
+   const size_t *auOrder;
+   size_t uFirst;
+   size_t uLast;
+
+   /* where this thread allocates Bindings and key copies, without
+      locking, until they are merged into the table's own. */
+   struct SymPool sBindingPool;
+   struct SymArena sKeyArena;
+
+   /* the number of keys this thread put. */
+   size_t uPutCount;
+};
+
+/*--------------------------------------------------------------------*/
+/* Do the first part of the work *(struct LoadWork*)pvWork, and       */
+/* return NULL.                                                       */
+
+static void *SymTable_hashWork(void *pvWork)
+{
+   struct LoadWork *psWork;
+   size_t u;
+
+   assert(pvWork != NULL);
+
+   psWork = (struct LoadWork*)pvWork;
+   for (u = psWork->uFirst; u < psWork->uLast; u++)
+   {
+      assert(psWork->apcKeys[u] != NULL);
+      psWork->auLengths[u] = strlen(psWork->apcKeys[u]);
+      psWork->auHashes[u] = SymTable_hash(psWork->oSymTable,
+                                          psWork->apcKeys[u],
+                                          psWork->auLengths[u]);
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+/* Do the second part of the work *(struct LoadWork*)pvWork, and      */
+/* return NULL. No other thread touches the buckets it links into.    */
+
+static void *SymTable_loadWork(void *pvWork)
+{
+   struct LoadWork *psWork;
+   SymTable_T oSymTable;
+   struct Binding *psNewBinding;
+   size_t uIndex;
+   size_t u;
+   size_t i;
+
+   assert(pvWork != NULL);
+
+   psWork = (struct LoadWork*)pvWork;
+   oSymTable = psWork->oSymTable;
+   for (i = psWork->uFirst; i < psWork->uLast; i++)
+   {
+      u = psWork->auOrder[i];
+      if (SymTable_findLink(oSymTable, psWork->apcKeys[u],
+                            psWork->auLengths[u],
+                            psWork->auHashes[u]) != NULL)
+         continue;
+
+      psNewBinding = SymTable_newBinding(oSymTable,
+                                         &psWork->sBindingPool,
+                                         &psWork->sKeyArena,
+                                         psWork->apcKeys[u],
+                                         psWork->auLengths[u],
+                                         psWork->auHashes[u],
+                                         psWork->apvValues[u]);
+      if (psNewBinding == NULL)
+         continue;
+
+      uIndex = psWork->auHashes[u] & (oSymTable->uBucketCount - 1U);
+      psNewBinding->psNextBinding = oSymTable->ppsBuckets[uIndex];
+      oSymTable->ppsBuckets[uIndex] = psNewBinding;
+      psWork->uPutCount++;
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putParallel(SymTable_T oSymTable,
+                            const char *const apcKeys[],
+                            const void *const apvValues[],
+                            size_t uCount, size_t uThreadCount)
+{
+   struct LoadWork *psWorks;
+   size_t *auLengths;
+   size_t *auHashes;
+   size_t *auOrder;
+   size_t uMask;
+   size_t uShare;
+   size_t uNext;
+   size_t uPutCount;
+   size_t uOwner;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0U);
+   assert(apvValues != NULL || uCount == 0U);
+
+   /* make room for every key first, so no thread ever expands */
+   uThreadCount = SymTable_threadCount(uThreadCount, uCount);
+   if (uThreadCount == 1U ||
+       uCount > ((size_t)-1 - oSymTable->uLength) ||
+       uCount > (size_t)-1 / (3U * sizeof(size_t)) ||
+       !SymTable_growTo(oSymTable, oSymTable->uLength + uCount))
+      return SymTable_putBatch(oSymTable, apcKeys, apvValues, uCount);
+
+   auLengths = (size_t*)malloc(3U * uCount * sizeof(size_t));
+   psWorks = (struct LoadWork*)malloc(uThreadCount *
+                                      sizeof(struct LoadWork));
+   if (auLengths == NULL || psWorks == NULL)
+   {
+      free(auLengths);
+      free(psWorks);
+      return SymTable_putBatch(oSymTable, apcKeys, apvValues, uCount);
+   }
+   auHashes = auLengths + uCount;
+   auOrder = auHashes + uCount;
+
+   /* measure and hash the keys in parallel, a slice each */
+   uShare = (uCount + uThreadCount - 1U) / uThreadCount;
+   for (u = 0; u < uThreadCount; u++)
+   {
+      psWorks[u].oSymTable = oSymTable;
+      psWorks[u].apcKeys = apcKeys;
+      psWorks[u].apvValues = apvValues;
+      psWorks[u].auLengths = auLengths;
+      psWorks[u].auHashes = auHashes;
+      psWorks[u].auOrder = auOrder;
+      psWorks[u].uFirst = u * uShare;
+      if (psWorks[u].uFirst > uCount)
+         psWorks[u].uFirst = uCount;
+      psWorks[u].uLast = psWorks[u].uFirst + uShare;
+      if (psWorks[u].uLast > uCount)
+         psWorks[u].uLast = uCount;
+      SymPool_init(&psWorks[u].sBindingPool, sizeof(struct Binding));
+      SymArena_init(&psWorks[u].sKeyArena);
+      psWorks[u].uPutCount = 0U;
+   }
+   SymThread_runAll(SymTable_hashWork, psWorks, sizeof(struct LoadWork),
+                    uThreadCount);
+
+   /* deal the keys out by range of buckets with a counting sort. It
+      keeps equal keys in their order, so the first of them wins as
+      in SymTable_putBatch() */
+   uMask = oSymTable->uBucketCount - 1U;
+   uShare = (oSymTable->uBucketCount + uThreadCount - 1U) /
+            uThreadCount;
+   for (u = 0; u < uThreadCount; u++)
+      psWorks[u].uLast = 0U;
+   for (u = 0; u < uCount; u++)
+      psWorks[(auHashes[u] & uMask) / uShare].uLast++;
+   uNext = 0U;
+   for (u = 0; u < uThreadCount; u++)
+   {
+      psWorks[u].uFirst = uNext;
+      uNext += psWorks[u].uLast;
+      psWorks[u].uLast = psWorks[u].uFirst;
+   }
+   for (u = 0; u < uCount; u++)
+   {
+      uOwner = (auHashes[u] & uMask) / uShare;
+      auOrder[psWorks[uOwner].uLast++] = u;
+   }
+
+   SymThread_runAll(SymTable_loadWork, psWorks, sizeof(struct LoadWork),
+                    uThreadCount);
+
+   /* hand everything the threads allocated over to the table */
+   uPutCount = 0U;
+   for (u = 0; u < uThreadCount; u++)
+   {
+      SymPool_merge(&oSymTable->sBindingPool, &psWorks[u].sBindingPool);
+      SymArena_merge(&oSymTable->sKeyArena, &psWorks[u].sKeyArena);
+      uPutCount += psWorks[u].uPutCount;
+   }
+   oSymTable->uLength += uPutCount;
+
+   free(auLengths);
+   free(psWorks);
+   return uPutCount;
 }
 
 /*--------------------------------------------------------------------*/
@@ -3,10 +3,19 @@
 /*--------------------------------------------------------------------*/
 
 #include "symtable.h"
+#include "symhash.h"
+#include "symalloc.h"
+#include "symorder.h"
+#include "symstats.h"
+#include "symtrace.h"
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* keys shorter than SHORT_KEY_SIZE bytes, not counting the NUL, are
+   stored right in their Binding. */
+enum { SHORT_KEY_SIZE = 16 };
+
 /*--------------------------------------------------------------------*/
 
 /* Each binding is stored in a Binding.  Bindings are linked to form
@@ -14,8 +23,18 @@
 
 struct Binding
 {
-   /* The key string. */
-   char *pcKey;
+   /* The length of the key string, not counting its NUL. */
+   size_t uKeyLength;
+
+   /* The key string. A key shorter than SHORT_KEY_SIZE is stored in
+      acShortKey; a longer one lives in the table's key arena and
+      pcLongKey points to it. In a table that borrows its keys,
+      pcLongKey is the caller's own string, whatever its length. */
+   union
+   {
+      char acShortKey[SHORT_KEY_SIZE];
+      char *pcLongKey;
+   } uKey;
 
    /* The value associated with the key. */
    const void *pvValue;
@@ -36,94 +55,349 @@ struct SymTable
 
    /* The number of bindings in SymTable. */
    size_t uLength;
+
+   /* Where this table's Bindings and key strings are allocated. */
+   struct SymPool sBindingPool;
+   struct SymArena sKeyArena;
+
+   /* Nonzero if Bindings point to the callers' key strings instead
+      of holding copies. */
+   int iBorrowKeys;
+
+   /* Nonzero if a Binding that a lookup finds moves to the front of
+      the list, so the keys used most are found soonest. */
+   int iMoveToFront;
+
+   /* The trace function and the sampling of lookups for it. */
+   struct SymTrace sTrace;
+
+#ifdef SYMTABLE_STATS
+   /* The counters reported by SymTable_getStats(). */
+   struct SymTable_Stats sStats;
+#endif
 };
 
 /*--------------------------------------------------------------------*/
 
+/* Return the key string of psBinding, a Binding of oSymTable. */
+
+static const char *SymTable_bindingKey(SymTable_T oSymTable,
+                                       const struct Binding *psBinding)
+{
+   assert(oSymTable != NULL);
+   assert(psBinding != NULL);
+
+   if (!oSymTable->iBorrowKeys &&
+       psBinding->uKeyLength < (size_t)SHORT_KEY_SIZE)
+      return psBinding->uKey.acShortKey;
+   return psBinding->uKey.pcLongKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_initOptions(struct SymTable_Options *psOptions)
+{
+   assert(psOptions != NULL);
+
+   /* a list has no buckets, so the load factor is never consulted */
+   psOptions->dMaxLoadFactor = 1.0;
+   psOptions->uRehashStep = 0U;
+   psOptions->pfHash = NULL;
+   psOptions->uHashSeed = 0U;
+   psOptions->iBorrowKeys = 0;
+   psOptions->iMoveToFront = 0;
+   psOptions->pfTrace = NULL;
+   psOptions->pvTraceExtra = NULL;
+   psOptions->uTraceSampleInterval = 1024U;
+   psOptions->dTraceMinSeconds = 0.0;
+   psOptions->uTraceMinProbes = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+
 SymTable_T SymTable_new(void)
+{
+   struct SymTable_Options sOptions;
+
+   SymTable_initOptions(&sOptions);
+   return SymTable_newWithOptions(&sOptions);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithOptions(
+   const struct SymTable_Options *psOptions)
 {
    SymTable_T oSymTable;
 
+   assert(psOptions != NULL);
+   assert(psOptions->dMaxLoadFactor > 0.0);
+
    oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
    if (oSymTable == NULL)
       return NULL;
 
    oSymTable->psFirstBinding = NULL;
    oSymTable->uLength = 0U;
+   oSymTable->iBorrowKeys = psOptions->iBorrowKeys;
+   oSymTable->iMoveToFront = psOptions->iMoveToFront;
+
+   SymPool_init(&oSymTable->sBindingPool, sizeof(struct Binding));
+   SymArena_init(&oSymTable->sKeyArena);
+   SymTrace_init(&oSymTable->sTrace, psOptions);
+#ifdef SYMTABLE_STATS
+   SymStats_init(&oSymTable->sStats);
+#endif
 
    return oSymTable;
 }
 
 /*--------------------------------------------------------------------*/
 
+SymTable_T SymTable_newWithCapacity(size_t uCount)
+{
+   /* a list never resizes, so there is no room to make */
+   (void)uCount;
+   return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
 void SymTable_free(SymTable_T oSymTable)
 {
-   struct Binding *psCurrentBinding;
-   struct Binding *psNextBinding;
+   assert(oSymTable != NULL);
+
+   /* freeing every binding and key string at once */
+   SymPool_destroy(&oSymTable->sBindingPool);
+   SymArena_destroy(&oSymTable->sKeyArena);
 
+   /* freeing all of oSymTable */
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
    assert(oSymTable != NULL);
+   return oSymTable->uLength;
+}
 
-   for (psCurrentBinding = oSymTable->psFirstBinding;
-        psCurrentBinding != NULL;
-        psCurrentBinding = psNextBinding)
+/*--------------------------------------------------------------------*/
+
+int SymTable_compact(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   /* a list has no array to shrink, and each
+      Binding is already released as it is removed */
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCount)
+{
+   assert(oSymTable != NULL);
+
+   /* a list never resizes, and allocates a Binding per put */
+   (void)uCount;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if psBinding, a Binding of oSymTable, holds the key of
+   uKeyLength bytes at pcKey, or 0 otherwise. The lengths are compared
+   first, so the bytes are compared only on a likely match. */
+
+static int SymTable_matches(SymTable_T oSymTable,
+                            const struct Binding *psBinding,
+                            const char *pcKey, size_t uKeyLength)
+{
+   assert(oSymTable != NULL);
+   assert(psBinding != NULL);
+   assert(pcKey != NULL);
+
+   SYMSTATS_ADD(oSymTable->sStats.uProbes, 1U);
+   if (psBinding->uKeyLength != uKeyLength)
+      return 0;
+
+   SYMSTATS_ADD(oSymTable->sStats.uKeyCompares, 1U);
+   return memcmp(SymTable_bindingKey(oSymTable, psBinding), pcKey,
+                 uKeyLength) == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the link -- psFirstBinding or the
+   psNextBinding field of a Binding -- that points to the Binding of
+   oSymTable whose key is the uKeyLength bytes at pcKey, or NULL if
+   that key is not present. */
+
+static struct Binding **SymTable_search(SymTable_T oSymTable,
+                                        const char *pcKey,
+                                        size_t uKeyLength)
+{
+   struct Binding **ppsLink;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   SYMSTATS_ADD(oSymTable->sStats.uLookups, 1U);
+   for (ppsLink = &oSymTable->psFirstBinding;
+        *ppsLink != NULL;
+        ppsLink = &(*ppsLink)->psNextBinding)
    {
-      psNextBinding = psCurrentBinding->psNextBinding;
+      if (SymTable_matches(oSymTable, *ppsLink, pcKey, uKeyLength))
+      {
+         SYMSTATS_ADD(oSymTable->sStats.uHits, 1U);
+         return ppsLink;
+      }
+   }
+
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of Bindings that SymTable_search() examined in
+   oSymTable to find psFound, or to find that a key is absent if
+   psFound is NULL. */
+
+static size_t SymTable_countProbes(SymTable_T oSymTable,
+                                   const struct Binding *psFound)
+{
+   const struct Binding *psBinding;
+   size_t uProbes = 0U;
 
-      /* freeing the key string */
-      free(psCurrentBinding->pcKey);
+   assert(oSymTable != NULL);
 
-      /* freeing the current binding */
-      free(psCurrentBinding);
+   for (psBinding = oSymTable->psFirstBinding;
+        psBinding != NULL;
+        psBinding = psBinding->psNextBinding)
+   {
+      uProbes++;
+      if (psBinding == psFound)
+         break;
    }
+   return uProbes;
+}
 
-   /* freeing all of oSymTable */
-   free(oSymTable);
+/*--------------------------------------------------------------------*/
+
+/* Return what SymTable_search() returns for the key of uKeyLength
+   bytes at pcKey, reporting the lookup to oSymTable's trace
+   function if it is sampled. */
+
+static struct Binding **SymTable_findLink(SymTable_T oSymTable,
+                                          const char *pcKey,
+                                          size_t uKeyLength)
+{
+   struct Binding **ppsLink;
+   const struct Binding *psFound;
+   double dStart;
+   double dSeconds;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   if (!SYMTRACE_SAMPLED(&oSymTable->sTrace))
+      return SymTable_search(oSymTable, pcKey, uKeyLength);
+
+   dStart = SymTrace_now();
+   ppsLink = SymTable_search(oSymTable, pcKey, uKeyLength);
+   dSeconds = SymTrace_now() - dStart;
+
+   psFound = ppsLink == NULL ? NULL : *ppsLink;
+   SymTrace_lookup(&oSymTable->sTrace, oSymTable, pcKey, uKeyLength,
+                   psFound != NULL,
+                   SymTable_countProbes(oSymTable, psFound), dSeconds);
+   return ppsLink;
 }
 
 /*--------------------------------------------------------------------*/
 
-size_t SymTable_getLength(SymTable_T oSymTable)
+/* Return the Binding of oSymTable whose key is the uKeyLength bytes
+   at pcKey, or NULL if that key is not present. If oSymTable was
+   created to move found Bindings to the front, the one returned is
+   now first. */
+
+static struct Binding *SymTable_find(SymTable_T oSymTable,
+                                     const char *pcKey,
+                                     size_t uKeyLength)
 {
+   struct Binding **ppsLink;
+   struct Binding *psCurrent;
+
    assert(oSymTable != NULL);
-   return oSymTable->uLength;
+   assert(pcKey != NULL);
+
+   ppsLink = SymTable_findLink(oSymTable, pcKey, uKeyLength);
+   if (ppsLink == NULL)
+      return NULL;
+
+   psCurrent = *ppsLink;
+   if (ppsLink != &oSymTable->psFirstBinding && oSymTable->iMoveToFront)
+   {
+      *ppsLink = psCurrent->psNextBinding;
+      psCurrent->psNextBinding = oSymTable->psFirstBinding;
+      oSymTable->psFirstBinding = psCurrent;
+   }
+   return psCurrent;
 }
 
 /*--------------------------------------------------------------------*/
 
-int SymTable_put(SymTable_T oSymTable,
-                 const char *pcKey, const void *pvValue)
+/* Insert a new binding of the uKeyLength bytes at pcKey to pvValue
+   at the front of oSymTable and return it, or return NULL if out of
+   memory. The key must not already be present. */
+
+static struct Binding *SymTable_insert(SymTable_T oSymTable,
+                                       const char *pcKey,
+                                       size_t uKeyLength,
+                                       const void *pvValue)
 {
    struct Binding *psNewBinding;
-   struct Binding *psCurrent;
    char *pcKeyCopy;
 
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
 
-   /* return 0 if key already exists */
-   for (psCurrent = oSymTable->psFirstBinding;
-         psCurrent != NULL;
-         psCurrent = psCurrent->psNextBinding)
-    {
-        if (strcmp(psCurrent->pcKey, pcKey) == 0)
-            return 0;
-    }
-
    /* allocating memory for the new binding node */
-   psNewBinding = (struct Binding*)malloc(sizeof(struct Binding));
+   psNewBinding =
+      (struct Binding*)SymPool_alloc(&oSymTable->sBindingPool);
    if (psNewBinding == NULL)
-      return 0;
+      return NULL;
 
-   pcKeyCopy = (char*)malloc(strlen(pcKey) + 1U);
-   if (pcKeyCopy == NULL)
+   /* borrowing the caller's key if the table was created to, or else
+      copying the key into the node if it is short enough, or into
+      the key arena otherwise. a copy is always NUL-terminated */
+   if (oSymTable->iBorrowKeys)
    {
-      free(psNewBinding);
-      return 0;
+      assert(pcKey[uKeyLength] == '\0');
+      psNewBinding->uKey.pcLongKey = (char*)pcKey;
+   }
+   else
+   {
+      if (uKeyLength < (size_t)SHORT_KEY_SIZE)
+         pcKeyCopy = psNewBinding->uKey.acShortKey;
+      else
+      {
+         pcKeyCopy =
+            SymArena_alloc(&oSymTable->sKeyArena, uKeyLength + 1U);
+         if (pcKeyCopy == NULL)
+         {
+            SymPool_release(&oSymTable->sBindingPool, psNewBinding);
+            return NULL;
+         }
+         psNewBinding->uKey.pcLongKey = pcKeyCopy;
+      }
+      memcpy(pcKeyCopy, pcKey, uKeyLength);
+      pcKeyCopy[uKeyLength] = '\0';
    }
-   strcpy(pcKeyCopy, pcKey);
-
 
-   psNewBinding->pcKey = pcKeyCopy;
+   psNewBinding->uKeyLength = uKeyLength;
    psNewBinding->pvValue = pvValue;
 
    /* insert new binding at the front of the list & update length */
@@ -131,7 +405,115 @@ int SymTable_put(SymTable_T oSymTable,
    oSymTable->psFirstBinding = psNewBinding;
    oSymTable->uLength++;
 
-   return 1;
+   return psNewBinding;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+                  size_t uKeyLength, const void *pvValue)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   /* return 0 if key already exists */
+   if (SymTable_find(oSymTable, pcKey, uKeyLength) != NULL)
+      return 0;
+
+   return SymTable_insert(oSymTable, pcKey, uKeyLength,
+                          pvValue) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+                 const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertN(SymTable_T oSymTable, const char *pcKey,
+                     size_t uKeyLength, const void *pvValue)
+{
+   struct Binding *psBinding;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psBinding = SymTable_find(oSymTable, pcKey, uKeyLength);
+   if (psBinding != NULL)
+   {
+      psBinding->pvValue = pvValue;
+      return 1;
+   }
+
+   return SymTable_insert(oSymTable, pcKey, uKeyLength,
+                          pvValue) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsert(SymTable_T oSymTable,
+                    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_upsertN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsertN(SymTable_T oSymTable, const char *pcKey,
+                             size_t uKeyLength, const void *pvValue)
+{
+   struct Binding *psBinding;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psBinding = SymTable_find(oSymTable, pcKey, uKeyLength);
+   if (psBinding == NULL)
+   {
+      psBinding = SymTable_insert(oSymTable, pcKey, uKeyLength,
+                                  pvValue);
+      if (psBinding == NULL)
+         return NULL;
+   }
+
+   return (void**)&psBinding->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+                            const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_getOrInsertN(oSymTable, pcKey, strlen(pcKey),
+                                pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable, const char *pcKey,
+                        size_t uKeyLength, const void *pvValue)
+{
+   struct Binding *psBinding;
+   const void *pvOldValue;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psBinding = SymTable_find(oSymTable, pcKey, uKeyLength);
+   if (psBinding == NULL)
+      return NULL;
+
+   /* store the old value, replace it, and return the old value */
+   pvOldValue = psBinding->pvValue;
+   psBinding->pvValue = pvValue;
+   return (void*)pvOldValue;
 }
 
 /*--------------------------------------------------------------------*/
@@ -139,116 +521,264 @@ int SymTable_put(SymTable_T oSymTable,
 void *SymTable_replace(SymTable_T oSymTable,
                        const char *pcKey, const void *pvValue)
 {
-   struct Binding *psCurrent;
-    const void *pvOldValue;
+   assert(pcKey != NULL);
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
 
-    assert(oSymTable != NULL);
-    assert(pcKey != NULL);
+/*--------------------------------------------------------------------*/
 
-    for (psCurrent = oSymTable->psFirstBinding;
-         psCurrent != NULL;
-         psCurrent = psCurrent->psNextBinding)
-    {
-        /* if we find the key that we want to replace */
-        if (strcmp(psCurrent->pcKey, pcKey) == 0)
-        {
-            /* store the old value, replace it, and return the old value */
-            pvOldValue = psCurrent->pvValue;
-            psCurrent->pvValue = pvValue;
-            return (void*)pvOldValue;
-        }
-    }
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
 
-    return NULL;
+   return SymTable_find(oSymTable, pcKey, uKeyLength) != NULL;
 }
 
 /*--------------------------------------------------------------------*/
 
 int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
 {
-   struct Binding *psCurrent;
+   assert(pcKey != NULL);
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
 
-    assert(oSymTable != NULL);
-    assert(pcKey != NULL);
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+                    size_t uKeyLength)
+{
+   struct Binding *psBinding;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
 
-    for (psCurrent = oSymTable->psFirstBinding;
-         psCurrent != NULL;
-         psCurrent = psCurrent->psNextBinding)
-    {
-        /* if we find the key */
-        if (strcmp(psCurrent->pcKey, pcKey) == 0)
-        /* return 1 to show key exists */
-            return 1;
-    }
-    /* return 0 to show key does not exist */
-    return 0;
+   psBinding = SymTable_find(oSymTable, pcKey, uKeyLength);
+   if (psBinding == NULL)
+      return NULL;
+   return (void*)psBinding->pvValue;
 }
 
 /*--------------------------------------------------------------------*/
 
 void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
 {
-   struct Binding *psCurrent;
+   assert(pcKey != NULL);
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
 
-    assert(oSymTable != NULL);
-    assert(pcKey != NULL);
+/*--------------------------------------------------------------------*/
 
-    for (psCurrent = oSymTable->psFirstBinding;
-         psCurrent != NULL;
-         psCurrent = psCurrent->psNextBinding)
-    {
-        /* if we find the key, return its value */
-        if (strcmp(psCurrent->pcKey, pcKey) == 0)
-            return (void*)psCurrent->pvValue;
-    }
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength)
+{
+   struct Binding **ppsLink;
+   struct Binding *psCurrentBinding;
+   const void *pvValue;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppsLink = SymTable_findLink(oSymTable, pcKey, uKeyLength);
+   if (ppsLink == NULL)
+      return NULL;
+
+   /* unlink the binding, storing the value to return later */
+   psCurrentBinding = *ppsLink;
+   pvValue = psCurrentBinding->pvValue;
+   *ppsLink = psCurrentBinding->psNextBinding;
+
+   if (!oSymTable->iBorrowKeys &&
+       psCurrentBinding->uKeyLength >= (size_t)SHORT_KEY_SIZE)
+      SymArena_release(&oSymTable->sKeyArena,
+                       psCurrentBinding->uKey.pcLongKey,
+                       psCurrentBinding->uKeyLength + 1U);
+   SymPool_release(&oSymTable->sBindingPool, psCurrentBinding);
+
+   /* decrease length as long as it is greater than 0 */
+   assert(oSymTable->uLength > 0U);
+   oSymTable->uLength--;
 
-    return NULL;
+   return (void*)pvValue;
 }
 
 /*--------------------------------------------------------------------*/
 
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
 {
-   struct Binding *psCurrentBinding;
-   struct Binding *psPrevBinding;
-   const void *pvValue;
+   assert(pcKey != NULL);
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+/* A list does not hash, so the code SymTable_hashN() returns is only */
+/* SymHash_word()'s with seed 0, and the functions that take one      */
+/* ignore it.                                                         */
 
+size_t SymTable_hashN(SymTable_T oSymTable, const char *pcKey,
+                      size_t uKeyLength)
+{
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
 
-   psPrevBinding = NULL;
-   psCurrentBinding = oSymTable->psFirstBinding;
+   return SymHash_word(pcKey, uKeyLength, 0U);
+}
 
-   while (psCurrentBinding != NULL)
-   {
-    /* if we find the key to remove */
-      if (strcmp(psCurrentBinding->pcKey, pcKey) == 0)
-      {
-        /* store the value to return later */
-         pvValue = psCurrentBinding->pvValue;
+/*--------------------------------------------------------------------*/
+
+int SymTable_putH(SymTable_T oSymTable, const char *pcKey,
+                  size_t uKeyLength, size_t uHash,
+                  const void *pvValue)
+{
+   (void)uHash;
+   return SymTable_putN(oSymTable, pcKey, uKeyLength, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertH(SymTable_T oSymTable, const char *pcKey,
+                     size_t uKeyLength, size_t uHash,
+                     const void *pvValue)
+{
+   (void)uHash;
+   return SymTable_upsertN(oSymTable, pcKey, uKeyLength, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsertH(SymTable_T oSymTable, const char *pcKey,
+                             size_t uKeyLength, size_t uHash,
+                             const void *pvValue)
+{
+   (void)uHash;
+   return SymTable_getOrInsertN(oSymTable, pcKey, uKeyLength, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceH(SymTable_T oSymTable, const char *pcKey,
+                        size_t uKeyLength, size_t uHash,
+                        const void *pvValue)
+{
+   (void)uHash;
+   return SymTable_replaceN(oSymTable, pcKey, uKeyLength, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsH(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength, size_t uHash)
+{
+   (void)uHash;
+   return SymTable_containsN(oSymTable, pcKey, uKeyLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getH(SymTable_T oSymTable, const char *pcKey,
+                    size_t uKeyLength, size_t uHash)
+{
+   (void)uHash;
+   return SymTable_getN(oSymTable, pcKey, uKeyLength);
+}
 
-         if (psPrevBinding == NULL)
-            oSymTable->psFirstBinding
-               = psCurrentBinding->psNextBinding;
-         else
-            psPrevBinding->psNextBinding
-               = psCurrentBinding->psNextBinding;
+/*--------------------------------------------------------------------*/
 
-         free(psCurrentBinding->pcKey);
-         free(psCurrentBinding);
+void *SymTable_removeH(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength, size_t uHash)
+{
+   (void)uHash;
+   return SymTable_removeN(oSymTable, pcKey, uKeyLength);
+}
 
-         /* decrease length as long as it is greater than 0 */
-         assert(oSymTable->uLength > 0U);
-         oSymTable->uLength--;
+/*--------------------------------------------------------------------*/
 
-         return (void*)pvValue;
+size_t SymTable_removeIf(SymTable_T oSymTable,
+                         int (*pfPredicate)(const char *pcKey,
+                                            void *pvValue,
+                                            void *pvExtra),
+                         void (*pfRelease)(const char *pcKey,
+                                           void *pvValue,
+                                           void *pvExtra),
+                         const void *pvExtra)
+{
+   struct Binding **ppsLink;
+   struct Binding *psCurrentBinding;
+   const char *pcKey;
+   size_t uRemoved = 0U;
+
+   assert(oSymTable != NULL);
+   assert(pfPredicate != NULL);
+
+   ppsLink = &oSymTable->psFirstBinding;
+   while (*ppsLink != NULL)
+   {
+      psCurrentBinding = *ppsLink;
+      pcKey = SymTable_bindingKey(oSymTable, psCurrentBinding);
+      if (!(*pfPredicate)(pcKey, (void*)psCurrentBinding->pvValue,
+                          (void*)pvExtra))
+      {
+         ppsLink = &psCurrentBinding->psNextBinding;
+         continue;
       }
 
-      psPrevBinding = psCurrentBinding;
-      psCurrentBinding = psCurrentBinding->psNextBinding;
+      if (pfRelease != NULL)
+         (*pfRelease)(pcKey, (void*)psCurrentBinding->pvValue,
+                      (void*)pvExtra);
+
+      /* unlink the binding, leaving ppsLink at the one after it */
+      *ppsLink = psCurrentBinding->psNextBinding;
+      if (!oSymTable->iBorrowKeys &&
+          psCurrentBinding->uKeyLength >= (size_t)SHORT_KEY_SIZE)
+         SymArena_release(&oSymTable->sKeyArena,
+                          psCurrentBinding->uKey.pcLongKey,
+                          psCurrentBinding->uKeyLength + 1U);
+      SymPool_release(&oSymTable->sBindingPool, psCurrentBinding);
+      uRemoved++;
    }
 
-   return NULL;
+   assert(oSymTable->uLength >= uRemoved);
+   oSymTable->uLength -= uRemoved;
+   return uRemoved;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable,
+                       const char *const apcKeys[], size_t uCount,
+                       void *apvValues[])
+{
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0U);
+   assert(apvValues != NULL || uCount == 0U);
+
+   /* a list has no buckets to prefetch, so look the keys up in turn */
+   for (u = 0; u < uCount; u++)
+      apvValues[u] = SymTable_get(oSymTable, apcKeys[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable,
+                         const char *const apcKeys[],
+                         const void *const apvValues[], size_t uCount)
+{
+   size_t uPutCount;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0U);
+   assert(apvValues != NULL || uCount == 0U);
+
+   uPutCount = 0U;
+   for (u = 0; u < uCount; u++)
+      if (SymTable_put(oSymTable, apcKeys[u], apvValues[u]))
+         uPutCount++;
+
+   return uPutCount;
 }
 
 /*--------------------------------------------------------------------*/
@@ -269,10 +799,146 @@ void SymTable_map(SymTable_T oSymTable,
         psCurrentBinding = psCurrentBinding->psNextBinding)
    {
     /* call pfApply for each binding */
-      (*pfApply)(psCurrentBinding->pcKey,
+      (*pfApply)(SymTable_bindingKey(oSymTable, psCurrentBinding),
                  (void*)psCurrentBinding->pvValue,
                  (void*)pvExtra);
    }
 }
 
 /*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable,
+                        struct SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->pvNext = oSymTable->psFirstBinding;
+   psIter->uIndex = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(struct SymTable_Iter *psIter,
+                      const char **ppcKey, void **ppvValue)
+{
+   const struct Binding *psBinding;
+
+   assert(psIter != NULL);
+   assert(psIter->oSymTable != NULL);
+   assert(ppcKey != NULL);
+   assert(ppvValue != NULL);
+
+   /* pvNext is the next Binding to give */
+   psBinding = (const struct Binding*)psIter->pvNext;
+   if (psBinding == NULL)
+      return 0;
+
+   psIter->pvNext = psBinding->psNextBinding;
+   *ppcKey = SymTable_bindingKey(psIter->oSymTable, psBinding);
+   *ppvValue = (void*)psBinding->pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getStats(SymTable_T oSymTable,
+                       struct SymTable_Stats *psStats)
+{
+   assert(oSymTable != NULL);
+   assert(psStats != NULL);
+
+#ifdef SYMTABLE_STATS
+   *psStats = oSymTable->sStats;
+#else
+   SymStats_init(psStats);
+#endif
+
+   /* the whole list is the one chain every lookup walks */
+   SymStats_addChain(psStats, oSymTable->uLength);
+   SymStats_finish(psStats, oSymTable->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_memoryUsage(SymTable_T oSymTable,
+                            struct SymTable_Memory *psMemory)
+{
+   struct SymTable_Memory sMemory;
+   struct Binding *psCurrent;
+
+   assert(oSymTable != NULL);
+
+   sMemory.uTableBytes = sizeof(struct SymTable);
+   sMemory.uIndexBytes = 0U;
+   sMemory.uBindingBytes = oSymTable->uLength * sizeof(struct Binding);
+
+   sMemory.uKeyBytes = 0U;
+   if (!oSymTable->iBorrowKeys)
+      for (psCurrent = oSymTable->psFirstBinding;
+           psCurrent != NULL;
+           psCurrent = psCurrent->psNextBinding)
+         if (psCurrent->uKeyLength >= (size_t)SHORT_KEY_SIZE)
+            sMemory.uKeyBytes += psCurrent->uKeyLength + 1U;
+
+   return SymStats_finishMemory(
+      &sMemory,
+      sMemory.uTableBytes +
+         SymPool_getFootprint(&oSymTable->sBindingPool) +
+         SymArena_getFootprint(&oSymTable->sKeyArena),
+      psMemory);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapRange(SymTable_T oSymTable,
+                      const char *pcLow, const char *pcHigh,
+                      void (*pfApply)(const char *pcKey,
+                                      void *pvValue,
+                                      void *pvExtra),
+                      const void *pvExtra)
+{
+   /* a list keeps its bindings in no order, so they are sorted here */
+   return SymOrder_mapRange(oSymTable, pcLow, pcHigh, pfApply,
+                            pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+                       void (*pfApply)(const char *pcKey,
+                                       void *pvValue,
+                                       void *pvExtra),
+                       const void *pvExtra)
+{
+   return SymOrder_mapPrefix(oSymTable, pcPrefix, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putParallel(SymTable_T oSymTable,
+                            const char *const apcKeys[],
+                            const void *const apvValues[],
+                            size_t uCount, size_t uThreadCount)
+{
+   /* every insertion must search the one list, so it cannot be
+      split among threads */
+   (void)uThreadCount;
+   return SymTable_putBatch(oSymTable, apcKeys, apvValues, uCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable, size_t uThreadCount,
+                          void (*pfApply)(const char *pcKey,
+                                          void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra)
+{
+   /* finding where to split the list would cost a full walk of it */
+   (void)uThreadCount;
+   SymTable_map(oSymTable, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
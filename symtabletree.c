@@ -0,0 +1,1983 @@
+/*--------------------------------------------------------------------*/
+/* symtabletree.c                                                     */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include "symhash.h"
+#include "symalloc.h"
+#include "symstats.h"
+#include "symthread.h"
+#include "symtrace.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the most Bindings a Leaf holds, and the most children a Branch
+   has. A node of either kind spans a few cache lines. */
+enum { LEAF_SIZE = 32, BRANCH_SIZE = 32 };
+
+/* number of leading key bytes kept beside each key in its node, so
+   most comparisons are decided without following the key pointer. */
+enum { HEAD_SIZE = 8 };
+
+/* the most levels of Branches a SymTable can have. Every Branch has
+   at least two children and every Leaf but a lone root holds at
+   least one Binding, so a tree can never get this tall. */
+enum { MAX_HEIGHT = 64 };
+
+/* each thread of SymTable_mapParallel() is given at least this many
+   bindings, so small tables are not split among more threads than
+   they can keep busy. */
+enum { MIN_WORK_PER_THREAD = 1024 };
+
+/*--------------------------------------------------------------------*/
+/* Each binding is stored in a Binding, in a Leaf.                    */
+
+struct Binding
+{
+   /* The key string, in the table's key arena or, in a table that
+      borrows its keys, the caller's own string. */
+   const char *pcKey;
+
+   /* The length of the key string, not counting its NUL. */
+   size_t uKeyLength;
+
+   /* The value associated with the key. */
+   const void *pvValue;
+};
+
+/*--------------------------------------------------------------------*/
+/* A Leaf holds Bindings in increasing order of key. The Leaves are   */
+/* linked in order, so a scan moves from one to the next without      */
+/* climbing the tree.                                                 */
+
+struct Leaf
+{
+   /* number of Bindings in asBindings. */
+   size_t uCount;
+
+   /* the Leaf with the next larger keys, or NULL. */
+   struct Leaf *psNextLeaf;
+
+   /* aacHeads[i] holds the first HEAD_SIZE bytes of the key of
+      asBindings[i], padded with NULs. The heads are searched first,
+      and they share a few cache lines. */
+   char aacHeads[LEAF_SIZE][HEAD_SIZE];
+
+   struct Binding asBindings[LEAF_SIZE];
+};
+
+/*--------------------------------------------------------------------*/
+/* A Separator divides the keys of two neighboring subtrees: every    */
+/* key to its left is smaller, and every key to its right is at       */
+/* least as large. It is the shortest prefix of the first key to its  */
+/* right that does so, copied into the table's key arena and not      */
+/* NUL-terminated.                                                    */
+
+struct Separator
+{
+   char *pcKey;
+   size_t uKeyLength;
+};
+
+/*--------------------------------------------------------------------*/
+/* A Branch has uCount children, all Leaves or all Branches, and      */
+/* uCount - 1 Separators between them.                                */
+
+struct Branch
+{
+   size_t uCount;
+
+   /* the heads of asSeparators, as in a Leaf. */
+   char aacHeads[BRANCH_SIZE - 1][HEAD_SIZE];
+
+   struct Separator asSeparators[BRANCH_SIZE - 1];
+
+   void *apvChildren[BRANCH_SIZE];
+};
+
+/*--------------------------------------------------------------------*/
+/* A SymTable is a B+-tree.                                           */
+
+struct SymTable
+{
+   /* the root node: a Leaf if uHeight is 0, or else a Branch whose
+      descendants uHeight levels down are Leaves. */
+   void *pvRoot;
+   size_t uHeight;
+
+   /* the Leaf with the smallest keys. Splits keep the left half in
+      the old Leaf and merges keep the left Leaf, so this is always
+      the Leaf the table was created with. */
+   struct Leaf *psFirstLeaf;
+
+   /* The number of bindings in the SymTable. */
+   size_t uLength;
+
+   /* Where this table's nodes, key strings, and Separators are
+      allocated. */
+   struct SymPool sLeafPool;
+   struct SymPool sBranchPool;
+   struct SymArena sKeyArena;
+
+   /* Nonzero if Bindings point to the callers' key strings instead
+      of holding copies. */
+   int iBorrowKeys;
+
+   /* The trace function and the sampling of lookups for it. */
+   struct SymTrace sTrace;
+
+#ifdef SYMTABLE_STATS
+   /* The counters reported by SymTable_getStats(). */
+   struct SymTable_Stats sStats;
+#endif
+};
+
+/*--------------------------------------------------------------------*/
+/* A Probe is a key being looked up, with its head.                   */
+
+struct Probe
+{
+   const char *pcKey;
+   size_t uKeyLength;
+   char acHead[HEAD_SIZE];
+
+#ifdef SYMTABLE_STATS
+   /* the counters of the table being searched. */
+   struct SymTable_Stats *psStats;
+#endif
+};
+
+/*--------------------------------------------------------------------*/
+/* A Step records, for one Branch on the way from the root to a Leaf, */
+/* which of its children the way continues to.                        */
+
+struct Step
+{
+   struct Branch *psBranch;
+   size_t uChild;
+};
+
+/*--------------------------------------------------------------------*/
+/* Store in acHead the head of the key of uKeyLength bytes at pcKey.  */
+
+static void SymTable_makeHead(char acHead[], const char *pcKey,
+                              size_t uKeyLength)
+{
+   assert(acHead != NULL);
+   assert(pcKey != NULL);
+
+   if (uKeyLength >= (size_t)HEAD_SIZE)
+      memcpy(acHead, pcKey, HEAD_SIZE);
+   else
+   {
+      memcpy(acHead, pcKey, uKeyLength);
+      memset(acHead + uKeyLength, 0, HEAD_SIZE - uKeyLength);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/* Return a negative number, 0, or a positive number as the key of    */
+/* uKeyLength1 bytes at pcKey1 is smaller than, equal to, or larger   */
+/* than that of uKeyLength2 bytes at pcKey2. Bytes compare as         */
+/* unsigned chars, and a key is smaller than any longer key that it   */
+/* begins, as strcmp() orders strings.                                */
+
+static int SymTable_compareKeys(const char *pcKey1, size_t uKeyLength1,
+                                const char *pcKey2, size_t uKeyLength2)
+{
+   int iResult;
+
+   iResult = memcmp(pcKey1, pcKey2,
+                    uKeyLength1 < uKeyLength2 ? uKeyLength1
+                                              : uKeyLength2);
+   if (iResult != 0)
+      return iResult;
+   return (uKeyLength1 > uKeyLength2) - (uKeyLength1 < uKeyLength2);
+}
+
+/*--------------------------------------------------------------------*/
+/* Compare the key of *psProbe, as SymTable_compareKeys() does, with  */
+/* the key of uKeyLength bytes at pcKey, whose head is acHead.        */
+
+static int SymTable_compare(const struct Probe *psProbe,
+                            const char acHead[],
+                            const char *pcKey, size_t uKeyLength)
+{
+   int iResult;
+
+   assert(psProbe != NULL);
+   assert(acHead != NULL);
+   assert(pcKey != NULL);
+
+   /* heads compare as their keys would wherever they differ: a NUL
+      of padding is never larger than the byte of the other key */
+   SYMSTATS_ADD(psProbe->psStats->uProbes, 1U);
+   iResult = memcmp(psProbe->acHead, acHead, HEAD_SIZE);
+   if (iResult != 0)
+      return iResult;
+
+   SYMSTATS_ADD(psProbe->psStats->uKeyCompares, 1U);
+
+   if (psProbe->uKeyLength >= (size_t)HEAD_SIZE &&
+       uKeyLength >= (size_t)HEAD_SIZE)
+      return SymTable_compareKeys(
+         psProbe->pcKey + HEAD_SIZE, psProbe->uKeyLength - HEAD_SIZE,
+         pcKey + HEAD_SIZE, uKeyLength - HEAD_SIZE);
+   return SymTable_compareKeys(psProbe->pcKey, psProbe->uKeyLength,
+                               pcKey, uKeyLength);
+}
+
+/*--------------------------------------------------------------------*/
+/* Initialize *psProbe for the key of uKeyLength bytes at pcKey, to   */
+/* be looked up in oSymTable.                                         */
+
+static void SymTable_makeProbe(SymTable_T oSymTable,
+                               struct Probe *psProbe,
+                               const char *pcKey, size_t uKeyLength)
+{
+   assert(oSymTable != NULL);
+   assert(psProbe != NULL);
+   assert(pcKey != NULL);
+
+   psProbe->pcKey = pcKey;
+   psProbe->uKeyLength = uKeyLength;
+   SymTable_makeHead(psProbe->acHead, pcKey, uKeyLength);
+#ifdef SYMTABLE_STATS
+   psProbe->psStats = &oSymTable->sStats;
+#else
+   (void)oSymTable;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the index of the first Binding of psLeaf whose key is at    */
+/* least that of *psProbe, or psLeaf->uCount if there is none. Set    */
+/* *piFound to 1 if that key equals the probe's, or to 0 otherwise.   */
+
+static size_t SymTable_searchLeaf(const struct Leaf *psLeaf,
+                                  const struct Probe *psProbe,
+                                  int *piFound)
+{
+   const struct Binding *psBinding;
+   size_t uLow;
+   size_t uHigh;
+   size_t uMiddle;
+   int iResult;
+
+   assert(psLeaf != NULL);
+   assert(psProbe != NULL);
+   assert(piFound != NULL);
+
+   SYMSTATS_ADD(psProbe->psStats->uLookups, 1U);
+   *piFound = 0;
+   uLow = 0U;
+   uHigh = psLeaf->uCount;
+   while (uLow < uHigh)
+   {
+      uMiddle = uLow + (uHigh - uLow) / 2U;
+      psBinding = &psLeaf->asBindings[uMiddle];
+      iResult = SymTable_compare(psProbe, psLeaf->aacHeads[uMiddle],
+                                 psBinding->pcKey,
+                                 psBinding->uKeyLength);
+      if (iResult > 0)
+         uLow = uMiddle + 1U;
+      else
+      {
+         if (iResult == 0)
+            *piFound = 1;
+         uHigh = uMiddle;
+      }
+   }
+   if (*piFound)
+      SYMSTATS_ADD(psProbe->psStats->uHits, 1U);
+   return uLow;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the index of the child of psBranch whose keys bracket that  */
+/* of *psProbe: the number of Separators no larger than it.           */
+
+static size_t SymTable_searchBranch(const struct Branch *psBranch,
+                                    const struct Probe *psProbe)
+{
+   const struct Separator *psSeparator;
+   size_t uLow;
+   size_t uHigh;
+   size_t uMiddle;
+
+   assert(psBranch != NULL);
+   assert(psProbe != NULL);
+
+   uLow = 0U;
+   uHigh = psBranch->uCount - 1U;
+   while (uLow < uHigh)
+   {
+      uMiddle = uLow + (uHigh - uLow) / 2U;
+      psSeparator = &psBranch->asSeparators[uMiddle];
+      if (SymTable_compare(psProbe, psBranch->aacHeads[uMiddle],
+                           psSeparator->pcKey,
+                           psSeparator->uKeyLength) >= 0)
+         uLow = uMiddle + 1U;
+      else
+         uHigh = uMiddle;
+   }
+   return uLow;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the Leaf of oSymTable where the key of *psProbe belongs. If */
+/* asPath is not NULL, record in asPath[0] through                    */
+/* asPath[uHeight-1] the way there from the root.                     */
+
+static struct Leaf *SymTable_descend(SymTable_T oSymTable,
+                                     const struct Probe *psProbe,
+                                     struct Step asPath[])
+{
+   struct Branch *psBranch;
+   void *pvNode;
+   size_t uChild;
+   size_t uLevel;
+
+   assert(oSymTable != NULL);
+   assert(psProbe != NULL);
+
+   pvNode = oSymTable->pvRoot;
+   for (uLevel = 0; uLevel < oSymTable->uHeight; uLevel++)
+   {
+      psBranch = (struct Branch*)pvNode;
+      uChild = SymTable_searchBranch(psBranch, psProbe);
+      if (asPath != NULL)
+      {
+         asPath[uLevel].psBranch = psBranch;
+         asPath[uLevel].uChild = uChild;
+      }
+      pvNode = psBranch->apvChildren[uChild];
+   }
+   return (struct Leaf*)pvNode;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the Leaf of oSymTable where the key of *psProbe belongs,    */
+/* recording the way there in asPath as SymTable_descend() does, and  */
+/* set *puIndex and *piFound as SymTable_searchLeaf() does. Report    */
+/* the lookup to oSymTable's trace function if it is sampled.         */
+
+static struct Leaf *SymTable_locate(SymTable_T oSymTable,
+                                    const struct Probe *psProbe,
+                                    struct Step asPath[],
+                                    size_t *puIndex, int *piFound)
+{
+   struct Leaf *psLeaf;
+   double dStart;
+   double dSeconds;
+
+   assert(oSymTable != NULL);
+   assert(psProbe != NULL);
+   assert(puIndex != NULL);
+   assert(piFound != NULL);
+
+   if (!SYMTRACE_SAMPLED(&oSymTable->sTrace))
+   {
+      psLeaf = SymTable_descend(oSymTable, psProbe, asPath);
+      *puIndex = SymTable_searchLeaf(psLeaf, psProbe, piFound);
+      return psLeaf;
+   }
+
+   dStart = SymTrace_now();
+   psLeaf = SymTable_descend(oSymTable, psProbe, asPath);
+   *puIndex = SymTable_searchLeaf(psLeaf, psProbe, piFound);
+   dSeconds = SymTrace_now() - dStart;
+
+   /* every lookup examines one node per level */
+   SymTrace_lookup(&oSymTable->sTrace, oSymTable, psProbe->pcKey,
+                   psProbe->uKeyLength, *piFound,
+                   oSymTable->uHeight + 1U, dSeconds);
+   return psLeaf;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the Binding of oSymTable whose key is the uKeyLength bytes  */
+/* at pcKey, or NULL if that key is not present.                      */
+
+static struct Binding *SymTable_find(SymTable_T oSymTable,
+                                     const char *pcKey,
+                                     size_t uKeyLength)
+{
+   struct Probe sProbe;
+   struct Leaf *psLeaf;
+   size_t uIndex;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   SymTable_makeProbe(oSymTable, &sProbe, pcKey, uKeyLength);
+   psLeaf = SymTable_locate(oSymTable, &sProbe, NULL, &uIndex, &iFound);
+   if (!iFound)
+      return NULL;
+   return &psLeaf->asBindings[uIndex];
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_initOptions(struct SymTable_Options *psOptions)
+{
+   assert(psOptions != NULL);
+
+   /* a tree has no buckets and does not hash, so only iBorrowKeys is
+      ever consulted */
+   psOptions->dMaxLoadFactor = 1.0;
+   psOptions->uRehashStep = 0U;
+   psOptions->pfHash = NULL;
+   psOptions->uHashSeed = 0U;
+   psOptions->iBorrowKeys = 0;
+   psOptions->iMoveToFront = 0;
+   psOptions->pfTrace = NULL;
+   psOptions->pvTraceExtra = NULL;
+   psOptions->uTraceSampleInterval = 1024U;
+   psOptions->dTraceMinSeconds = 0.0;
+   psOptions->uTraceMinProbes = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void)
+{
+   struct SymTable_Options sOptions;
+
+   SymTable_initOptions(&sOptions);
+   return SymTable_newWithOptions(&sOptions);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithOptions(
+   const struct SymTable_Options *psOptions)
+{
+   SymTable_T oSymTable;
+
+   assert(psOptions != NULL);
+   assert(psOptions->dMaxLoadFactor > 0.0);
+
+   oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+   if (oSymTable == NULL)
+      return NULL;
+
+   SymPool_init(&oSymTable->sLeafPool, sizeof(struct Leaf));
+   SymPool_init(&oSymTable->sBranchPool, sizeof(struct Branch));
+   SymArena_init(&oSymTable->sKeyArena);
+   SymTrace_init(&oSymTable->sTrace, psOptions);
+#ifdef SYMTABLE_STATS
+   SymStats_init(&oSymTable->sStats);
+#endif
+
+   oSymTable->psFirstLeaf =
+      (struct Leaf*)SymPool_alloc(&oSymTable->sLeafPool);
+   if (oSymTable->psFirstLeaf == NULL)
+   {
+      free(oSymTable);
+      return NULL;
+   }
+   oSymTable->psFirstLeaf->uCount = 0U;
+   oSymTable->psFirstLeaf->psNextLeaf = NULL;
+
+   oSymTable->pvRoot = oSymTable->psFirstLeaf;
+   oSymTable->uHeight = 0U;
+   oSymTable->uLength = 0U;
+   oSymTable->iBorrowKeys = psOptions->iBorrowKeys;
+
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCount)
+{
+   /* a tree grows a node at a time, so there is no room to make */
+   (void)uCount;
+   return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   /* freeing every node, key string, and Separator at once */
+   SymPool_destroy(&oSymTable->sLeafPool);
+   SymPool_destroy(&oSymTable->sBranchPool);
+   SymArena_destroy(&oSymTable->sKeyArena);
+
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+   return oSymTable->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_compact(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   /* the nodes that removals leave under-full
+      are already merged with their neighbours */
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCount)
+{
+   assert(oSymTable != NULL);
+
+   /* a tree grows a node at a time, and never rebuilds itself */
+   (void)uCount;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/* Insert into psLeaf, which is not full, a Binding at index uIndex   */
+/* of the key of uKeyLength bytes at pcKey, whose head is acHead, to  */
+/* pvValue. Return the new Binding.                                   */
+
+static struct Binding *SymTable_insertIntoLeaf(struct Leaf *psLeaf,
+                                               size_t uIndex,
+                                               const char acHead[],
+                                               const char *pcKey,
+                                               size_t uKeyLength,
+                                               const void *pvValue)
+{
+   struct Binding *psBinding;
+
+   assert(psLeaf != NULL);
+   assert(psLeaf->uCount < (size_t)LEAF_SIZE);
+   assert(uIndex <= psLeaf->uCount);
+
+   memmove(psLeaf->aacHeads[uIndex + 1U], psLeaf->aacHeads[uIndex],
+           (psLeaf->uCount - uIndex) * HEAD_SIZE);
+   memmove(&psLeaf->asBindings[uIndex + 1U],
+           &psLeaf->asBindings[uIndex],
+           (psLeaf->uCount - uIndex) * sizeof(struct Binding));
+   psLeaf->uCount++;
+
+   memcpy(psLeaf->aacHeads[uIndex], acHead, HEAD_SIZE);
+   psBinding = &psLeaf->asBindings[uIndex];
+   psBinding->pcKey = pcKey;
+   psBinding->uKeyLength = uKeyLength;
+   psBinding->pvValue = pvValue;
+   return psBinding;
+}
+
+/*--------------------------------------------------------------------*/
+/* Insert into psBranch, which is not full, the Separator            */
+/* *psSeparator with head acHead at index uIndex, and the child       */
+/* pvChild right after it.                                            */
+
+static void SymTable_insertIntoBranch(struct Branch *psBranch,
+                                      size_t uIndex,
+                                      const char acHead[],
+                                      const struct Separator
+                                         *psSeparator,
+                                      void *pvChild)
+{
+   size_t uMoved;
+
+   assert(psBranch != NULL);
+   assert(psBranch->uCount < (size_t)BRANCH_SIZE);
+   assert(uIndex < psBranch->uCount);
+
+   uMoved = psBranch->uCount - 1U - uIndex;
+   memmove(psBranch->aacHeads[uIndex + 1U], psBranch->aacHeads[uIndex],
+           uMoved * HEAD_SIZE);
+   memmove(&psBranch->asSeparators[uIndex + 1U],
+           &psBranch->asSeparators[uIndex],
+           uMoved * sizeof(struct Separator));
+   memmove(&psBranch->apvChildren[uIndex + 2U],
+           &psBranch->apvChildren[uIndex + 1U],
+           uMoved * sizeof(void*));
+
+   memcpy(psBranch->aacHeads[uIndex], acHead, HEAD_SIZE);
+   psBranch->asSeparators[uIndex] = *psSeparator;
+   psBranch->apvChildren[uIndex + 1U] = pvChild;
+   psBranch->uCount++;
+}
+
+/*--------------------------------------------------------------------*/
+/* Split psBranch, which is full, while inserting the Separator       */
+/* *psSeparator with head acHead at index uIndex and the child        */
+/* pvChild right after it. Move the upper half into psRight, which is */
+/* new, and store in *psSeparator and acHead the Separator that now   */
+/* divides psBranch from psRight.                                     */
+
+static void SymTable_splitBranch(struct Branch *psBranch,
+                                 struct Branch *psRight,
+                                 size_t uIndex, char acHead[],
+                                 struct Separator *psSeparator,
+                                 void *pvChild)
+{
+   /* the Separators and children of psBranch with the new ones in
+      place, a Separator and a child more than a Branch can hold */
+   char aacHeads[BRANCH_SIZE][HEAD_SIZE];
+   struct Separator asSeparators[BRANCH_SIZE];
+   void *apvChildren[BRANCH_SIZE + 1];
+   size_t uLeftCount;
+   size_t uRightCount;
+
+   assert(psBranch != NULL);
+   assert(psBranch->uCount == (size_t)BRANCH_SIZE);
+   assert(psRight != NULL);
+   assert(uIndex < psBranch->uCount);
+
+   memcpy(aacHeads, psBranch->aacHeads, uIndex * HEAD_SIZE);
+   memcpy(aacHeads[uIndex], acHead, HEAD_SIZE);
+   memcpy(aacHeads[uIndex + 1U], psBranch->aacHeads[uIndex],
+          (BRANCH_SIZE - 1U - uIndex) * HEAD_SIZE);
+   memcpy(asSeparators, psBranch->asSeparators,
+          uIndex * sizeof(struct Separator));
+   asSeparators[uIndex] = *psSeparator;
+   memcpy(&asSeparators[uIndex + 1U], &psBranch->asSeparators[uIndex],
+          (BRANCH_SIZE - 1U - uIndex) * sizeof(struct Separator));
+   memcpy(apvChildren, psBranch->apvChildren,
+          (uIndex + 1U) * sizeof(void*));
+   apvChildren[uIndex + 1U] = pvChild;
+   memcpy(&apvChildren[uIndex + 2U],
+          &psBranch->apvChildren[uIndex + 1U],
+          (BRANCH_SIZE - 1U - uIndex) * sizeof(void*));
+
+   /* the Separator between the halves moves up instead of staying in
+      either */
+   uLeftCount = (BRANCH_SIZE + 1U) / 2U;
+   uRightCount = BRANCH_SIZE + 1U - uLeftCount;
+
+   psBranch->uCount = uLeftCount;
+   memcpy(psBranch->aacHeads, aacHeads, (uLeftCount - 1U) * HEAD_SIZE);
+   memcpy(psBranch->asSeparators, asSeparators,
+          (uLeftCount - 1U) * sizeof(struct Separator));
+   memcpy(psBranch->apvChildren, apvChildren,
+          uLeftCount * sizeof(void*));
+
+   psRight->uCount = uRightCount;
+   memcpy(psRight->aacHeads, aacHeads[uLeftCount],
+          (uRightCount - 1U) * HEAD_SIZE);
+   memcpy(psRight->asSeparators, &asSeparators[uLeftCount],
+          (uRightCount - 1U) * sizeof(struct Separator));
+   memcpy(psRight->apvChildren, &apvChildren[uLeftCount],
+          uRightCount * sizeof(void*));
+
+   memcpy(acHead, aacHeads[uLeftCount - 1U], HEAD_SIZE);
+   *psSeparator = asSeparators[uLeftCount - 1U];
+}
+
+/*--------------------------------------------------------------------*/
+/* Insert a new binding of the key of *psProbe to pvValue at index    */
+/* uIndex of psLeaf, the Leaf of oSymTable reached by asPath, and     */
+/* return it, or return NULL if out of memory. The key must not       */
+/* already be present. Full nodes on the way are split. Everything    */
+/* the insertion needs is allocated before anything is changed, so    */
+/* running out of memory leaves oSymTable as it was.                  */
+
+static struct Binding *SymTable_insert(SymTable_T oSymTable,
+                                       const struct Probe *psProbe,
+                                       const struct Step asPath[],
+                                       struct Leaf *psLeaf,
+                                       size_t uIndex,
+                                       const void *pvValue)
+{
+   struct Branch *apsNewBranches[MAX_HEIGHT + 1];
+   size_t uNewBranchCount;
+   struct Leaf *psRight;
+   void *pvNewChild;
+   struct Branch *psRoot;
+   struct Branch *psBranch;
+   struct Binding *psBinding;
+   struct Separator sSeparator;
+   char acSeparatorHead[HEAD_SIZE];
+   const char *pcKey;
+   char *pcKeyCopy;
+   const char *pcBelow;
+   size_t uBelowLength;
+   const char *pcAbove;
+   size_t uAboveLength;
+   size_t uLeftCount;
+   size_t uLevel;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(psProbe != NULL);
+   assert(psLeaf != NULL);
+   assert(uIndex <= psLeaf->uCount);
+
+   /* borrowing the caller's key if the table was created to, or else
+      copying it into the key arena. a copy is always NUL-terminated */
+   pcKeyCopy = NULL;
+   if (oSymTable->iBorrowKeys)
+   {
+      assert(psProbe->pcKey[psProbe->uKeyLength] == '\0');
+      pcKey = psProbe->pcKey;
+   }
+   else
+   {
+      pcKeyCopy = SymArena_alloc(&oSymTable->sKeyArena,
+                                 psProbe->uKeyLength + 1U);
+      if (pcKeyCopy == NULL)
+         return NULL;
+      memcpy(pcKeyCopy, psProbe->pcKey, psProbe->uKeyLength);
+      pcKeyCopy[psProbe->uKeyLength] = '\0';
+      pcKey = pcKeyCopy;
+   }
+
+   if (psLeaf->uCount < (size_t)LEAF_SIZE)
+   {
+      oSymTable->uLength++;
+      return SymTable_insertIntoLeaf(psLeaf, uIndex, psProbe->acHead,
+                                     pcKey, psProbe->uKeyLength,
+                                     pvValue);
+   }
+
+   /* the Leaf splits between the keys at uLeftCount-1 and uLeftCount
+      of its Bindings with the new one in place. a key added past the
+      last one leaves the old Leaf full, so keys inserted in order
+      pack the Leaves */
+   uLeftCount = LEAF_SIZE / 2U;
+   if (uIndex == (size_t)LEAF_SIZE && psLeaf->psNextLeaf == NULL)
+      uLeftCount = LEAF_SIZE;
+   if (uIndex == uLeftCount)
+   {
+      pcAbove = pcKey;
+      uAboveLength = psProbe->uKeyLength;
+   }
+   else
+   {
+      u = uIndex < uLeftCount ? uLeftCount - 1U : uLeftCount;
+      pcAbove = psLeaf->asBindings[u].pcKey;
+      uAboveLength = psLeaf->asBindings[u].uKeyLength;
+   }
+   if (uIndex == uLeftCount - 1U)
+   {
+      pcBelow = pcKey;
+      uBelowLength = psProbe->uKeyLength;
+   }
+   else
+   {
+      u = uIndex < uLeftCount - 1U ? uLeftCount - 2U : uLeftCount - 1U;
+      pcBelow = psLeaf->asBindings[u].pcKey;
+      uBelowLength = psLeaf->asBindings[u].uKeyLength;
+   }
+
+   /* the shortest prefix of the key above the split that is larger
+      than the key below it */
+   sSeparator.uKeyLength = 0U;
+   while (sSeparator.uKeyLength < uBelowLength &&
+          pcBelow[sSeparator.uKeyLength] ==
+             pcAbove[sSeparator.uKeyLength])
+      sSeparator.uKeyLength++;
+   sSeparator.uKeyLength++;
+   assert(sSeparator.uKeyLength <= uAboveLength);
+
+   /* every full Branch above the Leaf splits too, and a new root is
+      needed if they all do */
+   uLevel = oSymTable->uHeight;
+   while (uLevel > 0U &&
+          asPath[uLevel - 1U].psBranch->uCount == (size_t)BRANCH_SIZE)
+      uLevel--;
+   uNewBranchCount = oSymTable->uHeight - uLevel;
+   if (uLevel == 0U)
+      uNewBranchCount++;
+
+   sSeparator.pcKey = SymArena_alloc(&oSymTable->sKeyArena,
+                                     sSeparator.uKeyLength);
+   psRight = (struct Leaf*)SymPool_alloc(&oSymTable->sLeafPool);
+   for (u = 0; u < uNewBranchCount; u++)
+   {
+      apsNewBranches[u] =
+         (struct Branch*)SymPool_alloc(&oSymTable->sBranchPool);
+      if (apsNewBranches[u] == NULL)
+         break;
+   }
+   if (sSeparator.pcKey == NULL || psRight == NULL ||
+       u < uNewBranchCount)
+   {
+      while (u > 0U)
+      {
+         u--;
+         SymPool_release(&oSymTable->sBranchPool, apsNewBranches[u]);
+      }
+      if (psRight != NULL)
+         SymPool_release(&oSymTable->sLeafPool, psRight);
+      if (sSeparator.pcKey != NULL)
+         SymArena_release(&oSymTable->sKeyArena, sSeparator.pcKey,
+                          sSeparator.uKeyLength);
+      if (pcKeyCopy != NULL)
+         SymArena_release(&oSymTable->sKeyArena, pcKeyCopy,
+                          psProbe->uKeyLength + 1U);
+      return NULL;
+   }
+   memcpy(sSeparator.pcKey, pcAbove, sSeparator.uKeyLength);
+   SymTable_makeHead(acSeparatorHead, sSeparator.pcKey,
+                     sSeparator.uKeyLength);
+
+   /* splitting the Leaf */
+   u = uIndex < uLeftCount ? uLeftCount - 1U : uLeftCount;
+   psRight->uCount = LEAF_SIZE - u;
+   memcpy(psRight->aacHeads, psLeaf->aacHeads[u],
+          psRight->uCount * HEAD_SIZE);
+   memcpy(psRight->asBindings, &psLeaf->asBindings[u],
+          psRight->uCount * sizeof(struct Binding));
+   psLeaf->uCount = u;
+   psRight->psNextLeaf = psLeaf->psNextLeaf;
+   psLeaf->psNextLeaf = psRight;
+   if (uIndex < uLeftCount)
+      psBinding = SymTable_insertIntoLeaf(psLeaf, uIndex,
+                                          psProbe->acHead, pcKey,
+                                          psProbe->uKeyLength, pvValue);
+   else
+      psBinding = SymTable_insertIntoLeaf(psRight, uIndex - u,
+                                          psProbe->acHead, pcKey,
+                                          psProbe->uKeyLength, pvValue);
+   oSymTable->uLength++;
+
+   /* passing the Separator and the new node up until a Branch has
+      room for them */
+   pvNewChild = psRight;
+   for (uLevel = oSymTable->uHeight, u = 0; uLevel > 0U; uLevel--)
+   {
+      psBranch = asPath[uLevel - 1U].psBranch;
+      if (psBranch->uCount < (size_t)BRANCH_SIZE)
+      {
+         SymTable_insertIntoBranch(psBranch,
+                                   asPath[uLevel - 1U].uChild,
+                                   acSeparatorHead, &sSeparator,
+                                   pvNewChild);
+         return psBinding;
+      }
+      SymTable_splitBranch(psBranch, apsNewBranches[u],
+                           asPath[uLevel - 1U].uChild,
+                           acSeparatorHead, &sSeparator, pvNewChild);
+      pvNewChild = apsNewBranches[u];
+      u++;
+   }
+
+   /* the root split, so a new root holds its two halves */
+   assert(u + 1U == uNewBranchCount);
+   psRoot = apsNewBranches[u];
+   psRoot->uCount = 2U;
+   memcpy(psRoot->aacHeads[0], acSeparatorHead, HEAD_SIZE);
+   psRoot->asSeparators[0] = sSeparator;
+   psRoot->apvChildren[0] = oSymTable->pvRoot;
+   psRoot->apvChildren[1] = pvNewChild;
+   oSymTable->pvRoot = psRoot;
+   oSymTable->uHeight++;
+   assert(oSymTable->uHeight < (size_t)MAX_HEIGHT);
+
+   return psBinding;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+                  size_t uKeyLength, const void *pvValue)
+{
+   struct Step asPath[MAX_HEIGHT];
+   struct Probe sProbe;
+   struct Leaf *psLeaf;
+   size_t uIndex;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   SymTable_makeProbe(oSymTable, &sProbe, pcKey, uKeyLength);
+   psLeaf = SymTable_locate(oSymTable, &sProbe, asPath, &uIndex,
+                            &iFound);
+
+   /* return 0 if key already exists */
+   if (iFound)
+      return 0;
+
+   return SymTable_insert(oSymTable, &sProbe, asPath, psLeaf, uIndex,
+                          pvValue) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable,
+                 const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the address of the value of the key of uKeyLength bytes at  */
+/* pcKey in oSymTable, first inserting a binding of it to pvValue if  */
+/* it is not present, or return NULL if out of memory. Set *piFound   */
+/* to 1 if the key was present, or to 0 otherwise.                    */
+
+static const void **SymTable_findOrInsert(SymTable_T oSymTable,
+                                          const char *pcKey,
+                                          size_t uKeyLength,
+                                          const void *pvValue,
+                                          int *piFound)
+{
+   struct Step asPath[MAX_HEIGHT];
+   struct Probe sProbe;
+   struct Leaf *psLeaf;
+   struct Binding *psBinding;
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+   assert(piFound != NULL);
+
+   SymTable_makeProbe(oSymTable, &sProbe, pcKey, uKeyLength);
+   psLeaf = SymTable_locate(oSymTable, &sProbe, asPath, &uIndex,
+                            piFound);
+   if (*piFound)
+      return &psLeaf->asBindings[uIndex].pvValue;
+
+   psBinding = SymTable_insert(oSymTable, &sProbe, asPath, psLeaf,
+                               uIndex, pvValue);
+   if (psBinding == NULL)
+      return NULL;
+   return &psBinding->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertN(SymTable_T oSymTable, const char *pcKey,
+                     size_t uKeyLength, const void *pvValue)
+{
+   const void **ppvValue;
+   int iFound;
+
+   ppvValue = SymTable_findOrInsert(oSymTable, pcKey, uKeyLength,
+                                    pvValue, &iFound);
+   if (ppvValue == NULL)
+      return 0;
+
+   *ppvValue = pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsert(SymTable_T oSymTable,
+                    const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_upsertN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsertN(SymTable_T oSymTable, const char *pcKey,
+                             size_t uKeyLength, const void *pvValue)
+{
+   int iFound;
+
+   return (void**)SymTable_findOrInsert(oSymTable, pcKey, uKeyLength,
+                                        pvValue, &iFound);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+                            const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_getOrInsertN(oSymTable, pcKey, strlen(pcKey),
+                                pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceN(SymTable_T oSymTable, const char *pcKey,
+                        size_t uKeyLength, const void *pvValue)
+{
+   struct Binding *psBinding;
+   const void *pvOldValue;
+
+   psBinding = SymTable_find(oSymTable, pcKey, uKeyLength);
+   if (psBinding == NULL)
+      return NULL;
+
+   pvOldValue = psBinding->pvValue;
+   psBinding->pvValue = pvValue;
+   return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+                       const char *pcKey, const void *pvValue)
+{
+   assert(pcKey != NULL);
+   return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength)
+{
+   return SymTable_find(oSymTable, pcKey, uKeyLength) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+                    size_t uKeyLength)
+{
+   struct Binding *psBinding;
+
+   psBinding = SymTable_find(oSymTable, pcKey, uKeyLength);
+   if (psBinding == NULL)
+      return NULL;
+   return (void*)psBinding->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+/* Remove from psBranch its child at index uChild, which must not be  */
+/* 0, and the Separator before that child. The Separator's key is     */
+/* not released.                                                      */
+
+static void SymTable_removeChild(struct Branch *psBranch,
+                                 size_t uChild)
+{
+   size_t uMoved;
+
+   assert(psBranch != NULL);
+   assert(uChild > 0U);
+   assert(uChild < psBranch->uCount);
+
+   uMoved = psBranch->uCount - 1U - uChild;
+   memmove(psBranch->aacHeads[uChild - 1U], psBranch->aacHeads[uChild],
+           uMoved * HEAD_SIZE);
+   memmove(&psBranch->asSeparators[uChild - 1U],
+           &psBranch->asSeparators[uChild],
+           uMoved * sizeof(struct Separator));
+   memmove(&psBranch->apvChildren[uChild],
+           &psBranch->apvChildren[uChild + 1U],
+           uMoved * sizeof(void*));
+   psBranch->uCount--;
+}
+
+/*--------------------------------------------------------------------*/
+/* Move every Binding of psRight, the Leaf of oSymTable after psLeaf, */
+/* into psLeaf, and remove psRight from psParent, the Branch that has */
+/* both Leaves at indices uChild and uChild+1.                        */
+
+static void SymTable_mergeLeaves(SymTable_T oSymTable,
+                                 struct Branch *psParent,
+                                 size_t uChild, struct Leaf *psLeaf,
+                                 struct Leaf *psRight)
+{
+   struct Separator *psSeparator;
+
+   assert(oSymTable != NULL);
+   assert(psParent != NULL);
+   assert(psLeaf != NULL);
+   assert(psRight != NULL);
+   assert(psLeaf->uCount + psRight->uCount <= (size_t)LEAF_SIZE);
+
+   memcpy(psLeaf->aacHeads[psLeaf->uCount], psRight->aacHeads,
+          psRight->uCount * HEAD_SIZE);
+   memcpy(&psLeaf->asBindings[psLeaf->uCount], psRight->asBindings,
+          psRight->uCount * sizeof(struct Binding));
+   psLeaf->uCount += psRight->uCount;
+   psLeaf->psNextLeaf = psRight->psNextLeaf;
+
+   psSeparator = &psParent->asSeparators[uChild];
+   SymArena_release(&oSymTable->sKeyArena, psSeparator->pcKey,
+                    psSeparator->uKeyLength);
+   SymTable_removeChild(psParent, uChild + 1U);
+   SymPool_release(&oSymTable->sLeafPool, psRight);
+}
+
+/*--------------------------------------------------------------------*/
+/* Move every child of psRight, the Branch after psBranch, into       */
+/* psBranch, and remove psRight from psParent, the Branch that has    */
+/* both at indices uChild and uChild+1. The Separator between them in */
+/* psParent moves down between the children moved and the others.     */
+
+static void SymTable_mergeBranches(SymTable_T oSymTable,
+                                   struct Branch *psParent,
+                                   size_t uChild,
+                                   struct Branch *psBranch,
+                                   struct Branch *psRight)
+{
+   size_t uCount;
+
+   assert(oSymTable != NULL);
+   assert(psParent != NULL);
+   assert(psBranch != NULL);
+   assert(psRight != NULL);
+   assert(psBranch->uCount + psRight->uCount <= (size_t)BRANCH_SIZE);
+
+   uCount = psBranch->uCount;
+   memcpy(psBranch->aacHeads[uCount - 1U], psParent->aacHeads[uChild],
+          HEAD_SIZE);
+   psBranch->asSeparators[uCount - 1U] = psParent->asSeparators[uChild];
+   memcpy(psBranch->aacHeads[uCount], psRight->aacHeads,
+          (psRight->uCount - 1U) * HEAD_SIZE);
+   memcpy(&psBranch->asSeparators[uCount], psRight->asSeparators,
+          (psRight->uCount - 1U) * sizeof(struct Separator));
+   memcpy(&psBranch->apvChildren[uCount], psRight->apvChildren,
+          psRight->uCount * sizeof(void*));
+   psBranch->uCount += psRight->uCount;
+
+   SymTable_removeChild(psParent, uChild + 1U);
+   SymPool_release(&oSymTable->sBranchPool, psRight);
+}
+
+/*--------------------------------------------------------------------*/
+/* Give psBranch, the child at index uChild of psParent, one child    */
+/* more by moving the nearest child of a neighbor over, and rotating  */
+/* the Separators through psParent to match.                          */
+
+static void SymTable_borrowChild(struct Branch *psParent, size_t uChild,
+                                 struct Branch *psBranch)
+{
+   struct Branch *psLeft;
+   struct Branch *psRight;
+   size_t uCount;
+
+   assert(psParent != NULL);
+   assert(psBranch != NULL);
+   assert(psBranch->uCount < (size_t)BRANCH_SIZE);
+
+   uCount = psBranch->uCount;
+   if (uChild > 0U)
+   {
+      psLeft = (struct Branch*)psParent->apvChildren[uChild - 1U];
+      assert(psLeft->uCount > 2U);
+
+      memmove(psBranch->aacHeads[1], psBranch->aacHeads[0],
+              (uCount - 1U) * HEAD_SIZE);
+      memmove(&psBranch->asSeparators[1], &psBranch->asSeparators[0],
+              (uCount - 1U) * sizeof(struct Separator));
+      memmove(&psBranch->apvChildren[1], &psBranch->apvChildren[0],
+              uCount * sizeof(void*));
+      memcpy(psBranch->aacHeads[0], psParent->aacHeads[uChild - 1U],
+             HEAD_SIZE);
+      psBranch->asSeparators[0] = psParent->asSeparators[uChild - 1U];
+      psBranch->apvChildren[0] =
+         psLeft->apvChildren[psLeft->uCount - 1U];
+
+      memcpy(psParent->aacHeads[uChild - 1U],
+             psLeft->aacHeads[psLeft->uCount - 2U], HEAD_SIZE);
+      psParent->asSeparators[uChild - 1U] =
+         psLeft->asSeparators[psLeft->uCount - 2U];
+      psLeft->uCount--;
+   }
+   else
+   {
+      psRight = (struct Branch*)psParent->apvChildren[uChild + 1U];
+      assert(psRight->uCount > 2U);
+
+      memcpy(psBranch->aacHeads[uCount - 1U],
+             psParent->aacHeads[uChild], HEAD_SIZE);
+      psBranch->asSeparators[uCount - 1U] =
+         psParent->asSeparators[uChild];
+      psBranch->apvChildren[uCount] = psRight->apvChildren[0];
+
+      memcpy(psParent->aacHeads[uChild], psRight->aacHeads[0],
+             HEAD_SIZE);
+      psParent->asSeparators[uChild] = psRight->asSeparators[0];
+      memmove(psRight->aacHeads[0], psRight->aacHeads[1],
+              (psRight->uCount - 2U) * HEAD_SIZE);
+      memmove(&psRight->asSeparators[0], &psRight->asSeparators[1],
+              (psRight->uCount - 2U) * sizeof(struct Separator));
+      memmove(&psRight->apvChildren[0], &psRight->apvChildren[1],
+              (psRight->uCount - 1U) * sizeof(void*));
+      psRight->uCount--;
+   }
+   psBranch->uCount++;
+}
+
+/*--------------------------------------------------------------------*/
+/* Restore the shape of oSymTable after a Binding was removed from    */
+/* psLeaf, the Leaf reached by asPath. A Leaf less than half full is  */
+/* merged with a neighbor whenever the two fit in one, and so is a    */
+/* Branch; a Branch left with one child borrows another. None of this */
+/* allocates memory, so removal cannot fail.                          */
+
+static void SymTable_rebalance(SymTable_T oSymTable,
+                               const struct Step asPath[],
+                               struct Leaf *psLeaf)
+{
+   struct Branch *psParent;
+   struct Branch *psBranch;
+   struct Branch *psNeighbor;
+   struct Leaf *psNeighborLeaf;
+   size_t uChild;
+   size_t uLevel;
+
+   assert(oSymTable != NULL);
+   assert(psLeaf != NULL);
+
+   if (oSymTable->uHeight == 0U ||
+       2U * psLeaf->uCount >= (size_t)LEAF_SIZE)
+      return;
+
+   psParent = asPath[oSymTable->uHeight - 1U].psBranch;
+   uChild = asPath[oSymTable->uHeight - 1U].uChild;
+   if (uChild > 0U)
+   {
+      psNeighborLeaf = (struct Leaf*)psParent->apvChildren[uChild - 1U];
+      if (psNeighborLeaf->uCount + psLeaf->uCount > (size_t)LEAF_SIZE)
+         return;
+      SymTable_mergeLeaves(oSymTable, psParent, uChild - 1U,
+                           psNeighborLeaf, psLeaf);
+   }
+   else
+   {
+      psNeighborLeaf = (struct Leaf*)psParent->apvChildren[1];
+      if (psLeaf->uCount + psNeighborLeaf->uCount > (size_t)LEAF_SIZE)
+         return;
+      SymTable_mergeLeaves(oSymTable, psParent, 0U, psLeaf,
+                           psNeighborLeaf);
+   }
+
+   /* a merge took a child from the parent, which may now be too small
+      in turn */
+   for (uLevel = oSymTable->uHeight - 1U; uLevel > 0U; uLevel--)
+   {
+      psBranch = asPath[uLevel].psBranch;
+      if (2U * psBranch->uCount >= (size_t)BRANCH_SIZE)
+         break;
+
+      psParent = asPath[uLevel - 1U].psBranch;
+      uChild = asPath[uLevel - 1U].uChild;
+      if (uChild > 0U)
+      {
+         psNeighbor =
+            (struct Branch*)psParent->apvChildren[uChild - 1U];
+         if (psNeighbor->uCount + psBranch->uCount <=
+             (size_t)BRANCH_SIZE)
+         {
+            SymTable_mergeBranches(oSymTable, psParent, uChild - 1U,
+                                   psNeighbor, psBranch);
+            continue;
+         }
+      }
+      else
+      {
+         psNeighbor = (struct Branch*)psParent->apvChildren[1];
+         if (psBranch->uCount + psNeighbor->uCount <=
+             (size_t)BRANCH_SIZE)
+         {
+            SymTable_mergeBranches(oSymTable, psParent, 0U, psBranch,
+                                   psNeighbor);
+            continue;
+         }
+      }
+
+      /* the neighbor is too full to merge with, so it has children to
+         spare */
+      if (psBranch->uCount < 2U)
+         SymTable_borrowChild(psParent, uChild, psBranch);
+      break;
+   }
+
+   /* a root left with one child gives way to it */
+   psBranch = (struct Branch*)oSymTable->pvRoot;
+   if (psBranch->uCount == 1U)
+   {
+      oSymTable->pvRoot = psBranch->apvChildren[0];
+      oSymTable->uHeight--;
+      SymPool_release(&oSymTable->sBranchPool, psBranch);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/* Remove from oSymTable the Binding at index uIndex of psLeaf, the   */
+/* Leaf that asPath leads to, and rebalance the tree.                 */
+
+static void SymTable_removeAt(SymTable_T oSymTable,
+                              struct Step asPath[],
+                              struct Leaf *psLeaf, size_t uIndex)
+{
+   struct Binding *psBinding;
+
+   assert(oSymTable != NULL);
+   assert(asPath != NULL);
+   assert(psLeaf != NULL);
+   assert(uIndex < psLeaf->uCount);
+
+   psBinding = &psLeaf->asBindings[uIndex];
+   if (!oSymTable->iBorrowKeys)
+      SymArena_release(&oSymTable->sKeyArena, (char*)psBinding->pcKey,
+                       psBinding->uKeyLength + 1U);
+
+   memmove(psLeaf->aacHeads[uIndex], psLeaf->aacHeads[uIndex + 1U],
+           (psLeaf->uCount - 1U - uIndex) * HEAD_SIZE);
+   memmove(psBinding, psBinding + 1,
+           (psLeaf->uCount - 1U - uIndex) * sizeof(struct Binding));
+   psLeaf->uCount--;
+
+   assert(oSymTable->uLength > 0U);
+   oSymTable->uLength--;
+
+   SymTable_rebalance(oSymTable, asPath, psLeaf);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength)
+{
+   struct Step asPath[MAX_HEIGHT];
+   struct Probe sProbe;
+   struct Leaf *psLeaf;
+   const void *pvValue;
+   size_t uIndex;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   SymTable_makeProbe(oSymTable, &sProbe, pcKey, uKeyLength);
+   psLeaf = SymTable_locate(oSymTable, &sProbe, asPath, &uIndex,
+                            &iFound);
+   if (!iFound)
+      return NULL;
+
+   pvValue = psLeaf->asBindings[uIndex].pvValue;
+   SymTable_removeAt(oSymTable, asPath, psLeaf, uIndex);
+   return (void*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+/* A tree does not hash, so the code SymTable_hashN() returns is only */
+/* SymHash_word()'s with seed 0, and the functions that take one      */
+/* ignore it.                                                         */
+
+size_t SymTable_hashN(SymTable_T oSymTable, const char *pcKey,
+                      size_t uKeyLength)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymHash_word(pcKey, uKeyLength, 0U);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putH(SymTable_T oSymTable, const char *pcKey,
+                  size_t uKeyLength, size_t uHash,
+                  const void *pvValue)
+{
+   (void)uHash;
+   return SymTable_putN(oSymTable, pcKey, uKeyLength, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertH(SymTable_T oSymTable, const char *pcKey,
+                     size_t uKeyLength, size_t uHash,
+                     const void *pvValue)
+{
+   (void)uHash;
+   return SymTable_upsertN(oSymTable, pcKey, uKeyLength, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsertH(SymTable_T oSymTable, const char *pcKey,
+                             size_t uKeyLength, size_t uHash,
+                             const void *pvValue)
+{
+   (void)uHash;
+   return SymTable_getOrInsertN(oSymTable, pcKey, uKeyLength, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceH(SymTable_T oSymTable, const char *pcKey,
+                        size_t uKeyLength, size_t uHash,
+                        const void *pvValue)
+{
+   (void)uHash;
+   return SymTable_replaceN(oSymTable, pcKey, uKeyLength, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsH(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength, size_t uHash)
+{
+   (void)uHash;
+   return SymTable_containsN(oSymTable, pcKey, uKeyLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getH(SymTable_T oSymTable, const char *pcKey,
+                    size_t uKeyLength, size_t uHash)
+{
+   (void)uHash;
+   return SymTable_getN(oSymTable, pcKey, uKeyLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeH(SymTable_T oSymTable, const char *pcKey,
+                       size_t uKeyLength, size_t uHash)
+{
+   (void)uHash;
+   return SymTable_removeN(oSymTable, pcKey, uKeyLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_removeIf(SymTable_T oSymTable,
+                         int (*pfPredicate)(const char *pcKey,
+                                            void *pvValue,
+                                            void *pvExtra),
+                         void (*pfRelease)(const char *pcKey,
+                                           void *pvValue,
+                                           void *pvExtra),
+                         const void *pvExtra)
+{
+   struct Step asPath[MAX_HEIGHT];
+   struct Probe sProbe;
+   struct Leaf *psLeaf;
+   const struct Binding *psBinding;
+   const char *pcNextKey;
+   size_t uNextKeyLength;
+   size_t uIndex;
+   size_t uRemoved = 0U;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pfPredicate != NULL);
+
+   psLeaf = oSymTable->psFirstLeaf;
+   uIndex = 0U;
+   for (;;)
+   {
+      while (psLeaf != NULL && uIndex == psLeaf->uCount)
+      {
+         psLeaf = psLeaf->psNextLeaf;
+         uIndex = 0U;
+      }
+      if (psLeaf == NULL)
+         break;
+
+      psBinding = &psLeaf->asBindings[uIndex];
+      if (!(*pfPredicate)(psBinding->pcKey, (void*)psBinding->pvValue,
+                          (void*)pvExtra))
+      {
+         uIndex++;
+         continue;
+      }
+
+      if (pfRelease != NULL)
+         (*pfRelease)(psBinding->pcKey, (void*)psBinding->pvValue,
+                      (void*)pvExtra);
+
+      /* removing moves Bindings, within and among Leaves, so
+         remember the key of the next one, whose string stays put,
+         and find it again */
+      pcNextKey = NULL;
+      uNextKeyLength = 0U;
+      if (uIndex + 1U < psLeaf->uCount)
+      {
+         pcNextKey = psBinding[1].pcKey;
+         uNextKeyLength = psBinding[1].uKeyLength;
+      }
+      else if (psLeaf->psNextLeaf != NULL)
+      {
+         pcNextKey = psLeaf->psNextLeaf->asBindings[0].pcKey;
+         uNextKeyLength = psLeaf->psNextLeaf->asBindings[0].uKeyLength;
+      }
+
+      SymTable_makeProbe(oSymTable, &sProbe, psBinding->pcKey,
+                         psBinding->uKeyLength);
+      psLeaf = SymTable_descend(oSymTable, &sProbe, asPath);
+      uIndex = SymTable_searchLeaf(psLeaf, &sProbe, &iFound);
+      assert(iFound);
+      SymTable_removeAt(oSymTable, asPath, psLeaf, uIndex);
+      uRemoved++;
+
+      if (pcNextKey == NULL)
+         break;
+      SymTable_makeProbe(oSymTable, &sProbe, pcNextKey, uNextKeyLength);
+      psLeaf = SymTable_descend(oSymTable, &sProbe, NULL);
+      uIndex = SymTable_searchLeaf(psLeaf, &sProbe, &iFound);
+      assert(iFound);
+   }
+   return uRemoved;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable,
+                       const char *const apcKeys[], size_t uCount,
+                       void *apvValues[])
+{
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0U);
+   assert(apvValues != NULL || uCount == 0U);
+
+   /* the Branches near the root stay cached from one lookup to the
+      next, so the keys are simply looked up in turn */
+   for (u = 0; u < uCount; u++)
+      apvValues[u] = SymTable_get(oSymTable, apcKeys[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable,
+                         const char *const apcKeys[],
+                         const void *const apvValues[], size_t uCount)
+{
+   size_t uPutCount;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0U);
+   assert(apvValues != NULL || uCount == 0U);
+
+   uPutCount = 0U;
+   for (u = 0; u < uCount; u++)
+      if (SymTable_put(oSymTable, apcKeys[u], apvValues[u]))
+         uPutCount++;
+
+   return uPutCount;
+}
+
+/*--------------------------------------------------------------------*/
+/* Call pfApply(pcKey, pvValue, pvExtra) for each binding in the      */
+/* Leaves of oSymTable from psLeaf up to but not including psEnd, in  */
+/* order.                                                             */
+
+static void SymTable_mapLeaves(struct Leaf *psLeaf,
+                               const struct Leaf *psEnd,
+                               void (*pfApply)(const char *pcKey,
+                                               void *pvValue,
+                                               void *pvExtra),
+                               const void *pvExtra)
+{
+   size_t u;
+
+   assert(pfApply != NULL);
+
+   for (; psLeaf != psEnd; psLeaf = psLeaf->psNextLeaf)
+   {
+      assert(psLeaf != NULL);
+      for (u = 0; u < psLeaf->uCount; u++)
+         (*pfApply)(psLeaf->asBindings[u].pcKey,
+                    (void*)psLeaf->asBindings[u].pvValue,
+                    (void*)pvExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey,
+                                  void *pvValue,
+                                  void *pvExtra),
+                  const void *pvExtra)
+{
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   SymTable_mapLeaves(oSymTable->psFirstLeaf, NULL, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable,
+                        struct SymTable_Iter *psIter)
+{
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   psIter->oSymTable = oSymTable;
+   psIter->pvNext = oSymTable->psFirstLeaf;
+   psIter->uIndex = 0U;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(struct SymTable_Iter *psIter,
+                      const char **ppcKey, void **ppvValue)
+{
+   const struct Leaf *psLeaf;
+   const struct Binding *psBinding;
+
+   assert(psIter != NULL);
+   assert(psIter->oSymTable != NULL);
+   assert(ppcKey != NULL);
+   assert(ppvValue != NULL);
+
+   /* pvNext is a Leaf, and uIndex the next of its Bindings to give */
+   psLeaf = (const struct Leaf*)psIter->pvNext;
+   while (psLeaf != NULL && psIter->uIndex == psLeaf->uCount)
+   {
+      psLeaf = psLeaf->psNextLeaf;
+      psIter->pvNext = psLeaf;
+      psIter->uIndex = 0U;
+   }
+   if (psLeaf == NULL)
+      return 0;
+
+   psBinding = &psLeaf->asBindings[psIter->uIndex];
+   psIter->uIndex++;
+   *ppcKey = psBinding->pcKey;
+   *ppvValue = (void*)psBinding->pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getStats(SymTable_T oSymTable,
+                       struct SymTable_Stats *psStats)
+{
+   struct Leaf *psLeaf;
+
+   assert(oSymTable != NULL);
+   assert(psStats != NULL);
+
+#ifdef SYMTABLE_STATS
+   *psStats = oSymTable->sStats;
+#else
+   SymStats_init(psStats);
+#endif
+
+   /* a lookup descends to one Leaf and searches only its bindings */
+   for (psLeaf = oSymTable->psFirstLeaf;
+        psLeaf != NULL;
+        psLeaf = psLeaf->psNextLeaf)
+      SymStats_addChain(psStats, psLeaf->uCount);
+   SymStats_finish(psStats, oSymTable->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the number of bytes of psBranch, whose descendants uHeight  */
+/* levels down are Leaves, of the Branches below it, and of all their */
+/* Separators.                                                        */
+
+static size_t SymTable_countBranchBytes(const struct Branch *psBranch,
+                                        size_t uHeight)
+{
+   size_t uBytes = sizeof(struct Branch);
+   size_t u;
+
+   assert(psBranch != NULL);
+   assert(uHeight > 0U);
+
+   for (u = 0; u + 1U < psBranch->uCount; u++)
+      uBytes += psBranch->asSeparators[u].uKeyLength;
+   if (uHeight > 1U)
+      for (u = 0; u < psBranch->uCount; u++)
+         uBytes += SymTable_countBranchBytes(
+            (const struct Branch*)psBranch->apvChildren[u],
+            uHeight - 1U);
+   return uBytes;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_memoryUsage(SymTable_T oSymTable,
+                            struct SymTable_Memory *psMemory)
+{
+   struct SymTable_Memory sMemory;
+   const struct Leaf *psLeaf;
+   size_t u;
+
+   assert(oSymTable != NULL);
+
+   /* a binding's record is its Binding and its key's head; the rest
+      of each Leaf is slack */
+   sMemory.uTableBytes = sizeof(struct SymTable);
+   sMemory.uIndexBytes = 0U;
+   if (oSymTable->uHeight > 0U)
+      sMemory.uIndexBytes = SymTable_countBranchBytes(
+         (const struct Branch*)oSymTable->pvRoot, oSymTable->uHeight);
+   sMemory.uBindingBytes =
+      oSymTable->uLength * (sizeof(struct Binding) + HEAD_SIZE);
+
+   sMemory.uKeyBytes = 0U;
+   if (!oSymTable->iBorrowKeys)
+      for (psLeaf = oSymTable->psFirstLeaf;
+           psLeaf != NULL;
+           psLeaf = psLeaf->psNextLeaf)
+         for (u = 0; u < psLeaf->uCount; u++)
+            sMemory.uKeyBytes +=
+               psLeaf->asBindings[u].uKeyLength + 1U;
+
+   return SymStats_finishMemory(
+      &sMemory,
+      sMemory.uTableBytes +
+         SymPool_getFootprint(&oSymTable->sLeafPool) +
+         SymPool_getFootprint(&oSymTable->sBranchPool) +
+         SymArena_getFootprint(&oSymTable->sKeyArena),
+      psMemory);
+}
+
+/*--------------------------------------------------------------------*/
+/* Store in *ppsLeaf and *puIndex the Leaf and index of the first    */
+/* Binding of oSymTable whose key is at least pcLow. If there is      */
+/* none, *puIndex is the number of Bindings in the last Leaf.         */
+
+static void SymTable_lowerBound(SymTable_T oSymTable,
+                                const char *pcLow,
+                                struct Leaf **ppsLeaf, size_t *puIndex)
+{
+   struct Probe sProbe;
+   struct Leaf *psLeaf;
+   size_t uIndex;
+   int iFound;
+
+   assert(oSymTable != NULL);
+   assert(pcLow != NULL);
+   assert(ppsLeaf != NULL);
+   assert(puIndex != NULL);
+
+   SymTable_makeProbe(oSymTable, &sProbe, pcLow, strlen(pcLow));
+   psLeaf = SymTable_descend(oSymTable, &sProbe, NULL);
+   uIndex = SymTable_searchLeaf(psLeaf, &sProbe, &iFound);
+
+   /* every key of the Leaf may be smaller, and then the bound is the
+      first key of the next */
+   if (uIndex == psLeaf->uCount && psLeaf->psNextLeaf != NULL)
+   {
+      psLeaf = psLeaf->psNextLeaf;
+      uIndex = 0U;
+   }
+
+   *ppsLeaf = psLeaf;
+   *puIndex = uIndex;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapRange(SymTable_T oSymTable,
+                      const char *pcLow, const char *pcHigh,
+                      void (*pfApply)(const char *pcKey,
+                                      void *pvValue,
+                                      void *pvExtra),
+                      const void *pvExtra)
+{
+   struct Leaf *psLeaf;
+   struct Binding *psBinding;
+   size_t uHighLength;
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   psLeaf = oSymTable->psFirstLeaf;
+   uIndex = 0U;
+   if (pcLow != NULL)
+      SymTable_lowerBound(oSymTable, pcLow, &psLeaf, &uIndex);
+   uHighLength = pcHigh == NULL ? 0U : strlen(pcHigh);
+
+   while (psLeaf != NULL)
+   {
+      for (; uIndex < psLeaf->uCount; uIndex++)
+      {
+         psBinding = &psLeaf->asBindings[uIndex];
+         if (pcHigh != NULL &&
+             SymTable_compareKeys(psBinding->pcKey,
+                                  psBinding->uKeyLength,
+                                  pcHigh, uHighLength) >= 0)
+            return 1;
+         (*pfApply)(psBinding->pcKey, (void*)psBinding->pvValue,
+                    (void*)pvExtra);
+      }
+      psLeaf = psLeaf->psNextLeaf;
+      uIndex = 0U;
+   }
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+                       void (*pfApply)(const char *pcKey,
+                                       void *pvValue,
+                                       void *pvExtra),
+                       const void *pvExtra)
+{
+   struct Leaf *psLeaf;
+   struct Binding *psBinding;
+   size_t uPrefixLength;
+   size_t uIndex;
+
+   assert(oSymTable != NULL);
+   assert(pcPrefix != NULL);
+   assert(pfApply != NULL);
+
+   /* the keys that begin with pcPrefix come together, starting with
+      the first key no smaller than pcPrefix */
+   uPrefixLength = strlen(pcPrefix);
+   SymTable_lowerBound(oSymTable, pcPrefix, &psLeaf, &uIndex);
+
+   while (psLeaf != NULL)
+   {
+      for (; uIndex < psLeaf->uCount; uIndex++)
+      {
+         psBinding = &psLeaf->asBindings[uIndex];
+         if (psBinding->uKeyLength < uPrefixLength ||
+             memcmp(psBinding->pcKey, pcPrefix, uPrefixLength) != 0)
+            return 1;
+         (*pfApply)(psBinding->pcKey, (void*)psBinding->pvValue,
+                    (void*)pvExtra);
+      }
+      psLeaf = psLeaf->psNextLeaf;
+      uIndex = 0U;
+   }
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putParallel(SymTable_T oSymTable,
+                            const char *const apcKeys[],
+                            const void *const apvValues[],
+                            size_t uCount, size_t uThreadCount)
+{
+   /* a split can reach the root, so no part of the tree is safe from
+      another thread's insertions */
+   (void)uThreadCount;
+   return SymTable_putBatch(oSymTable, apcKeys, apvValues, uCount);
+}
+
+/*--------------------------------------------------------------------*/
+/* One thread's share of a SymTable_mapParallel() call.               */
+
+struct MapWork
+{
+   /* this thread visits the Leaves from psFirst up to but not
+      including psEnd. */
+   struct Leaf *psFirst;
+   const struct Leaf *psEnd;
+
+   /* the arguments of SymTable_mapParallel(). */
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+   const void *pvExtra;
+};
+
+/*--------------------------------------------------------------------*/
+/* Do the work *(struct MapWork*)pvWork, and return NULL.             */
+
+static void *SymTable_mapWork(void *pvWork)
+{
+   struct MapWork *psWork;
+
+   assert(pvWork != NULL);
+
+   psWork = (struct MapWork*)pvWork;
+   SymTable_mapLeaves(psWork->psFirst, psWork->psEnd, psWork->pfApply,
+                      psWork->pvExtra);
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+/* Return the first Leaf under pvNode, a node uHeight levels above    */
+/* the Leaves.                                                        */
+
+static struct Leaf *SymTable_firstLeafUnder(void *pvNode,
+                                            size_t uHeight)
+{
+   assert(pvNode != NULL);
+
+   for (; uHeight > 0U; uHeight--)
+      pvNode = ((struct Branch*)pvNode)->apvChildren[0];
+   return (struct Leaf*)pvNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable, size_t uThreadCount,
+                          void (*pfApply)(const char *pcKey,
+                                          void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra)
+{
+   struct MapWork *psWorks;
+   struct Branch *psRoot;
+   size_t uShare;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   /* the subtrees of the root are dealt out, each thread taking a run
+      of them */
+   if (uThreadCount > oSymTable->uLength / MIN_WORK_PER_THREAD)
+      uThreadCount = oSymTable->uLength / MIN_WORK_PER_THREAD;
+   psRoot = (struct Branch*)oSymTable->pvRoot;
+   if (oSymTable->uHeight == 0U)
+      uThreadCount = 1U;
+   else if (uThreadCount > psRoot->uCount)
+      uThreadCount = psRoot->uCount;
+   psWorks = NULL;
+   if (uThreadCount > 1U)
+      psWorks = (struct MapWork*)malloc(uThreadCount *
+                                        sizeof(struct MapWork));
+   if (psWorks == NULL)
+   {
+      SymTable_map(oSymTable, pfApply, pvExtra);
+      return;
+   }
+
+   uShare = (psRoot->uCount + uThreadCount - 1U) / uThreadCount;
+   uThreadCount = (psRoot->uCount + uShare - 1U) / uShare;
+   for (u = 0; u < uThreadCount; u++)
+   {
+      psWorks[u].psFirst = SymTable_firstLeafUnder(
+         psRoot->apvChildren[u * uShare], oSymTable->uHeight - 1U);
+      psWorks[u].psEnd = NULL;
+      if (u > 0U)
+         psWorks[u - 1U].psEnd = psWorks[u].psFirst;
+      psWorks[u].pfApply = pfApply;
+      psWorks[u].pvExtra = pvExtra;
+   }
+
+   SymThread_runAll(SymTable_mapWork, psWorks, sizeof(struct MapWork),
+                    uThreadCount);
+   free(psWorks);
+}
+
+/*--------------------------------------------------------------------*/
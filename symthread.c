@@ -0,0 +1,57 @@
+/*--------------------------------------------------------------------*/
+/* symthread.c                                                        */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#include "symthread.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+/*--------------------------------------------------------------------*/
+
+void SymThread_runAll(void *(*pfRun)(void *pvWork), void *pvWorks,
+                      size_t uWorkSize, size_t uWorkCount)
+{
+   pthread_t *piThreads;
+   int *aiStarted;
+   size_t u;
+
+   assert(pfRun != NULL);
+   assert(pvWorks != NULL || uWorkCount == 0U);
+
+   if (uWorkCount == 0U)
+      return;
+
+   piThreads = (pthread_t*)malloc(uWorkCount * sizeof(pthread_t));
+   aiStarted = (int*)malloc(uWorkCount * sizeof(int));
+   if (piThreads == NULL || aiStarted == NULL)
+   {
+      /* without room to track threads, do everything here */
+      free(piThreads);
+      free(aiStarted);
+      for (u = 0; u < uWorkCount; u++)
+         (void)(*pfRun)((char*)pvWorks + u * uWorkSize);
+      return;
+   }
+
+   for (u = 1; u < uWorkCount; u++)
+      aiStarted[u] = pthread_create(&piThreads[u], NULL, pfRun,
+                                    (char*)pvWorks + u * uWorkSize)
+                     == 0;
+
+   (void)(*pfRun)(pvWorks);
+
+   for (u = 1; u < uWorkCount; u++)
+   {
+      if (aiStarted[u])
+         pthread_join(piThreads[u], NULL);
+      else
+         (void)(*pfRun)((char*)pvWorks + u * uWorkSize);
+   }
+
+   free(piThreads);
+   free(aiStarted);
+}
+
+/*--------------------------------------------------------------------*/
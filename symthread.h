@@ -0,0 +1,18 @@
+/*--------------------------------------------------------------------*/
+/* symthread.h                                                        */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTHREAD_INCLUDED
+#define SYMTHREAD_INCLUDED
+#include <stddef.h>
+
+/* Call pfRun(pvWork) for each of the uWorkCount work items of
+   uWorkSize bytes each at pvWorks, the first in the calling thread
+   and each other one in a thread of its own, and return once every
+   call has returned. A work item whose thread cannot be started is
+   run in the calling thread instead, so every item is always run. */
+void SymThread_runAll(void *(*pfRun)(void *pvWork), void *pvWorks,
+                      size_t uWorkSize, size_t uWorkCount);
+
+#endif
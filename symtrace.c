@@ -0,0 +1,161 @@
+/*--------------------------------------------------------------------*/
+/* symtrace.c                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() is a POSIX extension, so ask for it */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtrace.h"
+#include <assert.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+void SymTrace_init(struct SymTrace *psTrace,
+                   const struct SymTable_Options *psOptions)
+{
+   assert(psTrace != NULL);
+   assert(psOptions != NULL);
+
+   psTrace->pfTrace = psOptions->pfTrace;
+   psTrace->pvExtra = psOptions->pvTraceExtra;
+   psTrace->uSampleInterval = psOptions->uTraceSampleInterval;
+   if (psTrace->uSampleInterval == 0)
+      psTrace->uSampleInterval = 1;
+   psTrace->uLookupCount = 0;
+   psTrace->dMinSeconds = psOptions->dTraceMinSeconds;
+   psTrace->uMinProbes = psOptions->uTraceMinProbes;
+   psTrace->dResizeStart = 0.0;
+   psTrace->uResizeFrom = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTrace_sample(struct SymTrace *psTrace)
+{
+   size_t uCount;
+
+   assert(psTrace != NULL);
+
+   /* Several threads may look keys up in one table at once, so count
+      atomically where the compiler allows. A lookup lost to a race
+      elsewhere only shifts which lookups are sampled. */
+#ifdef __GNUC__
+   uCount = __atomic_add_fetch(&psTrace->uLookupCount, (size_t)1,
+                               __ATOMIC_RELAXED);
+#else
+   uCount = ++psTrace->uLookupCount;
+#endif
+   return uCount % psTrace->uSampleInterval == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+double SymTrace_now(void)
+{
+   struct timespec sNow;
+
+   clock_gettime(CLOCK_MONOTONIC, &sNow);
+   return (double)sNow.tv_sec + (double)sNow.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fill in *psEvent as an event of kind eKind in oSymTable, with
+   nothing else known of it yet. */
+
+static void SymTrace_clearEvent(struct SymTable_TraceEvent *psEvent,
+                                enum SymTable_TraceKind eKind,
+                                SymTable_T oSymTable)
+{
+   assert(psEvent != NULL);
+
+   psEvent->eKind = eKind;
+   psEvent->oSymTable = oSymTable;
+   psEvent->pcKey = NULL;
+   psEvent->uKeyLength = 0;
+   psEvent->iFound = 0;
+   psEvent->uProbes = 0;
+   psEvent->dSeconds = 0.0;
+   psEvent->uOldSize = 0;
+   psEvent->uNewSize = 0;
+   psEvent->uLength = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTrace_lookup(struct SymTrace *psTrace, SymTable_T oSymTable,
+                     const char *pcKey, size_t uKeyLength, int iFound,
+                     size_t uProbes, double dSeconds)
+{
+   struct SymTable_TraceEvent sEvent;
+   int iReport;
+
+   assert(psTrace != NULL);
+   assert(pcKey != NULL);
+
+   if (psTrace->pfTrace == NULL)
+      return;
+
+   if (psTrace->dMinSeconds == 0.0 && psTrace->uMinProbes == 0)
+      iReport = 1;
+   else
+      iReport = (psTrace->dMinSeconds != 0.0
+                 && dSeconds >= psTrace->dMinSeconds)
+         || (psTrace->uMinProbes != 0
+             && uProbes >= psTrace->uMinProbes);
+   if (!iReport)
+      return;
+
+   SymTrace_clearEvent(&sEvent, SYMTABLE_TRACE_LOOKUP, oSymTable);
+   sEvent.pcKey = pcKey;
+   sEvent.uKeyLength = uKeyLength;
+   sEvent.iFound = iFound;
+   sEvent.uProbes = uProbes;
+   sEvent.dSeconds = dSeconds;
+   psTrace->pfTrace(&sEvent, psTrace->pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTrace_beginResize(struct SymTrace *psTrace,
+                          SymTable_T oSymTable, size_t uLength,
+                          size_t uOldSize, size_t uNewSize)
+{
+   struct SymTable_TraceEvent sEvent;
+
+   assert(psTrace != NULL);
+
+   if (psTrace->pfTrace == NULL)
+      return;
+
+   psTrace->dResizeStart = SymTrace_now();
+   psTrace->uResizeFrom = uOldSize;
+
+   SymTrace_clearEvent(&sEvent, SYMTABLE_TRACE_RESIZE_BEGIN, oSymTable);
+   sEvent.uOldSize = uOldSize;
+   sEvent.uNewSize = uNewSize;
+   sEvent.uLength = uLength;
+   psTrace->pfTrace(&sEvent, psTrace->pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTrace_endResize(struct SymTrace *psTrace, SymTable_T oSymTable,
+                        size_t uLength, size_t uNewSize)
+{
+   struct SymTable_TraceEvent sEvent;
+
+   assert(psTrace != NULL);
+
+   if (psTrace->pfTrace == NULL)
+      return;
+
+   SymTrace_clearEvent(&sEvent, SYMTABLE_TRACE_RESIZE_END, oSymTable);
+   sEvent.dSeconds = SymTrace_now() - psTrace->dResizeStart;
+   sEvent.uOldSize = psTrace->uResizeFrom;
+   sEvent.uNewSize = uNewSize;
+   sEvent.uLength = uLength;
+   psTrace->pfTrace(&sEvent, psTrace->pvExtra);
+}
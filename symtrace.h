@@ -0,0 +1,78 @@
+/*--------------------------------------------------------------------*/
+/* symtrace.h                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTRACE_INCLUDED
+#define SYMTRACE_INCLUDED
+#include "symtable.h"
+#include <stddef.h>
+
+/* Tracing for the SymTable implementations, which each embed a
+   SymTrace configured by the trace fields of SymTable_Options.
+   Clients embed the structure by value but must not use its fields
+   directly. */
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTrace decides which lookups of one table to sample and
+   reports that table's events. */
+struct SymTrace
+{
+   /* the trace function and its extra argument, or NULL. */
+   void (*pfTrace)(const struct SymTable_TraceEvent *psEvent,
+                   void *pvExtra);
+   void *pvExtra;
+
+   /* 1 in uSampleInterval lookups is sampled: those that bring
+      uLookupCount to a multiple of it. */
+   size_t uSampleInterval;
+   size_t uLookupCount;
+
+   /* the thresholds a sampled lookup is reported at. */
+   double dMinSeconds;
+   size_t uMinProbes;
+
+   /* the time when, and the array size from which, the resize in
+      progress began. */
+   double dResizeStart;
+   size_t uResizeFrom;
+};
+
+/* Initialize *psTrace as *psOptions asks. */
+void SymTrace_init(struct SymTrace *psTrace,
+                   const struct SymTable_Options *psOptions);
+
+/* Return 1 if the lookup about to be made is to be sampled, or 0
+   otherwise. Evaluates psTrace more than once. */
+#define SYMTRACE_SAMPLED(psTrace) \
+   ((psTrace)->pfTrace != NULL && SymTrace_sample(psTrace))
+
+/* Count a lookup, and return 1 if it is to be sampled, or 0
+   otherwise. Use SYMTRACE_SAMPLED() instead, which is far cheaper
+   when tracing is off. */
+int SymTrace_sample(struct SymTrace *psTrace);
+
+/* Return the wall-clock time in seconds, from an arbitrary starting
+   point. */
+double SymTrace_now(void);
+
+/* Report, if it crosses a threshold, a sampled lookup in oSymTable
+   of the uKeyLength bytes at pcKey, which took dSeconds, examined
+   uProbes bindings, and found the key if iFound is 1. */
+void SymTrace_lookup(struct SymTrace *psTrace, SymTable_T oSymTable,
+                     const char *pcKey, size_t uKeyLength, int iFound,
+                     size_t uProbes, double dSeconds);
+
+/* Report that oSymTable, holding uLength bindings, has begun moving
+   from an array of uOldSize buckets or slots to one of uNewSize. */
+void SymTrace_beginResize(struct SymTrace *psTrace,
+                          SymTable_T oSymTable, size_t uLength,
+                          size_t uOldSize, size_t uNewSize);
+
+/* Report that the resize oSymTable began last has finished, leaving
+   it with uLength bindings in an array of uNewSize. */
+void SymTrace_endResize(struct SymTrace *psTrace, SymTable_T oSymTable,
+                        size_t uLength, size_t uNewSize);
+
+#endif
@@ -0,0 +1,357 @@
+/*--------------------------------------------------------------------*/
+/* symtyped.h                                                         */
+/* Author: Mohemeen Ahmed                                             */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTYPED_INCLUDED
+#define SYMTYPED_INCLUDED
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/* SYMTABLE_DECLARE(name, KeyT, ValT) declares, and
+   SYMTABLE_DEFINE(name, KeyT, ValT, hashFn, eqFn) defines, a hash
+   table type name_T that maps keys of type KeyT to values of type
+   ValT. Keys and values are stored by value in the table's own
+   arrays, so small ones need no boxing, and hashFn and eqFn are
+   called directly, so a compiler can inline them into every
+   operation. Declare a table in a header and define it once in a .c
+   file, or do both in a .c file that alone uses it. Each use of
+   either macro is followed by a semicolon.
+
+   hashFn(oKey) must return a size_t hash code for a KeyT, and
+   eqFn(oKey1, oKey2) nonzero if and only if two KeyTs are equal.
+   Either may be a function or a macro that evaluates its arguments
+   once. The table mixes every hash code before masking it, so even
+   ((size_t)(i)) is a fair hash for integers. KeyT and ValT must be
+   types that can be assigned, such as integers, pointers or structs.
+
+   SymTable_T remains the table of string keys and void * values.
+
+   The generated functions are:
+
+   name_T name_new(void);
+      Return a new empty table, or NULL if out of memory.
+   void name_free(name_T oTable);
+      Free oTable.
+   size_t name_getLength(name_T oTable);
+      Return the number of bindings in oTable.
+   int name_put(name_T oTable, KeyT oKey, ValT oValue);
+      Bind oKey to oValue and return 1 if oKey is not yet bound;
+      otherwise, or if out of memory, leave oTable alone and return 0.
+   ValT *name_find(name_T oTable, KeyT oKey);
+      Return the address of the value bound to oKey, through which
+      it may be read or replaced, or NULL if oKey is not bound. The
+      address is valid until the next put or remove.
+   int name_contains(name_T oTable, KeyT oKey);
+      Return 1 if oKey is bound in oTable, or 0 otherwise.
+   int name_remove(name_T oTable, KeyT oKey, ValT *poValue);
+      Remove oKey's binding and return 1, first storing its value in
+      *poValue unless poValue is NULL, or return 0 if oKey is not
+      bound.
+   void name_iterBegin(name_T oTable, struct name_Iter *psIter);
+   int name_iterNext(struct name_Iter *psIter, KeyT *poKey,
+                     ValT **ppoValue);
+      Visit each binding once, in no particular order, as with the
+      SymTable_Iter cursors; iterNext returns 0 when none are left.
+      oTable must not be changed during a visit except through
+      *ppoValue. */
+
+/* the multiplier and shift of the mix applied to each hash code.
+   They are those of SymHash_word's final avalanche step. */
+#define SYMTYPED_MIX_MULTIPLIER                                        \
+   (sizeof(size_t) >= 8U ?                                             \
+      ((((size_t)0xc6a4a793UL << 16) << 16) | (size_t)0x5bd1e995UL) :  \
+      (size_t)0x5bd1e995UL)
+#define SYMTYPED_MIX_SHIFT (sizeof(size_t) >= 8U ? 47U : 15U)
+
+/* number of slots in a new table. Must be a power of two. */
+#define SYMTYPED_INITIAL_SLOT_COUNT 16U
+
+/*--------------------------------------------------------------------*/
+
+#define SYMTABLE_DECLARE(name, KeyT, ValT)                             \
+                                                                       \
+typedef struct name *name##_T;                                         \
+                                                                       \
+struct name##_Iter                                                     \
+{                                                                      \
+   name##_T oTable;                                                    \
+   size_t uIndex;                                                      \
+};                                                                     \
+                                                                       \
+name##_T name##_new(void);                                             \
+void name##_free(name##_T oTable);                                     \
+size_t name##_getLength(name##_T oTable);                              \
+int name##_put(name##_T oTable, KeyT oKey, ValT oValue);               \
+ValT *name##_find(name##_T oTable, KeyT oKey);                         \
+int name##_contains(name##_T oTable, KeyT oKey);                       \
+int name##_remove(name##_T oTable, KeyT oKey, ValT *poValue);          \
+void name##_iterBegin(name##_T oTable, struct name##_Iter *psIter);    \
+int name##_iterNext(struct name##_Iter *psIter, KeyT *poKey,           \
+                    ValT **ppoValue)
+
+/*--------------------------------------------------------------------*/
+/* A table is an open-addressing hash table with linear probing. Its  */
+/* keys, values and occupancy flags are kept in three arrays, so that */
+/* a probe touches only keys, and removal shifts later bindings back  */
+/* instead of leaving tombstones.                                     */
+
+#define SYMTABLE_DEFINE(name, KeyT, ValT, hashFn, eqFn)                \
+                                                                       \
+struct name                                                            \
+{                                                                      \
+   /* arrays of uSlotCount keys, values and flags; a slot is in use    \
+      if its flag is nonzero. uSlotCount is a power of two. */         \
+   KeyT *poKeys;                                                       \
+   ValT *poValues;                                                     \
+   unsigned char *pucUsed;                                             \
+   size_t uSlotCount;                                                  \
+                                                                       \
+   /* number of slots in use. */                                       \
+   size_t uLength;                                                     \
+};                                                                     \
+                                                                       \
+/* Return the slot that oKey hashes to in a table whose slot-index     \
+   mask is uMask. */                                                   \
+                                                                       \
+static size_t name##_home(KeyT oKey, size_t uMask)                     \
+{                                                                      \
+   size_t uHash;                                                       \
+                                                                       \
+   uHash = (size_t)(hashFn(oKey));                                     \
+   uHash ^= uHash >> SYMTYPED_MIX_SHIFT;                               \
+   uHash *= SYMTYPED_MIX_MULTIPLIER;                                   \
+   uHash ^= uHash >> SYMTYPED_MIX_SHIFT;                               \
+   return uHash & uMask;                                               \
+}                                                                      \
+                                                                       \
+/* Return the slot of oTable that holds oKey, or uSlotCount if none    \
+   does. */                                                            \
+                                                                       \
+static size_t name##_index(name##_T oTable, KeyT oKey)                 \
+{                                                                      \
+   size_t uMask;                                                       \
+   size_t u;                                                           \
+                                                                       \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   uMask = oTable->uSlotCount - 1U;                                    \
+   for (u = name##_home(oKey, uMask); oTable->pucUsed[u];              \
+        u = (u + 1U) & uMask)                                          \
+      if (eqFn(oTable->poKeys[u], oKey))                               \
+         return u;                                                     \
+   return oTable->uSlotCount;                                          \
+}                                                                      \
+                                                                       \
+/* Store oKey and oValue in the first free slot of oTable's probe      \
+   sequence for oKey, which must not be bound. */                      \
+                                                                       \
+static void name##_insert(name##_T oTable, KeyT oKey, ValT oValue)     \
+{                                                                      \
+   size_t uMask;                                                       \
+   size_t u;                                                           \
+                                                                       \
+   assert(oTable != NULL);                                             \
+   assert(oTable->uLength < oTable->uSlotCount);                       \
+                                                                       \
+   uMask = oTable->uSlotCount - 1U;                                    \
+   for (u = name##_home(oKey, uMask); oTable->pucUsed[u];              \
+        u = (u + 1U) & uMask)                                          \
+      ;                                                                \
+   oTable->poKeys[u] = oKey;                                           \
+   oTable->poValues[u] = oValue;                                       \
+   oTable->pucUsed[u] = 1;                                             \
+   oTable->uLength++;                                                  \
+}                                                                      \
+                                                                       \
+/* Give oTable arrays of uSlotCount slots and no bindings. Return 1    \
+   if successful, or 0, leaving oTable alone, if out of memory. */     \
+                                                                       \
+static int name##_allocate(name##_T oTable, size_t uSlotCount)         \
+{                                                                      \
+   KeyT *poKeys;                                                       \
+   ValT *poValues;                                                     \
+   unsigned char *pucUsed;                                             \
+                                                                       \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   if (uSlotCount > (size_t)-1 / sizeof(KeyT) ||                       \
+       uSlotCount > (size_t)-1 / sizeof(ValT))                         \
+      return 0;                                                        \
+   poKeys = (KeyT*)malloc(uSlotCount * sizeof(KeyT));                  \
+   poValues = (ValT*)malloc(uSlotCount * sizeof(ValT));                \
+   pucUsed = (unsigned char*)calloc(uSlotCount, 1U);                   \
+   if (poKeys == NULL || poValues == NULL || pucUsed == NULL)          \
+   {                                                                   \
+      free(poKeys);                                                    \
+      free(poValues);                                                  \
+      free(pucUsed);                                                   \
+      return 0;                                                        \
+   }                                                                   \
+                                                                       \
+   oTable->poKeys = poKeys;                                            \
+   oTable->poValues = poValues;                                        \
+   oTable->pucUsed = pucUsed;                                          \
+   oTable->uSlotCount = uSlotCount;                                    \
+   oTable->uLength = 0U;                                               \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+/* Double the number of slots of oTable. Return 1 if successful, or 0, \
+   leaving oTable alone, if out of memory. */                          \
+                                                                       \
+static int name##_grow(name##_T oTable)                                \
+{                                                                      \
+   struct name sOld;                                                   \
+   size_t u;                                                           \
+                                                                       \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   sOld = *oTable;                                                     \
+   if (sOld.uSlotCount > (size_t)-1 / 2U)                              \
+      return 0;                                                        \
+   if (!name##_allocate(oTable, sOld.uSlotCount * 2U))                 \
+      return 0;                                                        \
+                                                                       \
+   for (u = 0; u < sOld.uSlotCount; u++)                               \
+      if (sOld.pucUsed[u])                                             \
+         name##_insert(oTable, sOld.poKeys[u], sOld.poValues[u]);      \
+   free(sOld.poKeys);                                                  \
+   free(sOld.poValues);                                                \
+   free(sOld.pucUsed);                                                 \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+name##_T name##_new(void)                                              \
+{                                                                      \
+   name##_T oTable;                                                    \
+                                                                       \
+   oTable = (name##_T)malloc(sizeof(struct name));                     \
+   if (oTable == NULL)                                                 \
+      return NULL;                                                     \
+   if (!name##_allocate(oTable, SYMTYPED_INITIAL_SLOT_COUNT))          \
+   {                                                                   \
+      free(oTable);                                                    \
+      return NULL;                                                     \
+   }                                                                   \
+   return oTable;                                                      \
+}                                                                      \
+                                                                       \
+void name##_free(name##_T oTable)                                      \
+{                                                                      \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   free(oTable->poKeys);                                               \
+   free(oTable->poValues);                                             \
+   free(oTable->pucUsed);                                              \
+   free(oTable);                                                       \
+}                                                                      \
+                                                                       \
+size_t name##_getLength(name##_T oTable)                               \
+{                                                                      \
+   assert(oTable != NULL);                                             \
+   return oTable->uLength;                                             \
+}                                                                      \
+                                                                       \
+int name##_put(name##_T oTable, KeyT oKey, ValT oValue)                \
+{                                                                      \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   if (name##_index(oTable, oKey) != oTable->uSlotCount)               \
+      return 0;                                                        \
+                                                                       \
+   /* keep at least one slot in eight free, so probes stay short */    \
+   if (oTable->uLength + 1U >                                          \
+       oTable->uSlotCount - oTable->uSlotCount / 8U)                   \
+      if (!name##_grow(oTable))                                        \
+         return 0;                                                     \
+                                                                       \
+   name##_insert(oTable, oKey, oValue);                                \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+ValT *name##_find(name##_T oTable, KeyT oKey)                          \
+{                                                                      \
+   size_t u;                                                           \
+                                                                       \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   u = name##_index(oTable, oKey);                                     \
+   if (u == oTable->uSlotCount)                                        \
+      return NULL;                                                     \
+   return &oTable->poValues[u];                                        \
+}                                                                      \
+                                                                       \
+int name##_contains(name##_T oTable, KeyT oKey)                        \
+{                                                                      \
+   assert(oTable != NULL);                                             \
+   return name##_index(oTable, oKey) != oTable->uSlotCount;            \
+}                                                                      \
+                                                                       \
+int name##_remove(name##_T oTable, KeyT oKey, ValT *poValue)           \
+{                                                                      \
+   size_t uMask;                                                       \
+   size_t uHole;                                                       \
+   size_t u;                                                           \
+                                                                       \
+   assert(oTable != NULL);                                             \
+                                                                       \
+   uHole = name##_index(oTable, oKey);                                 \
+   if (uHole == oTable->uSlotCount)                                    \
+      return 0;                                                        \
+   if (poValue != NULL)                                                \
+      *poValue = oTable->poValues[uHole];                              \
+                                                                       \
+   /* move back each later binding of the run that may fill the hole,  \
+      that is, whose home is no further along than the hole */         \
+   uMask = oTable->uSlotCount - 1U;                                    \
+   for (u = (uHole + 1U) & uMask; oTable->pucUsed[u];                  \
+        u = (u + 1U) & uMask)                                          \
+      if (((u - name##_home(oTable->poKeys[u], uMask)) & uMask) >=     \
+          ((u - uHole) & uMask))                                       \
+      {                                                                \
+         oTable->poKeys[uHole] = oTable->poKeys[u];                    \
+         oTable->poValues[uHole] = oTable->poValues[u];                \
+         uHole = u;                                                    \
+      }                                                                \
+   oTable->pucUsed[uHole] = 0;                                         \
+   oTable->uLength--;                                                  \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+void name##_iterBegin(name##_T oTable, struct name##_Iter *psIter)     \
+{                                                                      \
+   assert(oTable != NULL);                                             \
+   assert(psIter != NULL);                                             \
+                                                                       \
+   psIter->oTable = oTable;                                            \
+   psIter->uIndex = 0U;                                                \
+}                                                                      \
+                                                                       \
+int name##_iterNext(struct name##_Iter *psIter, KeyT *poKey,           \
+                    ValT **ppoValue)                                   \
+{                                                                      \
+   name##_T oTable;                                                    \
+                                                                       \
+   assert(psIter != NULL);                                             \
+   assert(psIter->oTable != NULL);                                     \
+                                                                       \
+   oTable = psIter->oTable;                                            \
+   for (; psIter->uIndex < oTable->uSlotCount; psIter->uIndex++)       \
+      if (oTable->pucUsed[psIter->uIndex])                             \
+      {                                                                \
+         if (poKey != NULL)                                            \
+            *poKey = oTable->poKeys[psIter->uIndex];                   \
+         if (ppoValue != NULL)                                         \
+            *ppoValue = &oTable->poValues[psIter->uIndex];             \
+         psIter->uIndex++;                                             \
+         return 1;                                                     \
+      }                                                                \
+   return 0;                                                           \
+}                                                                      \
+                                                                       \
+/* end with a declaration, so that the macro takes a semicolon */      \
+int name##_contains(name##_T oTable, KeyT oKey)
+
+#endif
@@ -4,6 +4,17 @@
 /*--------------------------------------------------------------------*/
 
 #include "symtable.h"
+#include "symhash.h"
+#include "symconc.h"
+#include "symrcu.h"
+#include "symimage.h"
+#include "symperfect.h"
+#include "symscope.h"
+#include "symintern.h"
+#include "symidmap.h"
+#include "symtyped.h"
+#include "symsnap.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -700,7 +711,9 @@ static void testTableOfTables(void)
    test assumes that a SymTable object is implemented as a hash table,
    that there are 509 buckets in the hash table, and that the
    implementation uses the hash function provided in the assignment
-   specification. */
+   specification. The hash implementations now default to a different
+   hash function and bucket count; testHashFunctions() shows how each
+   hash function spreads these keys. */
 
 static void testCollisions(void)
 {
@@ -776,22 +789,3534 @@ static void testCollisions(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Test SymTable objects created by SymTable_newWithOptions() with a
+   load factor of dMaxLoadFactor, by putting, getting, and removing
+   enough bindings to force several expansions. */
+
+static void testLoadFactor(double dMaxLoadFactor)
+{
+   enum {BINDING_COUNT = 3000};
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   struct SymTable_Options sOptions;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object with load factor %.2f.\n",
+      dMaxLoadFactor);
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   SymTable_initOptions(&sOptions);
+   ASSURE(sOptions.dMaxLoadFactor > 0.0);
+   sOptions.dMaxLoadFactor = dMaxLoadFactor;
+
+   oSymTable = SymTable_newWithOptions(&sOptions);
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+      ASSURE(iSuccessful);
+   }
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == BINDING_COUNT);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue == acValue);
+   }
+
+   iSuccessful = SymTable_put(oSymTable, "0", acValue);
+   ASSURE(! iSuccessful);
+
+   for (i = 0; i < BINDING_COUNT; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acValue);
+   }
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == BINDING_COUNT / 2);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey) == (i % 2 == 1));
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increment the binding count *pvExtra. pcKey and pvValue are
+   unused. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object that rehashes incrementally, checking that
+   every binding stays reachable by every function while expansions
+   are still in progress. */
+
+static void testIncrementalRehash(void)
+{
+   enum {BINDING_COUNT = 5000};
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   struct SymTable_Options sOptions;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   char acNewValue[] = "new value";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+   size_t uLength;
+   size_t uCount;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object that rehashes incrementally.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   SymTable_initOptions(&sOptions);
+   sOptions.uRehashStep = 1;
+
+   oSymTable = SymTable_newWithOptions(&sOptions);
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+      ASSURE(iSuccessful);
+
+      /* every binding so far must still be visited by map */
+      if (i % 499 == 0)
+      {
+         uCount = 0;
+         SymTable_map(oSymTable, countBinding, &uCount);
+         ASSURE(uCount == (size_t)(i + 1));
+      }
+   }
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+      ASSURE(! iSuccessful);
+   }
+
+   for (i = 0; i < BINDING_COUNT; i += 3)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_replace(oSymTable, acKey, acNewValue);
+      ASSURE(pcValue == acValue);
+   }
+
+   for (i = 0; i < BINDING_COUNT; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == (i % 3 == 0 ? acNewValue : acValue));
+   }
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == BINDING_COUNT / 2);
+
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == uLength);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      if (i % 2 == 0)
+         ASSURE(pcValue == NULL);
+      else
+         ASSURE(pcValue == (i % 3 == 0 ? acNewValue : acValue));
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Hash the iKeyCount keys in apcKeys with pfHash and uSeed into
+   uBucketCount buckets, reducing each hash code by masking if
+   iMask is nonzero or modulo uBucketCount otherwise. Write to stdout
+   a line, labeled pcLabel, that reports how many buckets are used,
+   how many keys collide with an earlier key, the longest chain, and
+   the average number of keys compared by a successful lookup. */
+
+static void reportHashStatistics(const char *pcLabel, SymHash_T pfHash,
+   size_t uSeed, const char *apcKeys[], int iKeyCount,
+   size_t uBucketCount, int iMask)
+{
+   size_t *puChainLengths;
+   size_t uHash;
+   size_t uIndex;
+   size_t uUsed = 0;
+   size_t uMaxChain = 0;
+   size_t uProbes = 0;
+   int i;
+
+   assert(pcLabel != NULL);
+   assert(pfHash != NULL);
+   assert(apcKeys != NULL);
+
+   puChainLengths = (size_t*)calloc(uBucketCount, sizeof(size_t));
+   ASSURE(puChainLengths != NULL);
+   if (puChainLengths == NULL)
+      return;
+
+   for (i = 0; i < iKeyCount; i++)
+   {
+      uHash = (*pfHash)(apcKeys[i], strlen(apcKeys[i]), uSeed);
+      if (iMask)
+         uIndex = uHash & (uBucketCount - 1);
+      else
+         uIndex = uHash % uBucketCount;
+
+      if (puChainLengths[uIndex] == 0)
+         uUsed++;
+      puChainLengths[uIndex]++;
+      uProbes += puChainLengths[uIndex];
+      if (puChainLengths[uIndex] > uMaxChain)
+         uMaxChain = puChainLengths[uIndex];
+   }
+
+   printf("%-24s buckets %5lu  used %5lu  collisions %5lu  "
+      "max chain %3lu  probes/hit %.2f\n",
+      pcLabel, (unsigned long)uBucketCount, (unsigned long)uUsed,
+      (unsigned long)((size_t)iKeyCount - uUsed),
+      (unsigned long)uMaxChain,
+      iKeyCount == 0 ? 0.0 : (double)uProbes / iKeyCount);
+   fflush(stdout);
+
+   free(puChainLengths);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Report collision and chain-length statistics for each hash function
+   in symhash.h, for sequential integer keys and for the keys that
+   testCollisions() uses. */
+
+static void testHashFunctions(void)
+{
+   enum {KEY_COUNT = 4096};
+   enum {MAX_KEY_LENGTH = 10};
+
+   static char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   const char *apcKeys[KEY_COUNT];
+   const char *apcCollidingKeys[] =
+      {"250", "469", "947", "1303", "2016"};
+   size_t uSeed;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the hash functions.\n");
+   printf("Hash function statistics should appear here:\n");
+   fflush(stdout);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(aacKeys[i], "%d", i);
+      apcKeys[i] = aacKeys[i];
+   }
+   uSeed = SymHash_makeSeed();
+   ASSURE(uSeed != SymHash_makeSeed());
+
+   printf("%d sequential integer keys:\n", KEY_COUNT);
+   reportHashStatistics("classic, modulo prime", SymHash_classic, 0,
+      apcKeys, KEY_COUNT, 4093, 0);
+   reportHashStatistics("classic, masked", SymHash_classic, 0,
+      apcKeys, KEY_COUNT, 4096, 1);
+   reportHashStatistics("word, masked", SymHash_word, 0,
+      apcKeys, KEY_COUNT, 4096, 1);
+   reportHashStatistics("word, seeded, masked", SymHash_word, uSeed,
+      apcKeys, KEY_COUNT, 4096, 1);
+   reportHashStatistics("sip, seeded, masked", SymHash_sip, uSeed,
+      apcKeys, KEY_COUNT, 4096, 1);
+
+   printf("5 keys that collide under the classic hash:\n");
+   reportHashStatistics("classic, modulo prime", SymHash_classic, 0,
+      apcCollidingKeys, 5, 509, 0);
+   reportHashStatistics("word, masked", SymHash_word, 0,
+      apcCollidingKeys, 5, 512, 1);
+   reportHashStatistics("word, seeded, masked", SymHash_word, uSeed,
+      apcCollidingKeys, 5, 512, 1);
+   reportHashStatistics("sip, seeded, masked", SymHash_sip, uSeed,
+      apcCollidingKeys, 5, 512, 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the word that SymHash_word() mixes to uMixed: the inverse
+   of its per-word multiply-xorshift step. */
+
+static size_t unmixWord(size_t uMixed)
+{
+   const size_t uMultiplier =
+      sizeof(size_t) >= 8U ?
+         ((((size_t)0xc6a4a793UL << 16) << 16) | (size_t)0x5bd1e995UL) :
+         (size_t)0x5bd1e995UL;
+   const unsigned int uShift = sizeof(size_t) >= 8U ? 47U : 24U;
+   size_t uInverse;
+   int i;
+
+   /* Newton's iteration doubles the correct low bits of the inverse
+      of an odd multiplier each time */
+   uInverse = uMultiplier;
+   for (i = 0; i < 6; i++)
+      uInverse *= (size_t)2 - uMultiplier * uInverse;
+
+   /* the shift is more than half a word, so the xorshift is its own
+      inverse */
+   uMixed *= uInverse;
+   uMixed ^= uMixed >> uShift;
+   return uMixed * uInverse;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if no byte of uWord is 0, or 0 otherwise. */
+
+static int hasNoNul(size_t uWord)
+{
+   size_t u;
+
+   for (u = 0; u < sizeof(size_t); u++, uWord >>= 8)
+      if ((uWord & 0xffU) == 0U)
+         return 0;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that two keys built to collide under SymHash_word() whatever
+   the seed do not collide under SymHash_sip() with random seeds. The
+   keys are two words each. SymHash_word() XORs each mixed word into
+   its state before multiplying the state by an odd number, which
+   keeps the top bit of the XOR, so flipping the top bit of both
+   mixed words leaves the hash code unchanged. */
+
+static void testSeededCollisions(void)
+{
+   enum {SEED_COUNT = 4};
+
+   const size_t uTopBit = ~((size_t)-1 >> 1);
+   char acKey1[2 * sizeof(size_t) + 1];
+   char acKey2[2 * sizeof(size_t) + 1];
+   size_t auWords1[2];
+   size_t auWords2[2];
+   size_t uSeed;
+   size_t u;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing hash functions with keys built to collide.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* find a pair whose four words have no NUL bytes */
+   for (u = 1; ; u++)
+   {
+      auWords1[0] = unmixWord(u);
+      auWords1[1] = unmixWord(u * 3U);
+      auWords2[0] = unmixWord(u ^ uTopBit);
+      auWords2[1] = unmixWord((u * 3U) ^ uTopBit);
+      if (hasNoNul(auWords1[0]) && hasNoNul(auWords1[1]) &&
+          hasNoNul(auWords2[0]) && hasNoNul(auWords2[1]))
+         break;
+   }
+   memcpy(acKey1, auWords1, sizeof(auWords1));
+   memcpy(acKey2, auWords2, sizeof(auWords2));
+   acKey1[sizeof(auWords1)] = '\0';
+   acKey2[sizeof(auWords2)] = '\0';
+   ASSURE(strlen(acKey1) == sizeof(auWords1));
+   ASSURE(strcmp(acKey1, acKey2) != 0);
+
+   for (i = 0; i < SEED_COUNT; i++)
+   {
+      uSeed = i == 0 ? 0U : SymHash_makeSeed();
+      ASSURE(SymHash_word(acKey1, sizeof(auWords1), uSeed) ==
+             SymHash_word(acKey2, sizeof(auWords2), uSeed));
+      ASSURE(SymHash_sip(acKey1, sizeof(auWords1), uSeed) !=
+             SymHash_sip(acKey2, sizeof(auWords2), uSeed));
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object that uses the keyed hash function with a
+   random seed. */
+
+static void testHashOptions(void)
+{
+   enum {BINDING_COUNT = 2000};
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   struct SymTable_Options sOptions;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object with a keyed hash function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   SymTable_initOptions(&sOptions);
+   sOptions.pfHash = SymHash_sip;
+   sOptions.uHashSeed = SymHash_makeSeed();
+
+   oSymTable = SymTable_newWithOptions(&sOptions);
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue == acValue);
+   }
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acValue);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If pcKey is one of the keys testKeyLengths() uses, mark it as seen
+   in the array of flags pvExtra, which is indexed by key length. */
+
+static void markKeyLength(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   size_t uLength;
+   size_t u;
+
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   (void)pvValue;
+   uLength = strlen(pcKey);
+   for (u = 0; u < uLength; u++)
+      if (pcKey[u] != (char)('a' + u % 26))
+         return;
+   ((int*)pvExtra)[uLength] = 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test keys of every length from 0 through MAX_KEY_LENGTH-1, which
+   spans the boundary between keys a SymTable object may store inline
+   and keys it must allocate separately. */
+
+static void testKeyLengths(void)
+{
+   enum {MAX_KEY_LENGTH = 40};
+
+   SymTable_T oSymTable;
+   char aacKeys[MAX_KEY_LENGTH][MAX_KEY_LENGTH];
+   int aiSeen[MAX_KEY_LENGTH];
+   char *pcValue;
+   int i;
+   int j;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing keys of many lengths.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* key i is the first i letters of the alphabet, repeated */
+   for (i = 0; i < MAX_KEY_LENGTH; i++)
+   {
+      for (j = 0; j < i; j++)
+         aacKeys[i][j] = (char)('a' + j % 26);
+      aacKeys[i][i] = '\0';
+      aiSeen[i] = 0;
+   }
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < MAX_KEY_LENGTH; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+   }
+
+   for (i = 0; i < MAX_KEY_LENGTH; i++)
+   {
+      pcValue = (char*)SymTable_get(oSymTable, aacKeys[i]);
+      ASSURE(pcValue == aacKeys[i]);
+   }
+
+   SymTable_map(oSymTable, markKeyLength, aiSeen);
+   for (i = 0; i < MAX_KEY_LENGTH; i++)
+      ASSURE(aiSeen[i]);
+
+   for (i = 0; i < MAX_KEY_LENGTH; i += 2)
+   {
+      pcValue = (char*)SymTable_remove(oSymTable, aacKeys[i]);
+      ASSURE(pcValue == aacKeys[i]);
+   }
+   for (i = 0; i < MAX_KEY_LENGTH; i++)
+      ASSURE(SymTable_contains(oSymTable, aacKeys[i]) == (i % 2 == 1));
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increment *(int*)pvExtra if pcKey is the very string pvValue
+   points to. */
+
+static void countBorrowedKey(const char *pcKey, void *pvValue,
+                             void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   if (pcKey == (const char*)pvValue)
+      (*(int*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object that borrows its keys, and check that the
+   default is still to copy them. Each binding's value is its own key,
+   so the keys pfApply receives show which keys were borrowed. */
+
+static void testBorrowedKeys(void)
+{
+   enum {KEY_COUNT = 4};
+
+   struct SymTable_Options sOptions;
+   SymTable_T oSymTable;
+   static char *apcKeys[KEY_COUNT] =
+      {"", "Ruth", "Gehrig, Henry Louis", "Mantle, Mickey Charles"};
+   char *pcValue;
+   int iBorrowed;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing borrowed keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   SymTable_initOptions(&sOptions);
+   ASSURE(! sOptions.iBorrowKeys);
+
+   /* by default every key is copied */
+   oSymTable = SymTable_newWithOptions(&sOptions);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, apcKeys[i], apcKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   iBorrowed = 0;
+   SymTable_map(oSymTable, countBorrowedKey, &iBorrowed);
+   ASSURE(iBorrowed == 0);
+   SymTable_free(oSymTable);
+
+   /* a borrowing table keeps the callers' pointers */
+   sOptions.iBorrowKeys = 1;
+   oSymTable = SymTable_newWithOptions(&sOptions);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, apcKeys[i], apcKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = SymTable_put(oSymTable, "Ruth", NULL);
+   ASSURE(! iSuccessful);
+   iBorrowed = 0;
+   SymTable_map(oSymTable, countBorrowedKey, &iBorrowed);
+   ASSURE(iBorrowed == KEY_COUNT);
+
+   /* lookups need not use the borrowed pointers themselves */
+   pcValue = (char*)SymTable_get(oSymTable, "Gehrig, Henry Louis");
+   ASSURE(pcValue == apcKeys[2]);
+   pcValue = (char*)SymTable_remove(oSymTable, "Mantle, Mickey Charles");
+   ASSURE(pcValue == apcKeys[3]);
+   pcValue = (char*)SymTable_remove(oSymTable, "");
+   ASSURE(pcValue == apcKeys[0]);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+   ASSURE(SymTable_contains(oSymTable, "Ruth"));
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable objects of every length from 0 through MAX_LENGTH,
+   rehashing at once and incrementally, so that a table that starts
+   small and outgrows that is checked on both sides of the change. */
+
+static void testSmallTables(void)
+{
+   enum {MAX_LENGTH = 20};
+   enum {MAX_KEY_LENGTH = 32};
+
+   struct SymTable_Options sOptions;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int aiValues[MAX_LENGTH];
+   size_t uCount;
+   int iLength;
+   int iRehashStep;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing small SymTable objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (iRehashStep = 0; iRehashStep <= 1; iRehashStep++)
+   {
+      SymTable_initOptions(&sOptions);
+      sOptions.uRehashStep = (size_t)iRehashStep;
+
+      for (iLength = 0; iLength <= MAX_LENGTH; iLength++)
+      {
+         oSymTable = SymTable_newWithOptions(&sOptions);
+         ASSURE(oSymTable != NULL);
+
+         /* every binding so far must stay findable after each put */
+         for (i = 0; i < iLength; i++)
+         {
+            sprintf(acKey, "small%d", i);
+            aiValues[i] = i;
+            iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+            ASSURE(iSuccessful);
+            sprintf(acKey, "small%d", i / 2);
+            ASSURE(SymTable_get(oSymTable, acKey) ==
+                   &aiValues[i / 2]);
+         }
+         ASSURE(SymTable_getLength(oSymTable) == (size_t)iLength);
+         uCount = 0U;
+         SymTable_map(oSymTable, countBinding, &uCount);
+         ASSURE(uCount == (size_t)iLength);
+
+         /* remove the even ones, then check the odd ones */
+         for (i = 0; i < iLength; i += 2)
+         {
+            sprintf(acKey, "small%d", i);
+            ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+         }
+         for (i = 0; i < iLength; i++)
+         {
+            sprintf(acKey, "small%d", i);
+            ASSURE(SymTable_contains(oSymTable, acKey) == (i % 2 == 1));
+         }
+         ASSURE(SymTable_getLength(oSymTable) ==
+                (size_t)(iLength / 2));
+
+         SymTable_free(oSymTable);
+      }
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable objects that grow, shrink back as bindings are
+   removed, and are compacted, checking every binding after each
+   phase. Every round fills the table again, so a table that has
+   shrunk is shown to grow as before. */
+
+static void testShrink(void)
+{
+   enum {BINDING_COUNT = 3000};
+   enum {KEEP_STRIDE = 97};
+   enum {MAX_KEY_LENGTH = 32};
+
+   struct SymTable_Options sOptions;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   int iRehashStep;
+   int iRound;
+   int iKey;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing shrinking and compacting.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (iRehashStep = 0; iRehashStep <= 1; iRehashStep++)
+   {
+      SymTable_initOptions(&sOptions);
+      sOptions.uRehashStep = (size_t)iRehashStep;
+      oSymTable = SymTable_newWithOptions(&sOptions);
+      ASSURE(oSymTable != NULL);
+
+      /* compacting an empty table leaves it usable */
+      iSuccessful = SymTable_compact(oSymTable);
+      ASSURE(iSuccessful);
+
+      for (iRound = 0; iRound < 3; iRound++)
+      {
+         for (i = 0; i < BINDING_COUNT; i++)
+         {
+            sprintf(acKey, "shrink%d", i);
+            aiValues[i] = i;
+            iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+            ASSURE(iSuccessful);
+         }
+
+         /* remove all but every KEEP_STRIDE'th binding, newest
+            first in odd rounds */
+         for (i = 0; i < BINDING_COUNT; i++)
+         {
+            iKey = iRound % 2 == 1 ? BINDING_COUNT - 1 - i : i;
+            if (iKey % KEEP_STRIDE == 0)
+               continue;
+            sprintf(acKey, "shrink%d", iKey);
+            ASSURE(SymTable_remove(oSymTable, acKey) ==
+                   &aiValues[iKey]);
+         }
+         for (i = 0; i < BINDING_COUNT; i++)
+         {
+            sprintf(acKey, "shrink%d", i);
+            ASSURE(SymTable_get(oSymTable, acKey) ==
+                   (i % KEEP_STRIDE == 0 ? &aiValues[i] : NULL));
+         }
+
+         iSuccessful = SymTable_compact(oSymTable);
+         ASSURE(iSuccessful);
+         ASSURE(SymTable_getLength(oSymTable) ==
+                (BINDING_COUNT + KEEP_STRIDE - 1) / KEEP_STRIDE);
+         for (i = 0; i < BINDING_COUNT; i += KEEP_STRIDE)
+         {
+            sprintf(acKey, "shrink%d", i);
+            ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+         }
+         ASSURE(SymTable_getLength(oSymTable) == 0);
+      }
+
+      /* an emptied table is compacted back to its smallest */
+      iSuccessful = SymTable_compact(oSymTable);
+      ASSURE(iSuccessful);
+      iSuccessful = SymTable_put(oSymTable, "shrink", &aiValues[0]);
+      ASSURE(iSuccessful);
+      ASSURE(SymTable_get(oSymTable, "shrink") == &aiValues[0]);
+
+      SymTable_free(oSymTable);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that the shape *psStats reports is consistent with a table of
+   uLength bindings. */
+
+static void checkStatsShape(const struct SymTable_Stats *psStats,
+                            size_t uLength)
+{
+   size_t uChains;
+   size_t uCounted;
+   size_t u;
+
+   assert(psStats != NULL);
+
+   uChains = 0U;
+   uCounted = 0U;
+   for (u = 0; u < (size_t)SYMTABLE_STATS_HISTOGRAM_SIZE; u++)
+   {
+      uChains += psStats->auChainLengths[u];
+      uCounted += u * psStats->auChainLengths[u];
+   }
+   ASSURE(psStats->uChainCount > 0U);
+   ASSURE(uChains == psStats->uChainCount);
+   ASSURE(uCounted <= uLength);
+   ASSURE(psStats->uMaxChainLength <= uLength);
+   if (uLength == 0U)
+   {
+      ASSURE(psStats->uMaxChainLength == 0U);
+      ASSURE(psStats->dAverageChainLength == 0.0);
+      ASSURE(psStats->auChainLengths[0] == psStats->uChainCount);
+   }
+   else
+   {
+      ASSURE(psStats->uMaxChainLength > 0U);
+      ASSURE(psStats->dAverageChainLength >= 1.0);
+      ASSURE(psStats->dAverageChainLength <=
+             (double)psStats->uMaxChainLength);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_getStats() function. Its counters are checked
+   only if SYMTABLE_STATS is defined, as the implementation must then
+   have been compiled with it too, and must read 0 otherwise. */
+
+static void testStats(void)
+{
+   enum {BINDING_COUNT = 1000};
+   enum {MISS_COUNT = 300};
+   enum {MAX_KEY_LENGTH = 32};
+
+   SymTable_T oSymTable;
+   struct SymTable_Stats sBefore;
+   struct SymTable_Stats sAfter;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_getStats().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_getStats(oSymTable, &sBefore);
+   checkStatsShape(&sBefore, 0U);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "stats%d", i);
+      aiValues[i] = i;
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   SymTable_getStats(oSymTable, &sBefore);
+   checkStatsShape(&sBefore, BINDING_COUNT);
+
+   /* every get is one lookup, a hit exactly if the key is present */
+   for (i = 0; i < BINDING_COUNT + MISS_COUNT; i++)
+   {
+      sprintf(acKey, "stats%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) ==
+             (i < BINDING_COUNT ? &aiValues[i] : NULL));
+   }
+   SymTable_getStats(oSymTable, &sAfter);
+   checkStatsShape(&sAfter, BINDING_COUNT);
+
+#ifdef SYMTABLE_STATS
+   ASSURE(sAfter.uLookups - sBefore.uLookups ==
+          BINDING_COUNT + MISS_COUNT);
+   ASSURE(sAfter.uHits - sBefore.uHits == BINDING_COUNT);
+   ASSURE(sAfter.uProbes - sBefore.uProbes >= BINDING_COUNT);
+   ASSURE(sAfter.uKeyCompares - sBefore.uKeyCompares >= BINDING_COUNT);
+   ASSURE(sAfter.uProbes >= sAfter.uKeyCompares);
+   ASSURE(sAfter.uResizes == sBefore.uResizes);
+   ASSURE(sAfter.dResizeSeconds >= 0.0);
+#else
+   ASSURE(sAfter.uLookups == 0U);
+   ASSURE(sAfter.uHits == 0U);
+   ASSURE(sAfter.uProbes == 0U);
+   ASSURE(sAfter.uKeyCompares == 0U);
+   ASSURE(sAfter.uResizes == 0U);
+   ASSURE(sAfter.dResizeSeconds == 0.0);
+#endif
+
+   /* removing every binding empties every chain */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "stats%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+   }
+   SymTable_getStats(oSymTable, &sAfter);
+   checkStatsShape(&sAfter, 0U);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A TraceLog counts the events reported to recordTrace(). */
+
+struct TraceLog
+{
+   /* the table the events must come from */
+   SymTable_T oSymTable;
+
+   /* the lookups reported, and how many of them found their key */
+   size_t uLookups;
+   size_t uFound;
+
+   /* the resizes begun and ended */
+   size_t uBegins;
+   size_t uEnds;
+
+   /* nonzero if an event was inconsistent */
+   int iBad;
+};
+
+/* Count *psEvent in the TraceLog pvExtra. */
+
+static void recordTrace(const struct SymTable_TraceEvent *psEvent,
+                        void *pvExtra)
+{
+   struct TraceLog *psLog = (struct TraceLog*)pvExtra;
+
+   assert(psEvent != NULL);
+   assert(psLog != NULL);
+
+   if (psEvent->oSymTable != psLog->oSymTable)
+      psLog->iBad = 1;
+
+   switch (psEvent->eKind)
+   {
+      case SYMTABLE_TRACE_LOOKUP:
+         psLog->uLookups++;
+         if (psEvent->iFound)
+            psLog->uFound++;
+         if (psEvent->pcKey == NULL || psEvent->uKeyLength == 0U ||
+             psEvent->dSeconds < 0.0 ||
+             (psEvent->iFound && psEvent->uProbes == 0U))
+            psLog->iBad = 1;
+         break;
+
+      case SYMTABLE_TRACE_RESIZE_BEGIN:
+         /* resizes do not overlap */
+         if (psLog->uBegins != psLog->uEnds ||
+             psEvent->uOldSize == psEvent->uNewSize)
+            psLog->iBad = 1;
+         psLog->uBegins++;
+         break;
+
+      case SYMTABLE_TRACE_RESIZE_END:
+         if (psLog->uBegins != psLog->uEnds + 1U ||
+             psEvent->dSeconds < 0.0 ||
+             psEvent->uNewSize == 0U)
+            psLog->iBad = 1;
+         psLog->uEnds++;
+         break;
+
+      default:
+         psLog->iBad = 1;
+         break;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the pfTrace option: which lookups it is told of, as set by
+   the sampling interval and the thresholds, and that the resizes it
+   is told of begin and end in pairs. */
+
+static void testTrace(void)
+{
+   enum {BINDING_COUNT = 1000};
+   enum {MISS_COUNT = 200};
+   enum {SAMPLE_INTERVAL = 4};
+   enum {MAX_KEY_LENGTH = 32};
+
+   struct SymTable_Options sOptions;
+   struct TraceLog sLog;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   int iPass;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the pfTrace option.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   SymTable_initOptions(&sOptions);
+   ASSURE(sOptions.pfTrace == NULL);
+   ASSURE(sOptions.uTraceSampleInterval > 0U);
+
+   /* pass 0 reports every lookup, pass 1 one in SAMPLE_INTERVAL,
+      and pass 2, whose thresholds no lookup reaches, none */
+   for (iPass = 0; iPass < 3; iPass++)
+   {
+      SymTable_initOptions(&sOptions);
+      sOptions.pfTrace = recordTrace;
+      sOptions.pvTraceExtra = &sLog;
+      sOptions.uTraceSampleInterval =
+         iPass == 1 ? (size_t)SAMPLE_INTERVAL : 1U;
+      if (iPass == 2)
+      {
+         sOptions.dTraceMinSeconds = 1e6;
+         sOptions.uTraceMinProbes = BINDING_COUNT + MISS_COUNT;
+      }
+
+      sLog.uLookups = sLog.uFound = sLog.uBegins = sLog.uEnds = 0U;
+      sLog.iBad = 0;
+      oSymTable = SymTable_newWithOptions(&sOptions);
+      ASSURE(oSymTable != NULL);
+      sLog.oSymTable = oSymTable;
+
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "trace%d", i);
+         aiValues[i] = i;
+         iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+         ASSURE(iSuccessful);
+      }
+      ASSURE(sLog.uBegins == sLog.uEnds);
+
+      sLog.uLookups = sLog.uFound = 0U;
+      for (i = 0; i < BINDING_COUNT + MISS_COUNT; i++)
+      {
+         sprintf(acKey, "trace%d", i);
+         ASSURE(SymTable_get(oSymTable, acKey) ==
+                (i < BINDING_COUNT ? &aiValues[i] : NULL));
+      }
+      if (iPass == 0)
+      {
+         ASSURE(sLog.uLookups == BINDING_COUNT + MISS_COUNT);
+         ASSURE(sLog.uFound == BINDING_COUNT);
+      }
+      else if (iPass == 1)
+         ASSURE(sLog.uLookups ==
+                (BINDING_COUNT + MISS_COUNT) / SAMPLE_INTERVAL);
+      else
+         ASSURE(sLog.uLookups == 0U);
+
+      /* removing every binding may shrink the table */
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "trace%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+      }
+      ASSURE(sLog.uBegins == sLog.uEnds);
+      ASSURE(!sLog.iBad);
+
+      SymTable_free(oSymTable);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if the fields of *psMemory sum to uTotal, or 0
+   otherwise. */
+
+static int sumsTo(const struct SymTable_Memory *psMemory, size_t uTotal)
+{
+   assert(psMemory != NULL);
+
+   return psMemory->uTableBytes + psMemory->uIndexBytes +
+          psMemory->uBindingBytes + psMemory->uKeyBytes +
+          psMemory->uSlackBytes == uTotal;
+}
+
+/* Test the SymTable_memoryUsage() function: its parts add up, and
+   the bindings and keys it reports grow with the table. */
+
+static void testMemoryUsage(void)
+{
+   enum {BINDING_COUNT = 1000};
+   enum {MAX_KEY_LENGTH = 64};
+
+   struct SymTable_Options sOptions;
+   struct SymTable_Memory sMemory;
+   SymTable_T oSymTable;
+   static char aacKeys[2 * BINDING_COUNT][MAX_KEY_LENGTH];
+   size_t uTotal;
+   size_t uBindingBytes;
+   size_t uKeyBytes;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_memoryUsage() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* keys too long for any table to keep inside a binding */
+   for (i = 0; i < 2 * BINDING_COUNT; i++)
+      sprintf(aacKeys[i], "a-key-too-long-to-inline-%d", i);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   uTotal = SymTable_memoryUsage(oSymTable, &sMemory);
+   ASSURE(sumsTo(&sMemory, uTotal));
+   ASSURE(sMemory.uTableBytes > 0);
+   ASSURE(sMemory.uBindingBytes == 0);
+   ASSURE(sMemory.uKeyBytes == 0);
+   ASSURE(SymTable_memoryUsage(oSymTable, NULL) == uTotal);
+
+   /* a binding costs the same however many there are, and each key
+      its own length and NUL */
+   uKeyBytes = 0;
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+      uKeyBytes += strlen(aacKeys[i]) + 1U;
+   }
+   uTotal = SymTable_memoryUsage(oSymTable, &sMemory);
+   ASSURE(sumsTo(&sMemory, uTotal));
+   ASSURE(sMemory.uBindingBytes > 0);
+   ASSURE(sMemory.uKeyBytes == uKeyBytes);
+   uBindingBytes = sMemory.uBindingBytes;
+
+   for (i = BINDING_COUNT; i < 2 * BINDING_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+      uKeyBytes += strlen(aacKeys[i]) + 1U;
+   }
+   uTotal = SymTable_memoryUsage(oSymTable, &sMemory);
+   ASSURE(sumsTo(&sMemory, uTotal));
+   ASSURE(sMemory.uBindingBytes == 2 * uBindingBytes);
+   ASSURE(sMemory.uKeyBytes == uKeyBytes);
+
+   /* what removals free is slack until it is reused */
+   for (i = 0; i < 2 * BINDING_COUNT; i++)
+      ASSURE(SymTable_remove(oSymTable, aacKeys[i]) == aacKeys[i]);
+   uTotal = SymTable_memoryUsage(oSymTable, &sMemory);
+   ASSURE(sumsTo(&sMemory, uTotal));
+   ASSURE(sMemory.uBindingBytes == 0);
+   ASSURE(sMemory.uKeyBytes == 0);
+   iSuccessful = SymTable_compact(oSymTable);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_memoryUsage(oSymTable, &sMemory) <= uTotal);
+   SymTable_free(oSymTable);
+
+   /* a table that borrows its keys stores none */
+   SymTable_initOptions(&sOptions);
+   sOptions.iBorrowKeys = 1;
+   oSymTable = SymTable_newWithOptions(&sOptions);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   uTotal = SymTable_memoryUsage(oSymTable, &sMemory);
+   ASSURE(sumsTo(&sMemory, uTotal));
+   ASSURE(sMemory.uBindingBytes == uBindingBytes);
+   ASSURE(sMemory.uKeyBytes == 0);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_reserve() and SymTable_newWithCapacity()
+   functions: a table given room for its bindings up front is never
+   resized while they are put, as its trace function shows. */
+
+static void testReserve(void)
+{
+   enum {BINDING_COUNT = 5000};
+   enum {MAX_KEY_LENGTH = 32};
+
+   struct SymTable_Options sOptions;
+   struct TraceLog sLog;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_reserve() and "
+          "SymTable_newWithCapacity().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   SymTable_initOptions(&sOptions);
+   sOptions.pfTrace = recordTrace;
+   sOptions.pvTraceExtra = &sLog;
+   sOptions.dTraceMinSeconds = 1e6;
+   sOptions.uTraceMinProbes = (size_t)-1;
+   sLog.uLookups = sLog.uFound = sLog.uBegins = sLog.uEnds = 0U;
+   sLog.iBad = 0;
+   oSymTable = SymTable_newWithOptions(&sOptions);
+   ASSURE(oSymTable != NULL);
+   sLog.oSymTable = oSymTable;
+
+   iSuccessful = SymTable_reserve(oSymTable, BINDING_COUNT);
+   ASSURE(iSuccessful);
+   ASSURE(sLog.uBegins == sLog.uEnds);
+   sLog.uBegins = sLog.uEnds = 0U;
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "reserve%d", i);
+      aiValues[i] = i;
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(sLog.uBegins == 0U);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+
+   /* room for fewer bindings than the table holds is already made */
+   iSuccessful = SymTable_reserve(oSymTable, 0U);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_reserve(oSymTable, BINDING_COUNT / 2);
+   ASSURE(iSuccessful);
+   ASSURE(sLog.uBegins == 0U);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "reserve%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &aiValues[i]);
+   }
+   ASSURE(!sLog.iBad);
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTable_newWithCapacity(BINDING_COUNT);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "reserve%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "reserve%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &aiValues[i]);
+   }
+   SymTable_free(oSymTable);
+
+   /* a table with room for nothing is an ordinary empty one */
+   oSymTable = SymTable_newWithCapacity(0U);
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "reserve", &aiValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "reserve") == &aiValues[0]);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_iterBegin() and SymTable_iterNext() functions:
+   each binding is given once, an iteration may stop and resume with
+   lookups and replacements in between, and an incremental rehash in
+   progress does not disturb it. */
+
+static void testIter(void)
+{
+   enum {BINDING_COUNT = 3000};
+   enum {CHUNK_SIZE = 7};
+   enum {MAX_KEY_LENGTH = 32};
+
+   struct SymTable_Options sOptions;
+   struct SymTable_Iter sIter;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   static int aiSeen[BINDING_COUNT];
+   const char *pcKey;
+   void *pvValue;
+   int iPass;
+   int iSeenCount;
+   int iChunk;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_iterBegin() and SymTable_iterNext().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* an empty table has nothing to give, however often asked */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_iterBegin(oSymTable, &sIter);
+   ASSURE(!SymTable_iterNext(&sIter, &pcKey, &pvValue));
+   ASSURE(!SymTable_iterNext(&sIter, &pcKey, &pvValue));
+   SymTable_free(oSymTable);
+
+   /* pass 0 uses the default options, and pass 1 leaves an
+      incremental rehash unfinished when the iteration begins */
+   for (iPass = 0; iPass < 2; iPass++)
+   {
+      SymTable_initOptions(&sOptions);
+      if (iPass == 1)
+         sOptions.uRehashStep = 1U;
+      oSymTable = SymTable_newWithOptions(&sOptions);
+      ASSURE(oSymTable != NULL);
+
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "iter%d", i);
+         aiValues[i] = i;
+         aiSeen[i] = 0;
+         iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+         ASSURE(iSuccessful);
+      }
+
+      /* take the bindings a chunk at a time, looking keys up and
+         replacing values between chunks */
+      iSeenCount = 0;
+      SymTable_iterBegin(oSymTable, &sIter);
+      for (;;)
+      {
+         for (iChunk = 0; iChunk < CHUNK_SIZE; iChunk++)
+         {
+            if (!SymTable_iterNext(&sIter, &pcKey, &pvValue))
+               break;
+            ASSURE(pvValue != NULL);
+            i = *(int*)pvValue;
+            ASSURE(i >= 0 && i < BINDING_COUNT);
+            sprintf(acKey, "iter%d", i);
+            ASSURE(strcmp(pcKey, acKey) == 0);
+            ASSURE(aiSeen[i] == 0);
+            aiSeen[i] = 1;
+            iSeenCount++;
+            ASSURE(SymTable_replace(oSymTable, pcKey, &aiValues[i]) ==
+                   &aiValues[i]);
+         }
+         if (iChunk < CHUNK_SIZE)
+            break;
+
+         sprintf(acKey, "iter%d", iSeenCount % BINDING_COUNT);
+         ASSURE(SymTable_get(oSymTable, acKey) ==
+                &aiValues[iSeenCount % BINDING_COUNT]);
+         ASSURE(SymTable_get(oSymTable, "iter-absent") == NULL);
+      }
+      ASSURE(iSeenCount == BINDING_COUNT);
+      ASSURE(!SymTable_iterNext(&sIter, &pcKey, &pvValue));
+
+      /* an iteration may simply be abandoned */
+      SymTable_iterBegin(oSymTable, &sIter);
+      iSuccessful = SymTable_iterNext(&sIter, &pcKey, &pvValue);
+      ASSURE(iSuccessful);
+      ASSURE(SymTable_remove(oSymTable, pcKey) == pvValue);
+      ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT - 1);
+
+      SymTable_free(oSymTable);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A Sweep says which bindings removeIfChosen() chooses, and counts
+   the calls of it and of releaseChosen(). */
+
+struct Sweep
+{
+   /* bindings whose int values are multiples of iKeepStride stay */
+   int iKeepStride;
+
+   size_t uTested;
+   size_t uReleased;
+};
+
+/* Return 1 if the binding of pcKey to the int at pvValue is to be
+   removed by the Sweep pvExtra, or 0 otherwise. */
+
+static int removeIfChosen(const char *pcKey, void *pvValue,
+                          void *pvExtra)
+{
+   struct Sweep *psSweep = (struct Sweep*)pvExtra;
+
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(psSweep != NULL);
+
+   psSweep->uTested++;
+   return *(int*)pvValue % psSweep->iKeepStride != 0;
+}
+
+/* Count the release of the binding of pcKey to pvValue in the Sweep
+   pvExtra, and mark the value released by negating it. */
+
+static void releaseChosen(const char *pcKey, void *pvValue,
+                          void *pvExtra)
+{
+   struct Sweep *psSweep = (struct Sweep*)pvExtra;
+
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(psSweep != NULL);
+
+   psSweep->uReleased++;
+   *(int*)pvValue = -*(int*)pvValue - 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_removeIf() function, with short and long keys,
+   with and without an incremental rehash in progress. */
+
+static void testRemoveIf(void)
+{
+   enum {BINDING_COUNT = 3000};
+   enum {KEEP_STRIDE = 3};
+   enum {MAX_KEY_LENGTH = 48};
+
+   struct SymTable_Options sOptions;
+   struct Sweep sSweep;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   size_t uKept;
+   size_t uRemoved;
+   int iPass;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_removeIf().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   uKept = (BINDING_COUNT + KEEP_STRIDE - 1) / KEEP_STRIDE;
+   for (iPass = 0; iPass < 2; iPass++)
+   {
+      SymTable_initOptions(&sOptions);
+      if (iPass == 1)
+         sOptions.uRehashStep = 1U;
+      oSymTable = SymTable_newWithOptions(&sOptions);
+      ASSURE(oSymTable != NULL);
+
+      /* nothing to remove from an empty table */
+      sSweep.iKeepStride = KEEP_STRIDE;
+      sSweep.uTested = sSweep.uReleased = 0U;
+      uRemoved = SymTable_removeIf(oSymTable, removeIfChosen,
+                                   releaseChosen, &sSweep);
+      ASSURE(uRemoved == 0U);
+      ASSURE(sSweep.uTested == 0U);
+
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, i % 2 == 0 ? "removeif%d"
+                 : "removeif-with-a-much-longer-key-%d", i);
+         aiValues[i] = i;
+         iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+         ASSURE(iSuccessful);
+      }
+
+      uRemoved = SymTable_removeIf(oSymTable, removeIfChosen,
+                                   releaseChosen, &sSweep);
+      ASSURE(uRemoved == BINDING_COUNT - uKept);
+      ASSURE(sSweep.uTested == BINDING_COUNT);
+      ASSURE(sSweep.uReleased == uRemoved);
+      ASSURE(SymTable_getLength(oSymTable) == uKept);
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, i % 2 == 0 ? "removeif%d"
+                 : "removeif-with-a-much-longer-key-%d", i);
+         if (i % KEEP_STRIDE == 0)
+         {
+            ASSURE(aiValues[i] == i);
+            ASSURE(SymTable_get(oSymTable, acKey) == &aiValues[i]);
+         }
+         else
+         {
+            ASSURE(aiValues[i] == -i - 1);
+            ASSURE(SymTable_get(oSymTable, acKey) == NULL);
+         }
+      }
+
+      /* remove the rest, without releasing them */
+      sSweep.iKeepStride = BINDING_COUNT + 1;
+      sSweep.uTested = sSweep.uReleased = 0U;
+      for (i = 0; i < BINDING_COUNT; i += KEEP_STRIDE)
+         aiValues[i] = i + 1;
+      uRemoved = SymTable_removeIf(oSymTable, removeIfChosen, NULL,
+                                   &sSweep);
+      ASSURE(uRemoved == uKept);
+      ASSURE(sSweep.uTested == uKept);
+      ASSURE(sSweep.uReleased == 0U);
+      ASSURE(SymTable_getLength(oSymTable) == 0);
+
+      /* the emptied table is still usable */
+      iSuccessful = SymTable_put(oSymTable, "removeif", &aiValues[0]);
+      ASSURE(iSuccessful);
+      ASSURE(SymTable_get(oSymTable, "removeif") == &aiValues[0]);
+      ASSURE(SymTable_getLength(oSymTable) == 1);
+
+      SymTable_free(oSymTable);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymScope object: bindings shadow those of outer scopes, and
+   popping a scope uncovers them again. */
+
+static void testScope(void)
+{
+   enum {DEPTH = 20};
+   enum {BINDING_COUNT = 1000};
+   enum {MAX_KEY_LENGTH = 32};
+
+   SymScope_T oSymScope;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   int iGlobal = 0;
+   int iLocal = 1;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymScope object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymScope = SymScope_new();
+   ASSURE(oSymScope != NULL);
+   ASSURE(SymScope_getDepth(oSymScope) == 0);
+
+   iSuccessful = SymScope_put(oSymScope, "x", &iGlobal);
+   ASSURE(iSuccessful);
+   iSuccessful = SymScope_put(oSymScope, "y", &iGlobal);
+   ASSURE(iSuccessful);
+   iSuccessful = SymScope_put(oSymScope, "x", &iLocal);
+   ASSURE(!iSuccessful);
+   ASSURE(SymScope_get(oSymScope, "x") == &iGlobal);
+   ASSURE(SymScope_getScope(oSymScope, "x") == 0);
+   ASSURE(SymScope_getScope(oSymScope, "z") == 1);
+
+   /* an inner binding shadows the outer one until its scope ends */
+   iSuccessful = SymScope_push(oSymScope);
+   ASSURE(iSuccessful);
+   ASSURE(SymScope_getDepth(oSymScope) == 1);
+   iSuccessful = SymScope_put(oSymScope, "x", &iLocal);
+   ASSURE(iSuccessful);
+   iSuccessful = SymScope_put(oSymScope, "z", &iLocal);
+   ASSURE(iSuccessful);
+   ASSURE(SymScope_get(oSymScope, "x") == &iLocal);
+   ASSURE(SymScope_get(oSymScope, "y") == &iGlobal);
+   ASSURE(SymScope_getScope(oSymScope, "x") == 1);
+   ASSURE(SymScope_getScope(oSymScope, "y") == 0);
+   ASSURE(SymScope_replace(oSymScope, "y", &iLocal) == &iGlobal);
+   ASSURE(SymScope_replace(oSymScope, "w", &iLocal) == NULL);
+   ASSURE(!SymScope_contains(oSymScope, "w"));
+   SymScope_pop(oSymScope);
+   ASSURE(SymScope_getDepth(oSymScope) == 0);
+   ASSURE(SymScope_get(oSymScope, "x") == &iGlobal);
+   ASSURE(SymScope_get(oSymScope, "y") == &iLocal);
+   ASSURE(!SymScope_contains(oSymScope, "z"));
+
+   /* deep nesting, each level shadowing the one outside it */
+   for (i = 0; i < DEPTH; i++)
+   {
+      iSuccessful = SymScope_push(oSymScope);
+      ASSURE(iSuccessful);
+      aiValues[i] = i;
+      iSuccessful = SymScope_put(oSymScope, "x", &aiValues[i]);
+      ASSURE(iSuccessful);
+      sprintf(acKey, "level%d", i);
+      iSuccessful = SymScope_put(oSymScope, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymScope_getDepth(oSymScope) == DEPTH);
+   for (i = DEPTH - 1; i >= 0; i--)
+   {
+      ASSURE(SymScope_get(oSymScope, "x") == &aiValues[i]);
+      ASSURE(SymScope_getScope(oSymScope, "x") == (size_t)i + 1U);
+      sprintf(acKey, "level%d", i);
+      ASSURE(SymScope_get(oSymScope, acKey) == &aiValues[i]);
+      SymScope_pop(oSymScope);
+      ASSURE(!SymScope_contains(oSymScope, acKey));
+   }
+   ASSURE(SymScope_get(oSymScope, "x") == &iGlobal);
+
+   /* a large scope goes away in one pop */
+   iSuccessful = SymScope_push(oSymScope);
+   ASSURE(iSuccessful);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "scope%d", i);
+      iSuccessful = SymScope_put(oSymScope, acKey, &aiValues[0]);
+      ASSURE(iSuccessful);
+   }
+   SymScope_pop(oSymScope);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "scope%d", i);
+      ASSURE(!SymScope_contains(oSymScope, acKey));
+   }
+   ASSURE(SymScope_get(oSymScope, "x") == &iGlobal);
+
+   /* a SymScope may be freed with scopes still open */
+   iSuccessful = SymScope_push(oSymScope);
+   ASSURE(iSuccessful);
+   iSuccessful = SymScope_put(oSymScope, "x", &iLocal);
+   ASSURE(iSuccessful);
+   SymScope_free(oSymScope);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymIntern object: each distinct string gets one dense ID and
+   one canonical copy. */
+
+static void testIntern(void)
+{
+   enum {STRING_COUNT = 5000};
+   enum {MAX_KEY_LENGTH = 32};
+
+   SymIntern_T oSymIntern;
+   char acKey[MAX_KEY_LENGTH];
+   const char *pcFirst;
+   size_t uId;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymIntern object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymIntern = SymIntern_new();
+   ASSURE(oSymIntern != NULL);
+   ASSURE(SymIntern_getCount(oSymIntern) == 0);
+   ASSURE(SymIntern_lookup(oSymIntern, "x") == 0);
+
+   /* the same string, from any buffer, gets the same ID */
+   strcpy(acKey, "x");
+   ASSURE(SymIntern_intern(oSymIntern, acKey) == 1);
+   ASSURE(SymIntern_intern(oSymIntern, "y") == 2);
+   ASSURE(SymIntern_intern(oSymIntern, "x") == 1);
+   ASSURE(SymIntern_intern(oSymIntern, "") == 3);
+   ASSURE(SymIntern_getCount(oSymIntern) == 3);
+   ASSURE(SymIntern_lookup(oSymIntern, "y") == 2);
+   ASSURE(SymIntern_lookup(oSymIntern, "z") == 0);
+   ASSURE(SymIntern_getCount(oSymIntern) == 3);
+
+   /* the canonical copy is the interned string's own */
+   pcFirst = SymIntern_getString(oSymIntern, 1);
+   ASSURE(pcFirst != acKey);
+   ASSURE(strcmp(pcFirst, "x") == 0);
+   ASSURE(strcmp(SymIntern_getString(oSymIntern, 3), "") == 0);
+   strcpy(acKey, "changed");
+   ASSURE(strcmp(pcFirst, "x") == 0);
+
+   /* IDs stay dense, and copies stay put, as the SymIntern grows */
+   for (i = 0; i < STRING_COUNT; i++)
+   {
+      sprintf(acKey, "intern%d", i);
+      uId = SymIntern_intern(oSymIntern, acKey);
+      ASSURE(uId == (size_t)i + 4U);
+   }
+   ASSURE(SymIntern_getCount(oSymIntern) == (size_t)STRING_COUNT + 3U);
+   ASSURE(SymIntern_getString(oSymIntern, 1) == pcFirst);
+   for (i = 0; i < STRING_COUNT; i++)
+   {
+      sprintf(acKey, "intern%d", i);
+      uId = SymIntern_lookup(oSymIntern, acKey);
+      ASSURE(uId == (size_t)i + 4U);
+      ASSURE(strcmp(SymIntern_getString(oSymIntern, uId), acKey) == 0);
+      ASSURE(SymIntern_intern(oSymIntern, acKey) == uId);
+   }
+   ASSURE(SymIntern_getCount(oSymIntern) == (size_t)STRING_COUNT + 3U);
+
+   SymIntern_free(oSymIntern);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymIdMap object, binding the IDs a SymIntern gives. */
+
+static void testIdMap(void)
+{
+   enum {ID_COUNT = 5000};
+
+   SymIdMap_T oSymIdMap;
+   static int aiValues[ID_COUNT];
+   int iSuccessful;
+   size_t u;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymIdMap object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymIdMap = SymIdMap_new();
+   ASSURE(oSymIdMap != NULL);
+   ASSURE(SymIdMap_getLength(oSymIdMap) == 0);
+   ASSURE(!SymIdMap_contains(oSymIdMap, 1));
+   ASSURE(SymIdMap_get(oSymIdMap, 1) == NULL);
+   ASSURE(SymIdMap_remove(oSymIdMap, 1) == NULL);
+
+   /* a NULL value is bound like any other */
+   iSuccessful = SymIdMap_put(oSymIdMap, 1, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymIdMap_contains(oSymIdMap, 1));
+   ASSURE(SymIdMap_get(oSymIdMap, 1) == NULL);
+   iSuccessful = SymIdMap_put(oSymIdMap, 1, &aiValues[0]);
+   ASSURE(!iSuccessful);
+   ASSURE(SymIdMap_replace(oSymIdMap, 1, &aiValues[1]) == NULL);
+   ASSURE(SymIdMap_get(oSymIdMap, 1) == &aiValues[1]);
+   ASSURE(SymIdMap_replace(oSymIdMap, 2, &aiValues[1]) == NULL);
+   ASSURE(!SymIdMap_contains(oSymIdMap, 2));
+   ASSURE(SymIdMap_getLength(oSymIdMap) == 1);
+
+   /* IDs need not be bound in order */
+   for (u = ID_COUNT - 1U; u >= 2U; u--)
+   {
+      iSuccessful = SymIdMap_put(oSymIdMap, u, &aiValues[u]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymIdMap_getLength(oSymIdMap) == ID_COUNT - 1U);
+   ASSURE(!SymIdMap_contains(oSymIdMap, 0));
+   ASSURE(!SymIdMap_contains(oSymIdMap, ID_COUNT));
+   for (u = 2U; u < ID_COUNT; u++)
+      ASSURE(SymIdMap_get(oSymIdMap, u) == &aiValues[u]);
+
+   /* removing an ID unbinds only it */
+   for (u = 2U; u < ID_COUNT; u += 2U)
+      ASSURE(SymIdMap_remove(oSymIdMap, u) == &aiValues[u]);
+   ASSURE(SymIdMap_getLength(oSymIdMap) == ID_COUNT / 2U);
+   for (u = 2U; u < ID_COUNT; u++)
+   {
+      ASSURE(SymIdMap_contains(oSymIdMap, u) == (int)(u % 2U));
+      if (u % 2U == 0U)
+      {
+         iSuccessful = SymIdMap_put(oSymIdMap, u, &aiValues[0]);
+         ASSURE(iSuccessful);
+      }
+   }
+   ASSURE(SymIdMap_getLength(oSymIdMap) == ID_COUNT - 1U);
+   ASSURE(SymIdMap_get(oSymIdMap, 2) == &aiValues[0]);
+
+   SymIdMap_free(oSymIdMap);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A table of int keys and long values, with hashing and equality
+   inlined. */
+
+#define INT_HASH(i) ((size_t)(i))
+#define INT_EQUAL(i1, i2) ((i1) == (i2))
+
+SYMTABLE_DECLARE(IntTable, int, long);
+SYMTABLE_DEFINE(IntTable, int, long, INT_HASH, INT_EQUAL);
+
+/* Test a table made by SYMTABLE_DEFINE. */
+
+static void testTyped(void)
+{
+   enum {BINDING_COUNT = 10000};
+
+   IntTable_T oIntTable;
+   struct IntTable_Iter sIter;
+   long *plValue;
+   long lValue;
+   long lSum;
+   int iKey;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a table made by SYMTABLE_DEFINE.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oIntTable = IntTable_new();
+   ASSURE(oIntTable != NULL);
+   ASSURE(IntTable_getLength(oIntTable) == 0);
+   ASSURE(IntTable_find(oIntTable, 0) == NULL);
+   ASSURE(!IntTable_remove(oIntTable, 0, NULL));
+
+   /* keys that share their low bits must not all collide */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      iSuccessful = IntTable_put(oIntTable, i * 1024, (long)i);
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = IntTable_put(oIntTable, 0, -1L);
+   ASSURE(!iSuccessful);
+   ASSURE(IntTable_getLength(oIntTable) == BINDING_COUNT);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      plValue = IntTable_find(oIntTable, i * 1024);
+      ASSURE(plValue != NULL && *plValue == (long)i);
+   }
+   ASSURE(!IntTable_contains(oIntTable, 1));
+
+   /* a value may be replaced through the address find returns */
+   plValue = IntTable_find(oIntTable, 1024);
+   ASSURE(plValue != NULL);
+   *plValue = 100L;
+   ASSURE(*IntTable_find(oIntTable, 1024) == 100L);
+   *plValue = 1L;
+
+   /* removing every other key leaves the rest reachable */
+   for (i = 0; i < BINDING_COUNT; i += 2)
+   {
+      lValue = -1L;
+      ASSURE(IntTable_remove(oIntTable, i * 1024, &lValue));
+      ASSURE(lValue == (long)i);
+   }
+   ASSURE(IntTable_getLength(oIntTable) == BINDING_COUNT / 2);
+   for (i = 0; i < BINDING_COUNT; i++)
+      ASSURE(IntTable_contains(oIntTable, i * 1024) == i % 2);
+
+   /* a visit sees each binding once */
+   lSum = 0L;
+   IntTable_iterBegin(oIntTable, &sIter);
+   while (IntTable_iterNext(&sIter, &iKey, &plValue))
+   {
+      ASSURE(iKey == (int)*plValue * 1024);
+      lSum += *plValue;
+   }
+   /* the odd values below BINDING_COUNT sum to its half squared */
+   ASSURE(lSum == (long)(BINDING_COUNT / 2) * (BINDING_COUNT / 2));
+
+   for (i = 0; i < BINDING_COUNT; i += 2)
+   {
+      iSuccessful = IntTable_put(oIntTable, i * 1024, (long)i);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(IntTable_getLength(oIntTable) == BINDING_COUNT);
+   for (i = 0; i < BINDING_COUNT; i++)
+      ASSURE(IntTable_remove(oIntTable, i * 1024, NULL));
+   ASSURE(IntTable_getLength(oIntTable) == 0);
+
+   IntTable_free(oIntTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a hash code of the uLength bytes at pvKey that depends only
+   on the first of them, so that keys with the same first byte
+   collide. uSeed is unused. */
+
+static size_t hashFirstByte(const void *pvKey, size_t uLength,
+                            size_t uSeed)
+{
+   assert(pvKey != NULL);
+
+   (void)uSeed;
+   if (uLength == 0U)
+      return 0U;
+   return (size_t)*(const unsigned char*)pvKey;
+}
+
+/* The work of the thread of testSnap() that reads a snapshot. */
+
+struct SnapWork
+{
+   /* the snapshot, and the number of keys it must hold. */
+   SymSnap_T oSnapshot;
+   int iKeyCount;
+
+   /* the values that key i must be bound to. */
+   const int *piValues;
+};
+
+/* Do the work *(struct SnapWork*)pvWork: check that key i of the
+   snapshot is bound to piValues[i] for each i, while another thread
+   changes the table the snapshot was taken of. Return NULL. */
+
+static void *doSnapWork(void *pvWork)
+{
+   enum {MAX_KEY_LENGTH = 32};
+
+   struct SnapWork *psWork;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   assert(pvWork != NULL);
+
+   psWork = (struct SnapWork*)pvWork;
+   for (i = 0; i < psWork->iKeyCount; i++)
+   {
+      sprintf(acKey, "snap%d", i);
+      ASSURE(SymSnap_get(psWork->oSnapshot, acKey) ==
+             &psWork->piValues[i]);
+   }
+   ASSURE(SymSnap_getLength(psWork->oSnapshot) ==
+          (size_t)psWork->iKeyCount);
+   return NULL;
+}
+
+/* Test a SymSnap object: a snapshot keeps the bindings the SymSnap
+   had when it was taken, however either is changed later. */
+
+static void testSnap(void)
+{
+   enum {KEY_COUNT = 2000};
+   enum {MAX_KEY_LENGTH = 32};
+
+   struct SymTable_Options sOptions;
+   SymSnap_T oSymSnap;
+   SymSnap_T oSnapshot;
+   SymSnap_T oSnapshot2;
+   struct SnapWork sWork;
+   pthread_t iThread;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[KEY_COUNT];
+   static int aiNewValues[KEY_COUNT];
+   size_t uCount;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymSnap object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymSnap = SymSnap_new();
+   ASSURE(oSymSnap != NULL);
+   ASSURE(SymSnap_getLength(oSymSnap) == 0);
+   ASSURE(SymSnap_get(oSymSnap, "x") == NULL);
+   ASSURE(SymSnap_remove(oSymSnap, "x") == NULL);
+
+   /* an empty SymSnap can be snapshotted too */
+   oSnapshot = SymSnap_snapshot(oSymSnap);
+   ASSURE(oSnapshot != NULL);
+   iSuccessful = SymSnap_put(oSymSnap, "x", &aiValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(!SymSnap_contains(oSnapshot, "x"));
+   SymSnap_free(oSnapshot);
+   ASSURE(SymSnap_remove(oSymSnap, "x") == &aiValues[0]);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "snap%d", i);
+      iSuccessful = SymSnap_put(oSymSnap, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = SymSnap_put(oSymSnap, "snap0", &aiNewValues[0]);
+   ASSURE(!iSuccessful);
+   ASSURE(SymSnap_getLength(oSymSnap) == KEY_COUNT);
+
+   /* changing the SymSnap leaves the snapshot alone */
+   oSnapshot = SymSnap_snapshot(oSymSnap);
+   ASSURE(oSnapshot != NULL);
+   ASSURE(SymSnap_getLength(oSnapshot) == KEY_COUNT);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "snap%d", i);
+      if (i % 2 == 0)
+         ASSURE(SymSnap_remove(oSymSnap, acKey) == &aiValues[i]);
+      else
+         ASSURE(SymSnap_replace(oSymSnap, acKey, &aiNewValues[i]) ==
+                &aiValues[i]);
+   }
+   ASSURE(SymSnap_getLength(oSymSnap) == KEY_COUNT / 2);
+   ASSURE(SymSnap_getLength(oSnapshot) == KEY_COUNT);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "snap%d", i);
+      ASSURE(SymSnap_get(oSnapshot, acKey) == &aiValues[i]);
+      ASSURE(SymSnap_get(oSymSnap, acKey) ==
+             (i % 2 == 0 ? NULL : &aiNewValues[i]));
+   }
+
+   /* and changing the snapshot leaves the SymSnap alone */
+   iSuccessful = SymSnap_put(oSnapshot, "extra", &aiValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(!SymSnap_contains(oSymSnap, "extra"));
+   ASSURE(SymSnap_replace(oSnapshot, "snap1", &aiValues[0]) ==
+          &aiValues[1]);
+   ASSURE(SymSnap_get(oSymSnap, "snap1") == &aiNewValues[1]);
+   ASSURE(SymSnap_remove(oSnapshot, "extra") == &aiValues[0]);
+   ASSURE(SymSnap_replace(oSnapshot, "snap1", &aiValues[1]) ==
+          &aiValues[0]);
+
+   /* a snapshot outlives the SymSnap it was taken of */
+   SymSnap_free(oSymSnap);
+   uCount = 0;
+   SymSnap_map(oSnapshot, countBinding, &uCount);
+   ASSURE(uCount == KEY_COUNT);
+
+   /* a snapshot may be read by one thread while another changes the
+      SymSnap it was taken of */
+   oSnapshot2 = SymSnap_snapshot(oSnapshot);
+   ASSURE(oSnapshot2 != NULL);
+   sWork.oSnapshot = oSnapshot2;
+   sWork.iKeyCount = KEY_COUNT;
+   sWork.piValues = aiValues;
+   iSuccessful = pthread_create(&iThread, NULL, doSnapWork,
+                                &sWork) == 0;
+   ASSURE(iSuccessful);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "snap%d", i);
+      ASSURE(SymSnap_remove(oSnapshot, acKey) == &aiValues[i]);
+   }
+   pthread_join(iThread, NULL);
+   ASSURE(SymSnap_getLength(oSnapshot) == 0);
+   SymSnap_free(oSnapshot);
+   SymSnap_free(oSnapshot2);
+
+   /* keys whose hash codes are equal are kept apart */
+   SymTable_initOptions(&sOptions);
+   sOptions.pfHash = hashFirstByte;
+   oSymSnap = SymSnap_newWithOptions(&sOptions);
+   ASSURE(oSymSnap != NULL);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%c%d", 'a' + i % 4, i);
+      iSuccessful = SymSnap_put(oSymSnap, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   oSnapshot = SymSnap_snapshot(oSymSnap);
+   ASSURE(oSnapshot != NULL);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%c%d", 'a' + i % 4, i);
+      if (i % 4 == 0)
+         ASSURE(SymSnap_remove(oSymSnap, acKey) == &aiValues[i]);
+      else if (i % 4 == 1)
+         ASSURE(SymSnap_replace(oSymSnap, acKey, &aiNewValues[i]) ==
+                &aiValues[i]);
+   }
+   ASSURE(SymSnap_getLength(oSymSnap) == KEY_COUNT - KEY_COUNT / 4);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%c%d", 'a' + i % 4, i);
+      ASSURE(SymSnap_get(oSnapshot, acKey) == &aiValues[i]);
+      if (i % 4 == 0)
+         ASSURE(!SymSnap_contains(oSymSnap, acKey));
+      else
+         ASSURE(SymSnap_get(oSymSnap, acKey) ==
+                (i % 4 == 1 ? &aiNewValues[i] : &aiValues[i]));
+   }
+   SymSnap_free(oSnapshot);
+   SymSnap_free(oSymSnap);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object created with the iMoveToFront option, which
+   may reorder bindings on lookup but must not otherwise change what
+   any operation does. */
+
+static void testMoveToFront(void)
+{
+   enum {BINDING_COUNT = 50};
+   enum {MAX_KEY_LENGTH = 32};
+
+   struct SymTable_Options sOptions;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int aiValues[BINDING_COUNT];
+   int iOther;
+   size_t uCount;
+   int iRound;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the move-to-front option.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   SymTable_initOptions(&sOptions);
+   ASSURE(! sOptions.iMoveToFront);
+   sOptions.iMoveToFront = 1;
+   oSymTable = SymTable_newWithOptions(&sOptions);
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "front%d", i);
+      aiValues[i] = i;
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* look up the keys, oldest first and some of them repeatedly */
+   for (iRound = 0; iRound < 3; iRound++)
+      for (i = 0; i < BINDING_COUNT; i += iRound + 1)
+      {
+         sprintf(acKey, "front%d", i);
+         ASSURE(SymTable_get(oSymTable, acKey) == &aiValues[i]);
+         ASSURE(SymTable_contains(oSymTable, acKey));
+      }
+   ASSURE(SymTable_get(oSymTable, "front") == NULL);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+   uCount = 0U;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == BINDING_COUNT);
+
+   /* replace and remove after the bindings have been reordered */
+   ASSURE(SymTable_replace(oSymTable, "front7", &iOther) ==
+          &aiValues[7]);
+   ASSURE(SymTable_get(oSymTable, "front7") == &iOther);
+   ASSURE(SymTable_put(oSymTable, "front7", &aiValues[7]) == 0);
+   for (i = 0; i < BINDING_COUNT; i += 3)
+   {
+      sprintf(acKey, "front%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) ==
+             (i == 7 ? (void*)&iOther : (void*)&aiValues[i]));
+   }
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "front%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey) == (i % 3 != 0));
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to acKey the key that testReuse() uses for binding i of round
+   iRound: the two numbers followed by (i % 180) x's. acKey must have
+   room for 200 characters. */
+
+static void makeReuseKey(char acKey[], int iRound, int i)
+{
+   size_t uPrefixLength;
+   size_t uPadLength;
+
+   assert(acKey != NULL);
+
+   sprintf(acKey, "%d-%d", iRound, i);
+   uPrefixLength = strlen(acKey);
+   uPadLength = (size_t)(i % 180);
+   memset(acKey + uPrefixLength, 'x', uPadLength);
+   acKey[uPrefixLength + uPadLength] = '\0';
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object through rounds of puts and removes, so the
+   memory of removed bindings and keys is reused by later ones. Keys
+   of many lengths, some longer than any size class, are used. */
+
+static void testReuse(void)
+{
+   enum {ROUND_COUNT = 20};
+   enum {BINDING_COUNT = 300};
+   enum {MAX_KEY_LENGTH = 200};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   char *pcValue;
+   int iRound;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing reuse of memory within a SymTable object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (iRound = 0; iRound < ROUND_COUNT; iRound++)
+   {
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         makeReuseKey(acKey, iRound, i);
+         iSuccessful = SymTable_put(oSymTable, acKey, acValue);
+         ASSURE(iSuccessful);
+      }
+
+      /* remove the odd ones of this round and the even ones of the
+         last round */
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         makeReuseKey(acKey, i % 2 == 1 ? iRound : iRound - 1, i);
+         pcValue = (char*)SymTable_remove(oSymTable, acKey);
+         ASSURE(pcValue == (iRound == 0 && i % 2 == 0 ? NULL : acValue));
+      }
+
+      /* the even ones of this round must be intact */
+      for (i = 0; i < BINDING_COUNT; i += 2)
+      {
+         makeReuseKey(acKey, iRound, i);
+         pcValue = (char*)SymTable_get(oSymTable, acKey);
+         ASSURE(pcValue == acValue);
+      }
+      ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT / 2);
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_upsert() and SymTable_getOrInsert() functions,
+   the latter by counting how often each of DISTINCT_COUNT words
+   occurs in a stream of WORD_COUNT of them. */
+
+static void testUpsert(void)
+{
+   enum {DISTINCT_COUNT = 700};
+   enum {WORD_COUNT = 2100};
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   static int aiCounts[DISTINCT_COUNT];
+   char acKey[MAX_KEY_LENGTH];
+   char acJeter[] = "Jeter";
+   char acRodriguez[] = "Rodriguez";
+   char acPosada[] = "Posada";
+   char *pcValue;
+   void **ppvValue;
+   int iDistinct;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_upsert() and SymTable_getOrInsert() "
+          "functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* upsert inserts an absent key and replaces a present one */
+   iSuccessful = SymTable_upsert(oSymTable, "Shortstop", acJeter);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   iSuccessful = SymTable_upsert(oSymTable, "Shortstop", acRodriguez);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   pcValue = (char*)SymTable_get(oSymTable, "Shortstop");
+   ASSURE(pcValue == acRodriguez);
+
+   /* getOrInsert leaves the value of a present key alone */
+   ppvValue = SymTable_getOrInsert(oSymTable, "Shortstop", acPosada);
+   ASSURE(ppvValue != NULL);
+   ASSURE(*ppvValue == acRodriguez);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+
+   /* and inserts an absent one, its value settable through the
+      address */
+   ppvValue = SymTable_getOrInsert(oSymTable, "Catcher", NULL);
+   ASSURE(ppvValue != NULL);
+   ASSURE(*ppvValue == NULL);
+   *ppvValue = acPosada;
+   pcValue = (char*)SymTable_get(oSymTable, "Catcher");
+   ASSURE(pcValue == acPosada);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+
+   /* reserve may move the bindings, so the address is fetched again
+      after it */
+   iSuccessful = SymTable_reserve(oSymTable, 100000U);
+   ASSURE(iSuccessful);
+   ppvValue = SymTable_getOrInsert(oSymTable, "Catcher", NULL);
+   ASSURE(ppvValue != NULL);
+   ASSURE(ppvValue == NULL || *ppvValue == acPosada);
+   if (ppvValue != NULL)
+      *ppvValue = acJeter;
+   pcValue = (char*)SymTable_get(oSymTable, "Catcher");
+   ASSURE(pcValue == acJeter);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+
+   SymTable_free(oSymTable);
+
+   /* the value of each word is its counter; a word is new if
+      getOrInsert gives back the counter offered for it */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iDistinct = 0;
+   for (i = 0; i < WORD_COUNT; i++)
+   {
+      sprintf(acKey, "%d", (i * 3) % DISTINCT_COUNT);
+      ppvValue = SymTable_getOrInsert(oSymTable, acKey,
+                                      &aiCounts[iDistinct]);
+      ASSURE(ppvValue != NULL);
+      if (*ppvValue == &aiCounts[iDistinct])
+         iDistinct++;
+      (*(int*)*ppvValue)++;
+   }
+   ASSURE(iDistinct == DISTINCT_COUNT);
+   ASSURE(SymTable_getLength(oSymTable) == DISTINCT_COUNT);
+   for (i = 0; i < DISTINCT_COUNT; i++)
+      ASSURE(aiCounts[i] == WORD_COUNT / DISTINCT_COUNT);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increment *(int*)pvExtra if pcKey is "alpha", so a test can check
+   that a key stored by length comes back NUL-terminated. */
+
+static void countAlpha(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   (void)pvValue;
+   if (strcmp(pcKey, "alpha") == 0)
+      (*(int*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the functions that take a key and its length, using keys that
+   are prefixes of one buffer and so are not NUL-terminated. */
+
+static void testLengthFunctions(void)
+{
+   SymTable_T oSymTable;
+   const char acBuffer[] = "alphabetagamma";
+   char acLookup[] = {'a', 'l', 'p', 'h', 'a', 'x'};
+   char acAlpha[] = "Alpha";
+   char acAlphabet[] = "Alphabet";
+   char acEmpty[] = "Empty";
+   char *pcValue;
+   void **ppvValue;
+   size_t uHash;
+   int iSuccessful;
+   int iCount;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the functions that take key lengths.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* keys that differ only in length are different keys */
+   iSuccessful = SymTable_putN(oSymTable, acBuffer, 5, acAlpha);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, acBuffer, 8, acAlphabet);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, acBuffer, 0, acEmpty);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, acLookup, 5, NULL);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+
+   /* the N functions and the plain ones find the same bindings */
+   pcValue = (char*)SymTable_getN(oSymTable, acLookup, 5);
+   ASSURE(pcValue == acAlpha);
+   pcValue = (char*)SymTable_get(oSymTable, "alpha");
+   ASSURE(pcValue == acAlpha);
+   pcValue = (char*)SymTable_get(oSymTable, "alphabet");
+   ASSURE(pcValue == acAlphabet);
+   pcValue = (char*)SymTable_get(oSymTable, "");
+   ASSURE(pcValue == acEmpty);
+   ASSURE(! SymTable_containsN(oSymTable, acLookup, 4));
+   ASSURE(! SymTable_containsN(oSymTable, acLookup, 6));
+   ASSURE(SymTable_containsN(oSymTable, acBuffer, 8));
+
+   /* stored keys are NUL-terminated copies */
+   iCount = 0;
+   SymTable_map(oSymTable, countAlpha, &iCount);
+   ASSURE(iCount == 1);
+
+   pcValue = (char*)SymTable_replaceN(oSymTable, acBuffer, 8, acAlpha);
+   ASSURE(pcValue == acAlphabet);
+   iSuccessful = SymTable_upsertN(oSymTable, acBuffer, 8, acAlphabet);
+   ASSURE(iSuccessful);
+   ppvValue = SymTable_getOrInsertN(oSymTable, acBuffer, 8, NULL);
+   ASSURE(ppvValue != NULL && *ppvValue == acAlphabet);
+   ppvValue = SymTable_getOrInsertN(oSymTable, acBuffer, 9, NULL);
+   ASSURE(ppvValue != NULL && *ppvValue == NULL);
+   ASSURE(SymTable_contains(oSymTable, "alphabeta"));
+
+   pcValue = (char*)SymTable_removeN(oSymTable, acLookup, 5);
+   ASSURE(pcValue == acAlpha);
+   pcValue = (char*)SymTable_removeN(oSymTable, acLookup, 5);
+   ASSURE(pcValue == NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+
+   /* the H functions, given the code SymTable_hashN() returns, find
+      the same bindings as the N functions */
+   uHash = SymTable_hashN(oSymTable, acLookup, 5);
+   ASSURE(uHash == SymTable_hashN(oSymTable, "alpha", 5));
+   iSuccessful = SymTable_putH(oSymTable, acLookup, 5, uHash, acAlpha);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putH(oSymTable, acLookup, 5, uHash, NULL);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTable_containsH(oSymTable, acLookup, 5, uHash));
+   pcValue = (char*)SymTable_getH(oSymTable, acLookup, 5, uHash);
+   ASSURE(pcValue == acAlpha);
+   pcValue = (char*)SymTable_replaceH(oSymTable, acLookup, 5, uHash,
+                                      acAlphabet);
+   ASSURE(pcValue == acAlpha);
+   iSuccessful = SymTable_upsertH(oSymTable, acLookup, 5, uHash,
+                                  acEmpty);
+   ASSURE(iSuccessful);
+   ppvValue = SymTable_getOrInsertH(oSymTable, acLookup, 5, uHash,
+                                    NULL);
+   ASSURE(ppvValue != NULL && *ppvValue == acEmpty);
+   pcValue = (char*)SymTable_get(oSymTable, "alpha");
+   ASSURE(pcValue == acEmpty);
+   pcValue = (char*)SymTable_removeH(oSymTable, acLookup, 5, uHash);
+   ASSURE(pcValue == acEmpty);
+   ASSURE(! SymTable_containsH(oSymTable, acLookup, 5, uHash));
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_putBatch() and SymTable_getBatch() functions on
+   batches longer than the groups an implementation prefetches for. */
+
+static void testBatch(void)
+{
+   enum {KEY_COUNT = 50};
+   enum {PUT_COUNT = 40};
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   const char *apcKeys[KEY_COUNT];
+   const void *apvPutValues[KEY_COUNT];
+   void *apvValues[KEY_COUNT];
+   size_t uPutCount;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_putBatch() and SymTable_getBatch() "
+          "functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(aacKeys[i], "key%d", i);
+      apcKeys[i] = aacKeys[i];
+      apvPutValues[i] = aacKeys[i];
+   }
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* the last key put repeats the first, so it is not inserted */
+   apcKeys[PUT_COUNT - 1] = aacKeys[0];
+   uPutCount = SymTable_putBatch(oSymTable, apcKeys, apvPutValues,
+                                 PUT_COUNT);
+   ASSURE(uPutCount == PUT_COUNT - 1);
+   ASSURE(SymTable_getLength(oSymTable) == PUT_COUNT - 1);
+   apcKeys[PUT_COUNT - 1] = aacKeys[PUT_COUNT - 1];
+
+   SymTable_getBatch(oSymTable, apcKeys, KEY_COUNT, apvValues);
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(apvValues[i] ==
+             (i < PUT_COUNT - 1 ? (void*)aacKeys[i] : NULL));
+
+   SymTable_getBatch(oSymTable, apcKeys, 0, apvValues);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the int at pvValue. pcKey and pvExtra are unused. */
+
+static void markBinding(const char *pcKey, void *pvValue,
+                        void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(pvExtra == NULL);
+
+   (*(int*)pvValue)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_putParallel() and SymTable_mapParallel()
+   functions with iBindingCount keys and up to iThreadCount
+   threads. */
+
+static void testParallel(int iThreadCount, int iBindingCount)
+{
+   enum {PRESET_COUNT = 100};
+   enum {LONG_KEY_LENGTH = 200};
+
+   SymTable_T oSymTable;
+   char **ppcKeys;
+   const void **ppvValues;
+   int *aiMarks;
+   char acLongKey[LONG_KEY_LENGTH + 1];
+   size_t uPutCount;
+   int iKeyCount;
+   int iDuplicateCount;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_putParallel() and "
+          "SymTable_mapParallel() functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   if (iBindingCount < PRESET_COUNT || iThreadCount <= 0)
+      return;
+
+   /* the keys past iBindingCount repeat earlier ones */
+   iDuplicateCount = iBindingCount / 10;
+   iKeyCount = iBindingCount + iDuplicateCount;
+   ppcKeys = (char**)calloc((size_t)iKeyCount, sizeof(char*));
+   ppvValues = (const void**)calloc((size_t)iKeyCount,
+                                    sizeof(const void*));
+   aiMarks = (int*)calloc((size_t)iKeyCount, sizeof(int));
+   ASSURE(ppcKeys != NULL && ppvValues != NULL && aiMarks != NULL);
+   if (ppcKeys == NULL || ppvValues == NULL || aiMarks == NULL)
+   {
+      free(ppcKeys);
+      free((void*)ppvValues);
+      free(aiMarks);
+      return;
+   }
+
+   /* mix short keys with ones that need the key arena, and a few
+      with blocks of their own */
+   memset(acLongKey, 'x', LONG_KEY_LENGTH);
+   acLongKey[LONG_KEY_LENGTH] = '\0';
+   for (i = 0; i < iBindingCount; i++)
+   {
+      ppcKeys[i] = (char*)malloc(LONG_KEY_LENGTH + 32);
+      ASSURE(ppcKeys[i] != NULL);
+      if (ppcKeys[i] == NULL)
+         return;
+      if (i % 97 == 0)
+         sprintf(ppcKeys[i], "%d%s", i, acLongKey);
+      else if (i % 4 == 0)
+         sprintf(ppcKeys[i], "parallel key %d", i);
+      else
+         sprintf(ppcKeys[i], "%d", i);
+      ppvValues[i] = &aiMarks[i];
+   }
+   for (i = 0; i < iDuplicateCount; i++)
+   {
+      ppcKeys[iBindingCount + i] = ppcKeys[i * 7 % iBindingCount];
+      ppvValues[iBindingCount + i] = &aiMarks[iBindingCount + i];
+   }
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < PRESET_COUNT; i++)
+      ASSURE(SymTable_put(oSymTable, ppcKeys[i], &aiMarks[i]));
+
+   /* neither the keys already present nor the repeats are put */
+   uPutCount = SymTable_putParallel(oSymTable,
+                                    (const char *const *)ppcKeys,
+                                    ppvValues, (size_t)iKeyCount,
+                                    (size_t)iThreadCount);
+   ASSURE(uPutCount == (size_t)(iBindingCount - PRESET_COUNT));
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(SymTable_get(oSymTable, ppcKeys[i]) == &aiMarks[i]);
+
+   /* every binding is visited exactly once */
+   SymTable_mapParallel(oSymTable, (size_t)iThreadCount, markBinding,
+                        NULL);
+   for (i = 0; i < iKeyCount; i++)
+      ASSURE(aiMarks[i] == (i < iBindingCount ? 1 : 0));
+
+   /* the table works as usual afterwards, and owns its own keys */
+   ASSURE(SymTable_remove(oSymTable, ppcKeys[0]) == &aiMarks[0]);
+   ASSURE(SymTable_put(oSymTable, ppcKeys[0], &aiMarks[0]));
+   for (i = 0; i < iBindingCount; i++)
+   {
+      ppcKeys[i][0] = '-';
+      ASSURE(SymTable_remove(oSymTable, ppcKeys[i]) == NULL);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+
+   SymTable_mapParallel(oSymTable, 1U, markBinding, NULL);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(aiMarks[i] == 2);
+
+   SymTable_free(oSymTable);
+   for (i = 0; i < iBindingCount; i++)
+      free(ppcKeys[i]);
+   free(ppcKeys);
+   free((void*)ppvValues);
+   free(aiMarks);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The keys an ordered traversal of testOrder() has visited. */
+
+struct OrderCheck
+{
+   /* if not NULL, the keys the traversal should visit, in order. */
+   const char *const *ppcExpected;
+
+   /* the last key visited, or NULL if none has been. */
+   const char *pcLast;
+
+   /* number of keys visited. */
+   size_t uCount;
+
+   /* 1 while every key has been larger than the one before it and
+      matched the expected key, if any. */
+   int iInOrder;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Record the visit of pcKey in the OrderCheck at pvExtra. pvValue is
+   unused. */
+
+static void checkOrder(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   struct OrderCheck *psCheck;
+
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   (void)pvValue;
+   psCheck = (struct OrderCheck*)pvExtra;
+   if (psCheck->pcLast != NULL && strcmp(psCheck->pcLast, pcKey) >= 0)
+      psCheck->iInOrder = 0;
+   if (psCheck->ppcExpected != NULL &&
+       (psCheck->ppcExpected[psCheck->uCount] == NULL ||
+        strcmp(psCheck->ppcExpected[psCheck->uCount], pcKey) != 0))
+      psCheck->iInOrder = 0;
+   psCheck->pcLast = pcKey;
+   psCheck->uCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Initialize *psCheck to expect the keys of the NULL-terminated array
+   ppcExpected, or any increasing keys if ppcExpected is NULL. */
+
+static void initOrderCheck(struct OrderCheck *psCheck,
+                           const char *const *ppcExpected)
+{
+   assert(psCheck != NULL);
+
+   psCheck->ppcExpected = ppcExpected;
+   psCheck->pcLast = NULL;
+   psCheck->uCount = 0;
+   psCheck->iInOrder = 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_mapRange() and SymTable_mapPrefix(), in a small table
+   and in one of iBindingCount bindings put and removed in scrambled
+   orders. */
+
+static void testOrder(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 32};
+
+   static const char *const apcKeys[] =
+   {
+      "foo.bar", "a", "fop", "", "foo", "\377", "b", "a.c", "foobar",
+      "ab", "foo.baz", "a.b", NULL
+   };
+   static const char *const apcAll[] =
+   {
+      "", "a", "a.b", "a.c", "ab", "b", "foo", "foo.bar", "foo.baz",
+      "foobar", "fop", "\377", NULL
+   };
+   static const char *const apcFooToFop[] =
+   {
+      "foo", "foo.bar", "foo.baz", "foobar", NULL
+   };
+   static const char *const apcFooDot[] = {"foo.bar", "foo.baz", NULL};
+   static const char *const apcNone[] = {NULL};
+
+   SymTable_T oSymTable;
+   struct OrderCheck sCheck;
+   char acKey[MAX_KEY_LENGTH];
+   char acLow[MAX_KEY_LENGTH];
+   char acHigh[MAX_KEY_LENGTH];
+   int iStride;
+   int iCount;
+   int i;
+   int j;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_mapRange() and SymTable_mapPrefix() "
+          "functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   initOrderCheck(&sCheck, apcNone);
+   ASSURE(SymTable_mapRange(oSymTable, NULL, NULL, checkOrder,
+                            &sCheck));
+   ASSURE(SymTable_mapPrefix(oSymTable, "", checkOrder, &sCheck));
+   ASSURE(sCheck.uCount == 0);
+
+   for (i = 0; apcKeys[i] != NULL; i++)
+      ASSURE(SymTable_put(oSymTable, apcKeys[i], NULL));
+
+   initOrderCheck(&sCheck, apcAll);
+   ASSURE(SymTable_mapRange(oSymTable, NULL, NULL, checkOrder,
+                            &sCheck));
+   ASSURE(sCheck.iInOrder && sCheck.uCount == 12);
+
+   initOrderCheck(&sCheck, apcAll);
+   ASSURE(SymTable_mapPrefix(oSymTable, "", checkOrder, &sCheck));
+   ASSURE(sCheck.iInOrder && sCheck.uCount == 12);
+
+   initOrderCheck(&sCheck, apcFooToFop);
+   ASSURE(SymTable_mapRange(oSymTable, "foo", "fop", checkOrder,
+                            &sCheck));
+   ASSURE(sCheck.iInOrder && sCheck.uCount == 4);
+
+   initOrderCheck(&sCheck, apcFooToFop);
+   ASSURE(SymTable_mapPrefix(oSymTable, "foo", checkOrder, &sCheck));
+   ASSURE(sCheck.iInOrder && sCheck.uCount == 4);
+
+   initOrderCheck(&sCheck, apcFooDot);
+   ASSURE(SymTable_mapPrefix(oSymTable, "foo.", checkOrder, &sCheck));
+   ASSURE(sCheck.iInOrder && sCheck.uCount == 2);
+
+   initOrderCheck(&sCheck, apcFooDot);
+   ASSURE(SymTable_mapRange(oSymTable, "foo.a", "foo.c", checkOrder,
+                            &sCheck));
+   ASSURE(sCheck.iInOrder && sCheck.uCount == 2);
+
+   /* the range is half-open, so an empty one visits nothing */
+   initOrderCheck(&sCheck, apcNone);
+   ASSURE(SymTable_mapRange(oSymTable, "b", "b", checkOrder, &sCheck));
+   ASSURE(SymTable_mapRange(oSymTable, "fop", "foo", checkOrder,
+                            &sCheck));
+   ASSURE(SymTable_mapPrefix(oSymTable, "zz", checkOrder, &sCheck));
+   ASSURE(SymTable_mapPrefix(oSymTable, "foo.bar.", checkOrder,
+                             &sCheck));
+   ASSURE(sCheck.uCount == 0);
+
+   /* bytes compare as unsigned, so "\377" comes last */
+   initOrderCheck(&sCheck, apcAll + 5);
+   ASSURE(SymTable_mapRange(oSymTable, "b", NULL, checkOrder,
+                            &sCheck));
+   ASSURE(sCheck.iInOrder && sCheck.uCount == 7);
+
+   SymTable_free(oSymTable);
+
+   /* keys put in one scrambled order and removed in another shuffle
+      the bindings around any tree the table keeps */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   /* 7919 and 7907 are prime, so stepping by one that does not divide
+      iBindingCount reaches every key */
+   iStride = 1;
+   if (iBindingCount % 7919 != 0)
+      iStride = 7919;
+   else if (iBindingCount % 7907 != 0)
+      iStride = 7907;
+   for (i = 0, j = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%08d", j);
+      ASSURE(SymTable_put(oSymTable, acKey, NULL));
+      j = (int)(((long)j + iStride) % iBindingCount);
+   }
+   for (i = 0; i < iBindingCount; i += 3)
+   {
+      sprintf(acKey, "%08d", iBindingCount - 1 - i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == NULL);
+   }
+   iCount = iBindingCount - (iBindingCount + 2) / 3;
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iCount);
+
+   initOrderCheck(&sCheck, NULL);
+   ASSURE(SymTable_mapRange(oSymTable, NULL, NULL, checkOrder,
+                            &sCheck));
+   ASSURE(sCheck.iInOrder && sCheck.uCount == (size_t)iCount);
+
+   /* a range of every key from i to j-1, some of which were removed */
+   i = iBindingCount / 3;
+   j = i + iBindingCount / 4;
+   sprintf(acLow, "%08d", i);
+   sprintf(acHigh, "%08d", j);
+   iCount = 0;
+   for (; i < j; i++)
+      if ((iBindingCount - 1 - i) % 3 != 0)
+         iCount++;
+   initOrderCheck(&sCheck, NULL);
+   ASSURE(SymTable_mapRange(oSymTable, acLow, acHigh, checkOrder,
+                            &sCheck));
+   ASSURE(sCheck.iInOrder && sCheck.uCount == (size_t)iCount);
+
+   /* the prefix of every key of one thousand */
+   iCount = 0;
+   for (i = 1000; i < 2000 && i < iBindingCount; i++)
+      if ((iBindingCount - 1 - i) % 3 != 0)
+         iCount++;
+   initOrderCheck(&sCheck, NULL);
+   ASSURE(SymTable_mapPrefix(oSymTable, "00001", checkOrder, &sCheck));
+   ASSURE(sCheck.iInOrder && sCheck.uCount == (size_t)iCount);
+
+   /* removing the rest, in increasing order, empties the table */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%08d", i);
+      SymTable_remove(oSymTable, acKey);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   initOrderCheck(&sCheck, apcNone);
+   ASSURE(SymTable_mapRange(oSymTable, NULL, NULL, checkOrder,
+                            &sCheck));
+   ASSURE(sCheck.uCount == 0);
+   ASSURE(SymTable_put(oSymTable, "again", NULL));
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return pvValue, the address of an int, and store the size of an
+   int in *puLength. pcKey and pvExtra are unused. */
+
+static const void *encodeInt(const char *pcKey, const void *pvValue,
+                             size_t *puLength, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(puLength != NULL);
+   assert(pvExtra == NULL);
+
+   *puLength = sizeof(int);
+   return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the int at pvValue, of uLength bytes, to the int at pvExtra.
+   pcKey is unused. */
+
+static void sumImageValue(const char *pcKey, const void *pvValue,
+                          size_t uLength, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(uLength == sizeof(int));
+   assert(pvExtra != NULL);
+
+   *(int*)pvExtra += *(const int*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read into *puWord the size_t at byte uOffset of the file named
+   pcPath, then replace it with uWord. Return 1 if successful, or 0
+   otherwise. */
+
+static int swapFileWord(const char *pcPath, size_t uOffset,
+                        size_t uWord, size_t *puWord)
+{
+   FILE *psFile;
+   int iSuccessful;
+
+   assert(pcPath != NULL);
+   assert(puWord != NULL);
+
+   psFile = fopen(pcPath, "r+b");
+   if (psFile == NULL)
+      return 0;
+   iSuccessful =
+      fseek(psFile, (long)uOffset, SEEK_SET) == 0 &&
+      fread(puWord, sizeof(size_t), 1, psFile) == 1 &&
+      fseek(psFile, (long)uOffset, SEEK_SET) == 0 &&
+      fwrite(&uWord, sizeof(size_t), 1, psFile) == 1;
+   return fclose(psFile) == 0 && iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymImage functions. */
+
+static void testImage(void)
+{
+   enum {KEY_COUNT = 1000};
+   enum {MAX_KEY_LENGTH = 32};
+
+   static const char acPath[] = "testsymtable.img";
+   static int aiValues[KEY_COUNT];
+   SymTable_T oSymTable;
+   SymImage_T oSymImage;
+   FILE *psFile;
+   char acKey[MAX_KEY_LENGTH];
+   const void *pvValue;
+   size_t uLength;
+   size_t uBucketsOffset;
+   size_t uEntriesOffset;
+   size_t uWord;
+   int iSum;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymImage functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* an empty table makes an empty image */
+   ASSURE(SymImage_write(oSymTable, acPath, encodeInt, NULL));
+   oSymImage = SymImage_open(acPath);
+   ASSURE(oSymImage != NULL);
+   ASSURE(SymImage_getLength(oSymImage) == 0);
+   ASSURE(! SymImage_contains(oSymImage, ""));
+   SymImage_close(oSymImage);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      /* some keys are too long to fit in a hash Binding */
+      sprintf(acKey, i % 3 == 0 ? "image key number %d" : "%d", i);
+      aiValues[i] = i;
+      ASSURE(SymTable_put(oSymTable, acKey, &aiValues[i]));
+   }
+   ASSURE(SymTable_put(oSymTable, "", &aiValues[1]));
+   ASSURE(SymImage_write(oSymTable, acPath, encodeInt, NULL));
+   SymTable_free(oSymTable);
+
+   /* the image outlives the table it was written from */
+   oSymImage = SymImage_open(acPath);
+   ASSURE(oSymImage != NULL);
+   if (oSymImage == NULL)
+      return;
+   ASSURE(SymImage_getLength(oSymImage) == KEY_COUNT + 1);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, i % 3 == 0 ? "image key number %d" : "%d", i);
+      uLength = 0;
+      pvValue = SymImage_get(oSymImage, acKey, &uLength);
+      ASSURE(pvValue != NULL);
+      ASSURE(uLength == sizeof(int));
+      ASSURE(pvValue == NULL || *(const int*)pvValue == i);
+      ASSURE(SymImage_contains(oSymImage, acKey));
+   }
+   pvValue = SymImage_get(oSymImage, "", &uLength);
+   ASSURE(pvValue != NULL && *(const int*)pvValue == 1);
+   ASSURE(SymImage_get(oSymImage, "image key number 1", &uLength) ==
+          NULL);
+   ASSURE(! SymImage_contains(oSymImage, "1000"));
+
+   iSum = 0;
+   SymImage_map(oSymImage, sumImageValue, &iSum);
+   ASSURE(iSum == KEY_COUNT * (KEY_COUNT - 1) / 2 + 1);
+   SymImage_close(oSymImage);
+
+   /* an image whose bucket starts or entries point outside it cannot
+      be opened. The header is 8 magic bytes and 7 size_ts, the
+      offsets of the bucket starts and of the entries last, and an
+      entry is 5 size_ts, the key offset second. */
+   uBucketsOffset = 0;
+   uEntriesOffset = 0;
+   ASSURE(swapFileWord(acPath, 8 + 5 * sizeof(size_t), 0,
+                       &uBucketsOffset));
+   ASSURE(swapFileWord(acPath, 8 + 5 * sizeof(size_t), uBucketsOffset,
+                       &uWord));
+   ASSURE(swapFileWord(acPath, 8 + 6 * sizeof(size_t), 0,
+                       &uEntriesOffset));
+   ASSURE(swapFileWord(acPath, 8 + 6 * sizeof(size_t), uEntriesOffset,
+                       &uWord));
+   ASSURE(swapFileWord(acPath, uBucketsOffset + sizeof(size_t),
+                       1000000000, &uWord));
+   ASSURE(SymImage_open(acPath) == NULL);
+   ASSURE(swapFileWord(acPath, uBucketsOffset + sizeof(size_t), uWord,
+                       &uWord));
+   ASSURE(swapFileWord(acPath, uEntriesOffset + sizeof(size_t),
+                       1000000000, &uWord));
+   ASSURE(SymImage_open(acPath) == NULL);
+   ASSURE(swapFileWord(acPath, uEntriesOffset + sizeof(size_t), uWord,
+                       &uWord));
+   oSymImage = SymImage_open(acPath);
+   ASSURE(oSymImage != NULL);
+   if (oSymImage != NULL)
+      SymImage_close(oSymImage);
+
+   /* a missing file, or one that is not an image, cannot be opened */
+   ASSURE(remove(acPath) == 0);
+   ASSURE(SymImage_open(acPath) == NULL);
+   psFile = fopen(acPath, "w");
+   ASSURE(psFile != NULL);
+   if (psFile != NULL)
+   {
+      for (i = 0; i < KEY_COUNT; i++)
+         fputs("not an image ", psFile);
+      fclose(psFile);
+   }
+   ASSURE(SymImage_open(acPath) == NULL);
+   remove(acPath);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to psFile the index of the int at pvValue within the array
+   at pvExtra, as an address within an array named aiWords. pcKey is
+   unused. */
+
+static void writeIntAddress(FILE *psFile, const char *pcKey,
+                            void *pvValue, void *pvExtra)
+{
+   assert(psFile != NULL);
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(pvExtra != NULL);
+
+   fprintf(psFile, "&aiWords[%d]",
+           (int)((int*)pvValue - (int*)pvExtra));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymPerfect functions. */
+
+static void testPerfect(void)
+{
+   enum {KEY_COUNT = 10000};
+   enum {MAX_KEY_LENGTH = 32};
+   enum {MAX_SOURCE_LENGTH = 4096};
+
+   static const char *apcWords[] =
+   {
+      "auto", "break", "case", "char", "const", "continue", "default",
+      "do", "double", "else", "enum", "extern", "float", "for",
+      "goto", "if", "int", "long", "register", "return", "short",
+      "signed", "sizeof", "static", "struct", "switch", "typedef",
+      "union", "unsigned", "void", "volatile", "while",
+      "", "say \"?\?=\"", "back\\slash", "tab\t"
+   };
+   enum {WORD_COUNT = sizeof(apcWords) / sizeof(apcWords[0])};
+
+   static int aiWords[WORD_COUNT];
+   static int aiValues[KEY_COUNT];
+   static char acSource[MAX_SOURCE_LENGTH];
+   SymTable_T oSymTable;
+   SymPerfect_T oSymPerfect;
+   FILE *psFile;
+   char acKey[MAX_KEY_LENGTH];
+   size_t uSourceLength;
+   size_t uCount;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymPerfect functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* an empty table compiles to an empty SymPerfect */
+   oSymPerfect = SymPerfect_compile(oSymTable);
+   ASSURE(oSymPerfect != NULL);
+   if (oSymPerfect == NULL)
+      return;
+   ASSURE(SymPerfect_getLength(oSymPerfect) == 0);
+   ASSURE(! SymPerfect_contains(oSymPerfect, "auto"));
+   ASSURE(SymPerfect_get(oSymPerfect, "") == NULL);
+   SymPerfect_free(oSymPerfect);
+
+   for (i = 0; i < (int)WORD_COUNT; i++)
+   {
+      aiWords[i] = i;
+      ASSURE(SymTable_put(oSymTable, apcWords[i], &aiWords[i]));
+   }
+   oSymPerfect = SymPerfect_compile(oSymTable);
+   SymTable_free(oSymTable);
+
+   /* the SymPerfect outlives the table it was compiled from */
+   ASSURE(oSymPerfect != NULL);
+   if (oSymPerfect == NULL)
+      return;
+   ASSURE(SymPerfect_getLength(oSymPerfect) == WORD_COUNT);
+   for (i = 0; i < (int)WORD_COUNT; i++)
+   {
+      ASSURE(SymPerfect_get(oSymPerfect, apcWords[i]) == &aiWords[i]);
+      ASSURE(SymPerfect_contains(oSymPerfect, apcWords[i]));
+   }
+   ASSURE(! SymPerfect_contains(oSymPerfect, "inline"));
+   ASSURE(! SymPerfect_contains(oSymPerfect, "whil"));
+   ASSURE(SymPerfect_get(oSymPerfect, "while ") == NULL);
+   uCount = 0;
+   SymPerfect_map(oSymPerfect, countBinding, &uCount);
+   ASSURE(uCount == WORD_COUNT);
+
+   /* the source defines the table, escaping what C would not accept
+      in a string literal */
+   psFile = tmpfile();
+   ASSURE(psFile != NULL);
+   if (psFile != NULL)
+   {
+      ASSURE(SymPerfect_writeSource(oSymPerfect, psFile, "Keyword",
+                                    writeIntAddress, aiWords));
+      rewind(psFile);
+      uSourceLength = fread(acSource, 1, sizeof(acSource) - 1, psFile);
+      acSource[uSourceLength] = '\0';
+      fclose(psFile);
+      ASSURE(uSourceLength < sizeof(acSource) - 1);
+      ASSURE(strstr(acSource, "void *Keyword_get(const char *pcKey)")
+             != NULL);
+      ASSURE(strstr(acSource, "{\"say \\\"\\?\\?=\\\"\", 9U, ") !=
+             NULL);
+      ASSURE(strstr(acSource, "{\"back\\\\slash\", 10U, ") != NULL);
+      ASSURE(strstr(acSource, "{\"tab\\011\", 4U, ") != NULL);
+      ASSURE(strstr(acSource, "&aiWords[31]},") != NULL);
+   }
+   SymPerfect_free(oSymPerfect);
+
+   /* a large key set */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "perfect%d", i);
+      aiValues[i] = i;
+      ASSURE(SymTable_put(oSymTable, acKey, &aiValues[i]));
+   }
+   oSymPerfect = SymPerfect_compile(oSymTable);
+   SymTable_free(oSymTable);
+   ASSURE(oSymPerfect != NULL);
+   if (oSymPerfect == NULL)
+      return;
+   ASSURE(SymPerfect_getLength(oSymPerfect) == KEY_COUNT);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "perfect%d", i);
+      ASSURE(SymPerfect_get(oSymPerfect, acKey) == &aiValues[i]);
+   }
+   ASSURE(! SymPerfect_contains(oSymPerfect, "perfect10000"));
+   SymPerfect_free(oSymPerfect);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* number of keys that every thread of testConcurrent() reads and
+   writes. */
+enum {SHARED_KEY_COUNT = 100};
+
+/* the value of every shared key. */
+static char acSharedValue[] = "shared";
+
+/* The work of one thread of testConcurrent(). */
+
+struct ConcurrentWork
+{
+   /* the table all the threads share. */
+   SymConc_T oSymConc;
+
+   /* the number of this thread, which all its own keys begin with. */
+   int iThread;
+
+   /* the number of keys this thread puts. */
+   int iOpCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Do the work *(struct ConcurrentWork*)pvWork: put iOpCount keys of
+   this thread's own, each bound to pvWork, reading and rewriting a
+   shared key after each put, and then remove the odd-numbered ones.
+   Return NULL. */
+
+static void *doConcurrentWork(void *pvWork)
+{
+   enum {MAX_KEY_LENGTH = 32};
+
+   struct ConcurrentWork *psWork;
+   char acKey[MAX_KEY_LENGTH];
+   char acSharedKey[MAX_KEY_LENGTH];
+   void *pvValue;
+   int i;
+   int iSuccessful;
+
+   assert(pvWork != NULL);
+
+   psWork = (struct ConcurrentWork*)pvWork;
+   for (i = 0; i < psWork->iOpCount; i++)
+   {
+      sprintf(acKey, "%d-%d", psWork->iThread, i);
+      iSuccessful = SymConc_put(psWork->oSymConc, acKey, psWork);
+      ASSURE(iSuccessful);
+      pvValue = SymConc_get(psWork->oSymConc, acKey);
+      ASSURE(pvValue == psWork);
+
+      sprintf(acSharedKey, "shared-%d", i % SHARED_KEY_COUNT);
+      pvValue = SymConc_get(psWork->oSymConc, acSharedKey);
+      ASSURE(pvValue == acSharedValue);
+      iSuccessful =
+         SymConc_upsert(psWork->oSymConc, acSharedKey, acSharedValue);
+      ASSURE(iSuccessful);
+   }
+
+   for (i = 1; i < psWork->iOpCount; i += 2)
+   {
+      sprintf(acKey, "%d-%d", psWork->iThread, i);
+      pvValue = SymConc_remove(psWork->oSymConc, acKey);
+      ASSURE(pvValue == psWork);
+   }
+
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymConc object, first from one thread and then shared by
+   iThreadCount threads that each put iOpCount keys. Write the time
+   consumed to stdout. */
+
+static void testConcurrent(int iThreadCount, int iOpCount)
+{
+   enum {MAX_THREAD_COUNT = 256};
+   enum {MAX_KEY_LENGTH = 32};
+
+   SymConc_T oSymConc;
+   static pthread_t aiThreads[MAX_THREAD_COUNT];
+   static struct ConcurrentWork asWork[MAX_THREAD_COUNT];
+   char acKey[MAX_KEY_LENGTH];
+   char acJeter[] = "Jeter";
+   char acRodriguez[] = "Rodriguez";
+   char *pcValue;
+   void *pvValue;
+   size_t uCount;
+   int iSuccessful;
+   int i;
+   int iThread;
+   clock_t iInitialClock;
+   clock_t iFinalClock;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymConc object shared by %d threads.\n",
+          iThreadCount);
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   ASSURE(iThreadCount > 0 && iThreadCount <= MAX_THREAD_COUNT);
+   if (iThreadCount <= 0 || iThreadCount > MAX_THREAD_COUNT)
+      return;
+
+   iInitialClock = clock();
+
+   /* from one thread, a SymConc behaves like a SymTable */
+   oSymConc = SymConc_new();
+   ASSURE(oSymConc != NULL);
+   iSuccessful = SymConc_put(oSymConc, "Shortstop", acJeter);
+   ASSURE(iSuccessful);
+   iSuccessful = SymConc_put(oSymConc, "Shortstop", acRodriguez);
+   ASSURE(! iSuccessful);
+   pcValue = (char*)SymConc_replace(oSymConc, "Shortstop", acRodriguez);
+   ASSURE(pcValue == acJeter);
+   pcValue = (char*)SymConc_get(oSymConc, "Shortstop");
+   ASSURE(pcValue == acRodriguez);
+   iSuccessful = SymConc_upsert(oSymConc, "Catcher", acJeter);
+   ASSURE(iSuccessful);
+   ASSURE(SymConc_contains(oSymConc, "Catcher"));
+   ASSURE(SymConc_getLength(oSymConc) == 2);
+   uCount = 0;
+   SymConc_map(oSymConc, countBinding, &uCount);
+   ASSURE(uCount == 2);
+   pcValue = (char*)SymConc_remove(oSymConc, "Catcher");
+   ASSURE(pcValue == acJeter);
+   ASSURE(! SymConc_contains(oSymConc, "Catcher"));
+   pcValue = (char*)SymConc_remove(oSymConc, "Shortstop");
+   ASSURE(pcValue == acRodriguez);
+   ASSURE(SymConc_getLength(oSymConc) == 0);
+
+   /* then many threads put, get, and remove keys of their own while
+      all of them read and rewrite the shared keys */
+   for (i = 0; i < SHARED_KEY_COUNT; i++)
+   {
+      sprintf(acKey, "shared-%d", i);
+      iSuccessful = SymConc_put(oSymConc, acKey, acSharedValue);
+      ASSURE(iSuccessful);
+   }
+
+   for (iThread = 0; iThread < iThreadCount; iThread++)
+   {
+      asWork[iThread].oSymConc = oSymConc;
+      asWork[iThread].iThread = iThread;
+      asWork[iThread].iOpCount = iOpCount;
+      iSuccessful = pthread_create(&aiThreads[iThread], NULL,
+                                   doConcurrentWork,
+                                   &asWork[iThread]) == 0;
+      ASSURE(iSuccessful);
+   }
+   for (iThread = 0; iThread < iThreadCount; iThread++)
+      pthread_join(aiThreads[iThread], NULL);
+
+   /* each thread's even-numbered keys are left, with the shared
+      ones */
+   ASSURE(SymConc_getLength(oSymConc) ==
+          (size_t)(SHARED_KEY_COUNT +
+                   iThreadCount * (iOpCount - iOpCount / 2)));
+   for (iThread = 0; iThread < iThreadCount; iThread++)
+   {
+      for (i = 0; i < iOpCount; i++)
+      {
+         sprintf(acKey, "%d-%d", iThread, i);
+         pvValue = SymConc_get(oSymConc, acKey);
+         ASSURE(pvValue == (i % 2 == 0 ? &asWork[iThread] : NULL));
+      }
+   }
+
+   SymConc_free(oSymConc);
+
+   iFinalClock = clock();
+   printf("CPU time (%d threads, %d keys each):  %f seconds\n",
+      iThreadCount, iOpCount,
+      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* number of keys whose values the writer of testRcu() keeps
+   replacing. */
+enum {STABLE_KEY_COUNT = 100};
+
+/* the two values that the stable keys alternate between, and the
+   value of every other key. */
+static char acStableValue1[] = "first";
+static char acStableValue2[] = "second";
+static char acChurnValue[] = "churn";
+
+/* The work of one reading thread of testRcu(). */
+
+struct RcuWork
+{
+   /* the table all the threads share. */
+   SymRcu_T oSymRcu;
+
+   /* the number of keys the writer puts, and of lookups to make. */
+   int iOpCount;
+   int iReadCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Do the work *(struct RcuWork*)pvWork: through a reader of its own,
+   look up stable keys and keys that the writer is putting and
+   removing, and check that each is either absent or bound to a value
+   it could have. Return NULL. */
+
+static void *doRcuWork(void *pvWork)
+{
+   enum {MAX_KEY_LENGTH = 32};
+
+   struct RcuWork *psWork;
+   SymRcuReader_T oReader;
+   char acKey[MAX_KEY_LENGTH];
+   void *pvValue;
+   int i;
+
+   assert(pvWork != NULL);
+
+   psWork = (struct RcuWork*)pvWork;
+   oReader = SymRcu_newReader(psWork->oSymRcu);
+   ASSURE(oReader != NULL);
+   if (oReader == NULL)
+      return NULL;
+
+   for (i = 0; i < psWork->iReadCount; i++)
+   {
+      sprintf(acKey, "stable-%d", i % STABLE_KEY_COUNT);
+      pvValue = SymRcu_get(oReader, acKey);
+      ASSURE(pvValue == acStableValue1 || pvValue == acStableValue2);
+
+      sprintf(acKey, "churn-%d", i % psWork->iOpCount);
+      pvValue = SymRcu_get(oReader, acKey);
+      ASSURE(pvValue == NULL || pvValue == acChurnValue);
+   }
+
+   SymRcu_freeReader(oReader);
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymRcu object, first from one thread and then changed by
+   one thread, which puts iOpCount keys and removes half of them,
+   while iThreadCount others look keys up. Write the time consumed to
+   stdout. */
+
+static void testRcu(int iThreadCount, int iOpCount)
+{
+   enum {MAX_THREAD_COUNT = 256};
+   enum {MAX_KEY_LENGTH = 32};
+
+   SymRcu_T oSymRcu;
+   SymRcuReader_T oReader;
+   static pthread_t aiThreads[MAX_THREAD_COUNT];
+   struct RcuWork sWork;
+   char acKey[MAX_KEY_LENGTH];
+   char acJeter[] = "Jeter";
+   char acRodriguez[] = "Rodriguez";
+   char *pcValue;
+   void *pvValue;
+   int iSuccessful;
+   int i;
+   int iThread;
+   clock_t iInitialClock;
+   clock_t iFinalClock;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymRcu object read by %d threads.\n",
+          iThreadCount);
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   ASSURE(iThreadCount > 0 && iThreadCount <= MAX_THREAD_COUNT);
+   if (iThreadCount <= 0 || iThreadCount > MAX_THREAD_COUNT ||
+       iOpCount <= 0)
+      return;
+
+   iInitialClock = clock();
+
+   /* from one thread, a SymRcu behaves like a SymTable */
+   oSymRcu = SymRcu_new();
+   ASSURE(oSymRcu != NULL);
+   oReader = SymRcu_newReader(oSymRcu);
+   ASSURE(oReader != NULL);
+   iSuccessful = SymRcu_put(oSymRcu, "Shortstop", acJeter);
+   ASSURE(iSuccessful);
+   iSuccessful = SymRcu_put(oSymRcu, "Shortstop", acRodriguez);
+   ASSURE(! iSuccessful);
+   pcValue = (char*)SymRcu_get(oReader, "Shortstop");
+   ASSURE(pcValue == acJeter);
+   pcValue = (char*)SymRcu_replace(oSymRcu, "Shortstop", acRodriguez);
+   ASSURE(pcValue == acJeter);
+   pcValue = (char*)SymRcu_get(oReader, "Shortstop");
+   ASSURE(pcValue == acRodriguez);
+   pcValue = (char*)SymRcu_replace(oSymRcu, "Catcher", acJeter);
+   ASSURE(pcValue == NULL);
+   ASSURE(! SymRcu_contains(oReader, "Catcher"));
+   iSuccessful = SymRcu_put(oSymRcu, "Catcher", NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymRcu_contains(oReader, "Catcher"));
+   ASSURE(SymRcu_get(oReader, "Catcher") == NULL);
+   ASSURE(SymRcu_getLength(oSymRcu) == 2);
+   pvValue = SymRcu_remove(oSymRcu, "Catcher");
+   ASSURE(pvValue == NULL);
+   ASSURE(! SymRcu_contains(oReader, "Catcher"));
+   pcValue = (char*)SymRcu_remove(oSymRcu, "Shortstop");
+   ASSURE(pcValue == acRodriguez);
+   ASSURE(SymRcu_remove(oSymRcu, "Shortstop") == NULL);
+   ASSURE(SymRcu_getLength(oSymRcu) == 0);
+   SymRcu_freeReader(oReader);
+
+   /* then one thread changes it, growing it through several
+      expansions, while the others keep looking keys up */
+   for (i = 0; i < STABLE_KEY_COUNT; i++)
+   {
+      sprintf(acKey, "stable-%d", i);
+      iSuccessful = SymRcu_put(oSymRcu, acKey, acStableValue1);
+      ASSURE(iSuccessful);
+   }
+
+   sWork.oSymRcu = oSymRcu;
+   sWork.iOpCount = iOpCount;
+   sWork.iReadCount = iOpCount * 2;
+   for (iThread = 0; iThread < iThreadCount; iThread++)
+   {
+      iSuccessful = pthread_create(&aiThreads[iThread], NULL,
+                                   doRcuWork, &sWork) == 0;
+      ASSURE(iSuccessful);
+   }
+
+   for (i = 0; i < iOpCount; i++)
+   {
+      sprintf(acKey, "churn-%d", i);
+      iSuccessful = SymRcu_put(oSymRcu, acKey, acChurnValue);
+      ASSURE(iSuccessful);
+
+      sprintf(acKey, "stable-%d", i % STABLE_KEY_COUNT);
+      pcValue = (i / STABLE_KEY_COUNT) % 2 == 0 ?
+         acStableValue2 : acStableValue1;
+      pvValue = SymRcu_replace(oSymRcu, acKey, pcValue);
+      ASSURE(pvValue == acStableValue1 || pvValue == acStableValue2);
+
+      if (i % 2 == 1)
+      {
+         sprintf(acKey, "churn-%d", i - 1);
+         pvValue = SymRcu_remove(oSymRcu, acKey);
+         ASSURE(pvValue == acChurnValue);
+      }
+   }
+
+   for (iThread = 0; iThread < iThreadCount; iThread++)
+      pthread_join(aiThreads[iThread], NULL);
+
+   /* the odd-numbered keys are left, with the stable ones */
+   ASSURE(SymRcu_getLength(oSymRcu) ==
+          (size_t)(STABLE_KEY_COUNT + iOpCount / 2));
+   oReader = SymRcu_newReader(oSymRcu);
+   ASSURE(oReader != NULL);
+   for (i = 0; i < iOpCount; i++)
+   {
+      sprintf(acKey, "churn-%d", i);
+      pvValue = SymRcu_get(oReader, acKey);
+      ASSURE(pvValue == (i % 2 == 1 ? acChurnValue : NULL));
+   }
+   SymRcu_freeReader(oReader);
+
+   SymRcu_free(oSymRcu);
+
+   iFinalClock = clock();
+   printf("CPU time (%d readers, %d keys written):  %f seconds\n",
+      iThreadCount, iOpCount,
+      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the ability of a SymTable object to be large, that is, to
    contain iBindingCount bindings. Write the time consumed to stdout. */
 
 static void testLargeTable(int iBindingCount)
 {
    enum {MAX_KEY_LENGTH = 10};
+   enum {BATCH_SIZE = 64};
 
    SymTable_T oSymTable;
    SymTable_T oSymTableSmall;
    char acKey[MAX_KEY_LENGTH];
+   char aacBatchKeys[BATCH_SIZE][MAX_KEY_LENGTH];
+   const char *apcBatchKeys[BATCH_SIZE];
+   void *apvBatchValues[BATCH_SIZE];
    char *pcValue;
    int i;
+   int j;
+   int iBatchLength;
    int iSmall;
    int iLarge;
    int iSuccessful;
    clock_t iInitialClock;
+   clock_t iGetClock;
+   clock_t iBatchClock;
+   clock_t iBatchEndClock;
    clock_t iFinalClock;
    size_t uLength = 0;
    size_t uLength2;
@@ -832,6 +4357,7 @@ static void testLargeTable(int iBindingCount)
 
    /* Get each binding's value, and make sure that it contains
       the same characters as its key. */
+   iGetClock = clock();
    iSmall = 0;
    iLarge = iBindingCount - 1;
    while (iSmall < iLarge)
@@ -858,6 +4384,30 @@ static void testLargeTable(int iBindingCount)
       ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
    }
 
+   /* Get each binding's value again, BATCH_SIZE keys at a time, so
+      the time taken can be compared with that of the gets above. */
+   iBatchClock = clock();
+   for (i = 0; i < iBindingCount; i += iBatchLength)
+   {
+      iBatchLength = iBindingCount - i;
+      if (iBatchLength > BATCH_SIZE)
+         iBatchLength = BATCH_SIZE;
+      for (j = 0; j < iBatchLength; j++)
+      {
+         sprintf(aacBatchKeys[j], "%d", i + j);
+         apcBatchKeys[j] = aacBatchKeys[j];
+      }
+      SymTable_getBatch(oSymTable, apcBatchKeys, (size_t)iBatchLength,
+                        apvBatchValues);
+      for (j = 0; j < iBatchLength; j++)
+      {
+         pcValue = (char*)apvBatchValues[j];
+         ASSURE((pcValue != NULL) &&
+                (strcmp(pcValue, aacBatchKeys[j]) == 0));
+      }
+   }
+   iBatchEndClock = clock();
+
    /* Remove each binding. Also free each binding's value. */
    iSmall = 0;
    iLarge = iBindingCount - 1;
@@ -910,6 +4460,11 @@ static void testLargeTable(int iBindingCount)
 
    /* Note the current time, and print the time consumed to stdout. */
    iFinalClock = clock();
+   printf("CPU time (%d gets, one at a time):  %f seconds\n",
+      iBindingCount, ((double)(iBatchClock - iGetClock)) / CLOCKS_PER_SEC);
+   printf("CPU time (%d gets, in batches of %d):  %f seconds\n",
+      iBindingCount, (int)BATCH_SIZE,
+      ((double)(iBatchEndClock - iBatchClock)) / CLOCKS_PER_SEC);
    printf("CPU time (%d bindings):  %f seconds\n", iBindingCount,
       ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
    fflush(stdout);
@@ -921,16 +4476,22 @@ static void testLargeTable(int iBindingCount)
    As always, argc is the command-line argument count, argv contains
    the command-line arguments, and argv[0] is the name of the
    executable binary file. argv[1] is the number of bindings to put
-   into a potentially large SymTable object.  Exit with EXIT_FAILURE
-   if argv[1] is missing or not numeric.  Otherwise return 0. */
+   into a potentially large SymTable object. argv[2], if present, is
+   the number of threads to stress a SymConc object with; each puts
+   argv[1] keys of its own. Exit with EXIT_FAILURE if argv[1] is
+   missing or either argument is not numeric.  Otherwise return 0. */
 
 int main(int argc, char *argv[])
 {
+   enum {DEFAULT_THREAD_COUNT = 4};
+
    int iBindingCount;
+   int iThreadCount;
 
-   if (argc != 2)
+   if (argc != 2 && argc != 3)
    {
-      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      fprintf(stderr, "Usage: %s bindingcount [threadcount]\n",
+              argv[0]);
       exit(EXIT_FAILURE);
    }
 
@@ -944,6 +4505,14 @@ int main(int argc, char *argv[])
       fprintf(stderr, "bindingcount cannot be negative\n");
       exit(EXIT_FAILURE);
    }
+
+   iThreadCount = DEFAULT_THREAD_COUNT;
+   if (argc == 3 && (sscanf(argv[2], "%d", &iThreadCount) != 1 ||
+                     iThreadCount <= 0))
+   {
+      fprintf(stderr, "threadcount must be a positive number\n");
+      exit(EXIT_FAILURE);
+   }
    
 #ifndef S_SPLINT_S
    setCpuTimeLimit();
@@ -960,7 +4529,47 @@ int main(int argc, char *argv[])
    testLongKey();
    testTableOfTables();
    testCollisions();
+   testLoadFactor(0.25);
+   testLoadFactor(4.0);
+   testIncrementalRehash();
+   testHashFunctions();
+   testSeededCollisions();
+   testHashOptions();
+   testKeyLengths();
+   testReuse();
+   testBorrowedKeys();
+   testSmallTables();
+   testMoveToFront();
+   testShrink();
+   testStats();
+   testTrace();
+   testReserve();
+   testMemoryUsage();
+   testIter();
+   testRemoveIf();
+   testScope();
+   testIntern();
+   testIdMap();
+   testTyped();
+   testSnap();
+   testUpsert();
+   testLengthFunctions();
+   testBatch();
+   testParallel(iThreadCount, iBindingCount);
+   testOrder(iBindingCount);
+   testImage();
+   testPerfect();
    testLargeTable(iBindingCount);
+   if (argc == 3)
+   {
+      testConcurrent(iThreadCount, iBindingCount);
+      testRcu(iThreadCount, iBindingCount);
+   }
+   else
+   {
+      testConcurrent(iThreadCount, iBindingCount / iThreadCount);
+      testRcu(iThreadCount, iBindingCount / iThreadCount);
+   }
 
    printf("------------------------------------------------------\n");
    printf("End of %s.\n", argv[0]);